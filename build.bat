@@ -268,6 +268,8 @@ REM USAGE function: output a usage message
 	echo    utests      : run all the defined unit tests.
 	echo    suites      : run all the defined unit tests, individually.
 	echo    suite:U     : run one unit test, U.
+	echo    bench       : run the conversion benchmarks; the results are
+	echo                  saved to bench_conversion.json, in the build dir.
 	echo    package[:V] : generate the installer. V is a versioning string
 	echo                  that will be added to the installer file name and can
 	echo                  can only be specified before the project/make files
@@ -650,6 +652,14 @@ REM TESTS_SUITE_S function: run the compiled unit tests
 			)
 		)
 	)
+	if /i not [%ARG:bench=%] == [%ARG%] (
+		echo %~nx0: running the conversion benchmarks.
+		test\%BUILD_TYPE%\bench_conversion.exe ^
+			--gtest_output=json:bench_conversion.json
+		if ERRORLEVEL 1 (
+			goto END
+		)
+	)
 
 	goto:eof
 
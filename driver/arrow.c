@@ -0,0 +1,1037 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License;
+ * you may not use this file except in compliance with the Elastic License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <timestamp.h>
+#include <cborinternal_p.h> /* for decode_half() */
+
+#include "ujdecode.h"
+#include "arrow.h"
+#include "log.h"
+#include "queries.h"
+
+/* initial size of a column's buffers and of a dictionary's hash table */
+#define ARROW_BUFF_INIT		256
+#define ARROW_SLOTS_INIT	64
+
+/* how the result set columns are exported */
+typedef enum {
+	ACOL_NULL,
+	ACOL_BOOL,
+	ACOL_INT8,
+	ACOL_INT16,
+	ACOL_INT32,
+	ACOL_INT64,
+	ACOL_UINT64,
+	ACOL_FLOAT,
+	ACOL_DOUBLE,
+	ACOL_TIMESTAMP, /* microseconds since Epoch, UTC */
+	ACOL_DATE, /* days since Epoch */
+	ACOL_TIME, /* microseconds since midnight */
+	ACOL_DICT, /* dictionary-encoded UTF-8 (keywords) */
+	ACOL_UTF8, /* anything else: the value as received */
+} acol_type_et;
+
+/* growable buffer */
+typedef struct {
+	uint8_t *mem;
+	size_t cnt; /* used bytes */
+	size_t cap; /* allocated bytes */
+} abuff_st;
+
+/* the builder of one column of a record batch */
+typedef struct {
+	acol_type_et type;
+	size_t width; /* byte size of a fixed-width value */
+	int64_t nulls;
+	abuff_st valid; /* validity bitmap */
+	abuff_st vals; /* values (bitmap for bools), offsets or dict indexes */
+	abuff_st data; /* UTF-8 bytes */
+	/* keywords' dictionary: offsets and data of the distinct values, plus
+	 * an open addressing hash table of (1-based) indexes into these */
+	abuff_st doffs;
+	abuff_st ddata;
+	int32_t dcnt;
+	int32_t *slots;
+	size_t nslots; /* power of 2 */
+} acol_st;
+
+/* a value received from ES, normalized over the JSON and CBOR encodings */
+typedef struct {
+	enum {
+		AVAL_NULL,
+		AVAL_BOOL,
+		AVAL_INT,
+		AVAL_UINT,
+		AVAL_DBL,
+		AVAL_STR,
+	} type;
+	BOOL b;
+	int64_t i64;
+	uint64_t u64;
+	double dbl;
+	cstr_st u8; /* text, UTF-8 encoded; not 0-terminated */
+} aval_st;
+
+/* private data of the exported structures: these own all their memory */
+typedef struct {
+	const void *buffers[3];
+	struct ArrowArray *children;
+	struct ArrowArray **child_ptrs;
+	struct ArrowArray dictionary;
+} array_priv_st;
+
+typedef struct {
+	char *name;
+	struct ArrowSchema *children;
+	struct ArrowSchema **child_ptrs;
+	struct ArrowSchema dictionary;
+} schema_priv_st;
+
+static const wstr_st keyword_type = WSTR_INIT("KEYWORD");
+
+
+static BOOL abuff_reserve(abuff_st *buff, size_t add)
+{
+	size_t cap;
+	uint8_t *mem;
+
+	if (buff->cnt + add <= buff->cap) {
+		return TRUE;
+	}
+	cap = buff->cap ? buff->cap : ARROW_BUFF_INIT;
+	while (cap < buff->cnt + add) {
+		cap *= 2;
+	}
+	if (! (mem = realloc(buff->mem, cap))) {
+		ERRN("OOM for %zu bytes.", cap);
+		return FALSE;
+	}
+	buff->mem = mem;
+	buff->cap = cap;
+	return TRUE;
+}
+
+static inline BOOL abuff_append(abuff_st *buff, const void *data, size_t len)
+{
+	if (! abuff_reserve(buff, len)) {
+		return FALSE;
+	}
+	memcpy(buff->mem + buff->cnt, data, len);
+	buff->cnt += len;
+	return TRUE;
+}
+
+/* hand over the buffer's memory */
+static inline void *abuff_take(abuff_st *buff)
+{
+	void *mem = buff->mem;
+	memset(buff, 0, sizeof(*buff));
+	return mem;
+}
+
+/* set bit #'idx' in a bitmap growing one bit at a time */
+static inline BOOL bitmap_append(abuff_st *bmap, int64_t idx, BOOL set)
+{
+	if ((idx & 7) == 0) {
+		if (! abuff_reserve(bmap, 1)) {
+			return FALSE;
+		}
+		bmap->mem[bmap->cnt ++] = 0;
+	}
+	if (set) {
+		bmap->mem[idx >> 3] |= (uint8_t)(1 << (idx & 7));
+	}
+	return TRUE;
+}
+
+/* append a string to a pair of UTF-8 offsets and data buffers */
+static BOOL utf8_append(abuff_st *offs, abuff_st *data, const cstr_st *u8)
+{
+	int32_t end;
+
+	/* the pages' size is capped far below this, by MaxBodySizeMB */
+	if (INT32_MAX - data->cnt < u8->cnt) {
+		ERR("UTF-8 data buffer exceeding 32-bit offsets.");
+		return FALSE;
+	}
+	if (u8->cnt && (! abuff_append(data, u8->str, u8->cnt))) {
+		return FALSE;
+	}
+	end = (int32_t)data->cnt;
+	return abuff_append(offs, &end, sizeof(end));
+}
+
+/* (re)build the dictionary's hash table, double the size */
+static BOOL dict_rehash(acol_st *col)
+{
+	size_t nslots, h;
+	int32_t *slots, *offs, i;
+
+	nslots = col->nslots ? col->nslots * 2 : ARROW_SLOTS_INIT;
+	if (! (slots = calloc(nslots, sizeof(*slots)))) {
+		ERRN("OOM for %zu slots.", nslots);
+		return FALSE;
+	}
+	offs = (int32_t *)col->doffs.mem;
+	for (i = 0; i < col->dcnt; i ++) {
+		h = (size_t)fnv1a_hash(ESODBC_FNV1A_BASIS, col->ddata.mem + offs[i],
+				offs[i + 1] - offs[i]);
+		for (h &= nslots - 1; slots[h]; h = (h + 1) & (nslots - 1))
+			;
+		slots[h] = i + 1;
+	}
+	free(col->slots);
+	col->slots = slots;
+	col->nslots = nslots;
+	return TRUE;
+}
+
+/* get the dictionary index of a keyword, adding it if new */
+static BOOL dict_index(acol_st *col, const cstr_st *u8, int32_t *idx)
+{
+	size_t h;
+	int32_t *offs, i;
+
+	/* keep the table at most half full */
+	if (col->nslots <= 2 * (size_t)col->dcnt && (! dict_rehash(col))) {
+		return FALSE;
+	}
+	offs = (int32_t *)col->doffs.mem;
+	h = (size_t)fnv1a_hash(ESODBC_FNV1A_BASIS, u8->str, u8->cnt) &
+		(col->nslots - 1);
+	for (; col->slots[h]; h = (h + 1) & (col->nslots - 1)) {
+		i = col->slots[h] - 1;
+		if ((size_t)(offs[i + 1] - offs[i]) == u8->cnt &&
+			memcmp(col->ddata.mem + offs[i], u8->str, u8->cnt) == 0) {
+			*idx = i;
+			return TRUE;
+		}
+	}
+	if (! utf8_append(&col->doffs, &col->ddata, u8)) {
+		return FALSE;
+	}
+	*idx = col->dcnt ++;
+	col->slots[h] = col->dcnt;
+	return TRUE;
+}
+
+static void init_column(esodbc_rec_st *irec, acol_st *col)
+{
+	esodbc_estype_st *es_type = irec->es_type;
+	int32_t zero = 0;
+
+	memset(col, 0, sizeof(*col));
+	col->type = ACOL_UTF8;
+	if (! es_type) {
+		/* shouldn't happen, the types are checked when attaching the page */
+		assert(0);
+	} else if (es_type->data_type == ES_NULL_TO_SQL) {
+		col->type = ACOL_NULL;
+	} else {
+		switch (es_type->c_concise_type) {
+			case SQL_C_BIT:
+				col->type = ACOL_BOOL;
+				break;
+			case SQL_C_TINYINT:
+			case SQL_C_STINYINT:
+				col->type = ACOL_INT8;
+				col->width = sizeof(int8_t);
+				break;
+			case SQL_C_SSHORT:
+				col->type = ACOL_INT16;
+				col->width = sizeof(int16_t);
+				break;
+			case SQL_C_SLONG:
+				col->type = ACOL_INT32;
+				col->width = sizeof(int32_t);
+				break;
+			case SQL_C_SBIGINT:
+				col->type = ACOL_INT64;
+				col->width = sizeof(int64_t);
+				break;
+			case SQL_C_UBIGINT:
+				col->type = ACOL_UINT64;
+				col->width = sizeof(uint64_t);
+				break;
+			case SQL_C_FLOAT:
+				col->type = ACOL_FLOAT;
+				col->width = sizeof(float);
+				break;
+			case SQL_C_DOUBLE:
+				col->type = ACOL_DOUBLE;
+				col->width = sizeof(double);
+				break;
+			case SQL_C_TYPE_TIMESTAMP:
+				col->type = ACOL_TIMESTAMP;
+				col->width = sizeof(int64_t);
+				break;
+			case SQL_C_TYPE_DATE:
+				col->type = ACOL_DATE;
+				col->width = sizeof(int32_t);
+				break;
+			case SQL_C_TYPE_TIME:
+				col->type = ACOL_TIME;
+				col->width = sizeof(int64_t);
+				break;
+			case ES_KEYWORD_TO_CSQL:
+				if (EQ_CASE_WSTR(&es_type->type_name, &keyword_type)) {
+					col->type = ACOL_DICT;
+					col->width = sizeof(int32_t);
+				}
+				break;
+		}
+	}
+	/* variable-length data starts with a 0 offset (in an otherwise empty
+	 * buffer, the append can't fail) */
+	if (col->type == ACOL_UTF8) {
+		abuff_append(&col->vals, &zero, sizeof(zero));
+	} else if (col->type == ACOL_DICT) {
+		abuff_append(&col->doffs, &zero, sizeof(zero));
+	}
+}
+
+static void free_columns(acol_st *cols, SQLSMALLINT cnt)
+{
+	SQLSMALLINT i;
+
+	for (i = 0; i < cnt; i ++) {
+		free(cols[i].valid.mem);
+		free(cols[i].vals.mem);
+		free(cols[i].data.mem);
+		free(cols[i].doffs.mem);
+		free(cols[i].ddata.mem);
+		free(cols[i].slots);
+	}
+	free(cols);
+}
+
+static const char *column_format(acol_type_et type)
+{
+	switch (type) {
+		case ACOL_NULL:
+			return "n";
+		case ACOL_BOOL:
+			return "b";
+		case ACOL_INT8:
+			return "c";
+		case ACOL_INT16:
+			return "s";
+		case ACOL_INT32:
+		case ACOL_DICT: /* the indexes */
+			return "i";
+		case ACOL_INT64:
+			return "l";
+		case ACOL_UINT64:
+			return "L";
+		case ACOL_FLOAT:
+			return "f";
+		case ACOL_DOUBLE:
+			return "g";
+		case ACOL_TIMESTAMP:
+			return "tsu:UTC";
+		case ACOL_DATE:
+			return "tdD";
+		case ACOL_TIME:
+			return "ttu";
+		default:
+			assert(0);
+		/* no break */
+		case ACOL_UTF8:
+			return "u";
+	}
+}
+
+/*
+ * Read the value of a column, as referenced in the IRD record by the last
+ * scan of a row. JSON strings are transcoded into the 'scratch' buffer.
+ */
+static BOOL read_value(esodbc_stmt_st *stmt, esodbc_rec_st *irec,
+	abuff_st *scratch, aval_st *val)
+{
+	CborValue *obj;
+	CborType elem_type;
+	CborError res;
+	const wchar_t *wstr;
+	size_t len;
+	int cnt;
+	uint16_t ui16;
+	float flt;
+	bool boolval;
+
+	if (irec->ovr.set) {
+		val->type = AVAL_INT;
+		val->i64 = irec->ovr.val;
+		return TRUE;
+	}
+	if (stmt->rset.pack_json) {
+		switch (UJGetType(irec->i_val.json)) {
+			case UJT_Null:
+				val->type = AVAL_NULL;
+				return TRUE;
+			case UJT_True:
+			case UJT_False:
+				val->type = AVAL_BOOL;
+				val->b = UJGetType(irec->i_val.json) == UJT_True;
+				return TRUE;
+			case UJT_Long:
+			case UJT_LongLong:
+				val->type = AVAL_INT;
+				val->i64 = UJNumericLongLong(irec->i_val.json);
+				return TRUE;
+			case UJT_UnsignedLongLong:
+				val->type = AVAL_UINT;
+				val->u64 = UJNumericUnsignedLongLong(irec->i_val.json);
+				return TRUE;
+			case UJT_Double:
+				val->type = AVAL_DBL;
+				val->dbl = UJNumericFloat(irec->i_val.json);
+				return TRUE;
+			case UJT_String:
+				val->type = AVAL_STR;
+				wstr = UJReadString(irec->i_val.json, &len);
+				val->u8.cnt = 0;
+				val->u8.str = scratch->mem;
+				if (len <= 0) {
+					return TRUE;
+				}
+				/* worst case: 3 UTF-8 bytes per UTF-16 unit */
+				scratch->cnt = 0;
+				if (! abuff_reserve(scratch, 3 * len)) {
+					return FALSE;
+				}
+				cnt = U16WC_TO_MBU8(wstr, len, scratch->mem, scratch->cap);
+				if (cnt <= 0) {
+					ERRH(stmt, "failed to transcode to UTF-8 string `"
+						LWPDL "`.", (int)len, wstr);
+					return FALSE;
+				}
+				val->u8.str = scratch->mem;
+				val->u8.cnt = cnt;
+				return TRUE;
+			default:
+				ERRH(stmt, "unexpected object of type %d.",
+					UJGetType(irec->i_val.json));
+				return FALSE;
+		}
+	}
+
+	obj = &irec->i_val.cbor;
+	switch ((elem_type = cbor_value_get_type(obj))) {
+		case CborNullType:
+			val->type = AVAL_NULL;
+			return TRUE;
+		case CborBooleanType:
+			res = cbor_value_get_boolean(obj, &boolval);
+			val->type = AVAL_BOOL;
+			val->b = boolval;
+			break;
+		case CborIntegerType:
+			val->type = AVAL_INT;
+			res = cbor_value_get_int64_checked(obj, &val->i64);
+			if (res == CborErrorDataTooLarge &&
+				cbor_value_is_unsigned_integer(obj)) {
+				val->type = AVAL_UINT;
+				res = cbor_value_get_uint64(obj, &val->u64);
+			}
+			break;
+		case CborTagType: /* unsigned long (see copy_one_cell_cbor()) */
+			val->type = AVAL_UINT;
+			res = cbor_value_get_tagged_uint64(obj, &val->u64);
+			break;
+		case CborHalfFloatType:
+			val->type = AVAL_DBL;
+			res = cbor_value_get_half_float(obj, &ui16);
+			val->dbl = decode_half(ui16);
+			break;
+		case CborFloatType:
+			val->type = AVAL_DBL;
+			res = cbor_value_get_float(obj, &flt);
+			val->dbl = (double)flt;
+			break;
+		case CborDoubleType:
+			val->type = AVAL_DBL;
+			res = cbor_value_get_double(obj, &val->dbl);
+			break;
+		case CborTextStringType:
+			/* the text is UTF-8 already: reference it in place */
+			val->type = AVAL_STR;
+			res = cbor_value_get_unchunked_string(obj,
+					(const char **)&val->u8.str, &val->u8.cnt);
+			break;
+		default:
+			ERRH(stmt, "unexpected elem. of type 0x%x.", elem_type);
+			return FALSE;
+	}
+	if (res != CborNoError) {
+		ERRH(stmt, "failed to extract value of type 0x%x: %s.", elem_type,
+			cbor_error_string(res));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* the ISO 8601 string of a DATETIME, DATE or TIME to Arrow's scale */
+static BOOL parse_temporal(acol_type_et type, const cstr_st *u8, int64_t *out)
+{
+	static const char epoch[] = "1970-01-01T";
+	static const char midnight[] = "T00:00:00Z";
+	char buff[sizeof(epoch) + ISO8601_TIMESTAMP_MAX_LEN];
+	const char *str = (const char *)u8->str;
+	size_t len = u8->cnt;
+	timestamp_t tsp;
+	int64_t days, secs;
+
+	if (type == ACOL_DATE && len == DATE_TEMPLATE_LEN) {
+		memcpy(buff, str, len);
+		memcpy(buff + len, midnight, sizeof(midnight) - 1);
+		str = buff;
+		len += sizeof(midnight) - 1;
+	} else if (type == ACOL_TIME && len < ISO8601_TIMESTAMP_MAX_LEN &&
+		(! memchr(str, 'T', len))) {
+		/* a time only: place it on the Epoch day */
+		memcpy(buff, epoch, sizeof(epoch) - 1);
+		memcpy(buff + sizeof(epoch) - 1, str, len);
+		str = buff;
+		len += sizeof(epoch) - 1;
+	}
+	if (timestamp_parse(str, len, &tsp)) {
+		return FALSE;
+	}
+
+	/* floor'ed division, for the values before Epoch */
+	days = tsp.sec / 86400 - (tsp.sec % 86400 < 0);
+	secs = tsp.sec - days * 86400;
+	switch (type) {
+		case ACOL_DATE:
+			*out = days;
+			break;
+		case ACOL_TIME:
+			*out = secs * 1000000 + tsp.nsec / 1000;
+			break;
+		default:
+			*out = tsp.sec * 1000000 + tsp.nsec / 1000;
+	}
+	return TRUE;
+}
+
+/* render a non-text value into a text column */
+static BOOL value_to_text(aval_st *val, abuff_st *scratch)
+{
+	char buff[32];
+	int cnt;
+
+	switch (val->type) {
+		case AVAL_BOOL:
+			cnt = snprintf(buff, sizeof(buff), "%s",
+					val->b ? "true" : "false");
+			break;
+		case AVAL_INT:
+			cnt = snprintf(buff, sizeof(buff), "%lld", (long long)val->i64);
+			break;
+		case AVAL_UINT:
+			cnt = snprintf(buff, sizeof(buff), "%llu",
+					(unsigned long long)val->u64);
+			break;
+		case AVAL_DBL:
+			cnt = snprintf(buff, sizeof(buff), "%.17g", val->dbl);
+			break;
+		default:
+			return FALSE;
+	}
+	if (cnt <= 0) {
+		return FALSE;
+	}
+	scratch->cnt = 0;
+	if (! abuff_append(scratch, buff, cnt)) {
+		return FALSE;
+	}
+	val->type = AVAL_STR;
+	val->u8.str = scratch->mem;
+	val->u8.cnt = cnt;
+	return TRUE;
+}
+
+/*
+ * Append the value of one row to the column being built.
+ * row: the index of the row in the batch
+ * colno: column number, for the diagnostic
+ */
+static SQLRETURN append_value(esodbc_stmt_st *stmt, acol_st *col,
+	int64_t row, aval_st *val, abuff_st *scratch, SQLINTEGER colno)
+{
+	union {
+		int8_t i8;
+		int16_t i16;
+		int32_t i32;
+		int64_t i64;
+		uint64_t u64;
+		float flt;
+		double dbl;
+	} num;
+	esodbc_state_et state = SQL_STATE_HY000;
+	BOOL valid, bit = FALSE;
+	int64_t i64;
+
+	valid = val->type != AVAL_NULL;
+	if (! bitmap_append(&col->valid, row, valid)) {
+		goto oom;
+	}
+	if (! valid) {
+		col->nulls ++;
+		memset(&num, 0, sizeof(num));
+		if (col->type == ACOL_UTF8) {
+			val->u8.cnt = 0;
+		}
+	} else {
+		/* bring the value to the column's type */
+		switch (col->type) {
+			case ACOL_NULL:
+				break;
+			case ACOL_BOOL:
+				if (val->type == AVAL_BOOL) {
+					bit = val->b;
+				} else if (val->type == AVAL_INT) {
+					bit = val->i64 != 0;
+				} else {
+					goto inv_val;
+				}
+				break;
+
+			do {
+			case ACOL_INT8:
+			case ACOL_INT16:
+			case ACOL_INT32:
+			case ACOL_INT64:
+				if (val->type == AVAL_INT) {
+					i64 = val->i64;
+				} else if (val->type == AVAL_UINT && val->u64 <= INT64_MAX) {
+					i64 = (int64_t)val->u64;
+				} else {
+					goto inv_val;
+				}
+			} while (0);
+				state = SQL_STATE_22003;
+				if (col->type == ACOL_INT8) {
+					if (i64 < INT8_MIN || INT8_MAX < i64) {
+						goto inv_val;
+					}
+					num.i8 = (int8_t)i64;
+				} else if (col->type == ACOL_INT16) {
+					if (i64 < INT16_MIN || INT16_MAX < i64) {
+						goto inv_val;
+					}
+					num.i16 = (int16_t)i64;
+				} else if (col->type == ACOL_INT32) {
+					if (i64 < INT32_MIN || INT32_MAX < i64) {
+						goto inv_val;
+					}
+					num.i32 = (int32_t)i64;
+				} else {
+					num.i64 = i64;
+				}
+				break;
+
+			case ACOL_UINT64:
+				if (val->type == AVAL_UINT) {
+					num.u64 = val->u64;
+				} else if (val->type == AVAL_INT && 0 <= val->i64) {
+					num.u64 = (uint64_t)val->i64;
+				} else {
+					goto inv_val;
+				}
+				break;
+
+			case ACOL_FLOAT:
+			case ACOL_DOUBLE:
+				if (val->type == AVAL_DBL) {
+					num.dbl = val->dbl;
+				} else if (val->type == AVAL_INT) {
+					num.dbl = (double)val->i64;
+				} else if (val->type == AVAL_UINT) {
+					num.dbl = (double)val->u64;
+				} else {
+					goto inv_val;
+				}
+				if (col->type == ACOL_FLOAT) {
+					num.flt = (float)num.dbl;
+				}
+				break;
+
+			case ACOL_TIMESTAMP:
+			case ACOL_DATE:
+			case ACOL_TIME:
+				state = SQL_STATE_22007;
+				if (val->type != AVAL_STR ||
+					(! parse_temporal(col->type, &val->u8, &num.i64))) {
+					goto inv_val;
+				}
+				if (col->type == ACOL_DATE) {
+					num.i32 = (int32_t)num.i64;
+				}
+				break;
+
+			case ACOL_DICT:
+			case ACOL_UTF8:
+				if (val->type != AVAL_STR && (! value_to_text(val, scratch))) {
+					goto oom;
+				}
+				break;
+		}
+	}
+
+	switch (col->type) {
+		case ACOL_NULL:
+			break;
+		case ACOL_BOOL:
+			if (! bitmap_append(&col->vals, row, bit)) {
+				goto oom;
+			}
+			break;
+		case ACOL_UTF8:
+			if (! utf8_append(&col->vals, &col->data, &val->u8)) {
+				goto oom;
+			}
+			break;
+		case ACOL_DICT:
+			if (valid && (! dict_index(col, &val->u8, &num.i32))) {
+				goto oom;
+			}
+		/* no break */
+		default:
+			if (! abuff_append(&col->vals, &num, col->width)) {
+				goto oom;
+			}
+	}
+	return SQL_SUCCESS;
+
+inv_val:
+	ERRH(stmt, "value of type %d can't be exported in column #%d of "
+		"type %d.", val->type, colno, col->type);
+	return post_row_diagnostic(stmt, state,
+			state == SQL_STATE_HY000 ? MK_WPTR("Invalid server answer") :
+			NULL, /*code*/0, stmt->tv_rows, colno);
+oom:
+	return post_row_diagnostic(stmt, SQL_STATE_HY001, NULL, /*code*/0,
+			stmt->tv_rows, colno);
+}
+
+static void release_array(struct ArrowArray *array)
+{
+	array_priv_st *priv = (array_priv_st *)array->private_data;
+	int64_t i;
+
+	/* the children moved by the consumer are marked as released */
+	for (i = 0; i < array->n_children; i ++) {
+		if (array->children[i]->release) {
+			array->children[i]->release(array->children[i]);
+		}
+	}
+	if (array->dictionary && array->dictionary->release) {
+		array->dictionary->release(array->dictionary);
+	}
+	for (i = 0; i < array->n_buffers; i ++) {
+		free((void *)array->buffers[i]);
+	}
+	free(priv->children);
+	free(priv->child_ptrs);
+	free(priv);
+	array->release = NULL;
+}
+
+static void release_schema(struct ArrowSchema *schema)
+{
+	schema_priv_st *priv = (schema_priv_st *)schema->private_data;
+	int64_t i;
+
+	for (i = 0; i < schema->n_children; i ++) {
+		if (schema->children[i]->release) {
+			schema->children[i]->release(schema->children[i]);
+		}
+	}
+	if (schema->dictionary && schema->dictionary->release) {
+		schema->dictionary->release(schema->dictionary);
+	}
+	free(priv->name);
+	free(priv->children);
+	free(priv->child_ptrs);
+	free(priv);
+	schema->release = NULL;
+}
+
+/* Set up an (empty) exported array, ready to be released. */
+static BOOL init_array(struct ArrowArray *array, int64_t length,
+	int64_t n_buffers)
+{
+	array_priv_st *priv;
+
+	memset(array, 0, sizeof(*array));
+	if (! (priv = calloc(1, sizeof(*priv)))) {
+		ERRN("OOM for %zu bytes.", sizeof(*priv));
+		return FALSE;
+	}
+	array->length = length;
+	array->n_buffers = n_buffers;
+	array->buffers = priv->buffers;
+	array->private_data = priv;
+	array->release = release_array;
+	return TRUE;
+}
+
+static BOOL init_schema(struct ArrowSchema *schema, const char *format,
+	int64_t flags)
+{
+	schema_priv_st *priv;
+
+	memset(schema, 0, sizeof(*schema));
+	if (! (priv = calloc(1, sizeof(*priv)))) {
+		ERRN("OOM for %zu bytes.", sizeof(*priv));
+		return FALSE;
+	}
+	schema->format = format;
+	schema->flags = flags;
+	schema->private_data = priv;
+	schema->release = release_schema;
+	return TRUE;
+}
+
+/* hand the built column over to an exported array */
+static BOOL export_column(acol_st *col, int64_t rows, struct ArrowArray *out)
+{
+	array_priv_st *priv;
+	struct ArrowArray *dict;
+
+	if (! init_array(out, rows, col->type == ACOL_NULL ? 0 :
+			col->type == ACOL_UTF8 ? 3 : 2)) {
+		return FALSE;
+	}
+	if (col->type == ACOL_NULL) {
+		out->null_count = rows;
+		return TRUE;
+	}
+	priv = (array_priv_st *)out->private_data;
+	out->null_count = col->nulls;
+	/* the validity bitmap can be left out if no value is NULL */
+	priv->buffers[0] = col->nulls ? abuff_take(&col->valid) : NULL;
+	priv->buffers[1] = abuff_take(&col->vals);
+	if (col->type == ACOL_UTF8) {
+		priv->buffers[2] = abuff_take(&col->data);
+	} else if (col->type == ACOL_DICT) {
+		dict = &priv->dictionary;
+		if (! init_array(dict, col->dcnt, 3)) {
+			return FALSE;
+		}
+		out->dictionary = dict;
+		priv = (array_priv_st *)dict->private_data;
+		priv->buffers[1] = abuff_take(&col->doffs);
+		priv->buffers[2] = abuff_take(&col->ddata);
+	}
+	return TRUE;
+}
+
+static BOOL export_batch(acol_st *cols, SQLSMALLINT ncols, int64_t rows,
+	struct ArrowArray *out)
+{
+	array_priv_st *priv;
+	SQLSMALLINT i;
+
+	if (! init_array(out, rows, /*struct's validity*/1)) {
+		return FALSE;
+	}
+	priv = (array_priv_st *)out->private_data;
+	priv->children = calloc(ncols, sizeof(*priv->children));
+	priv->child_ptrs = calloc(ncols, sizeof(*priv->child_ptrs));
+	if (! (priv->children && priv->child_ptrs)) {
+		ERRN("OOM for %hd children.", ncols);
+		return FALSE;
+	}
+	out->children = priv->child_ptrs;
+	out->n_children = ncols;
+	for (i = 0; i < ncols; i ++) {
+		priv->child_ptrs[i] = &priv->children[i];
+		if (! export_column(&cols[i], rows, &priv->children[i])) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static BOOL export_schema(esodbc_desc_st *ird, acol_st *cols,
+	struct ArrowSchema *out)
+{
+	schema_priv_st *priv;
+	struct ArrowSchema *child;
+	wstr_st *name;
+	SQLSMALLINT i;
+	int cnt;
+
+	if (! init_schema(out, "+s", 0)) {
+		return FALSE;
+	}
+	priv = (schema_priv_st *)out->private_data;
+	priv->children = calloc(ird->count, sizeof(*priv->children));
+	priv->child_ptrs = calloc(ird->count, sizeof(*priv->child_ptrs));
+	if (! (priv->children && priv->child_ptrs)) {
+		ERRN("OOM for %hd children.", ird->count);
+		return FALSE;
+	}
+	out->children = priv->child_ptrs;
+	out->n_children = ird->count;
+
+	for (i = 0; i < ird->count; i ++) {
+		child = &priv->children[i];
+		priv->child_ptrs[i] = child;
+		if (! init_schema(child, column_format(cols[i].type),
+				ARROW_FLAG_NULLABLE)) {
+			return FALSE;
+		}
+		/* column name, as UTF-8 */
+		name = &ird->recs[i].name;
+		cnt = name->cnt ? U16WC_TO_MBU8(name->str, name->cnt, NULL, 0) : 0;
+		if (cnt < 0) {
+			cnt = 0;
+		}
+		if (! (child->name = malloc(cnt + /*\0*/1))) {
+			ERRN("OOM for %d bytes.", cnt + 1);
+			return FALSE;
+		}
+		((schema_priv_st *)child->private_data)->name = (char *)child->name;
+		if (cnt) {
+			cnt = U16WC_TO_MBU8(name->str, name->cnt, child->name, cnt);
+		}
+		((char *)child->name)[0 < cnt ? cnt : 0] = '\0';
+
+		if (cols[i].type == ACOL_DICT) {
+			child->dictionary =
+				&((schema_priv_st *)child->private_data)->dictionary;
+			if (! init_schema(child->dictionary, "u", 0)) {
+				child->dictionary = NULL;
+				return FALSE;
+			}
+		}
+	}
+	return TRUE;
+}
+
+SQLRETURN EsSQLFetchArrow(SQLHSTMT StatementHandle,
+	struct ArrowSchema *Schema, struct ArrowArray *Array)
+{
+	esodbc_stmt_st *stmt;
+	esodbc_desc_st *ird;
+	esodbc_rec_st *irec;
+	acol_st *cols;
+	abuff_st scratch = {0};
+	aval_st val;
+	SQLSMALLINT i;
+	SQLRETURN ret;
+	int64_t rows;
+	LONG64 start;
+
+	stmt = STMH(StatementHandle);
+	ird = stmt->ird;
+
+	if (! (Schema && Array)) {
+		ERRH(stmt, "NULL Arrow structure provided.");
+		RET_HDIAGS(stmt, SQL_STATE_HY009);
+	}
+	Schema->release = NULL;
+	Array->release = NULL;
+
+	if (! STMT_HAS_RESULTSET(stmt)) {
+		if (STMT_NODATA_FORCED(stmt)) {
+			DBGH(stmt, "empty result set flag set - returning no data.");
+			return SQL_NO_DATA;
+		}
+		ERRH(stmt, "no resultset available on statement.");
+		RET_HDIAGS(stmt, SQL_STATE_HY010);
+	}
+	if (ird->count <= 0) {
+		ERRH(stmt, "no columns in result set.");
+		RET_HDIAGS(stmt, SQL_STATE_HY010);
+	}
+
+	/* reset SQLGetData state, to reset fetch position */
+	STMT_GD_RESET(stmt);
+
+	/* get to the first row left to export */
+	while ((ret = scan_row(stmt)) == SQL_NO_DATA) {
+		ret = fetch_next_page(stmt);
+		if (ret == SQL_NO_DATA) {
+			INFOH(stmt, "no data %sto return.", stmt->rset.vrows ?
+				"left " : "");
+			return SQL_NO_DATA;
+		} else if (! SQL_SUCCEEDED(ret)) {
+			return ret;
+		}
+	}
+	if (! SQL_SUCCEEDED(ret)) {
+		ERRH(stmt, "scanning row %zu failed.", stmt->tv_rows);
+		return ret;
+	}
+
+	/* have the next page requested, while the current one is exported */
+	prefetch_start(stmt);
+
+	if (! (cols = calloc(ird->count, sizeof(*cols)))) {
+		ERRNH(stmt, "OOM for %hd columns.", ird->count);
+		RET_HDIAGS(stmt, SQL_STATE_HY001);
+	}
+	for (i = 0; i < ird->count; i ++) {
+		init_column(&ird->recs[i], &cols[i]);
+	}
+
+	start = perf_clock();
+	rows = 0;
+	do {
+		for (i = 0; i < ird->count; i ++) {
+			irec = &ird->recs[i];
+			if (! read_value(stmt, irec, &scratch, &val)) {
+				ret = post_row_diagnostic(stmt, SQL_STATE_HY000,
+						MK_WPTR("Invalid server answer"), /*code*/0,
+						stmt->tv_rows, i + 1);
+				goto end;
+			}
+			ret = append_value(stmt, &cols[i], rows, &val, &scratch, i + 1);
+			if (! SQL_SUCCEEDED(ret)) {
+				goto end;
+			}
+		}
+		rows ++;
+	} while ((ret = scan_row(stmt)) != SQL_NO_DATA && SQL_SUCCEEDED(ret));
+	if (ret != SQL_NO_DATA) {
+		ERRH(stmt, "scanning row %zu failed.", stmt->tv_rows);
+		goto end;
+	}
+
+	if (! (export_schema(ird, cols, Schema) &&
+			export_batch(cols, ird->count, rows, Array))) {
+		post_diagnostic(stmt, SQL_STATE_HY001, NULL, 0);
+		ret = SQL_ERROR;
+		goto end;
+	}
+	DBGH(stmt, "exported batch of %lld rows, %hd columns; cursor left @ "
+		"row # %zu in set # %zu.", (long long)rows, ird->count,
+		stmt->rset.vrows, stmt->nset);
+	STMT_PERF_COUNT(stmt, ESODBC_PERF_ROWS, rows);
+	ret = SQL_SUCCESS;
+
+end:
+	STMT_PERF_LAPSE(stmt, ESODBC_PERF_TIME_CONVERT, start);
+	if (! SQL_SUCCEEDED(ret)) {
+		if (Schema->release) {
+			Schema->release(Schema);
+		}
+		if (Array->release) {
+			Array->release(Array);
+		}
+	}
+	free_columns(cols, ird->count);
+	free(scratch.mem);
+	return ret;
+}
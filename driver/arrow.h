@@ -0,0 +1,78 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License;
+ * you may not use this file except in compliance with the Elastic License.
+ */
+#ifndef __ARROW_H__
+#define __ARROW_H__
+
+#include <stdint.h>
+
+#include "error.h"
+#include "handles.h"
+
+/*
+ * Apache Arrow C Data Interface: the ABI-stable structures, as published by
+ * the Arrow project (https://arrow.apache.org/docs/format/CDataInterface.html).
+ * The guard is the one the specification mandates, so that the definitions
+ * can coexist with those of an Arrow implementation the application uses.
+ */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED	1
+#define ARROW_FLAG_NULLABLE				2
+#define ARROW_FLAG_MAP_KEYS_SORTED		4
+
+struct ArrowSchema {
+	/* array type description */
+	const char *format;
+	const char *name;
+	const char *metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema **children;
+	struct ArrowSchema *dictionary;
+
+	/* release callback */
+	void (*release)(struct ArrowSchema *);
+	/* opaque producer-specific data */
+	void *private_data;
+};
+
+struct ArrowArray {
+	/* array data description */
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void **buffers;
+	struct ArrowArray **children;
+	struct ArrowArray *dictionary;
+
+	/* release callback */
+	void (*release)(struct ArrowArray *);
+	/* opaque producer-specific data */
+	void *private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+/*
+ * Driver extension, exported by the driver's library (not by the Driver
+ * Manager): the statement handle it takes is the driver's, obtainable with
+ * SQLGetInfo(SQL_DRIVER_HSTMT).
+ * Each call exports the rows of the result set not yet fetched from the
+ * current page received from Elasticsearch as one record batch: a struct
+ * array with one child per result set column, together with its schema.
+ * The structures are owned by the application after the call and must be
+ * released through their release callbacks.
+ * Returns SQL_NO_DATA once the result set is exhausted.
+ */
+SQLRETURN EsSQLFetchArrow(SQLHSTMT StatementHandle,
+	struct ArrowSchema *Schema, struct ArrowArray *Array);
+SQLRETURN SQL_API SQLFetchArrow(SQLHSTMT StatementHandle,
+	struct ArrowSchema *Schema, struct ArrowArray *Array);
+
+#endif /* __ARROW_H__ */
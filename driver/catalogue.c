@@ -53,6 +53,181 @@ static SQLRETURN fake_answer(SQLHSTMT hstmt, cstr_st *answer)
 	return attach_answer(STMH(hstmt), &fake, /*is JSON*/TRUE);
 }
 
+/* catalog answer cached by a connection, keyed by the SQL generated for it
+ * and the current catalog (which the request is sent along with) */
+typedef struct catalog_cache {
+	struct catalog_cache *next;
+	wstr_st sql;
+	wstr_st catalog;
+	cstr_st body;
+	BOOL is_json;
+	ULONGLONG loaded; /* tick count at caching time */
+} catalog_cache_st;
+
+/* unlink an entry from the cache list and free it */
+static void cat_cache_unlink(esodbc_dbc_st *dbc, catalog_cache_st **link)
+{
+	catalog_cache_st *entry = *link;
+
+	*link = entry->next;
+	assert(entry->body.cnt <= dbc->cat_cache_size);
+	dbc->cat_cache_size -= entry->body.cnt;
+	free(entry->sql.str);
+	free(entry->catalog.str);
+	free(entry->body.str);
+	free(entry);
+}
+
+/* does the entry hold the answer of the query, with the current catalog? */
+static inline BOOL cat_cache_match(esodbc_dbc_st *dbc,
+	catalog_cache_st *entry, wstr_st *sql)
+{
+	return EQ_WSTR(&entry->sql, sql) &&
+		EQ_WSTR(&entry->catalog, &dbc->catalog.w);
+}
+
+void catalog_cache_clear(esodbc_dbc_st *dbc)
+{
+	ESODBC_MUX_LOCK(&dbc->cat_cache_mux);
+	while (dbc->cat_cache) {
+		cat_cache_unlink(dbc, &dbc->cat_cache);
+	}
+	assert(! dbc->cat_cache_size);
+	ESODBC_MUX_UNLOCK(&dbc->cat_cache_mux);
+}
+
+/* Copy into 'body' the cached answer of the query, if available and not
+ * expired. Returns TRUE on cache hit. */
+BOOL TEST_API cat_cache_lookup(esodbc_dbc_st *dbc, wstr_st *sql,
+	cstr_st *body, BOOL *is_json)
+{
+	catalog_cache_st *entry, **link;
+	ULONGLONG now = GetTickCount64();
+	BOOL found = FALSE;
+
+	ESODBC_MUX_LOCK(&dbc->cat_cache_mux);
+	for (link = &dbc->cat_cache; (entry = *link); link = &entry->next) {
+		if (cat_cache_match(dbc, entry, sql)) {
+			break;
+		}
+	}
+	if (entry) {
+		if (entry->loaded + dbc->meta_cache_ttl * 1000ULL <= now) {
+			DBGH(dbc, "dropping expired catalog cache entry.");
+			cat_cache_unlink(dbc, link);
+		} else if (! (body->str = malloc(entry->body.cnt + /*\0*/1))) {
+			ERRNH(dbc, "OOM for %zu bytes.", entry->body.cnt + 1);
+		} else {
+			memcpy(body->str, entry->body.str, entry->body.cnt);
+			body->str[entry->body.cnt] = '\0';
+			body->cnt = entry->body.cnt;
+			*is_json = entry->is_json;
+			/* move the entry to the front of the list */
+			*link = entry->next;
+			entry->next = dbc->cat_cache;
+			dbc->cat_cache = entry;
+			found = TRUE;
+		}
+	}
+	ESODBC_MUX_UNLOCK(&dbc->cat_cache_mux);
+	return found;
+}
+
+/* Cache a copy of the statement's answer to the query; the least recently
+ * used entries are evicted once the cache outgrows its maximum size. */
+void TEST_API cat_cache_add(esodbc_stmt_st *stmt, wstr_st *sql)
+{
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	cstr_st *body = &stmt->rset.body;
+	catalog_cache_st *entry, **link;
+
+	if (ESODBC_CATALOG_CACHE_MAX < body->cnt) {
+		INFOH(stmt, "catalog answer too large to cache: %zu bytes.",
+			body->cnt);
+		return;
+	}
+	if (! (entry = calloc(1, sizeof(*entry)))) {
+		ERRNH(stmt, "OOM for %zu bytes.", sizeof(*entry));
+		return; /* not fatal: just won't cache */
+	}
+	entry->sql.str = malloc(sql->cnt * sizeof(SQLWCHAR));
+	/* (+1: no 0-sized allocations with no current catalog) */
+	entry->catalog.str = malloc((dbc->catalog.w.cnt + 1) * sizeof(SQLWCHAR));
+	entry->body.str = malloc(body->cnt);
+	if ((! entry->sql.str) || (! entry->catalog.str) || (! entry->body.str)) {
+		ERRNH(stmt, "OOM for %zu bytes.", (sql->cnt + dbc->catalog.w.cnt + 1)
+			* sizeof(SQLWCHAR) + body->cnt);
+		free(entry->sql.str);
+		free(entry->catalog.str);
+		free(entry->body.str);
+		free(entry);
+		return;
+	}
+	wmemcpy(entry->sql.str, sql->str, sql->cnt);
+	entry->sql.cnt = sql->cnt;
+	wmemcpy(entry->catalog.str, dbc->catalog.w.str, dbc->catalog.w.cnt);
+	entry->catalog.cnt = dbc->catalog.w.cnt;
+	memcpy(entry->body.str, body->str, body->cnt);
+	entry->body.cnt = body->cnt;
+	entry->is_json = stmt->rset.pack_json;
+	entry->loaded = GetTickCount64();
+
+	ESODBC_MUX_LOCK(&dbc->cat_cache_mux);
+	/* drop any entry added meanwhile by a concurrently executing statement */
+	for (link = &dbc->cat_cache; *link; link = &(*link)->next) {
+		if (cat_cache_match(dbc, *link, sql)) {
+			cat_cache_unlink(dbc, link);
+			break;
+		}
+	}
+	entry->next = dbc->cat_cache;
+	dbc->cat_cache = entry;
+	dbc->cat_cache_size += entry->body.cnt;
+	while (ESODBC_CATALOG_CACHE_MAX < dbc->cat_cache_size) {
+		/* the just added entry is the last to be evicted */
+		for (link = &dbc->cat_cache; (*link)->next; link = &(*link)->next)
+			;
+		cat_cache_unlink(dbc, link);
+	}
+	ESODBC_MUX_UNLOCK(&dbc->cat_cache_mux);
+	DBGH(stmt, "catalog answer cached: %zu bytes (total: %zu).",
+		body->cnt, dbc->cat_cache_size);
+}
+
+/*
+ * Execute a catalog query. With a metadata cache TTL set, the answer is
+ * served out of the connection's catalog cache, if available, or cached
+ * otherwise (if complete, i.e. not paginated).
+ */
+SQLRETURN catalog_exec(esodbc_stmt_st *stmt, SQLWCHAR *sql, size_t cnt)
+{
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	wstr_st key = {sql, cnt};
+	cstr_st body;
+	BOOL is_json;
+	SQLRETURN ret;
+
+	/* no caching, or an asynchronous execution is being polled for */
+	if ((! dbc->meta_cache_ttl) || STMT_ASYNC_UNDERWAY(stmt)) {
+		return EsSQLExecDirectW(stmt, sql, (SQLINTEGER)cnt);
+	}
+
+	if (cat_cache_lookup(dbc, &key, &body, &is_json)) {
+		DBGH(stmt, "catalog answer served from cache for `" LWPDL "`.",
+			LWSTR(&key));
+		ret = EsSQLFreeStmt(stmt, ESODBC_SQL_CLOSE);
+		assert(SQL_SUCCEEDED(ret)); /* can't return error */
+		return attach_answer(stmt, &body, is_json);
+	}
+
+	ret = EsSQLExecDirectW(stmt, sql, (SQLINTEGER)cnt);
+	if (SQL_SUCCEEDED(ret) && (! STMT_HAS_CURSOR(stmt)) &&
+		stmt->rset.body.cnt) {
+		cat_cache_add(stmt, &key);
+	}
+	return ret;
+}
+
 SQLRETURN EsSQLStatisticsW(
 	SQLHSTMT           hstmt,
 	_In_reads_opt_(cchCatalogName) SQLWCHAR    *szCatalogName,
@@ -101,8 +276,27 @@ void free_current_catalog(esodbc_dbc_st *dbc)
 	}
 }
 
+void free_server_attrs(esodbc_dbc_st *dbc, BOOL catalog_only)
+{
+	if (dbc->srv_attrs.catalog.str) {
+		free(dbc->srv_attrs.catalog.str);
+		dbc->srv_attrs.catalog.str = NULL;
+		dbc->srv_attrs.catalog.cnt = 0;
+	}
+	if (catalog_only) {
+		return;
+	}
+	if (dbc->srv_attrs.user.str) {
+		free(dbc->srv_attrs.user.str);
+		dbc->srv_attrs.user.str = NULL;
+		dbc->srv_attrs.user.cnt = 0;
+	}
+}
+
 SQLRETURN set_current_catalog(esodbc_dbc_st *dbc, wstr_st *catalog)
 {
+	/* the server will report the newly set catalog, if any */
+	free_server_attrs(dbc, /*catalog only*/TRUE);
 	if (dbc->catalog.w.cnt) {
 		DBGH(dbc, "catalog previously set to `" LWPDL "`.",
 			LWSTR(&dbc->catalog.w));
@@ -136,7 +330,9 @@ err:
 }
 
 /* writes into 'dest', of size 'room', the current requested attr. of 'dbc'.
- * returns negative on error, or the char count written otherwise */
+ * returns negative on error, or the char count written otherwise.
+ * The value is only queried from the server once per connection (or once
+ * per current catalog change, for the catalog). */
 SQLSMALLINT fetch_server_attr(esodbc_dbc_st *dbc, SQLINTEGER attr_id,
 	SQLWCHAR *dest, SQLSMALLINT room)
 {
@@ -148,6 +344,31 @@ SQLSMALLINT fetch_server_attr(esodbc_dbc_st *dbc, SQLINTEGER attr_id,
 	static const size_t buff_cnt = ESODBC_MAX_IDENTIFIER_LEN + /*\0*/1;
 	wstr_st attr_val;
 	wstr_st attr_sql;
+	wstr_st *cached;
+
+	switch (attr_id) {
+		case SQL_ATTR_CURRENT_CATALOG:
+			attr_sql = MK_WSTR("SELECT database()");
+			cached = &dbc->srv_attrs.catalog;
+			break;
+		case SQL_USER_NAME:
+			attr_sql = MK_WSTR("SELECT user()");
+			cached = &dbc->srv_attrs.user;
+			break;
+		default:
+			BUGH(dbc, "unexpected attribute ID: %ld.", attr_id);
+			return -1;
+	}
+
+	if (cached->str) {
+		DBGH(dbc, "attribute %ld cached value: `" LWPDL "`.", attr_id,
+			LWSTR(cached));
+		if (! SQL_SUCCEEDED(write_wstr(dbc, dest, cached, room, &used))) {
+			ERRH(dbc, "failed to copy value: `" LWPDL "`.", LWSTR(cached));
+			return -1;
+		}
+		return used;
+	}
 
 	buff = malloc(sizeof(*buff) * buff_cnt);
 	if (! buff) {
@@ -160,18 +381,8 @@ SQLSMALLINT fetch_server_attr(esodbc_dbc_st *dbc, SQLINTEGER attr_id,
 		goto end;
 	}
 	assert(stmt);
-
-	switch (attr_id) {
-		case SQL_ATTR_CURRENT_CATALOG:
-			attr_sql = MK_WSTR("SELECT database()");
-			break;
-		case SQL_USER_NAME:
-			attr_sql = MK_WSTR("SELECT user()");
-			break;
-		default:
-			BUGH(dbc, "unexpected attribute ID: %ld.", attr_id);
-			goto end;
-	}
+	/* internal statement: don't inherit application's async mode */
+	STMH(stmt)->async_enable = SQL_ASYNC_ENABLE_OFF;
 
 	if (! SQL_SUCCEEDED(attach_sql(stmt, attr_sql.str, attr_sql.cnt))) {
 		ERRH(dbc, "failed to attach query to statement.");
@@ -218,6 +429,15 @@ SQLSMALLINT fetch_server_attr(esodbc_dbc_st *dbc, SQLINTEGER attr_id,
 	}
 	DBGH(dbc, "attribute %ld value: `" LWPDL "`.", attr_id, LWSTR(&attr_val));
 
+	/* cache the value; failing to is not fatal */
+	if ((cached->str = malloc((attr_val.cnt + 1) * sizeof(SQLWCHAR)))) {
+		wmemcpy(cached->str, attr_val.str, attr_val.cnt);
+		cached->str[attr_val.cnt] = L'\0';
+		cached->cnt = attr_val.cnt;
+	} else {
+		ERRNH(dbc, "OOM for %zu wchars.", attr_val.cnt + 1);
+	}
+
 	if (! SQL_SUCCEEDED(write_wstr(dbc, dest, &attr_val, room, &used))) {
 		ERRH(dbc, "failed to copy value: `" LWPDL "`.", LWSTR(&attr_val));
 		used = -1; /* write_wstr() can change pointer, and still fail */
@@ -457,7 +677,7 @@ SQLRETURN EsSQLTablesW(
 
 	DBGH(stmt, "tables catalog SQL [%zu]:`" LWPDL "`.", pos, (int)pos, pbuf);
 
-	ret = EsSQLExecDirectW(stmt, pbuf, (SQLINTEGER)pos);
+	ret = catalog_exec(stmt, pbuf, pos);
 end:
 	free(pbuf);
 	return ret;
@@ -496,222 +716,62 @@ static inline BOOL col_of_type(SQLSMALLINT idx, SQLSMALLINT type)
 	return false;
 }
 
-static SQLRETURN safe_copy(esodbc_stmt_st *stmt, wstr_st *dest,
-	size_t *pos, SQLWCHAR *str, size_t cnt)
-{
-	SQLWCHAR *r;
-
-	DBGH(stmt, "writing @pos=%zu / max=%zu string [%zu] `" LWPDL "`.", *pos,
-		dest->cnt, cnt, cnt, str ? str : L"<null>");
-	/* is there enough room to copy the new string? */
-	assert(cnt);
-	if (dest->cnt <= *pos + cnt) {
-		dest->cnt = dest->cnt ? dest->cnt : ESODBC_BODY_BUF_START_SIZE;
-		while (dest->cnt <= *pos + cnt) {
-			dest->cnt *= 3;
-		}
-		if (! (r = realloc(dest->str, dest->cnt * sizeof(SQLWCHAR)))) {
-			ERRNH(stmt, "OOM: %zu w-chars.", dest->cnt);
-			RET_HDIAGS(stmt, SQL_STATE_HY001);
-		} else {
-			dest->str = r;
-		}
-	}
-	if (str) {
-		wmemcpy(dest->str + *pos, str, cnt);
-		*pos += cnt;
-		DBGH(stmt, "crr buffer: [%zu] `" LWPDL "`.", *pos, *pos, dest->str);
-	}
-	return SQL_SUCCESS;
-}
-
-static SQLRETURN copy_one_cell(esodbc_stmt_st *stmt, wstr_st *dest,
-	size_t *pos, long row_cnt, SQLSMALLINT col_idx)
-{
-	SQLRETURN ret;
-	BOOL is_str;
-	SQLLEN len_ind;
-	const static wstr_st null = WSTR_INIT("null"), qmark = WSTR_INIT("\"");
-
-	/* fetch data's length (always converted to w-string) */
-	ret = EsSQLGetData(stmt, col_idx, SQL_C_WCHAR, dest->str, 0, &len_ind);
-	if (! SQL_SUCCEEDED(ret)) {
-		ERRH(stmt, "failed to get data length for cell@[%ld, %hd].",
-			row_cnt, col_idx);
-		return ret;
-	}
-	/* null data */
-	if (len_ind == SQL_NULL_DATA) {
-		return safe_copy(stmt, dest, pos, null.str, null.cnt);
-	} else if (len_ind < 0) {
-		ERRH(stmt, "unexpected no-total indicator for cell@[%ld, %hd].",
-			row_cnt, col_idx);
-		RET_HDIAGS(stmt, SQL_STATE_HY000);
-	} /* else: indicator >= 0 */
-
-	is_str = col_of_type(col_idx, ES_KEYWORD_TO_SQL);
-	/* make sure there's enough space to write string */
-	ret = safe_copy(stmt, dest, pos, NULL,
-			len_ind/sizeof(SQLWCHAR) + /*2x'"'*/2 * is_str + /*\0*/1);
-	if (! SQL_SUCCEEDED(ret)) {
-		return ret;
-	}
-	/* write opening quote */
-	if (is_str) {
-		ret = safe_copy(stmt, dest, pos, qmark.str, qmark.cnt);
-		assert(SQL_SUCCEEDED(ret));
-	}
-	ret = EsSQLGetData(stmt, col_idx, SQL_C_WCHAR, dest->str + *pos,
-			(len_ind + /*\0*/1) * sizeof(SQLWCHAR), &len_ind);
-	if (! SQL_SUCCEEDED(ret)) {
-		ERRH(stmt, "failed to get data for cell@[%ld, %hd].",
-			row_cnt, col_idx);
-		return ret;
-	} else {
-		assert(0 < len_ind);
-		*pos += len_ind / sizeof(SQLWCHAR);
-	}
-	/* write closing quote */
-	if (is_str) {
-		ret = safe_copy(stmt, dest, pos, qmark.str, qmark.cnt);
-		assert(SQL_SUCCEEDED(ret));
-	}
-
-	return SQL_SUCCESS;
-}
-
-/* in received result set update those varchar columns (DATA_TYPE ==
- * SQL_VARCHAR) whose COLUMN_SIZE and BUFFER_LENGTH columns exceed the set
- * limit */
+/* in received result set override the values of the COLUMN_SIZE,
+ * BUFFER_LENGTH and CHAR_OCTET_LENGTH columns with the set varchar limit;
+ * the received body is used as-is, the limit being applied as the values are
+ * transferred to the application */
 SQLRETURN TEST_API update_varchar_defs(esodbc_stmt_st *stmt)
 {
-	const static wstr_st sqlcols_resp_head = WSTR_INIT("{"
-			"\"columns\":["
-			"{\"name\":\"TABLE_CAT\", \"type\":\"keyword\"},"
-			"{\"name\":\"TABLE_SCHEM\", \"type\":\"keyword\"},"
-			"{\"name\":\"TABLE_NAME\", \"type\":\"keyword\"},"
-			"{\"name\":\"COLUMN_NAME\", \"type\":\"keyword\"},"
-			"{\"name\":\"DATA_TYPE\", \"type\":\"short\"},"
-			"{\"name\":\"TYPE_NAME\", \"type\":\"keyword\"},"
-			"{\"name\":\"COLUMN_SIZE\", \"type\":\"integer\"},"
-			"{\"name\":\"BUFFER_LENGTH\", \"type\":\"integer\"},"
-			"{\"name\":\"DECIMAL_DIGITS\", \"type\":\"short\"},"
-			"{\"name\":\"NUM_PREC_RADIX\", \"type\":\"short\"},"
-			"{\"name\":\"NULLABLE\", \"type\":\"short\"},"
-			"{\"name\":\"REMARKS\", \"type\":\"keyword\"},"
-			"{\"name\":\"COLUMN_DEF\", \"type\":\"keyword\"},"
-			"{\"name\":\"SQL_DATA_TYPE\", \"type\":\"short\"},"
-			"{\"name\":\"SQL_DATETIME_SUB\", \"type\":\"short\"},"
-			"{\"name\":\"CHAR_OCTET_LENGTH\", \"type\":\"integer\"},"
-			"{\"name\":\"ORDINAL_POSITION\", \"type\":\"integer\"},"
-			"{\"name\":\"IS_NULLABLE\", \"type\":\"keyword\"}"
-			"],"
-			"\"rows\":["
-		);
-	const static wstr_st sqlcols_resp_tail = WSTR_INIT("]}");
-	const static wstr_st first_brkt = WSTR_INIT("[");
-	const static wstr_st subseq_brkt = WSTR_INIT(",[");
-	const static wstr_st close_brkt = WSTR_INIT("]");
-	const static wstr_st comma = WSTR_INIT(", ");
-	const wstr_st *brkt;
-	SQLRETURN ret;
-	SQLSMALLINT col_cnt, i;
-	long row_cnt;
-	wstr_st dest = {0};
-	size_t pos;
-	SQLULEN max_length;
-	cstr_st u8mb;
-	wstr_st *lim = &HDRH(stmt)->dbc->varchar_limit_str;
-
-	/* save and reset SQL_ATTR_MAX_LENGTH attribute, it'll interfere with
-	 * reading length of avail data with SQLGetData() otherwise. */
-	max_length = stmt->max_length;
-	stmt->max_length = 0;
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	esodbc_desc_st *ird = stmt->ird;
+	esodbc_rec_st *irec;
+	esodbc_estype_st *es_type;
+	SQLSMALLINT i, type;
 
 	/* check that we have as many columns as members in target row struct */
-	ret = EsSQLNumResultCols(stmt, &col_cnt);
-	if (! SQL_SUCCEEDED(ret)) {
-		ERRH(stmt, "failed to get result columns count.");
-		goto end;
-	} else if (col_cnt < SQLCOLS_IDX_MAX) {
+	if (ird->count < SQLCOLS_IDX_MAX) {
+		/* leave the result set as received */
 		ERRH(stmt, "Elasticsearch returned an unexpected number of columns "
-			"(%hd vs min expected %d).", col_cnt, SQLCOLS_IDX_MAX);
-		goto end;
+			"(%hd vs min expected %d).", ird->count, SQLCOLS_IDX_MAX);
+		return SQL_SUCCESS;
 	} else {
-		DBGH(stmt, "Elasticsearch types columns count: %hd.", col_cnt);
-	}
-
-	pos = 0;
-	ret = safe_copy(stmt, &dest, &pos, sqlcols_resp_head.str,
-			sqlcols_resp_head.cnt);
-	if (! SQL_SUCCEEDED(ret)) {
-		goto end;
+		DBGH(stmt, "Elasticsearch types columns count: %hd.", ird->count);
 	}
 
-	row_cnt = 1;
-	while (SQL_SUCCEEDED(ret = EsSQLFetch(stmt))) {
-		brkt = 1 < row_cnt ? &subseq_brkt : &first_brkt;
-		ret = safe_copy(stmt, &dest, &pos, brkt->str, brkt->cnt);
-		if (! SQL_SUCCEEDED(ret)) {
-			goto end;
-		}
-		for (i = 0; i < SQLCOLS_IDX_MAX; i ++) {
-			if (i) {
-				ret = safe_copy(stmt, &dest, &pos, comma.str, comma.cnt);
-				if (! SQL_SUCCEEDED(ret)) {
-					goto end;
+	for (i = 1; i <= SQLCOLS_IDX_MAX; i ++) {
+		irec = &ird->recs[i - 1];
+		switch (i) {
+			case SQLCOLS_IDX_COLUMN_SIZE:
+			case SQLCOLS_IDX_BUFFER_LENGTH:
+			case SQLCOLS_IDX_CHAR_OCTET_LENGTH:
+				irec->ovr.set = TRUE;
+				irec->ovr.val = (SQLBIGINT)dbc->varchar_limit;
+				type = SQL_INTEGER;
+				break;
+			default:
+				if (col_of_type(i, ES_KEYWORD_TO_SQL)) {
+					continue;
 				}
-			}
-			switch (i + 1) {
-				case SQLCOLS_IDX_COLUMN_SIZE:
-				case SQLCOLS_IDX_BUFFER_LENGTH:
-				case SQLCOLS_IDX_CHAR_OCTET_LENGTH:
-					ret = safe_copy(stmt, &dest, &pos, lim->str, lim->cnt);
-					break;
-				default:
-					ret = copy_one_cell(stmt, &dest, &pos, row_cnt, i + 1);
-			}
-			if (! SQL_SUCCEEDED(ret)) {
-				goto end;
-			}
+				type = col_of_type(i, SQL_SMALLINT) ? SQL_SMALLINT :
+					SQL_INTEGER;
 		}
-		ret = safe_copy(stmt, &dest, &pos, close_brkt.str,
-				close_brkt.cnt);
-		if (! SQL_SUCCEEDED(ret)) {
-			goto end;
+		/* some ES versions report the wrong type for the numeric columns */
+		if (irec->concise_type == type) {
+			continue;
 		}
-		row_cnt ++;
-	}
-
-	ret = safe_copy(stmt, &dest, &pos, sqlcols_resp_tail.str,
-			sqlcols_resp_tail.cnt);
-	if (! SQL_SUCCEEDED(ret)) {
-		goto end;
-	}
-	/* answer succesfully rewritten */
-	dest.cnt = pos;
-	DBGH(stmt, "table definition: [%zu] `" LWPDL "`.", dest.cnt, LWSTR(&dest));
-
-	if (! wstr_to_utf8(&dest, &u8mb)) {
-		ERRH(stmt, "UTF16 to UTF8 conversion failed for: [%zu] `" LWPDL "`.",
-			dest.cnt, LWSTR(&dest));
-		ret = SET_HDIAG(stmt, SQL_STATE_HY000, "Strings conversion error", 0);
-	} else {
-		/* unbind previously received result set */
-		ret = EsSQLFreeStmt(stmt, SQL_CLOSE);
-		if (! SQL_SUCCEEDED(ret)) {
-			goto end;
+		if (! (es_type = lookup_es_type(dbc, type, /*no prec*/0))) {
+			ERRH(stmt, "no ES/SQL type found for SQL type %hd.", type);
+			RET_HDIAG(stmt, SQL_STATE_HY000, "Type lookup failed", 0);
 		}
-		ret = attach_answer(stmt, &u8mb, /*is json*/TRUE);
+		DBGH(stmt, "column #%hd: type %hd retyped as %hd.", i,
+			irec->concise_type, type);
+		irec->es_type = es_type;
+		irec->concise_type = es_type->data_type;
+		irec->type = es_type->sql_data_type;
+		irec->datetime_interval_code = es_type->sql_datetime_sub;
+		irec->meta_type = es_type->meta_type;
 	}
-end:
-	if (dest.str) {
-		free(dest.str);
-		dest.cnt = 0;
-	}
-	/* reinstate any saved SQL_ATTR_MAX_LENGTH value */
-	stmt->max_length = max_length;
-	return ret;
+	return SQL_SUCCESS;
 }
 
 SQLRETURN EsSQLColumnsW
@@ -859,7 +919,7 @@ SQLRETURN EsSQLColumnsW
 		goto end;
 	}
 
-	ret = EsSQLExecDirectW(stmt, pbuf, (SQLINTEGER)cnt);
+	ret = catalog_exec(stmt, pbuf, cnt);
 	if (SQL_SUCCEEDED(ret) && HDRH(stmt)->dbc->varchar_limit) {
 		ret = update_varchar_defs(stmt);
 	}
@@ -37,7 +37,13 @@ SQLSMALLINT fetch_server_attr(esodbc_dbc_st *dbc, SQLINTEGER attr_id,
 	SQLWCHAR *dest, SQLSMALLINT room);
 SQLRETURN set_current_catalog(esodbc_dbc_st *dbc, wstr_st *catalog);
 void free_current_catalog(esodbc_dbc_st *dbc);
+void free_server_attrs(esodbc_dbc_st *dbc, BOOL catalog_only);
 SQLRETURN TEST_API update_varchar_defs(esodbc_stmt_st *stmt);
+SQLRETURN catalog_exec(esodbc_stmt_st *stmt, SQLWCHAR *sql, size_t cnt);
+void catalog_cache_clear(esodbc_dbc_st *dbc);
+BOOL TEST_API cat_cache_lookup(esodbc_dbc_st *dbc, wstr_st *sql,
+	cstr_st *body, BOOL *is_json);
+void TEST_API cat_cache_add(esodbc_stmt_st *stmt, wstr_st *sql);
 
 
 SQLRETURN EsSQLStatisticsW(
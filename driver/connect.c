@@ -166,8 +166,86 @@ static struct curl_slist *cbor_headers = NULL;
  * enough to avoid name clashes. */
 volatile unsigned filelog_cnt = 0;
 
+/*
+ * Process-wide pools of HTTP connections. A pool is shared by the DBCs
+ * connecting to the same Elasticsearch endpoint, as same user and with same
+ * TLS and proxy settings.
+ * The pool's share handle holds the DNS and TLS session caches, which libcurl
+ * can share across threads (under the pool's locks); the TLS settings being
+ * part of the pool's key, the sessions are only resumed with same settings.
+ * libcurl doesn't support sharing the connection cache across threads, so the
+ * connections are cached by the multi handles: a DBC checks out an idle multi
+ * handle from the pool on connect and returns it on disconnect, so that a
+ * multi handle (and its connections) is only ever used by one DBC at a time.
+ * The pools are kept until the driver is unloaded, so that the connections
+ * outlive the DBCs that opened them.
+ */
+typedef struct idle_multi {
+	CURLM *multi;
+	ULONGLONG since; /* tick count of the moment of check-in */
+	struct idle_multi *next;
+} idle_multi_st;
+
+typedef struct conn_pool {
+	cstr_st key;
+	CURLSH *share;
+	/* one lock for each type of shared data */
+	esodbc_mutex_lt mux[CURL_LOCK_DATA_LAST];
+	idle_multi_st *idle; /* most recently checked in first */
+	size_t idle_cnt;
+	struct conn_pool *next;
+} conn_pool_st;
+
+static conn_pool_st *pools = NULL;
+static esodbc_mutex_lt pools_mux = ESODBC_MUX_SINIT;
+
+/*
+ * Process-wide cache of the server's version and ES/SQL types, shared by the
+ * DBCs connecting to the same endpoint, with same credentials and types
+ * affecting settings. The DBCs reference the content of an entry directly,
+ * so the entries are refcounted; an expired entry is unlinked and freed
+ * once no longer used.
+ */
+typedef struct srv_cache {
+	cstr_st key;
+	ULONGLONG loaded; /* tick count of the moment of loading */
+	unsigned refs; /* count of DBCs using the entry */
+	BOOL stale; /* unlinked from list, to be freed on last release */
+	wstr_st srv_ver;
+	esodbc_estype_st *es_types;
+	SQLULEN no_types;
+	struct srv_cache *next;
+} srv_cache_st;
+
+static srv_cache_st *srv_caches = NULL;
+static esodbc_mutex_lt srv_caches_mux = ESODBC_MUX_SINIT;
+
+/*
+ * Process-wide cache of the single-page (cursor-less) query answers, keyed by
+ * the connection's server metadata cache key (endpoint, credentials) and the
+ * serialized request (query, parameters, catalog, time zone, fetch size etc.)
+ * The cache is bounded by ESODBC_RSLT_CACHE_MAX; the least recently used
+ * entries are evicted first.
+ */
+typedef struct rslt_cache {
+	cstr_st key;
+	cstr_st body; /* answer to the request */
+	BOOL is_json; /* answer's format */
+	ULONGLONG loaded; /* tick count of the moment of caching */
+	struct rslt_cache *next;
+} rslt_cache_st;
+
+static rslt_cache_st *rslt_caches = NULL; /* MRU first */
+static size_t rslt_caches_size = 0; /* total size of the cached answers */
+static esodbc_mutex_lt rslt_caches_mux = ESODBC_MUX_SINIT;
+
 
 static BOOL load_es_types(esodbc_dbc_st *dbc);
+static void set_es_types(esodbc_dbc_st *dbc, SQLULEN rows_fetched,
+	esodbc_estype_st *types);
+static void srv_cache_free(srv_cache_st *entry);
+static void srv_cache_release(esodbc_dbc_st *dbc);
+static void rslt_cache_unlink(rslt_cache_st **link);
 
 BOOL connect_init()
 {
@@ -211,12 +289,291 @@ BOOL connect_init()
 
 void connect_cleanup()
 {
+	conn_pool_st *pool;
+	idle_multi_st *idle;
+	srv_cache_st *entry;
+	CURLSHcode res;
+
 	DBG("cleaning up connection/transport.");
 	curl_slist_free_all(json_headers);
 	curl_slist_free_all(cbor_headers);
+
+	ESODBC_MUX_LOCK(&pools_mux);
+	while (pools) {
+		pool = pools;
+		pools = pool->next;
+		DBG("libcurl: cleaning up share handle 0x%p.", pool->share);
+		if ((res = curl_share_cleanup(pool->share)) != CURLSHE_OK) {
+			ERR("libcurl: failed to clean up share handle 0x%p: %s.",
+				pool->share, curl_share_strerror(res));
+		}
+		while (pool->idle) {
+			idle = pool->idle;
+			pool->idle = idle->next;
+			curl_multi_cleanup(idle->multi);
+			free(idle);
+		}
+		free(pool->key.str);
+		free(pool);
+	}
+	ESODBC_MUX_UNLOCK(&pools_mux);
+
+	ESODBC_MUX_LOCK(&srv_caches_mux);
+	while (srv_caches) {
+		entry = srv_caches;
+		srv_caches = entry->next;
+		if (entry->refs) {
+			/* a DBC hasn't been freed: leak the entry, it's referenced */
+			WARN("server metadata cache entry still in use (%u).",
+				entry->refs);
+		} else {
+			srv_cache_free(entry);
+		}
+	}
+	ESODBC_MUX_UNLOCK(&srv_caches_mux);
+
+	ESODBC_MUX_LOCK(&rslt_caches_mux);
+	while (rslt_caches) {
+		rslt_cache_unlink(&rslt_caches);
+	}
+	ESODBC_MUX_UNLOCK(&rslt_caches_mux);
+
 	curl_global_cleanup();
 }
 
+static void pool_lock_cb(CURL *handle, curl_lock_data data,
+	curl_lock_access access, void *userptr)
+{
+	conn_pool_st *pool = (conn_pool_st *)userptr;
+	assert(0 <= data && data < CURL_LOCK_DATA_LAST);
+	ESODBC_MUX_LOCK(&pool->mux[data]);
+}
+
+static void pool_unlock_cb(CURL *handle, curl_lock_data data, void *userptr)
+{
+	conn_pool_st *pool = (conn_pool_st *)userptr;
+	assert(0 <= data && data < CURL_LOCK_DATA_LAST);
+	ESODBC_MUX_UNLOCK(&pool->mux[data]);
+}
+
+/* Concatenate the given parts into a lookup key, after a leading
+ * discriminator character. */
+static BOOL make_key(esodbc_dbc_st *dbc, char lead, cstr_st **parts,
+	size_t count, cstr_st *key)
+{
+	size_t i, pos;
+
+	key->cnt = /* lead */1;
+	for (i = 0; i < count; i ++) {
+		key->cnt += /*separator*/1 + parts[i]->cnt;
+	}
+	if (! (key->str = malloc(key->cnt))) {
+		ERRNH(dbc, "OOM for %zu bytes.", key->cnt);
+		return FALSE;
+	}
+
+	key->str[0] = lead;
+	pos = 1;
+	for (i = 0; i < count; i ++) {
+		/* 0-separated, since none of the parts can contain it */
+		key->str[pos ++] = '\0';
+		if (parts[i]->cnt) {
+			memcpy(key->str + pos, parts[i]->str, parts[i]->cnt);
+			pos += parts[i]->cnt;
+		}
+	}
+	assert(pos == key->cnt);
+	return TRUE;
+}
+
+/* Build the key of the pool a DBC can use: root URL, user, TLS level and CA,
+ * proxy URL. The password/API key isn't part of it, since the authentication
+ * takes place with every HTTP request. */
+static BOOL pool_key(esodbc_dbc_st *dbc, cstr_st *key)
+{
+	cstr_st *parts[] = {&dbc->root_url, &dbc->uid, &dbc->ca_path,
+			&dbc->proxy_url
+		};
+
+	return make_key(dbc, '0' + (char)dbc->secure, parts,
+			sizeof(parts)/sizeof(*parts), key);
+}
+
+/* Returns the share handle of the pool the DBC belongs to, creating the pool
+ * if needed. */
+static CURLSH *pool_share(esodbc_dbc_st *dbc)
+{
+	conn_pool_st *pool;
+	cstr_st key;
+	CURLSHcode res;
+	size_t i;
+
+	if (! pool_key(dbc, &key)) {
+		return NULL;
+	}
+
+	ESODBC_MUX_LOCK(&pools_mux);
+	for (pool = pools; pool; pool = pool->next) {
+		if (pool->key.cnt == key.cnt &&
+			memcmp(pool->key.str, key.str, key.cnt) == 0) {
+			DBGH(dbc, "libcurl: reusing share handle 0x%p.", pool->share);
+			free(key.str);
+			ESODBC_MUX_UNLOCK(&pools_mux);
+			return pool->share;
+		}
+	}
+
+	if (! (pool = calloc(1, sizeof(*pool)))) {
+		ERRNH(dbc, "OOM for %zu bytes.", sizeof(*pool));
+		goto err;
+	}
+	for (i = 0; i < CURL_LOCK_DATA_LAST; i ++) {
+		ESODBC_MUX_INIT(&pool->mux[i]);
+	}
+	if (! (pool->share = curl_share_init())) {
+		ERRH(dbc, "libcurl: failed to init share handle.");
+		goto err;
+	}
+	res = curl_share_setopt(pool->share, CURLSHOPT_LOCKFUNC, pool_lock_cb);
+	if (res == CURLSHE_OK) {
+		res = curl_share_setopt(pool->share, CURLSHOPT_UNLOCKFUNC,
+				pool_unlock_cb);
+	}
+	if (res == CURLSHE_OK) {
+		res = curl_share_setopt(pool->share, CURLSHOPT_USERDATA, pool);
+	}
+	if (res == CURLSHE_OK) {
+		res = curl_share_setopt(pool->share, CURLSHOPT_SHARE,
+				CURL_LOCK_DATA_DNS);
+	}
+	if (res == CURLSHE_OK) {
+		res = curl_share_setopt(pool->share, CURLSHOPT_SHARE,
+				CURL_LOCK_DATA_SSL_SESSION);
+	}
+	if (res != CURLSHE_OK) {
+		ERRH(dbc, "libcurl: failed to set up share handle: %s.",
+			curl_share_strerror(res));
+		goto err;
+	}
+
+	pool->key = key;
+	pool->next = pools;
+	pools = pool;
+	ESODBC_MUX_UNLOCK(&pools_mux);
+
+	INFOH(dbc, "libcurl: new share handle 0x%p.", pool->share);
+	return pool->share;
+
+err:
+	ESODBC_MUX_UNLOCK(&pools_mux);
+	if (pool) {
+		if (pool->share) {
+			curl_share_cleanup(pool->share);
+		}
+		free(pool);
+	}
+	free(key.str);
+	return NULL;
+}
+
+/* Returns a multi handle for the DBC to drive its transfers with: an idle
+ * one from the DBC's pool, if any is available, or a new one. */
+static CURLM *pool_checkout(esodbc_dbc_st *dbc)
+{
+	conn_pool_st *pool;
+	idle_multi_st *idle, *stale = NULL;
+	CURLM *multi = NULL;
+	ULONGLONG now;
+
+	if (dbc->curl_share) {
+		now = GetTickCount64();
+		ESODBC_MUX_LOCK(&pools_mux);
+		for (pool = pools; pool; pool = pool->next) {
+			if (pool->share == dbc->curl_share) {
+				break;
+			}
+		}
+		assert(pool);
+		if (pool && pool->idle) {
+			idle = pool->idle;
+			pool->idle = idle->next;
+			pool->idle_cnt --;
+			if (now - idle->since < (ULONGLONG)dbc->pool_idle_tout * 1000) {
+				multi = idle->multi;
+				free(idle);
+			} else {
+				/* the most recent is expired, so are all the others */
+				idle->next = pool->idle;
+				stale = idle;
+				pool->idle = NULL;
+				pool->idle_cnt = 0;
+			}
+		}
+		ESODBC_MUX_UNLOCK(&pools_mux);
+
+		while (stale) {
+			idle = stale;
+			stale = idle->next;
+			DBGH(dbc, "libcurl: discarding expired multi handle 0x%p.",
+				idle->multi);
+			curl_multi_cleanup(idle->multi);
+			free(idle);
+		}
+		if (multi) {
+			DBGH(dbc, "libcurl: checked out multi handle 0x%p.", multi);
+			return multi;
+		}
+	}
+
+	if (! (multi = curl_multi_init())) {
+		ERRNH(dbc, "libcurl: failed to fetch new multi handle.");
+	}
+	return multi;
+}
+
+/* Hands the DBC's multi handle back to its pool, or frees it if the DBC
+ * isn't pooled or the pool already holds enough idle handles. */
+static void pool_checkin(esodbc_dbc_st *dbc)
+{
+	conn_pool_st *pool;
+	idle_multi_st *idle;
+
+	assert(dbc->curl_multi);
+	if (dbc->curl_share) {
+		if (! (idle = malloc(sizeof(*idle)))) {
+			ERRNH(dbc, "OOM for %zu bytes.", sizeof(*idle));
+		} else {
+			idle->multi = dbc->curl_multi;
+			idle->since = GetTickCount64();
+
+			ESODBC_MUX_LOCK(&pools_mux);
+			for (pool = pools; pool; pool = pool->next) {
+				if (pool->share == dbc->curl_share) {
+					break;
+				}
+			}
+			assert(pool);
+			if (pool && pool->idle_cnt < (size_t)dbc->pool_max_idle) {
+				idle->next = pool->idle;
+				pool->idle = idle;
+				pool->idle_cnt ++;
+				idle = NULL;
+			}
+			ESODBC_MUX_UNLOCK(&pools_mux);
+
+			if (! idle) {
+				DBGH(dbc, "libcurl: checked in multi handle 0x%p.",
+					dbc->curl_multi);
+				dbc->curl_multi = NULL;
+				return;
+			}
+			free(idle);
+		}
+	}
+	curl_multi_cleanup(dbc->curl_multi);
+	dbc->curl_multi = NULL;
+}
+
 #ifndef NDEBUG
 static int debug_callback(CURL *handle, curl_infotype type, char *data,
 	size_t size, void *userptr)
@@ -266,40 +623,37 @@ static int debug_callback(CURL *handle, curl_infotype type, char *data,
  * TODO: initial chunk size and incremental sizes for the reallocation should
  * be better "calibrated" (/ follow some max/hysteretic curve).
  */
-static size_t write_callback(char *ptr, size_t size, size_t nmemb,
-	void *userdata)
+static size_t append_answer(void *h, char **abuff, size_t *alen,
+	size_t *apos, size_t amax, const char *ptr, size_t have)
 {
-	esodbc_dbc_st *dbc = (esodbc_dbc_st *)userdata;
 	char *wbuf;
 	size_t avail; /* available space in current buffer */
-	size_t have; /* I have a new chunk of this size */
 	size_t need; /* new size of buffer I need */
 
-	assert(dbc->apos <= dbc->alen);
-	avail = dbc->alen - dbc->apos;
-	have = size * nmemb;
+	assert(*apos <= *alen);
+	avail = *alen - *apos;
 
-	DBGH(dbc, "libcurl: new data chunk of size [%zu] x %zu arrived; "
-		"available buffer: %zu/%zu.", nmemb, size, avail, dbc->alen);
+	DBGH(h, "libcurl: new data chunk of %zu bytes arrived; available "
+		"buffer: %zu/%zu.", have, avail, *alen);
 
 	/* do I need to grow the existing buffer? */
 	if (avail < have) {
 		/* calculate how much space to allocate. start from existing length,
 		 * if set, othewise from a constant (on first allocation). */
-		need = dbc->alen ? dbc->alen : ESODBC_BODY_BUF_START_SIZE;
-		while (need < dbc->apos + have) {
+		need = *alen ? *alen : ESODBC_BODY_BUF_START_SIZE;
+		while (need < *apos + have) {
 			need *= 2;
 		}
-		DBGH(dbc, "libcurl: need to grow buffer for new chunk of %zu "
-			"from %zu to %zu bytes.", have, dbc->alen, need);
-		if (dbc->amax && (dbc->amax < need)) { /* do I need more than max? */
-			if (dbc->amax <= (size_t)dbc->alen) { /* am I at max already? */
+		DBGH(h, "libcurl: need to grow buffer for new chunk of %zu "
+			"from %zu to %zu bytes.", have, *alen, need);
+		if (amax && (amax < need)) { /* do I need more than max? */
+			if (amax <= (size_t)*alen) { /* am I at max already? */
 				goto too_large;
 			} else { /* am not: alloc max possible (if that's enough) */
-				need = dbc->amax;
-				WARNH(dbc, "libcurl: capped buffer to max: %zu", need);
+				need = amax;
+				WARNH(h, "libcurl: capped buffer to max: %zu", need);
 				/* re'eval what I have available... */
-				avail = dbc->amax - dbc->apos;
+				avail = amax - *apos;
 				if (avail < have) {
 					goto too_large;
 				}
@@ -311,20 +665,20 @@ static size_t write_callback(char *ptr, size_t size, size_t nmemb,
 		 * read past it (though this won't prevent it from failing to parse
 		 * valid JSON within the indicated length if there's white space in
 		 * the chunk right past the indicated JSON length.) */
-		wbuf = realloc(dbc->abuff, need + /*\0*/1);
+		wbuf = realloc(*abuff, need + /*\0*/1);
 		if (! wbuf) {
-			ERRNH(dbc, "libcurl: failed to realloc to %zuB.", need);
+			ERRNH(h, "libcurl: failed to realloc to %zuB.", need);
 			return 0;
 		}
-		dbc->abuff = wbuf;
-		dbc->alen = need;
+		*abuff = wbuf;
+		*alen = need;
 	}
 
-	memcpy(dbc->abuff + dbc->apos, ptr, have);
-	dbc->apos += have;
+	memcpy(*abuff + *apos, ptr, have);
+	*apos += have;
 	/* Add the 0-term for UJSON4C (but don't count it - see above) */
-	dbc->abuff[dbc->apos] = '\0';
-	DBGH(dbc, "libcurl: copied %zuB: `%.*s`.", have, have, ptr);
+	(*abuff)[*apos] = '\0';
+	DBGH(h, "libcurl: copied %zuB: `%.*s`.", have, have, ptr);
 
 	/*
 	 * "Your callback should return the number of bytes actually taken care
@@ -339,13 +693,25 @@ static size_t write_callback(char *ptr, size_t size, size_t nmemb,
 	return have;
 
 too_large:
-	ERRH(dbc, "libcurl: at %zu and can't grow past max %zu for new chunk of "
-		"%zu bytes.", dbc->apos, dbc->amax, have);
+	ERRH(h, "libcurl: at %zu and can't grow past max %zu for new chunk of "
+		"%zu bytes.", *apos, amax, have);
 	return 0;
 }
 
-/* post cURL error message: include CURLOPT_ERRORBUFFER if available */
-static SQLRETURN dbc_curl_post_diag(esodbc_dbc_st *dbc, esodbc_state_et state)
+/* libcurl's write callback of the DBC's handle */
+static size_t write_callback(char *ptr, size_t size, size_t nmemb,
+	void *userdata)
+{
+	esodbc_dbc_st *dbc = (esodbc_dbc_st *)userdata;
+	return append_answer(dbc, &dbc->abuff, &dbc->alen, &dbc->apos,
+			dbc->amax, ptr, size * nmemb);
+}
+
+/* post cURL error message: include CURLOPT_ERRORBUFFER if available.
+ * The message is posted into the given diagnostic, which needn't be the
+ * DBC's (the handle can be used by a worker thread). */
+static SQLRETURN dbc_curl_post_diag(esodbc_dbc_st *dbc, esodbc_diag_st *diag,
+	esodbc_state_et state)
 {
 	SQLWCHAR buff[SQL_MAX_MESSAGE_LENGTH] = {1};
 	SQLWCHAR *fmt;
@@ -375,10 +741,10 @@ static SQLRETURN dbc_curl_post_diag(esodbc_dbc_st *dbc, esodbc_state_et state)
 		 * available buffer room, but 0-terminate it; if that's the case.
 		 * retry, skipping formatting. */
 		ERRH(dbc, "formatting error message failed; skipping formatting.");
-		return post_c_diagnostic(dbc, state, curl_msg, curl_err);
+		return fill_c_diagnostic(diag, state, curl_msg, curl_err);
 	} else {
 		ERRH(dbc, "libcurl failure message: " LWPD ".", buff);
-		return post_diagnostic(dbc, state, buff, curl_err);
+		return fill_diagnostic(diag, state, buff, curl_err);
 	}
 }
 
@@ -402,9 +768,10 @@ static void cleanup_curl(esodbc_dbc_st *dbc)
 
 /* Sets the method cURL should use (GET for root URL, POST otherwise) and the
  * URL itself.
- * Posts the cURL error as diagnostic, on failure.
+ * Posts the cURL error into the given diagnostic, on failure.
  * Not thread safe. */
-SQLRETURN dbc_curl_set_url(esodbc_dbc_st *dbc, int url_type)
+SQLRETURN dbc_curl_set_url(esodbc_dbc_st *dbc, int url_type,
+	esodbc_diag_st *diag)
 {
 	CURLoption req_type;
 	char *url;
@@ -447,7 +814,7 @@ SQLRETURN dbc_curl_set_url(esodbc_dbc_st *dbc, int url_type)
 	DBGH(dbc, "URL type set to: %d.", dbc->crr_url);
 	return SQL_SUCCESS;
 err:
-	dbc_curl_post_diag(dbc, SQL_STATE_HY000);
+	dbc_curl_post_diag(dbc, diag, SQL_STATE_HY000);
 	cleanup_curl(dbc);
 	return SQL_ERROR;
 }
@@ -472,7 +839,9 @@ static struct curl_slist *curl_slist_duplicate(struct curl_slist *inlist)
 	return outlist;
 }
 
-static SQLRETURN dbc_curl_init(esodbc_dbc_st *dbc)
+/* Set up the DBC's cURL handle.
+ * Posts any failure into the given diagnostic. */
+static SQLRETURN dbc_curl_init(esodbc_dbc_st *dbc, esodbc_diag_st *diag)
 {
 	CURL *curl;
 	SQLRETURN ret;
@@ -483,11 +852,20 @@ static SQLRETURN dbc_curl_init(esodbc_dbc_st *dbc)
 
 	assert(! dbc->curl);
 
+	/* the multi handle outlives the easy one, see cleanup_dbc() */
+	if (! dbc->curl_multi) {
+		if (! (dbc->curl_multi = pool_checkout(dbc))) {
+			return fill_c_diagnostic(diag, SQL_STATE_HY000,
+					"failed to init the transport", 0);
+		}
+	}
+
 	/* get a libcurl handle */
 	curl = curl_easy_init();
 	if (! curl) {
 		ERRNH(dbc, "libcurl: failed to fetch new handle.");
-		RET_HDIAG(dbc, SQL_STATE_HY000, "failed to init the transport", 0);
+		return fill_c_diagnostic(diag, SQL_STATE_HY000,
+				"failed to init the transport", 0);
 	} else {
 		dbc->curl = curl;
 	}
@@ -703,6 +1081,22 @@ static SQLRETURN dbc_curl_init(esodbc_dbc_st *dbc)
 		goto err;
 	}
 
+	/* pooled connections */
+	if (dbc->curl_share) {
+		dbc->curl_err = curl_easy_setopt(curl, CURLOPT_SHARE,
+				dbc->curl_share);
+		if (dbc->curl_err != CURLE_OK) {
+			ERRH(dbc, "libcurl: failed to set share handle.");
+			goto err;
+		}
+		dbc->curl_err = curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN,
+				dbc->pool_idle_tout);
+		if (dbc->curl_err != CURLE_OK) {
+			ERRH(dbc, "libcurl: failed to set connections idle timeout.");
+			goto err;
+		}
+	}
+
 #ifndef NDEBUG
 	if (dbc->hdr.log && LOG_LEVEL_DBG <= dbc->hdr.log->level) {
 		dbc->curl_err = curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION,
@@ -729,22 +1123,99 @@ static SQLRETURN dbc_curl_init(esodbc_dbc_st *dbc)
 	return SQL_SUCCESS;
 
 err:
-	ret = dbc_curl_post_diag(dbc, SQL_STATE_HY000);
+	ret = dbc_curl_post_diag(dbc, diag, SQL_STATE_HY000);
 	cleanup_curl(dbc);
 	return ret;
 }
 
+/* Read the completion messages of the multi handle, for the outcome of
+ * DBC's own transfer.
+ * Not thread safe: must be called under the curl_mux. */
+static void dbc_curl_multi_dispatch(esodbc_dbc_st *dbc, BOOL *done,
+	CURLcode *res)
+{
+	CURLMsg *msg;
+	int left;
+
+	while ((msg = curl_multi_info_read(dbc->curl_multi, &left))) {
+		if (msg->msg != CURLMSG_DONE) {
+			continue;
+		}
+		if (msg->easy_handle == dbc->curl) {
+			*done = TRUE;
+			*res = msg->data.result;
+		} else {
+			ERRH(dbc, "libcurl: transfer done on unknown handle 0x%p.",
+				msg->easy_handle);
+		}
+	}
+}
+
+/* Drive the transfer through the multi handle, checking the cancellation
+ * flag (if any) in between waits for network activity. A canceled transfer
+ * is aborted with CURLE_ABORTED_BY_CALLBACK. */
+static CURLcode dbc_curl_multi_perform(esodbc_dbc_st *dbc,
+	volatile LONG *cancel)
+{
+	CURLMcode mcode;
+	CURLcode res = CURLE_OK;
+	BOOL done = FALSE;
+	int running;
+
+	mcode = curl_multi_add_handle(dbc->curl_multi, dbc->curl);
+	if (mcode != CURLM_OK) {
+		ERRH(dbc, "libcurl: failed to add handle to multi: %s.",
+			curl_multi_strerror(mcode));
+		return CURLE_FAILED_INIT;
+	}
+
+	do {
+		if (cancel && *cancel) {
+			INFOH(dbc, "libcurl: transfer canceled, aborting.");
+			res = CURLE_ABORTED_BY_CALLBACK;
+			break;
+		}
+		mcode = curl_multi_perform(dbc->curl_multi, &running);
+		if (mcode == CURLM_OK) {
+			dbc_curl_multi_dispatch(dbc, &done, &res);
+			if (! (done || running)) {
+				ERRH(dbc, "libcurl: transfer stopped without completion.");
+				res = CURLE_RECV_ERROR;
+				break;
+			} else if (! done) {
+				mcode = curl_multi_poll(dbc->curl_multi, NULL, 0,
+						ESODBC_XFER_POLL_MS, NULL);
+			}
+		}
+		if (mcode != CURLM_OK) {
+			ERRH(dbc, "libcurl: multi transfer failed: %s.",
+				curl_multi_strerror(mcode));
+			res = mcode == CURLM_OUT_OF_MEMORY ? CURLE_OUT_OF_MEMORY :
+				CURLE_RECV_ERROR;
+			break;
+		}
+	} while (! done);
+
+	/* an unfinished transfer will have its connection closed */
+	mcode = curl_multi_remove_handle(dbc->curl_multi, dbc->curl);
+	if (mcode != CURLM_OK) {
+		ERRH(dbc, "libcurl: failed to remove handle from multi: %s.",
+			curl_multi_strerror(mcode));
+	}
+	return res;
+}
+
 /* Perform a HTTP request, on the (pre)prepared connection.
  * Returns the HTTP code, response body (if any) and its type (if present). */
-static BOOL dbc_curl_perform(esodbc_dbc_st *dbc, long *code, cstr_st *rsp_body,
-	char **cont_type)
+static BOOL dbc_curl_perform(esodbc_dbc_st *dbc, volatile LONG *cancel,
+	long *code, cstr_st *rsp_body, char **cont_type)
 {
 	curl_off_t xfer_tm_start, xfer_tm_total;
 
 	assert(dbc->abuff == NULL);
 
 	/* execute the request */
-	dbc->curl_err = curl_easy_perform(dbc->curl);
+	dbc->curl_err = dbc_curl_multi_perform(dbc, cancel);
 
 	/* copy answer references */
 	rsp_body->str = dbc->abuff;
@@ -801,7 +1272,7 @@ err:
 }
 
 static SQLRETURN content_type_supported(esodbc_dbc_st *dbc,
-	const char *cont_type_val, BOOL *is_json)
+	const char *cont_type_val, BOOL *is_json, esodbc_diag_st *diag)
 {
 	if (! cont_type_val) {
 		WARNH(dbc, "no content type provided; assuming '%s'.",
@@ -819,146 +1290,834 @@ static SQLRETURN content_type_supported(esodbc_dbc_st *dbc,
 	} else {
 		ERRH(dbc, "unsupported content type received: `%s` "
 			"(must be JSON or CBOR).", cont_type_val);
-		return post_c_diagnostic(dbc, SQL_STATE_08S01,
+		return fill_c_diagnostic(diag, SQL_STATE_08S01,
 				"Unsupported content type received", 0);
 	}
-	DBGH(dbc, "content of type: %s.", *is_json ? "JSON" : "CBOR");
-	return SQL_SUCCESS;
+	DBGH(dbc, "content of type: %s.", *is_json ? "JSON" : "CBOR");
+	return SQL_SUCCESS;
+}
+
+static BOOL dbc_curl_add_post_body(esodbc_dbc_st *dbc, SQLULEN tout,
+	const cstr_st *u8body)
+{
+	curl_off_t post_size = u8body->cnt;
+	assert(dbc->curl);
+
+	dbc->curl_err = CURLE_OK;
+	dbc->curl_err_buff[0] = '\0';
+
+	if (0 < tout) {
+		dbc->curl_err = curl_easy_setopt(dbc->curl, CURLOPT_TIMEOUT, tout);
+		if (dbc->curl_err != CURLE_OK) {
+			ERRH(dbc, "libcurl: failed to set timeout=%ld.", tout);
+			goto err;
+		}
+	}
+
+	/* len of the body */
+	dbc->curl_err = curl_easy_setopt(dbc->curl, CURLOPT_POSTFIELDSIZE_LARGE,
+			post_size);
+	if (dbc->curl_err != CURLE_OK) {
+		ERRH(dbc, "libcurl: failed to set post fieldsize: %zu.", u8body->cnt);
+		goto err;
+	}
+	/* body itself */
+	dbc->curl_err = curl_easy_setopt(dbc->curl, CURLOPT_POSTFIELDS,
+			u8body->str);
+	if (dbc->curl_err != CURLE_OK) {
+		ERRH(dbc, "libcurl: failed to set post fields: `" LCPDL "`.",
+			LCSTR(u8body));
+		goto err;
+	}
+
+	return TRUE;
+
+err:
+	ERRH(dbc, "libcurl: failure code %d, message: %s.", dbc->curl_err,
+		curl_easy_strerror(dbc->curl_err));
+	return FALSE;
+}
+
+/* Account a completed transfer with the performance counters. */
+static void perf_count_xfer(esodbc_dbc_st *dbc, esodbc_perf_st *perf,
+	CURL *curl, size_t recv)
+{
+	curl_off_t sent, wire, xfer_tm;
+
+	if (curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &sent) != CURLE_OK) {
+		sent = 0;
+	}
+	/* body bytes read off the connection, before any content decoding */
+	if (curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &wire) !=
+		CURLE_OK) {
+		wire = (curl_off_t)recv;
+	}
+	if (curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &xfer_tm) !=
+		CURLE_OK) {
+		xfer_tm = 0;
+	}
+	perf_count(dbc, perf, ESODBC_PERF_REQUESTS, 1);
+	perf_count(dbc, perf, ESODBC_PERF_BYTES_SENT, (LONG64)sent);
+	perf_count(dbc, perf, ESODBC_PERF_BYTES_RECV, (LONG64)recv);
+	perf_count(dbc, perf, ESODBC_PERF_BYTES_WIRE, (LONG64)wire);
+	perf_count(dbc, perf, ESODBC_PERF_TIME_NETWORK, (LONG64)xfer_tm);
+}
+
+/*
+ * Sends a HTTP POST request with the given request body, over the DBC's
+ * handle.
+ * On success, the body and encoding of the (200) answer are returned. On
+ * failure, an error answer (if any) is returned along with its HTTP code,
+ * while any transport-level diagnostic is posted into the given 'diag' (and
+ * never into the DBC's, which the application can be reading meanwhile).
+ * The body of the answer must be freed by the caller, in both cases.
+ * The transfer is aborted (and HY008 posted) once '*cancel' is set, if
+ * 'cancel' is provided.
+ * The transfer is accounted with the connection's and, if provided, the
+ * given 'perf' counters.
+ * Thread safe.
+ */
+SQLRETURN dbc_curl_post(esodbc_dbc_st *dbc, SQLULEN tout, int url_type,
+	const cstr_st *req_body, volatile LONG *cancel, long *code,
+	cstr_st *rsp_body, BOOL *is_json, esodbc_diag_st *diag,
+	esodbc_perf_st *perf)
+{
+	SQLRETURN ret;
+	char *cont_type;
+
+	*code = -1; /* = no answer available */
+	rsp_body->str = NULL;
+	rsp_body->cnt = 0;
+
+	ESODBC_MUX_LOCK(&dbc->curl_mux);
+
+	if (! dbc->curl) {
+		ret = dbc_curl_init(dbc, diag);
+		if (! SQL_SUCCEEDED(ret)) {
+			goto err;
+		}
+	}
+
+	if (dbc->crr_url != url_type) {
+		ret = dbc_curl_set_url(dbc, url_type, diag);
+		if (! SQL_SUCCEEDED(ret)) {
+			goto err;
+		}
+	}
+
+	if (dbc_curl_add_post_body(dbc, tout, req_body) &&
+		dbc_curl_perform(dbc, cancel, code, rsp_body, &cont_type)) {
+		perf_count_xfer(dbc, perf, dbc->curl, rsp_body->cnt);
+		ret = content_type_supported(dbc, cont_type, is_json, diag);
+		if (! SQL_SUCCEEDED(ret)) {
+			*code = -1; /* make answer unavailable */
+		} else if (*code == 200) {
+			if (rsp_body->cnt) {
+				ESODBC_MUX_UNLOCK(&dbc->curl_mux);
+				return SQL_SUCCESS;
+			} else {
+				ERRH(dbc, "received 200 response code with empty body.");
+				ret = fill_c_diagnostic(diag, SQL_STATE_08S01,
+						"Received 200 response code with empty body.", 0);
+			}
+		} else {
+			/* error answer: to be parsed by the caller */
+			ret = SQL_ERROR;
+		}
+	} else if (dbc->curl_err == CURLE_ABORTED_BY_CALLBACK && cancel &&
+		*cancel) {
+		ret = fill_c_diagnostic(diag, SQL_STATE_HY008,
+				"The request has been canceled", 0);
+	} else {
+		ret = dbc_curl_post_diag(dbc, diag, SQL_STATE_08S01);
+	}
+
+	/* something went wrong, reset cURL handle/connection */
+	cleanup_curl(dbc);
+err:
+	ESODBC_MUX_UNLOCK(&dbc->curl_mux);
+	return ret;
+}
+
+/*
+ * Wakes up a DBC's transfer waiting for network activity, for it to check
+ * its cancellation flag.
+ * Thread safe: the multi handle lives as long as the connection.
+ */
+void dbc_curl_wakeup(esodbc_dbc_st *dbc)
+{
+	CURLM *multi = dbc->curl_multi;
+	CURLMcode mcode;
+
+	if (multi) {
+		mcode = curl_multi_wakeup(multi);
+		if (mcode != CURLM_OK) {
+			ERRH(dbc, "libcurl: failed to wake up multi: %s.",
+				curl_multi_strerror(mcode));
+		}
+	}
+}
+
+/* Wake up the statement's parameters array transfers, if any. */
+void curl_batch_wakeup(esodbc_stmt_st *stmt)
+{
+	CURLM *multi = stmt->batch_multi;
+	CURLMcode mcode;
+
+	if (multi) {
+		mcode = curl_multi_wakeup(multi);
+		if (mcode != CURLM_OK) {
+			ERRH(stmt, "libcurl: failed to wake up batch multi: %s.",
+				curl_multi_strerror(mcode));
+		}
+	}
+}
+
+/* Free the statement's parameters array multi handle, if any; the statement
+ * must not be in use by any other thread. */
+void curl_batch_cleanup(esodbc_stmt_st *stmt)
+{
+	if (stmt->batch_multi) {
+		curl_multi_cleanup(stmt->batch_multi);
+		stmt->batch_multi = NULL;
+	}
+}
+
+/*
+ * Sends a HTTP POST request with the given request body.
+ */
+SQLRETURN curl_post(esodbc_stmt_st *stmt, int url_type,
+	const cstr_st *req_body)
+{
+	SQLRETURN ret;
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	SQLULEN tout;
+	long code;
+	cstr_st rsp_body;
+	BOOL is_json;
+	esodbc_diag_st diag;
+
+	if (dbc->pack_json) {
+		DBGH(stmt, "POSTing JSON to URL type %d: [%zu] `" LCPDL "`.", url_type,
+			req_body->cnt, LCSTR(req_body));
+	} else {
+		DBGH(stmt, "POSTing CBOR to URL type %d: [%zu] `%s`.", url_type,
+			req_body->cnt, cstr_hex_dump(req_body));
+	}
+
+	/* set timeout as maximum between connection and statement value */
+	tout = dbc->timeout < stmt->query_timeout ? stmt->query_timeout :
+		dbc->timeout;
+
+	/* a cancellation only applies to a request that's under way */
+	InterlockedExchange(&stmt->cancel, FALSE);
+	ret = dbc_curl_post(dbc, tout, url_type, req_body, &stmt->cancel, &code,
+			&rsp_body, &is_json, &HDRH(stmt)->diag, &stmt->perf);
+	if (SQL_SUCCEEDED(ret)) {
+		return (url_type == ESODBC_CURL_QUERY) ?
+			attach_answer(stmt, &rsp_body, is_json) :
+			/* ESODBC_CURL_CLOSE */
+			close_es_answ_handler(stmt, &rsp_body, is_json);
+	}
+
+	/* if a page fetching has been canceled, release the server's cursor */
+	if (HDRH(stmt)->diag.state == SQL_STATE_HY008 &&
+		url_type == ESODBC_CURL_QUERY && STMT_HAS_CURSOR(stmt)) {
+		diag = HDRH(stmt)->diag;
+		if (! SQL_SUCCEEDED(close_es_cursor(stmt))) {
+			WARNH(stmt, "failed to close cursor of canceled statement.");
+		}
+		HDRH(stmt)->diag = diag;
+	}
+
+	/* was there an error answer received correctly? */
+	if (0 < code) {
+		ret = attach_error(stmt, &rsp_body, is_json, code);
+	}
+
+	/* an answer might have been received, but a late curl error (like
+	 * fetching the result code) could have occurred. */
+	if (rsp_body.str) {
+		free(rsp_body.str);
+		rsp_body.str = NULL;
+	}
+
+	return ret;
+}
+
+/* libcurl's write callback of a statement's asynchronous handle */
+static size_t async_write_callback(char *ptr, size_t size, size_t nmemb,
+	void *userdata)
+{
+	esodbc_stmt_st *stmt = (esodbc_stmt_st *)userdata;
+	return append_answer(stmt, &stmt->async.abuff, &stmt->async.alen,
+			&stmt->async.apos, HDRH(stmt)->dbc->amax, ptr, size * nmemb);
+}
+
+/* Release statement's asynchronous handle, request and any received data.
+ * Not thread safe: must be called under the async_mux. */
+static void async_clear(esodbc_stmt_st *stmt)
+{
+	CURLMcode mcode;
+
+	if (stmt->async.curl) {
+		/* an unfinished transfer will have its connection closed */
+		if (HDRH(stmt)->dbc->async_multi) {
+			mcode = curl_multi_remove_handle(HDRH(stmt)->dbc->async_multi,
+					stmt->async.curl);
+			if (mcode != CURLM_OK) {
+				ERRH(stmt, "libcurl: failed to remove handle from multi: "
+					"%s.", curl_multi_strerror(mcode));
+			}
+		}
+		curl_easy_cleanup(stmt->async.curl);
+		stmt->async.curl = NULL;
+	}
+	if (stmt->async.req.str) {
+		free(stmt->async.req.str);
+		stmt->async.req.str = NULL;
+		stmt->async.req.cnt = 0;
+	}
+	if (stmt->async.hdrs) {
+		curl_slist_free_all(stmt->async.hdrs);
+		stmt->async.hdrs = NULL;
+	}
+	stmt->async.done = FALSE;
+	stmt->async.res = CURLE_OK;
+	if (stmt->async.abuff) {
+		free(stmt->async.abuff);
+		stmt->async.abuff = NULL;
+	}
+	stmt->async.alen = 0;
+	stmt->async.apos = 0;
+}
+
+/* Hand the completion messages of the DBC's async multi handle over to
+ * their statements.
+ * Not thread safe: must be called under the async_mux. */
+static void async_multi_dispatch(esodbc_dbc_st *dbc)
+{
+	CURLMsg *msg;
+	esodbc_stmt_st *stmt;
+	int left;
+
+	while ((msg = curl_multi_info_read(dbc->async_multi, &left))) {
+		if (msg->msg != CURLMSG_DONE) {
+			continue;
+		}
+		if (curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
+				(char **)&stmt) == CURLE_OK && stmt) {
+			DBGH(stmt, "libcurl: async transfer done (code: %d).",
+				msg->data.result);
+			stmt->async.done = TRUE;
+			stmt->async.res = msg->data.result;
+		} else {
+			ERRH(dbc, "libcurl: transfer done on unknown handle 0x%p.",
+				msg->easy_handle);
+		}
+	}
+}
+
+/*
+ * Sets up the statement's asynchronous transfer, over a clone of the DBC's
+ * handle, and adds it to the DBC's async multi handle.
+ * The DBC's handle is only try-locked: while it's busy with a synchronous
+ * transfer, the start is deferred (and SQL_STILL_EXECUTING returned).
+ */
+static SQLRETURN async_start(esodbc_stmt_st *stmt)
+{
+	SQLRETURN ret = SQL_SUCCESS;
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	CURL *curl = NULL;
+	struct curl_slist *hdrs = NULL;
+	CURLMcode mcode;
+	SQLULEN tout;
+
+	assert(stmt->async.req.str && (! stmt->async.curl));
+
+	if (! ESODBC_MUX_TRYLOCK(&dbc->curl_mux)) {
+		DBGH(stmt, "DBC's handle busy, async request start deferred.");
+		return SQL_STILL_EXECUTING;
+	}
+	/* clone the DBC's handle, with all the connection's settings */
+	if (! dbc->curl) {
+		ret = dbc_curl_init(dbc, &HDRH(stmt)->diag);
+	}
+	if (SQL_SUCCEEDED(ret) && dbc->crr_url != ESODBC_CURL_QUERY) {
+		ret = dbc_curl_set_url(dbc, ESODBC_CURL_QUERY, &HDRH(stmt)->diag);
+	}
+	if (SQL_SUCCEEDED(ret) && (! (curl = curl_easy_duphandle(dbc->curl)))) {
+		ERRH(stmt, "libcurl: failed to duplicate handle.");
+		ret = post_c_diagnostic(stmt, SQL_STATE_HY000,
+				"failed to init the transport", 0);
+	}
+	/* the DBC's Authorization headers list can be freed with the DBC's
+	 * handle (the packing ones are global, though) */
+	if (SQL_SUCCEEDED(ret) && dbc->curl_hdrs) {
+		if (! (hdrs = curl_slist_duplicate(dbc->curl_hdrs))) {
+			ERRNH(stmt, "failed duplicating HTTP headers.");
+			curl_easy_cleanup(curl);
+			ret = post_c_diagnostic(stmt, SQL_STATE_HY001, NULL, 0);
+		}
+	}
+	ESODBC_MUX_UNLOCK(&dbc->curl_mux);
+	if (! SQL_SUCCEEDED(ret)) {
+		goto end;
+	}
+
+	tout = dbc->timeout < stmt->query_timeout ? stmt->query_timeout :
+		dbc->timeout;
+	stmt->async.err_buff[0] = '\0';
+	stmt->async.hdrs = hdrs;
+	stmt->async.curl = curl;
+	if ((hdrs && curl_easy_setopt(curl, CURLOPT_HTTPHEADER, hdrs) !=
+			CURLE_OK) ||
+		curl_easy_setopt(curl, CURLOPT_PRIVATE, stmt) != CURLE_OK ||
+		curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+			async_write_callback) != CURLE_OK ||
+		curl_easy_setopt(curl, CURLOPT_WRITEDATA, stmt) != CURLE_OK ||
+		curl_easy_setopt(curl, CURLOPT_ERRORBUFFER,
+			stmt->async.err_buff) != CURLE_OK ||
+		curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)tout) != CURLE_OK ||
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE,
+			(curl_off_t)stmt->async.req.cnt) != CURLE_OK ||
+		/* the request is kept with the statement for the transfer's life */
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS,
+			stmt->async.req.str) != CURLE_OK) {
+		ERRH(stmt, "libcurl: failed to set up async handle.");
+		ret = post_c_diagnostic(stmt, SQL_STATE_HY000, "failed to set up "
+				"the asynchronous request", 0);
+		goto end;
+	}
+
+	ESODBC_MUX_LOCK(&dbc->async_mux);
+	if ((! dbc->async_multi) && (! (dbc->async_multi = curl_multi_init()))) {
+		ERRH(stmt, "libcurl: failed to init async multi handle.");
+		mcode = CURLM_OUT_OF_MEMORY;
+	} else {
+		mcode = curl_multi_add_handle(dbc->async_multi, curl);
+		if (mcode != CURLM_OK) {
+			ERRH(stmt, "libcurl: failed to add handle to multi: %s.",
+				curl_multi_strerror(mcode));
+		}
+	}
+	ESODBC_MUX_UNLOCK(&dbc->async_mux);
+	if (mcode != CURLM_OK) {
+		ret = post_c_diagnostic(stmt, SQL_STATE_HY000, "failed to start "
+				"the asynchronous request", 0);
+	}
+
+end:
+	if (! SQL_SUCCEEDED(ret)) {
+		ESODBC_MUX_LOCK(&dbc->async_mux);
+		async_clear(stmt);
+		ESODBC_MUX_UNLOCK(&dbc->async_mux);
+	}
+	return ret;
+}
+
+/*
+ * Starts POSTing a query request asynchronously, over a clone of the DBC's
+ * handle that the DBC's async multi handle drives. The transfer progresses
+ * with each curl_async_poll() call.
+ * Returns SQL_STILL_EXECUTING, unless the request completes right away.
+ */
+SQLRETURN curl_post_async(esodbc_stmt_st *stmt, const cstr_st *req_body)
+{
+	assert(! STMT_ASYNC_UNDERWAY(stmt));
+	DBGH(stmt, "async POSTing %zu bytes.", req_body->cnt);
+
+	/* the request must outlive the caller's buffer */
+	if (! (stmt->async.req.str = malloc(req_body->cnt))) {
+		ERRNH(stmt, "OOM for %zuB.", req_body->cnt);
+		RET_HDIAGS(stmt, SQL_STATE_HY001);
+	}
+	memcpy(stmt->async.req.str, req_body->str, req_body->cnt);
+	stmt->async.req.cnt = req_body->cnt;
+
+	/* a cancellation only applies to a request that's under way */
+	InterlockedExchange(&stmt->cancel, FALSE);
+
+	return curl_async_poll(stmt);
+}
+
+/*
+ * Progresses statement's asynchronous request, without blocking: neither
+ * the start of the transfer, nor its progress wait on the DBC's synchronous
+ * transfers.
+ * Returns SQL_STILL_EXECUTING until the answer is received (and attached) or
+ * the request fails.
+ */
+SQLRETURN curl_async_poll(esodbc_stmt_st *stmt)
+{
+	SQLRETURN ret = SQL_ERROR;
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	CURLMcode mcode;
+	CURLcode res;
+	int running;
+	long code = -1;
+	char *cont_type = NULL;
+	cstr_st body;
+	BOOL is_json = dbc->pack_json;
+
+	assert(STMT_ASYNC_UNDERWAY(stmt));
+
+	if (! stmt->async.curl) {
+		if (stmt->cancel) {
+			INFOH(stmt, "async request canceled before its start.");
+			ESODBC_MUX_LOCK(&dbc->async_mux);
+			async_clear(stmt);
+			ESODBC_MUX_UNLOCK(&dbc->async_mux);
+			return post_c_diagnostic(stmt, SQL_STATE_HY008,
+					"The request has been canceled", 0);
+		}
+		ret = async_start(stmt);
+		if (ret != SQL_SUCCESS) {
+			return ret;
+		}
+	}
+
+	ESODBC_MUX_LOCK(&dbc->async_mux);
+	if (! stmt->async.done) {
+		if (stmt->cancel) {
+			INFOH(stmt, "libcurl: async transfer canceled, aborting.");
+			stmt->async.done = TRUE;
+			stmt->async.res = CURLE_ABORTED_BY_CALLBACK;
+		} else {
+			mcode = curl_multi_perform(dbc->async_multi, &running);
+			if (mcode == CURLM_OK) {
+				async_multi_dispatch(dbc);
+			} else {
+				ERRH(stmt, "libcurl: multi transfer failed: %s.",
+					curl_multi_strerror(mcode));
+				stmt->async.done = TRUE;
+				stmt->async.res = mcode == CURLM_OUT_OF_MEMORY ?
+					CURLE_OUT_OF_MEMORY : CURLE_RECV_ERROR;
+			}
+		}
+		if (! stmt->async.done) {
+			ESODBC_MUX_UNLOCK(&dbc->async_mux);
+			return SQL_STILL_EXECUTING;
+		}
+	}
+
+	/* transfer complete: collect the outcome */
+	res = stmt->async.res;
+	body.str = stmt->async.abuff;
+	body.cnt = stmt->async.apos;
+	stmt->async.abuff = NULL;
+	if (res == CURLE_OK) {
+		perf_count_xfer(dbc, &stmt->perf, stmt->async.curl, body.cnt);
+		res = curl_easy_getinfo(stmt->async.curl, CURLINFO_RESPONSE_CODE,
+				&code);
+		if (res == CURLE_OK && body.cnt) {
+			res = curl_easy_getinfo(stmt->async.curl, CURLINFO_CONTENT_TYPE,
+					&cont_type);
+		}
+		if (res == CURLE_OK && (! SQL_SUCCEEDED(content_type_supported(dbc,
+						cont_type, &is_json, &HDRH(stmt)->diag)))) {
+			code = -1; /* make answer unavailable */
+		}
+	} else if (res != CURLE_ABORTED_BY_CALLBACK) {
+		ERRH(stmt, "libcurl: async transfer failed: %s (code: %d; %s).",
+			curl_easy_strerror(res), res, stmt->async.err_buff);
+	}
+	async_clear(stmt);
+	ESODBC_MUX_UNLOCK(&dbc->async_mux);
+
+	INFOH(stmt, "libcurl: async request answered, received code %ld and %zu "
+		"bytes back.", code, body.cnt);
+	if (res == CURLE_ABORTED_BY_CALLBACK && stmt->cancel) {
+		ret = post_c_diagnostic(stmt, SQL_STATE_HY008,
+				"The request has been canceled", 0);
+	} else if (res != CURLE_OK) {
+		ret = post_c_diagnostic(stmt, SQL_STATE_08S01,
+				curl_easy_strerror(res), res);
+	} else if (code == 200) {
+		if (body.cnt) {
+			/* statement takes ownership of the body */
+			return attach_answer(stmt, &body, is_json);
+		}
+		ERRH(stmt, "received 200 response code with empty body.");
+		ret = post_c_diagnostic(stmt, SQL_STATE_08S01,
+				"Received 200 response code with empty body.", 0);
+	} else if (0 < code) {
+		ret = attach_error(stmt, &body, is_json, code);
+	} /* else: unsupported content type */
+
+	if (body.str) {
+		free(body.str);
+	}
+	return ret;
+}
+
+/* Abandon statement's asynchronous request, if any is under way. */
+void curl_async_abort(esodbc_stmt_st *stmt)
+{
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+
+	if (! STMT_ASYNC_UNDERWAY(stmt)) {
+		return;
+	}
+	INFOH(stmt, "abandoning asynchronous request under way.");
+	ESODBC_MUX_LOCK(&dbc->async_mux);
+	async_clear(stmt);
+	ESODBC_MUX_UNLOCK(&dbc->async_mux);
 }
 
-static BOOL dbc_curl_add_post_body(esodbc_dbc_st *dbc, SQLULEN tout,
-	const cstr_st *u8body)
+/* transfer state of one request of a parameters array execution */
+typedef struct batch_xfer {
+	esodbc_stmt_st *stmt;
+	CURL *curl; /* NULL if not (or no longer) under way */
+	char *abuff; /* buffer holding the answer */
+	size_t alen; /* size of abuff */
+	size_t apos; /* current write position in the abuff */
+} batch_xfer_st;
+
+/* libcurl's write callback of a batch request's handle */
+static size_t batch_write_callback(char *ptr, size_t size, size_t nmemb,
+	void *userdata)
 {
-	curl_off_t post_size = u8body->cnt;
-	assert(dbc->curl);
+	batch_xfer_st *xfer = (batch_xfer_st *)userdata;
+	return append_answer(xfer->stmt, &xfer->abuff, &xfer->alen, &xfer->apos,
+			HDRH(xfer->stmt)->dbc->amax, ptr, size * nmemb);
+}
 
-	dbc->curl_err = CURLE_OK;
-	dbc->curl_err_buff[0] = '\0';
+/* Clone the template handle and add it to the batch's multi handle. */
+static BOOL batch_xfer_start(esodbc_stmt_st *stmt, CURLM *multi,
+	CURL *tmpl, const cstr_st *req_body, batch_xfer_st *xfer)
+{
+	CURLMcode mcode;
 
-	if (0 < tout) {
-		dbc->curl_err = curl_easy_setopt(dbc->curl, CURLOPT_TIMEOUT, tout);
-		if (dbc->curl_err != CURLE_OK) {
-			ERRH(dbc, "libcurl: failed to set timeout=%ld.", tout);
-			goto err;
-		}
+	xfer->stmt = stmt;
+	if (! (xfer->curl = curl_easy_duphandle(tmpl))) {
+		ERRH(stmt, "libcurl: failed to duplicate handle.");
+		return FALSE;
 	}
-
-	/* len of the body */
-	dbc->curl_err = curl_easy_setopt(dbc->curl, CURLOPT_POSTFIELDSIZE_LARGE,
-			post_size);
-	if (dbc->curl_err != CURLE_OK) {
-		ERRH(dbc, "libcurl: failed to set post fieldsize: %zu.", u8body->cnt);
+	/* the request bodies outlive the batch: no need to copy them */
+	if (curl_easy_setopt(xfer->curl, CURLOPT_PRIVATE, xfer) != CURLE_OK ||
+		curl_easy_setopt(xfer->curl, CURLOPT_WRITEDATA, xfer) != CURLE_OK ||
+		curl_easy_setopt(xfer->curl, CURLOPT_POSTFIELDSIZE_LARGE,
+			(curl_off_t)req_body->cnt) != CURLE_OK ||
+		curl_easy_setopt(xfer->curl, CURLOPT_POSTFIELDS,
+			req_body->str) != CURLE_OK) {
+		ERRH(stmt, "libcurl: failed to set up batch handle.");
 		goto err;
 	}
-	/* body itself */
-	dbc->curl_err = curl_easy_setopt(dbc->curl, CURLOPT_POSTFIELDS,
-			u8body->str);
-	if (dbc->curl_err != CURLE_OK) {
-		ERRH(dbc, "libcurl: failed to set post fields: `" LCPDL "`.",
-			LCSTR(u8body));
+	mcode = curl_multi_add_handle(multi, xfer->curl);
+	if (mcode != CURLM_OK) {
+		ERRH(stmt, "libcurl: failed to add handle to multi: %s.",
+			curl_multi_strerror(mcode));
 		goto err;
 	}
-
 	return TRUE;
-
 err:
-	ERRH(dbc, "libcurl: failure code %d, message: %s.", dbc->curl_err,
-		curl_easy_strerror(dbc->curl_err));
+	curl_easy_cleanup(xfer->curl);
+	xfer->curl = NULL;
 	return FALSE;
 }
 
+/* Collect the outcome of a batch request and release its handle. */
+static void batch_xfer_done(esodbc_stmt_st *stmt, CURLM *multi,
+	batch_xfer_st *xfer, CURLcode res, pset_answ_st *answ)
+{
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	char *cont_type = NULL;
+	esodbc_diag_st diag;
+
+	if (res == CURLE_OK) {
+		perf_count_xfer(dbc, &stmt->perf, xfer->curl, xfer->apos);
+		res = curl_easy_getinfo(xfer->curl, CURLINFO_RESPONSE_CODE,
+				&answ->code);
+		if (res == CURLE_OK && xfer->apos) {
+			res = curl_easy_getinfo(xfer->curl, CURLINFO_CONTENT_TYPE,
+					&cont_type);
+		}
+	}
+	if (res == CURLE_OK) {
+		/* the failure is reported through the transfer result */
+		answ->is_json = dbc->pack_json;
+		if (! SQL_SUCCEEDED(content_type_supported(dbc, cont_type,
+					&answ->is_json, &diag))) {
+			answ->code = -1; /* make answer unavailable */
+			res = CURLE_WEIRD_SERVER_REPLY;
+		}
+	} else {
+		ERRH(stmt, "libcurl: batch transfer failed: %s (code: %d).",
+			curl_easy_strerror(res), res);
+	}
+	answ->res = res;
+	answ->body.str = xfer->abuff;
+	answ->body.cnt = xfer->apos;
+	xfer->abuff = NULL;
+
+	curl_multi_remove_handle(multi, xfer->curl);
+	curl_easy_cleanup(xfer->curl);
+	xfer->curl = NULL;
+}
+
 /*
- * Sends a HTTP POST request with the given request body.
+ * POSTs the query requests of a parameters array execution, with at most
+ * ESODBC_MAX_PARAMSET_XFERS of them under way at any time, over clones of
+ * the DBC's handle. Requests with no body are skipped.
+ * The outcome of each request is returned in the corresponding 'answs'
+ * element; the received bodies must be freed by the caller.
+ * Returns failure only if the transfers can't be set up or are canceled.
  */
-SQLRETURN curl_post(esodbc_stmt_st *stmt, int url_type,
-	const cstr_st *req_body)
+SQLRETURN curl_post_batch(esodbc_stmt_st *stmt, SQLULEN cnt,
+	const cstr_st *reqs, pset_answ_st *answs)
 {
-	SQLRETURN ret;
-	CURLcode res = CURLE_OK;
+	SQLRETURN ret = SQL_SUCCESS;
 	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	CURL *tmpl = NULL;
+	struct curl_slist *hdrs = NULL;
+	CURLM *multi = NULL;
+	CURLMsg *msg;
+	CURLMcode mcode = CURLM_OK;
+	batch_xfer_st *xfers, *xfer;
+	SQLULEN i, next;
+	int running, left, active;
 	SQLULEN tout;
-	long code = -1; /* = no answer available */
-	cstr_st rsp_body = (cstr_st) {
-		NULL, 0
-	};
-	char *cont_type;
-	BOOL is_json;
 
-	if (dbc->pack_json) {
-		DBGH(stmt, "POSTing JSON to URL type %d: [%zu] `" LCPDL "`.", url_type,
-			req_body->cnt, LCSTR(req_body));
-	} else {
-		DBGH(stmt, "POSTing CBOR to URL type %d: [%zu] `%s`.", url_type,
-			req_body->cnt, cstr_hex_dump(req_body));
+	if (! (xfers = calloc(cnt, sizeof(*xfers)))) {
+		ERRNH(stmt, "OOM for %llu transfers.", (uint64_t)cnt);
+		RET_HDIAGS(stmt, SQL_STATE_HY001);
+	}
+	for (i = 0; i < cnt; i ++) {
+		answs[i].res = CURLE_OK;
+		answs[i].code = -1;
+		answs[i].body.str = NULL;
+		answs[i].body.cnt = 0;
 	}
 
+	/* clone the DBC's handle, with all the connection's settings */
 	ESODBC_MUX_LOCK(&dbc->curl_mux);
-
 	if (! dbc->curl) {
-		ret = dbc_curl_init(dbc);
-		if (! SQL_SUCCEEDED(ret)) {
-			goto err;
+		ret = dbc_curl_init(dbc, &HDRH(stmt)->diag);
+	}
+	if (SQL_SUCCEEDED(ret) && dbc->crr_url != ESODBC_CURL_QUERY) {
+		ret = dbc_curl_set_url(dbc, ESODBC_CURL_QUERY, &HDRH(stmt)->diag);
+	}
+	if (SQL_SUCCEEDED(ret) && (! (tmpl = curl_easy_duphandle(dbc->curl)))) {
+		ERRH(stmt, "libcurl: failed to duplicate handle.");
+		ret = post_c_diagnostic(stmt, SQL_STATE_HY000,
+				"failed to init the transport", 0);
+	}
+	/* the DBC's Authorization headers list can be freed with the DBC's
+	 * handle, while the batch is under way */
+	if (SQL_SUCCEEDED(ret) && dbc->curl_hdrs) {
+		if (! (hdrs = curl_slist_duplicate(dbc->curl_hdrs))) {
+			ERRNH(stmt, "failed duplicating HTTP headers.");
+			ret = post_c_diagnostic(stmt, SQL_STATE_HY001, NULL, 0);
 		}
 	}
-
-	RESET_HDIAG(dbc);
-
-	if (dbc->crr_url != url_type) {
-		ret = dbc_curl_set_url(dbc, url_type);
-		if (! SQL_SUCCEEDED(ret)) {
-			goto err;
-		}
+	ESODBC_MUX_UNLOCK(&dbc->curl_mux);
+	if (! SQL_SUCCEEDED(ret)) {
+		goto end;
 	}
 
-	/* set timeout as maximum between connection and statement value */
 	tout = dbc->timeout < stmt->query_timeout ? stmt->query_timeout :
 		dbc->timeout;
+	/* the clones mustn't share the DBC's error buffer */
+	if ((hdrs && curl_easy_setopt(tmpl, CURLOPT_HTTPHEADER, hdrs) !=
+			CURLE_OK) ||
+		curl_easy_setopt(tmpl, CURLOPT_WRITEFUNCTION,
+			batch_write_callback) != CURLE_OK ||
+		curl_easy_setopt(tmpl, CURLOPT_ERRORBUFFER, NULL) != CURLE_OK ||
+		curl_easy_setopt(tmpl, CURLOPT_TIMEOUT, (long)tout) != CURLE_OK) {
+		ERRH(stmt, "libcurl: failed to set up batch template handle.");
+		ret = post_c_diagnostic(stmt, SQL_STATE_HY000, "failed to set up the "
+				"parameters array requests", 0);
+		goto end;
+	}
+	/* the multi handle is kept with the statement, for SQLCancel() to be
+	 * able to wake it up (and its connections to be reused) */
+	if (! stmt->batch_multi) {
+		if (! (multi = curl_multi_init())) {
+			ERRH(stmt, "libcurl: failed to init multi handle.");
+			ret = post_c_diagnostic(stmt, SQL_STATE_HY000, "failed to set "
+					"up the parameters array requests", 0);
+			goto end;
+		}
+		stmt->batch_multi = multi;
+	} else {
+		multi = stmt->batch_multi;
+	}
 
-	if (dbc_curl_add_post_body(dbc, tout, req_body) &&
-		dbc_curl_perform(dbc, &code, &rsp_body, &cont_type)) {
-		ret = content_type_supported(dbc, cont_type, &is_json);
-		if (! SQL_SUCCEEDED(ret)) {
-			code = -1; /* make answer unavailable */
-		} else if (code == 200) {
-			if (rsp_body.cnt) {
-				ESODBC_MUX_UNLOCK(&dbc->curl_mux);
-				return (url_type == ESODBC_CURL_QUERY) ?
-					attach_answer(stmt, &rsp_body, is_json) :
-					/* ESODBC_CURL_CLOSE */
-					close_es_answ_handler(stmt, &rsp_body, is_json);
+	/* a cancellation only applies to a request that's under way */
+	InterlockedExchange(&stmt->cancel, FALSE);
+	for (next = 0, active = 0; ; ) {
+		/* keep the pipeline full */
+		for (; active < ESODBC_MAX_PARAMSET_XFERS && next < cnt; next ++) {
+			if (! reqs[next].str) {
+				continue;
+			}
+			if (batch_xfer_start(stmt, multi, tmpl, &reqs[next],
+					&xfers[next])) {
+				active ++;
 			} else {
-				ERRH(stmt, "received 200 response code with empty body.");
-				ret = post_c_diagnostic(dbc, SQL_STATE_08S01,
-						"Received 200 response code with empty body.", 0);
+				answs[next].res = CURLE_FAILED_INIT;
 			}
 		}
-	} else {
-		ret = dbc_curl_post_diag(dbc, SQL_STATE_08S01);
-	}
+		if (! active || stmt->cancel) {
+			break;
+		}
 
-	/* something went wrong, reset cURL handle/connection */
-	cleanup_curl(dbc);
-err:
-	/* was there an error answer received correctly? */
-	if (0 < code) {
-		ret = attach_error(stmt, &rsp_body, is_json, code);
-	} else {
-		/* copy any error occured at DBC level back down to the statement,
-		 * where it's going to be read from. */
-		if (HDRH(dbc)->diag.state) {
-			HDRH(stmt)->diag = HDRH(dbc)->diag;
+		mcode = curl_multi_perform(multi, &running);
+		if (mcode != CURLM_OK) {
+			break;
+		}
+		while ((msg = curl_multi_info_read(multi, &left))) {
+			if (msg->msg != CURLMSG_DONE) {
+				continue;
+			}
+			if (curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE,
+					(char **)&xfer) != CURLE_OK || (! xfer)) {
+				BUG("can't retrieve transfer of finished handle.");
+				continue;
+			}
+			batch_xfer_done(stmt, multi, xfer, msg->data.result,
+				&answs[xfer - xfers]);
+			active --;
+		}
+		if (running) {
+			mcode = curl_multi_poll(multi, NULL, 0, ESODBC_XFER_POLL_MS,
+					NULL);
+			if (mcode != CURLM_OK) {
+				break;
+			}
 		}
 	}
-	/* if need to copy the diag., the mux release can only be done aftewards */
-	ESODBC_MUX_UNLOCK(&dbc->curl_mux);
 
-	/* an answer might have been received, but a late curl error (like
-	 * fetching the result code) could have occurred. */
-	if (rsp_body.str) {
-		free(rsp_body.str);
-		rsp_body.str = NULL;
+	if (mcode != CURLM_OK) {
+		ERRH(stmt, "libcurl: multi transfer failed: %s.",
+			curl_multi_strerror(mcode));
+		ret = post_c_diagnostic(stmt, SQL_STATE_08S01,
+				curl_multi_strerror(mcode), mcode);
+	} else if (stmt->cancel) {
+		INFOH(stmt, "libcurl: batch transfer canceled, aborting.");
+		ret = post_c_diagnostic(stmt, SQL_STATE_HY008,
+				"The request has been canceled", 0);
 	}
 
+end:
+	/* abandon whatever's still under way */
+	for (i = 0; i < cnt; i ++) {
+		if (xfers[i].curl) {
+			curl_multi_remove_handle(multi, xfers[i].curl);
+			curl_easy_cleanup(xfers[i].curl);
+		}
+		if (xfers[i].abuff) {
+			free(xfers[i].abuff);
+		}
+	}
+	free(xfers);
+	if (tmpl) {
+		curl_easy_cleanup(tmpl);
+	}
+	if (hdrs) {
+		curl_slist_free_all(hdrs);
+	}
 	return ret;
 }
 
@@ -1238,6 +2397,7 @@ SQLRETURN config_dbc(esodbc_dbc_st *dbc, esodbc_dsn_attrs_st *attrs)
 	wstr_st prefix;
 	int cnt, ipv6, n;
 	SQLBIGINT secure, timeout, max_body_size, max_fetch_size, varchar_limit;
+	SQLBIGINT pool_max_idle, pool_idle_tout, meta_cache_ttl;
 	SQLWCHAR buff_url[ESODBC_MAX_URL_LEN];
 	wstr_st url = (wstr_st) {
 		buff_url, /*will be init'ed later*/0
@@ -1617,6 +2777,12 @@ SQLRETURN config_dbc(esodbc_dbc_st *dbc, esodbc_dsn_attrs_st *attrs)
 	/* auto escape pattern value argument */
 	dbc->auto_esc_pva = wstr2bool(&attrs->auto_esc_pva);
 	INFOH(dbc, "auto escape PVA: %s.", dbc->auto_esc_pva ? "true" : "false");
+	/* next page prefetching */
+	dbc->prefetch = wstr2bool(&attrs->prefetch);
+	INFOH(dbc, "prefetching: %s.", dbc->prefetch ? "true" : "false");
+	/* columnar result sets */
+	dbc->columnar = wstr2bool(&attrs->columnar);
+	INFOH(dbc, "columnar: %s.", dbc->columnar ? "true" : "false");
 	/* varchar limit */
 	if (str2bigint(&attrs->varchar_limit, /*wide?*/TRUE, &varchar_limit,
 			/*strict*/TRUE) < 0) {
@@ -1647,6 +2813,63 @@ SQLRETURN config_dbc(esodbc_dbc_st *dbc, esodbc_dsn_attrs_st *attrs)
 		INFOH(dbc, "varchar limit: %lu.", dbc->varchar_limit);
 	}
 
+	/*
+	 * connections pooling
+	 */
+	if (str2bigint(&attrs->pool_max_idle, /*wide?*/TRUE, &pool_max_idle,
+			/*strict*/TRUE) < 0 ||
+		str2bigint(&attrs->pool_idle_tout, /*wide?*/TRUE, &pool_idle_tout,
+			/*strict*/TRUE) < 0) {
+		ERRH(dbc, "failed to convert pool max idle `" LWPDL "` or idle "
+			"timeout `" LWPDL "`.", LWSTR(&attrs->pool_max_idle),
+			LWSTR(&attrs->pool_idle_tout));
+		SET_HDIAG(dbc, SQL_STATE_HY000, "pooling setting number "
+			"conversion failure", 0);
+		goto err;
+	}
+	if (LONG_MAX < pool_max_idle || pool_max_idle < 0 ||
+		LONG_MAX < pool_idle_tout || pool_idle_tout < 0) {
+		ERRH(dbc, "invalid '%s' (%lld) or '%s' (%lld) setting value.",
+			ESODBC_DSN_POOL_MAX_IDLE, pool_max_idle,
+			ESODBC_DSN_POOL_IDLE_TOUT, pool_idle_tout);
+		SET_HDIAG(dbc, SQL_STATE_HY000, "invalid pooling setting", 0);
+		goto err;
+	}
+	dbc->pool_max_idle = (long)pool_max_idle;
+	dbc->pool_idle_tout = (long)pool_idle_tout;
+	if (dbc->pool_max_idle) {
+		if (! (dbc->curl_share = pool_share(dbc))) {
+			SET_HDIAG(dbc, SQL_STATE_HY000, "connection pool setup failed",
+				0);
+			goto err;
+		}
+		INFOH(dbc, "connection pooling: max idle: %ld, idle timeout: %lds.",
+			dbc->pool_max_idle, dbc->pool_idle_tout);
+	} else {
+		INFOH(dbc, "connection pooling disabled.");
+	}
+
+	/*
+	 * server metadata caching
+	 */
+	if (str2bigint(&attrs->meta_cache_ttl, /*wide?*/TRUE, &meta_cache_ttl,
+			/*strict*/TRUE) < 0) {
+		ERRH(dbc, "failed to convert metadata cache TTL `" LWPDL "`.",
+			LWSTR(&attrs->meta_cache_ttl));
+		SET_HDIAG(dbc, SQL_STATE_HY000, "metadata cache TTL number "
+			"conversion failure", 0);
+		goto err;
+	} else if (ULONG_MAX < meta_cache_ttl || meta_cache_ttl < 0) {
+		ERRH(dbc, "'%s' setting value (%lld) out of range [%d, %lu].",
+			ESODBC_DSN_META_CACHE_TTL, meta_cache_ttl, 0, ULONG_MAX);
+		SET_HDIAG(dbc, SQL_STATE_HY000, "invalid metadata cache TTL "
+			"setting", 0);
+		goto err;
+	} else {
+		dbc->meta_cache_ttl = (SQLUINTEGER)meta_cache_ttl;
+		INFOH(dbc, "metadata cache TTL: %lus.", dbc->meta_cache_ttl);
+	}
+
 	return SQL_SUCCESS;
 err:
 	/* release allocated resources before the failure; not the diag, tho */
@@ -1658,6 +2881,7 @@ err:
 /* release all resources, except the handler itself */
 void cleanup_dbc(esodbc_dbc_st *dbc)
 {
+	catalog_cache_clear(dbc);
 	if (dbc->ca_path.str) {
 		free(dbc->ca_path.str);
 		dbc->ca_path.str = NULL;
@@ -1700,6 +2924,13 @@ void cleanup_dbc(esodbc_dbc_st *dbc)
 	} else {
 		assert(dbc->pwd.cnt == 0);
 	}
+	if (dbc->api_key.str) {
+		free(dbc->api_key.str);
+		dbc->api_key.str = NULL;
+		dbc->api_key.cnt = 0;
+	} else {
+		assert(dbc->api_key.cnt == 0);
+	}
 	if (dbc->proxy_url.str) {
 		free(dbc->proxy_url.str);
 		dbc->proxy_url.str = NULL;
@@ -1733,6 +2964,9 @@ void cleanup_dbc(esodbc_dbc_st *dbc)
 		assert(! dbc->server.cnt);
 		assert(! dbc->server.str);
 	}
+	if (dbc->srv_cache) {
+		srv_cache_release(dbc);
+	}
 	if (dbc->es_types) {
 		free(dbc->es_types);
 		dbc->es_types = NULL;
@@ -1740,12 +2974,17 @@ void cleanup_dbc(esodbc_dbc_st *dbc)
 	} else {
 		assert(dbc->no_types == 0);
 	}
+	dbc->max_float_type = NULL;
+	dbc->max_varchar_type = NULL;
+	dbc->ulong = NULL;
+	dbc->lgst_name = NULL;
 	if (dbc->srv_ver.str) {
 		free(dbc->srv_ver.str);
 		dbc->srv_ver.str = NULL;
 		dbc->srv_ver.cnt = 0;
 	}
 	free_current_catalog(dbc);
+	free_server_attrs(dbc, /*catalog only*/FALSE);
 	assert(dbc->catalog.w.cnt == 0);
 	assert(dbc->catalog.c.cnt == 0);
 	if (dbc->varchar_limit_str.str) {
@@ -1756,6 +2995,16 @@ void cleanup_dbc(esodbc_dbc_st *dbc)
 
 	assert(dbc->abuff == NULL);
 	cleanup_curl(dbc);
+	if (dbc->curl_multi) {
+		pool_checkin(dbc);
+	}
+	/* the statements' async transfers have been abandoned by now */
+	if (dbc->async_multi) {
+		curl_multi_cleanup(dbc->async_multi);
+		dbc->async_multi = NULL;
+	}
+	/* the pool itself is kept for other/later DBCs */
+	dbc->curl_share = NULL;
 
 	if (dbc->hdr.log && dbc->hdr.log != _gf_log) {
 		filelog_del(dbc->hdr.log);
@@ -1948,18 +3197,20 @@ static SQLRETURN check_server_version(esodbc_dbc_st *dbc)
 	SQLWCHAR wbuff[sizeof(err_msg_fmt)/sizeof(err_msg_fmt[0]) + 32];
 	int n;
 
-	ret = dbc_curl_set_url(dbc, ESODBC_CURL_ROOT);
+	ret = dbc_curl_set_url(dbc, ESODBC_CURL_ROOT, &HDRH(dbc)->diag);
 	if (! SQL_SUCCEEDED(ret)) {
 		return ret;
 	}
 
 	RESET_HDIAG(dbc);
-	if (! dbc_curl_perform(dbc, &code, &rsp_body, &cont_type)) {
-		dbc_curl_post_diag(dbc, SQL_STATE_HY000);
+	if (! dbc_curl_perform(dbc, /*cancel*/NULL, &code, &rsp_body,
+			&cont_type)) {
+		dbc_curl_post_diag(dbc, &HDRH(dbc)->diag, SQL_STATE_HY000);
 		cleanup_curl(dbc);
 		return SQL_ERROR;
 	}
-	if (! SQL_SUCCEEDED(content_type_supported(dbc, cont_type, &is_json))) {
+	if (! SQL_SUCCEEDED(content_type_supported(dbc, cont_type, &is_json,
+				&HDRH(dbc)->diag))) {
 		goto err;
 	}
 	if (! rsp_body.cnt) {
@@ -2049,10 +3300,302 @@ err:
 	}
 }
 
+static void srv_cache_free(srv_cache_st *entry)
+{
+	assert(! entry->refs);
+	free(entry->key.str);
+	free(entry->srv_ver.str);
+	free(entry->es_types);
+	free(entry);
+}
+
+/* Build the key of the server metadata cache: root URL, user, a hash of the
+ * password and API key and the varchar limit (applied to the loaded types).
+ * An 'extra' part, if given, is appended last (it can contain 0s). */
+static BOOL srv_cache_key(esodbc_dbc_st *dbc, const cstr_st *extra,
+	cstr_st *key)
+{
+	char buff[2 * sizeof("18446744073709551615")];
+	cstr_st tail = {(SQLCHAR *)buff, 0};
+	cstr_st *parts[] = {&dbc->root_url, &dbc->uid, &tail, (cstr_st *)extra};
+	uint64_t hash = ESODBC_FNV1A_BASIS;
+	const SQLCHAR sep = '\0';
+	int n;
+
+	/* password and API key share the storage: the user name tells which one
+	 * is set (see config_dbc()); hash them as distinct fields */
+	if (dbc->uid.cnt) {
+		hash = fnv1a_hash(hash, dbc->pwd.str, dbc->pwd.cnt);
+	}
+	hash = fnv1a_hash(hash, &sep, sizeof(sep));
+	if (! dbc->uid.cnt) {
+		hash = fnv1a_hash(hash, dbc->api_key.str, dbc->api_key.cnt);
+	}
+	n = snprintf(buff, sizeof(buff), "%" PRIx64 ":%lu", hash,
+			(unsigned long)dbc->varchar_limit);
+	if (n <= 0 || sizeof(buff) <= (size_t)n) {
+		ERRH(dbc, "failed to print cache key tail.");
+		return FALSE;
+	}
+	tail.cnt = (size_t)n;
+
+	return make_key(dbc, '0' + (char)dbc->secure, parts,
+			sizeof(parts)/sizeof(*parts) - (extra ? 0 : 1), key);
+}
+
+/* unlink an entry from the cache list; free it, if no longer in use */
+static void srv_cache_unlink(srv_cache_st **link)
+{
+	srv_cache_st *entry = *link;
+
+	*link = entry->next;
+	if (entry->refs) {
+		entry->stale = TRUE;
+	} else {
+		srv_cache_free(entry);
+	}
+}
+
+/* Reference in the DBC the cached server version and types, if available and
+ * not expired. Returns TRUE on cache hit. */
+static BOOL srv_cache_attach(esodbc_dbc_st *dbc, cstr_st *key)
+{
+	srv_cache_st *entry, **link;
+	ULONGLONG now = GetTickCount64();
+
+	ESODBC_MUX_LOCK(&srv_caches_mux);
+	for (link = &srv_caches; (entry = *link); link = &entry->next) {
+		if (entry->key.cnt == key->cnt &&
+			memcmp(entry->key.str, key->str, key->cnt) == 0) {
+			break;
+		}
+	}
+	if (entry && (dbc->cache_refresh ||
+			entry->loaded + dbc->meta_cache_ttl * 1000ULL <= now)) {
+		INFOH(dbc, "dropping %s server metadata cache entry.",
+			dbc->cache_refresh ? "refreshed" : "expired");
+		srv_cache_unlink(link);
+		entry = NULL;
+	}
+	if (entry) {
+		entry->refs ++;
+		dbc->srv_cache = entry;
+		dbc->srv_ver = entry->srv_ver;
+		set_es_types(dbc, entry->no_types, entry->es_types);
+	}
+	ESODBC_MUX_UNLOCK(&srv_caches_mux);
+
+	if (entry) {
+		INFOH(dbc, "using cached server metadata: version `" LWPDL "`, "
+			"%lu types.", LWSTR(&dbc->srv_ver), (unsigned long)dbc->no_types);
+	}
+	return entry != NULL;
+}
+
+/* Add the freshly loaded server version and types to the cache: the DBC will
+ * keep referencing them, but the cache owns them from now on. */
+static void srv_cache_add(esodbc_dbc_st *dbc, cstr_st *key)
+{
+	srv_cache_st *entry, **link;
+
+	if (! (entry = calloc(1, sizeof(*entry)))) {
+		ERRNH(dbc, "OOM for %zu bytes.", sizeof(*entry));
+		return; /* not fatal: just won't cache */
+	}
+	entry->key = *key;
+	key->str = NULL;
+	key->cnt = 0;
+	entry->loaded = GetTickCount64();
+	entry->refs = 1;
+	entry->srv_ver = dbc->srv_ver;
+	entry->es_types = dbc->es_types;
+	entry->no_types = dbc->no_types;
+
+	ESODBC_MUX_LOCK(&srv_caches_mux);
+	/* drop any entry added meanwhile by a concurrently connecting DBC */
+	for (link = &srv_caches; *link; link = &(*link)->next) {
+		if ((*link)->key.cnt == entry->key.cnt &&
+			memcmp((*link)->key.str, entry->key.str, entry->key.cnt) == 0) {
+			srv_cache_unlink(link);
+			break;
+		}
+	}
+	entry->next = srv_caches;
+	srv_caches = entry;
+	ESODBC_MUX_UNLOCK(&srv_caches_mux);
+
+	dbc->srv_cache = entry;
+	DBGH(dbc, "server metadata cached.");
+}
+
+/* Release DBC's reference to the cached server version and types. */
+static void srv_cache_release(esodbc_dbc_st *dbc)
+{
+	srv_cache_st *entry = dbc->srv_cache;
+
+	ESODBC_MUX_LOCK(&srv_caches_mux);
+	assert(0 < entry->refs);
+	entry->refs --;
+	if (entry->stale && (! entry->refs)) {
+		srv_cache_free(entry);
+	}
+	ESODBC_MUX_UNLOCK(&srv_caches_mux);
+
+	dbc->srv_cache = NULL;
+	/* content is owned by the cache */
+	dbc->srv_ver.str = NULL;
+	dbc->srv_ver.cnt = 0;
+	dbc->es_types = NULL;
+	dbc->no_types = 0;
+}
+
+/* unlink an entry from the result cache list and free it */
+static void rslt_cache_unlink(rslt_cache_st **link)
+{
+	rslt_cache_st *entry = *link;
+
+	*link = entry->next;
+	assert(entry->body.cnt <= rslt_caches_size);
+	rslt_caches_size -= entry->body.cnt;
+	free(entry->key.str);
+	free(entry->body.str);
+	free(entry);
+}
+
+/* Copy into 'answer' the cached answer to the statement's request 'req', if
+ * available and not expired. Returns TRUE on cache hit. */
+BOOL TEST_API rslt_cache_lookup(esodbc_stmt_st *stmt, const cstr_st *req,
+	cstr_st *answer, BOOL *is_json)
+{
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	rslt_cache_st *entry, **link;
+	cstr_st key;
+	ULONGLONG now = GetTickCount64();
+	BOOL found = FALSE;
+
+	if (! srv_cache_key(dbc, req, &key)) {
+		WARNH(stmt, "failed to build result cache key.");
+		return FALSE;
+	}
+
+	ESODBC_MUX_LOCK(&rslt_caches_mux);
+	for (link = &rslt_caches; (entry = *link); link = &entry->next) {
+		if (entry->key.cnt == key.cnt &&
+			memcmp(entry->key.str, key.str, key.cnt) == 0) {
+			break;
+		}
+	}
+	if (entry) {
+		if (entry->loaded + dbc->rslt_cache_ttl * 1000ULL <= now) {
+			DBGH(stmt, "dropping expired result cache entry.");
+			rslt_cache_unlink(link);
+		} else if (! (answer->str = malloc(entry->body.cnt + /*\0*/1))) {
+			ERRNH(stmt, "OOM for %zu bytes.", entry->body.cnt + 1);
+		} else {
+			memcpy(answer->str, entry->body.str, entry->body.cnt);
+			answer->str[entry->body.cnt] = '\0';
+			answer->cnt = entry->body.cnt;
+			*is_json = entry->is_json;
+			/* move the entry to the front of the list */
+			*link = entry->next;
+			entry->next = rslt_caches;
+			rslt_caches = entry;
+			found = TRUE;
+		}
+	}
+	ESODBC_MUX_UNLOCK(&rslt_caches_mux);
+	free(key.str);
+
+	STMT_PERF_COUNT(stmt, found ? ESODBC_PERF_RSLT_CACHE_HITS :
+		ESODBC_PERF_RSLT_CACHE_MISSES, 1);
+	DBGH(stmt, "result cache %s.", found ? "hit" : "miss");
+	return found;
+}
+
+/* Cache a copy of the statement's current answer to the request 'req'. */
+void TEST_API rslt_cache_add(esodbc_stmt_st *stmt, const cstr_st *req)
+{
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	cstr_st *body = &stmt->rset.body;
+	rslt_cache_st *entry, **link;
+
+	if (ESODBC_RSLT_CACHE_MAX < body->cnt) {
+		INFOH(stmt, "answer too large to cache: %zu bytes.", body->cnt);
+		return;
+	}
+	if (! (entry = calloc(1, sizeof(*entry)))) {
+		ERRNH(stmt, "OOM for %zu bytes.", sizeof(*entry));
+		return; /* not fatal: just won't cache */
+	}
+	if (! srv_cache_key(dbc, req, &entry->key)) {
+		WARNH(stmt, "failed to build result cache key.");
+		free(entry);
+		return;
+	}
+	if (! (entry->body.str = malloc(body->cnt))) {
+		ERRNH(stmt, "OOM for %zu bytes.", body->cnt);
+		free(entry->key.str);
+		free(entry);
+		return;
+	}
+	memcpy(entry->body.str, body->str, body->cnt);
+	entry->body.cnt = body->cnt;
+	entry->is_json = stmt->rset.pack_json;
+	entry->loaded = GetTickCount64();
+
+	ESODBC_MUX_LOCK(&rslt_caches_mux);
+	/* drop any entry added meanwhile by a concurrently executing statement */
+	for (link = &rslt_caches; *link; link = &(*link)->next) {
+		if ((*link)->key.cnt == entry->key.cnt &&
+			memcmp((*link)->key.str, entry->key.str, entry->key.cnt) == 0) {
+			rslt_cache_unlink(link);
+			break;
+		}
+	}
+	entry->next = rslt_caches;
+	rslt_caches = entry;
+	rslt_caches_size += entry->body.cnt;
+	while (ESODBC_RSLT_CACHE_MAX < rslt_caches_size) {
+		/* the just added entry is the last to be evicted */
+		for (link = &rslt_caches; (*link)->next; link = &(*link)->next)
+			;
+		rslt_cache_unlink(link);
+	}
+	ESODBC_MUX_UNLOCK(&rslt_caches_mux);
+	DBGH(stmt, "answer cached: %zu bytes.", body->cnt);
+}
+
+/* Drop the cached answers to the requests of connections with same key. */
+static void rslt_cache_drop(esodbc_dbc_st *dbc)
+{
+	rslt_cache_st **link;
+	cstr_st prefix;
+
+	if (! srv_cache_key(dbc, /*extra*/NULL, &prefix)) {
+		WARNH(dbc, "failed to build result cache key.");
+		return;
+	}
+	ESODBC_MUX_LOCK(&rslt_caches_mux);
+	for (link = &rslt_caches; *link; ) {
+		/* the request follows the prefix, separated by a 0 */
+		if (prefix.cnt < (*link)->key.cnt &&
+			memcmp((*link)->key.str, prefix.str, prefix.cnt) == 0 &&
+			(*link)->key.str[prefix.cnt] == '\0') {
+			rslt_cache_unlink(link);
+		} else {
+			link = &(*link)->next;
+		}
+	}
+	ESODBC_MUX_UNLOCK(&rslt_caches_mux);
+	free(prefix.str);
+	INFOH(dbc, "cached results dropped.");
+}
+
 /* fully initializes a DBC and performs a simple test query */
 SQLRETURN do_connect(esodbc_dbc_st *dbc, esodbc_dsn_attrs_st *attrs)
 {
 	SQLRETURN ret;
+	cstr_st key = {NULL, 0};
 
 	/* multiple connection attempts are possible (when prompting user) */
 	cleanup_dbc(dbc);
@@ -2064,16 +3607,27 @@ SQLRETURN do_connect(esodbc_dbc_st *dbc, esodbc_dsn_attrs_st *attrs)
 	}
 
 	/* init libcurl objects */
-	ret = dbc_curl_init(dbc);
+	ret = dbc_curl_init(dbc, &HDRH(dbc)->diag);
 	if (! SQL_SUCCEEDED(ret)) {
 		ERRH(dbc, "failed to init transport.");
 		return ret;
 	}
 
+	/* has another DBC loaded the server's metadata recently? */
+	if (dbc->meta_cache_ttl) {
+		if (! srv_cache_key(dbc, /*extra*/NULL, &key)) {
+			WARNH(dbc, "failed to build cache key; not caching.");
+		} else if (srv_cache_attach(dbc, &key)) {
+			free(key.str);
+			dbc->cache_refresh = FALSE;
+			return SQL_SUCCESS;
+		}
+	}
+
 	/* retrieve and set server's version */
 	ret = check_server_version(dbc);
 	if (! SQL_SUCCEEDED(ret)) {
-		return ret;
+		goto end;
 	} else {
 		DBGH(dbc, "server version check at URL %s: OK.", dbc->url.str);
 	}
@@ -2083,13 +3637,22 @@ SQLRETURN do_connect(esodbc_dbc_st *dbc, esodbc_dsn_attrs_st *attrs)
 	if (! load_es_types(dbc)) {
 		ERRH(dbc, "failed to load Elasticsearch/SQL data types.");
 		if (HDRH(dbc)->diag.state) {
-			RET_STATE(HDRH(dbc)->diag.state);
+			ret = esodbc_errors[HDRH(dbc)->diag.state].retcode;
 		} else {
-			RET_HDIAG(dbc, SQL_STATE_HY000,
-				"failed to load Elasticsearch/SQL data types", 0);
+			ret = post_c_diagnostic(dbc, SQL_STATE_HY000,
+					"failed to load Elasticsearch/SQL data types", 0);
 		}
+		goto end;
 	}
 
+	if (key.str) {
+		srv_cache_add(dbc, &key);
+		dbc->cache_refresh = FALSE;
+	}
+end:
+	if (key.str) {
+		free(key.str);
+	}
 	return ret;
 }
 
@@ -2902,6 +4465,8 @@ static BOOL load_es_types(esodbc_dbc_st *dbc)
 		return FALSE;
 	}
 	assert(stmt);
+	/* internal statement: don't inherit application's async mode */
+	STMH(stmt)->async_enable = SQL_ASYNC_ENABLE_OFF;
 
 #ifdef TESTING
 	/* for testing cases with no ES server available, the connection needs to
@@ -3437,11 +5002,14 @@ SQLRETURN EsSQLSetConnectAttrW(
 			break;
 
 		case SQL_ATTR_ASYNC_ENABLE:
-			ERRH(dbc, "no support for async API (setting param: %llu)",
-				(uint64_t)Value);
-			if ((SQLULEN)(uintptr_t)Value == SQL_ASYNC_ENABLE_ON) {
-				RET_HDIAGS(dbc, SQL_STATE_HYC00);
+			INFOH(dbc, "setting async mode to %llu.", (uint64_t)Value);
+			if ((SQLULEN)(uintptr_t)Value != SQL_ASYNC_ENABLE_ON &&
+				(SQLULEN)(uintptr_t)Value != SQL_ASYNC_ENABLE_OFF) {
+				ERRH(dbc, "invalid async mode value.");
+				RET_HDIAGS(dbc, SQL_STATE_HY024);
 			}
+			/* only applies to statements allocated subsequently */
+			dbc->async_enable = (SQLULEN)(uintptr_t)Value;
 			break;
 		case SQL_ATTR_ASYNC_DBC_FUNCTIONS_ENABLE:
 			ERRH(dbc, "no support for async API (setting param: %llu)",
@@ -3544,6 +5112,24 @@ SQLRETURN EsSQLSetConnectAttrW(
 			RET_HDIAGS(DBCH(ConnectionHandle), SQL_STATE_HY092);
 #endif
 
+		case ESODBC_SQL_ATTR_CACHE_REFRESH:
+			dbc->cache_refresh = (BOOL)(uintptr_t)Value;
+			INFOH(dbc, "cached server metadata refresh: %s.",
+				dbc->cache_refresh ? "requested" : "cancelled");
+			if (dbc->cache_refresh) {
+				catalog_cache_clear(dbc);
+				free_server_attrs(dbc, /*catalog only*/FALSE);
+				if (dbc->es_types) { /* connected */
+					rslt_cache_drop(dbc);
+				}
+			}
+			break;
+
+		case ESODBC_SQL_ATTR_RSLT_CACHE_TTL:
+			dbc->rslt_cache_ttl = (SQLUINTEGER)(uintptr_t)Value;
+			INFOH(dbc, "result cache TTL: %lus.", dbc->rslt_cache_ttl);
+			break;
+
 		case SQL_ATTR_MAX_ROWS: /* stmt attr -- 2.x app */
 			WARNH(dbc, "applying a statement as connection attribute (2.x?)");
 			DBGH(dbc, "setting max rows: %llu.", (uint64_t)Value);
@@ -3554,6 +5140,9 @@ SQLRETURN EsSQLSetConnectAttrW(
 			break;
 
 		default:
+			if (IS_PERF_ATTR(Attribute)) {
+				return perf_reset_attr(dbc, &dbc->perf, Attribute);
+			}
 			ERRH(dbc, "unknown Attribute: %d.", Attribute);
 			RET_HDIAGS(dbc, SQL_STATE_HY092);
 	}
@@ -3614,8 +5203,8 @@ SQLRETURN EsSQLGetConnectAttrW(
 			*(SQLULEN *)ValuePtr = dbc->metadata_id;
 			break;
 		case SQL_ATTR_ASYNC_ENABLE:
-			DBGH(dbc, "getting async mode: %lu", SQL_ASYNC_ENABLE_OFF);
-			*(SQLULEN *)ValuePtr = SQL_ASYNC_ENABLE_OFF;
+			DBGH(dbc, "getting async mode: %llu", (uint64_t)dbc->async_enable);
+			*(SQLULEN *)ValuePtr = dbc->async_enable;
 			break;
 
 		case SQL_ATTR_QUIET_MODE:
@@ -3663,6 +5252,17 @@ SQLRETURN EsSQLGetConnectAttrW(
 
 		//case SQL_ATTR_DBC_INFO_TOKEN:
 
+		case ESODBC_SQL_ATTR_CACHE_REFRESH:
+			DBGH(dbc, "getting cache refresh request: %d.",
+				dbc->cache_refresh);
+			*(SQLUINTEGER *)ValuePtr = (SQLUINTEGER)dbc->cache_refresh;
+			break;
+		case ESODBC_SQL_ATTR_RSLT_CACHE_TTL:
+			DBGH(dbc, "getting result cache TTL: %lus.",
+				dbc->rslt_cache_ttl);
+			*(SQLUINTEGER *)ValuePtr = dbc->rslt_cache_ttl;
+			break;
+
 		case SQL_ATTR_TRACE:
 		case SQL_ATTR_TRACEFILE: /* DM-only */
 		case SQL_ATTR_ENLIST_IN_DTC:
@@ -3681,6 +5281,9 @@ SQLRETURN EsSQLGetConnectAttrW(
 #endif
 
 		default:
+			if (IS_PERF_ATTR(Attribute)) {
+				return perf_get_attr(dbc, &dbc->perf, Attribute, ValuePtr);
+			}
 			ERRH(dbc, "unknown Attribute type %ld.", Attribute);
 			// FIXME: add the other attributes
 			FIXME;
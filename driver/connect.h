@@ -16,9 +16,25 @@
 BOOL connect_init();
 void connect_cleanup();
 
-SQLRETURN dbc_curl_set_url(esodbc_dbc_st *dbc, int url_type);
+SQLRETURN dbc_curl_set_url(esodbc_dbc_st *dbc, int url_type,
+	esodbc_diag_st *diag);
+SQLRETURN dbc_curl_post(esodbc_dbc_st *dbc, SQLULEN tout, int url_type,
+	const cstr_st *req_body, volatile LONG *cancel, long *code,
+	cstr_st *rsp_body, BOOL *is_json, esodbc_diag_st *diag,
+	esodbc_perf_st *perf);
+void dbc_curl_wakeup(esodbc_dbc_st *dbc);
+void curl_batch_wakeup(esodbc_stmt_st *stmt);
+void curl_batch_cleanup(esodbc_stmt_st *stmt);
 SQLRETURN curl_post(esodbc_stmt_st *stmt, int url_type,
 	const cstr_st *req_body);
+SQLRETURN curl_post_async(esodbc_stmt_st *stmt, const cstr_st *req_body);
+SQLRETURN curl_async_poll(esodbc_stmt_st *stmt);
+void curl_async_abort(esodbc_stmt_st *stmt);
+SQLRETURN curl_post_batch(esodbc_stmt_st *stmt, SQLULEN cnt,
+	const cstr_st *reqs, pset_answ_st *answs);
+BOOL TEST_API rslt_cache_lookup(esodbc_stmt_st *stmt, const cstr_st *req,
+	cstr_st *answer, BOOL *is_json);
+void TEST_API rslt_cache_add(esodbc_stmt_st *stmt, const cstr_st *req);
 void cleanup_dbc(esodbc_dbc_st *dbc);
 SQLRETURN do_connect(esodbc_dbc_st *dbc, esodbc_dsn_attrs_st *attrs);
 SQLRETURN config_dbc(esodbc_dbc_st *dbc, esodbc_dsn_attrs_st *attrs);
@@ -453,6 +453,109 @@ inline void *deferred_address(SQLSMALLINT field_id, size_t pos,
 	return base ? (char *)base + offt + pos * elem_size : NULL;
 }
 
+/*
+ * deferred_address() of a bound column's buffers, using the IRD record's
+ * conversion plan, if one is valid for the ARD record.
+ */
+inline void *planned_address(SQLSMALLINT field_id, size_t pos,
+	esodbc_rec_st *arec, esodbc_rec_st *irec)
+{
+	void *base;
+	size_t stride;
+	SQLLEN offt;
+
+	if (! REC_PLAN_VALID(irec, arec)) {
+		return deferred_address(field_id, pos, arec);
+	}
+	switch (field_id) {
+		case SQL_DESC_DATA_PTR:
+			base = arec->data_ptr;
+			stride = irec->plan.data_stride;
+			break;
+		case SQL_DESC_INDICATOR_PTR:
+			base = arec->indicator_ptr;
+			stride = irec->plan.len_stride;
+			break;
+		case SQL_DESC_OCTET_LENGTH_PTR:
+			base = arec->octet_length_ptr;
+			stride = irec->plan.len_stride;
+			break;
+		default:
+			BUG("can't calculate the planned address of field type %d.",
+				field_id);
+			return NULL;
+	}
+	if (! base) {
+		return NULL;
+	}
+	offt = irec->plan.offt_ptr ? *irec->plan.offt_ptr : 0;
+	return (char *)base + offt + pos * stride;
+}
+
+/*
+ * Build the conversion plans of the bound columns: resolve, for each, the
+ * target C type, the addressing of the application buffers and whether the
+ * values can be copied as-is.
+ * The plans are only valid as long as the ARD isn't modified, so they're
+ * rebuilt with each (re)binding.
+ */
+void conv_plans_build(esodbc_stmt_st *stmt)
+{
+	SQLSMALLINT i, cnt;
+	esodbc_desc_st *ard = stmt->ard, *ird = stmt->ird;
+	esodbc_rec_st *arec, *irec;
+
+	cnt = ard->count < ird->count ? ard->count : ird->count;
+	for (i = 0; i < ird->count; i ++) {
+		irec = &ird->recs[i];
+		memset(&irec->plan, 0, sizeof(irec->plan));
+		if (cnt <= i) {
+			continue;
+		}
+		arec = &ard->recs[i];
+		if (! REC_IS_BOUND(arec)) {
+			continue;
+		}
+		assert(irec->es_type);
+
+		irec->plan.ctype = arec->concise_type != SQL_C_DEFAULT ?
+			arec->concise_type : irec->es_type->c_concise_type;
+		if (ard->bind_type == SQL_BIND_BY_COLUMN) {
+			irec->plan.data_stride = (size_t)arec->octet_length;
+			irec->plan.len_stride = sizeof(SQLLEN);
+			irec->plan.offt_ptr = NULL;
+		} else {
+			irec->plan.data_stride = ard->bind_type;
+			irec->plan.len_stride = ard->bind_type;
+			irec->plan.offt_ptr = ard->bind_offset_ptr;
+		}
+		/* copying as-is requires source and target to have the same
+		 * representation; for text, sql2c_u8string() does the length
+		 * accounting, SQL_ATTR_MAX_LENGTH included. The numeric copies
+		 * needn't care about the attribute, which only applies to character
+		 * and binary data, so it's not part of the plan. */
+		if ((irec->plan.ctype == SQL_C_SBIGINT &&
+				irec->meta_type == METATYPE_EXACT_NUMERIC) ||
+			(irec->plan.ctype == SQL_C_DOUBLE &&
+				irec->meta_type == METATYPE_FLOAT_NUMERIC) ||
+			/* the driver's ANSI strings are UTF-8, like received text */
+			(irec->plan.ctype == SQL_C_CHAR &&
+				irec->meta_type == METATYPE_STRING)) {
+			irec->plan.direct = irec->plan.ctype;
+		} else {
+			irec->plan.direct = SQL_C_DEFAULT;
+		}
+		irec->plan.arec = arec;
+		irec->plan.gen = ard->gen;
+		DBGH(stmt, "column #%hd planned: C type: %hd, direct: %hd, data "
+			"stride: %zu, length stride: %zu.", i + 1, irec->plan.ctype,
+			irec->plan.direct, irec->plan.data_stride,
+			irec->plan.len_stride);
+	}
+	stmt->plans.ard_gen = ard->gen;
+	stmt->plans.ird_gen = ird->gen;
+}
+
 /*
  * Handles the lengths of the data to copy out to the application:
  * (1) returns the max amount of bytes to copy (in the data_ptr), taking into
@@ -571,6 +674,9 @@ static inline SQLSMALLINT get_rec_c_type(esodbc_rec_st *arec,
 	esodbc_rec_st *irec)
 {
 	SQLSMALLINT ctype;
+	if (REC_PLAN_VALID(irec, arec)) {
+		return irec->plan.ctype;
+	}
 	/* "To use the default mapping, an application specifies the SQL_C_DEFAULT
 	 * type identifier." */
 	if (arec->concise_type != SQL_C_DEFAULT) {
@@ -976,9 +1082,10 @@ SQLRETURN sql2c_quadword(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	ll = (long long)qword;
 
 	/* pointer where to write how many characters we will/would use */
-	octet_len_ptr = deferred_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec);
+	octet_len_ptr = planned_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec,
+			irec);
 	/* pointer to app's buffer */
-	data_ptr = deferred_address(SQL_DESC_DATA_PTR, pos, arec);
+	data_ptr = planned_address(SQL_DESC_DATA_PTR, pos, arec, irec);
 
 	/* Assume a C type behind an SQL C type, but check size representation.
 	 * Uses local vars: stmt. */
@@ -1212,63 +1319,24 @@ static SQLRETURN double_to_binary(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	return SQL_SUCCESS;
 }
 
-static inline const void *floats_rep(esodbc_stmt_st *stmt, double dbl,
-	BOOL wide, int *rep)
+/* floats representation, as per the ScientificFloats setting */
+static inline int floats_rep(esodbc_stmt_st *stmt, double dbl)
 {
-	static const char *flt_def = "%.*f";
-	static const wchar_t *flt_wdef = L"%.*f";
-	static const char *flt_exp = "%.*E";
-	static const wchar_t *flt_wexp = L"%.*E";
-
 	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
 	double abs;
 
-	if (wide) {
-		switch (dbc->sci_floats) {
-			case ESODBC_FLTS_DEFAULT:
-				*rep = ESODBC_FLTS_DEFAULT;
-				return flt_wdef;
-			case ESODBC_FLTS_SCIENTIFIC:
-				*rep = ESODBC_FLTS_SCIENTIFIC;
-				return flt_wexp;
-			case ESODBC_FLTS_AUTO:
-				abs = (0 <= dbl) ? dbl : -dbl;
-				if (abs < 1E-3 || 1E7 <= abs) {
-					*rep = ESODBC_FLTS_SCIENTIFIC;
-					return flt_wexp;
-				} else {
-					*rep = ESODBC_FLTS_DEFAULT;
-					return flt_wdef;
-				}
-			default:
-				BUGH(stmt, "unexpected floats representation value: %d.",
-					dbc->sci_floats);
-				*rep = ESODBC_FLTS_DEFAULT;
-				return flt_wdef;
-		}
-	} else {
-		switch (dbc->sci_floats) {
-			case ESODBC_FLTS_DEFAULT:
-				*rep = ESODBC_FLTS_DEFAULT;
-				return flt_def;
-			case ESODBC_FLTS_SCIENTIFIC:
-				*rep = ESODBC_FLTS_SCIENTIFIC;
-				return flt_exp;
-			case ESODBC_FLTS_AUTO:
-				abs = (0 <= dbl) ? dbl : -dbl;
-				if (abs < 1E-3 || 1E7 <= abs) {
-					*rep = ESODBC_FLTS_SCIENTIFIC;
-					return flt_exp;
-				} else {
-					*rep = ESODBC_FLTS_DEFAULT;
-					return flt_def;
-				}
-			default:
-				BUGH(stmt, "unexpected floats representation value: %d.",
-					dbc->sci_floats);
-				*rep = ESODBC_FLTS_DEFAULT;
-				return flt_def;
-		}
+	switch (dbc->sci_floats) {
+		case ESODBC_FLTS_DEFAULT:
+		case ESODBC_FLTS_SCIENTIFIC:
+			return dbc->sci_floats;
+		case ESODBC_FLTS_AUTO:
+			abs = (0 <= dbl) ? dbl : -dbl;
+			return (abs < 1E-3 || 1E7 <= abs) ? ESODBC_FLTS_SCIENTIFIC :
+				ESODBC_FLTS_DEFAULT;
+		default:
+			BUGH(stmt, "unexpected floats representation value: %d.",
+				dbc->sci_floats);
+			return ESODBC_FLTS_DEFAULT;
 	}
 }
 
@@ -1282,11 +1350,8 @@ static SQLRETURN double_to_str(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	esodbc_state_et state;
 	xstr_st xstr;
 	SQLSMALLINT prec; /* ~ision */
-	const char *flt_fmt;
-	const wchar_t *flt_wfmt;
 	int rep;
-	size_t octets, cnt;
-	int n;
+	size_t octets, cnt, n;
 
 	/* Note: there's no way for the app to ask for a number of decimal digits
 	 * - =scale - from the driver in the conversion (setting the scale of the
@@ -1295,23 +1360,24 @@ static SQLRETURN double_to_str(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	 * the whole part of the floats. */
 	/* https://docs.microsoft.com/en-us/sql/odbc/reference/appendixes/rules-for-conversions */
 	prec = irec->es_type->maximum_scale;
+	rep = floats_rep(stmt, dbl);
+	/* print off the shortest round-trip representation, 0-padded; CRT
+	 * printf'ing is only used when that needs rounding off (see dtoa.c) */
 	if (wide) {
-		flt_wfmt = (const wchar_t *)floats_rep(stmt, dbl, /*wide?*/TRUE, &rep);
-		/* Note: this call would fail on Win CRT on insufficient buffer */
-		n = swprintf(wbuff, DBL_BASE10_MAX_LEN + 1,flt_wfmt, prec, dbl);
+		n = dbl2tot(dbl, prec, rep == ESODBC_FLTS_SCIENTIFIC, wbuff,
+				sizeof(wbuff)/sizeof(*wbuff), /*wide*/TRUE);
 		xstr.w.str = wbuff;
 	} else {
-		flt_fmt = (const char *)floats_rep(stmt, dbl, /*wide?*/FALSE, &rep);
-		n = snprintf(buff, DBL_BASE10_MAX_LEN + 1, flt_fmt, prec, dbl);
+		n = dbl2tot(dbl, prec, rep == ESODBC_FLTS_SCIENTIFIC, buff,
+				sizeof(buff), /*wide*/FALSE);
 		xstr.c.str = buff;
 	}
-	if (n <= 0) {
-		/* ..if this will work this time. */
-		ERRNH(stmt, "failed to %c-print double %lf and precision %d.",
-			dbl, prec, wide ? 'W' : 'C');
+	if (! n) {
+		ERRH(stmt, "failed to %c-print double %lf and precision %d.",
+			wide ? 'W' : 'C', dbl, prec);
 		RET_HDIAG(stmt, SQL_STATE_HY000, "failed to print double", 0);
 	}
-	xstr.c.cnt = (size_t)n;
+	xstr.c.cnt = n;
 	assert(xstr.c.cnt == xstr.w.cnt);
 	xstr.wide = wide;
 
@@ -1350,9 +1416,10 @@ SQLRETURN sql2c_double(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	ard = stmt->ard;
 
 	/* pointer where to write how many characters we will/would use */
-	octet_len_ptr = deferred_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec);
+	octet_len_ptr = planned_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec,
+			irec);
 	/* pointer to app's buffer */
-	data_ptr = deferred_address(SQL_DESC_DATA_PTR, pos, arec);
+	data_ptr = planned_address(SQL_DESC_DATA_PTR, pos, arec, irec);
 
 	/* Transfer a double to an SQL integer type.
 	 * Uses local vars: stmt, data_ptr, irec, octet_len_ptr.
@@ -1554,26 +1621,229 @@ static inline SQLRETURN wstr_to_wstr(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	return transfer_xstr0(arec, irec, &xsrc, data_ptr, octet_len_ptr);
 }
 
+/*
+ * Cache of the local timezone's UTC offset transitions, per year: the
+ * timestamps are shifted between UTC and local time with a lookup into it,
+ * rather than a C runtime call per value. A year's table is built out of the
+ * runtime's localtime() on first use and dropped with each update of the
+ * timezone parameter (see update_crr_date()): the cache being per thread,
+ * each entry is tagged with the generation it was built in, for the other
+ * threads to notice the update.
+ */
+#define TZ_CACHE_YEARS		8
+/* max offset changes within a year (usually 0 or 2) */
+#define TZ_YEAR_MAX_TRANS	8
+#define SECS_PER_DAY		(24 * 3600)
+
+typedef struct {
+	int year; /* 0 if not built */
+	LONG gen; /* tz_gen value the table was built in */
+	int cnt; /* count of intervals with a constant offset */
+	int64_t start[TZ_YEAR_MAX_TRANS + 1]; /* UTC start, secs since Epoch */
+	long offt[TZ_YEAR_MAX_TRANS + 1]; /* local time - UTC, in seconds */
+} tz_year_st;
+
+static thread_local tz_year_st tz_cache[TZ_CACHE_YEARS];
+/* bumped with each update of the timezone parameter */
+static volatile LONG tz_gen = 0;
+
+/* days since Epoch of a proleptic Gregorian date */
+static inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d)
+{
+	int64_t era;
+	unsigned yoe, doy, doe;
+
+	y -= m <= 2;
+	era = (0 <= y ? y : y - 399) / 400;
+	yoe = (unsigned)(y - era * 400);
+	doy = (153 * (2 < m ? m - 3 : m + 9) + 2) / 5 + d - 1;
+	doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + (int64_t)doe - 719468;
+}
+
+static inline void civil_from_days(int64_t z, int *y, unsigned *m,
+	unsigned *d)
+{
+	int64_t era;
+	unsigned doe, yoe, doy, mp;
+
+	z += 719468;
+	era = (0 <= z ? z : z - 146096) / 146097;
+	doe = (unsigned)(z - era * 146097);
+	yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+	doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+	mp = (5 * doy + 2) / 153;
+	*d = doy - (153 * mp + 2) / 5 + 1;
+	*m = mp < 10 ? mp + 3 : mp - 9;
+	*y = (int)(yoe + era * 400 + (*m <= 2));
+}
+
+static inline int64_t tss_to_secs(TIMESTAMP_STRUCT *tss)
+{
+	return days_from_civil(tss->year, tss->month, tss->day) * SECS_PER_DAY +
+		tss->hour * 3600 + tss->minute * 60 + tss->second;
+}
+
+static inline void secs_to_tss(int64_t secs, TIMESTAMP_STRUCT *tss)
+{
+	int64_t days = secs / SECS_PER_DAY;
+	long rem = (long)(secs % SECS_PER_DAY);
+	int year;
+	unsigned month, day;
+
+	if (rem < 0) {
+		rem += SECS_PER_DAY;
+		days --;
+	}
+	civil_from_days(days, &year, &month, &day);
+	tss->year = (SQLSMALLINT)year;
+	tss->month = (SQLUSMALLINT)month;
+	tss->day = (SQLUSMALLINT)day;
+	tss->hour = (SQLUSMALLINT)(rem / 3600);
+	tss->minute = (SQLUSMALLINT)((rem % 3600) / 60);
+	tss->second = (SQLUSMALLINT)(rem % 60);
+}
+
+/* local time minus UTC at the given moment, as the C runtime has it */
+static BOOL local_offset(int64_t utc, long *offt)
+{
+	time_t t = (time_t)utc;
+	struct tm *tm;
+
+	if ((int64_t)t != utc) {
+		return FALSE; /* out of time_t range */
+	}
+#ifndef _WIN32
+	/* ISO/C90's localtime() is not thead safe */
+#error	"localtime_r required for thread safety"
+#endif /* ! _WIN32 */
+	if (! (tm = localtime(&t))) {
+		return FALSE;
+	}
+	*offt = (long)(days_from_civil(tm->tm_year + 1900, tm->tm_mon + 1,
+				tm->tm_mday) * SECS_PER_DAY + tm->tm_hour * 3600 +
+			tm->tm_min * 60 + tm->tm_sec - utc);
+	return TRUE;
+}
+
+/* Returns the offset transitions table of the given year, building it if
+ * not cached, or NULL if the runtime can't provide the local time for it. */
+static tz_year_st *tz_year(int year)
+{
+	tz_year_st *ty = &tz_cache[(unsigned)year % TZ_CACHE_YEARS];
+	int64_t lo, hi, mid, end;
+	long offt, prev;
+	LONG gen = tz_gen;
+
+	if (ty->year == year && ty->gen == gen) {
+		return ty;
+	}
+	ty->year = 0;
+	ty->gen = gen;
+	if (year < 1970) {
+		return NULL; /* also outside MKTIME_YEAR_RANGE */
+	}
+
+	lo = days_from_civil(year, 1, 1) * SECS_PER_DAY;
+	end = days_from_civil(year + 1, 1, 1) * SECS_PER_DAY - 1;
+	if (! local_offset(lo, &prev)) {
+		return NULL;
+	}
+	ty->start[0] = lo;
+	ty->offt[0] = prev;
+	ty->cnt = 1;
+	/* sample the offset daily and bisect down to the second of a change */
+	for (; lo < end; lo = hi) {
+		hi = lo + SECS_PER_DAY < end ? lo + SECS_PER_DAY : end;
+		if (! local_offset(hi, &offt)) {
+			return NULL;
+		}
+		if (offt == prev) {
+			continue;
+		}
+		while (lo + 1 < hi) {
+			mid = lo + (hi - lo) / 2;
+			if (! local_offset(mid, &offt)) {
+				return NULL;
+			}
+			if (offt == prev) {
+				lo = mid;
+			} else {
+				hi = mid;
+			}
+		}
+		if (TZ_YEAR_MAX_TRANS < ty->cnt || (! local_offset(hi, &offt))) {
+			return NULL;
+		}
+		ty->start[ty->cnt] = hi;
+		ty->offt[ty->cnt ++] = offt;
+		prev = offt;
+	}
+	ty->year = year;
+	DBG("timezone transitions of year %d cached: %d.", year, ty->cnt - 1);
+	return ty;
+}
+
+/* Shifts the timestamp from UTC to local time, or the reverse.
+ * Returns FALSE if the transitions table isn't available for its year. */
+static BOOL tz_shift(TIMESTAMP_STRUCT *tss, BOOL to_local)
+{
+	tz_year_st *ty;
+	int64_t secs;
+	int lo, hi, mid;
+
+	if (! (ty = tz_year(tss->year))) {
+		return FALSE;
+	}
+	secs = tss_to_secs(tss);
+	if (to_local) {
+		/* last interval starting before the UTC time */
+		for (lo = 0, hi = ty->cnt - 1; lo < hi; ) {
+			mid = (lo + hi + 1) / 2;
+			if (ty->start[mid] <= secs) {
+				lo = mid;
+			} else {
+				hi = mid - 1;
+			}
+		}
+		secs += ty->offt[lo];
+	} else {
+		/* first interval the local time maps into: on an ambiguous time,
+		 * the one before the transition, like mktime() does */
+		for (lo = 0; lo < ty->cnt - 1; lo ++) {
+			if (secs - ty->offt[lo] < ty->start[lo + 1]) {
+				break;
+			}
+		}
+		secs -= ty->offt[lo];
+	}
+	secs_to_tss(secs, tss);
+	return TRUE;
+}
+
 static SQLRETURN tss_local_to_utc(esodbc_stmt_st *stmt, TIMESTAMP_STRUCT *tss)
 {
 	struct tm *tmp, tm;
 	time_t utc;
 
-	TIMESTAMP_STRUCT_TO_TM(tss, &tm);
-	tm.tm_isdst = -1;
+	if (! tz_shift(tss, /*to local*/FALSE)) {
+		TIMESTAMP_STRUCT_TO_TM(tss, &tm);
+		tm.tm_isdst = -1;
 #ifndef _WIN32
-	/* ISO/C90's gmtime() is not thead safe */
+		/* ISO/C90's gmtime() is not thead safe */
 #error	"gmtime_r required for thread safety"
 #endif /* ! _WIN32 */
-	if (((utc = mktime(&tm)) == (time_t)-1) || (! (tmp = gmtime(&utc)))) {
-		ERRNH(stmt, "failed to convert local timestamp "
-			"%04hd-%02hu-%02hu %02hu:%02hu:%02hu..%lu to UTC. "
-			MKTIME_FAIL_MSG, tss->year, tss->month, tss->day,
-			tss->hour, tss->minute, tss->second, tss->fraction);
-		RET_HDIAG(stmt, SQL_STATE_22008, "Timestamp timezone adjustment "
-			"failed. " MKTIME_FAIL_MSG, errno);
+		if (((utc = mktime(&tm)) == (time_t)-1) ||
+			(! (tmp = gmtime(&utc)))) {
+			ERRNH(stmt, "failed to convert local timestamp "
+				"%04hd-%02hu-%02hu %02hu:%02hu:%02hu..%lu to UTC. "
+				MKTIME_FAIL_MSG, tss->year, tss->month, tss->day,
+				tss->hour, tss->minute, tss->second, tss->fraction);
+			RET_HDIAG(stmt, SQL_STATE_22008, "Timestamp timezone adjustment "
+				"failed. " MKTIME_FAIL_MSG, errno);
+		}
+		TM_TO_TIMESTAMP_STRUCT(tmp, tss, tss->fraction);
 	}
-	TM_TO_TIMESTAMP_STRUCT(tmp, tss, tss->fraction);
 
 	DBGH(stmt, "UTC: `%04hd-%02hu-%02hu %02hu:%02hu:%02hu..%lu`.",
 		tss->year, tss->month, tss->day,
@@ -1608,13 +1878,15 @@ static SQLRETURN tss_utc_to_local(esodbc_stmt_st *stmt, TIMESTAMP_STRUCT *tss)
 	struct tm tm;
 	SQLRETURN res;
 
-	TIMESTAMP_STRUCT_TO_TM(tss, &tm);
-	tm.tm_isdst = -1;
-	res = tm_utc_to_local(stmt, &tm);
-	if (! SQL_SUCCEEDED(res)) {
-		return res;
+	if (! tz_shift(tss, /*to local*/TRUE)) {
+		TIMESTAMP_STRUCT_TO_TM(tss, &tm);
+		tm.tm_isdst = -1;
+		res = tm_utc_to_local(stmt, &tm);
+		if (! SQL_SUCCEEDED(res)) {
+			return res;
+		}
+		TM_TO_TIMESTAMP_STRUCT(&tm, tss, tss->fraction);
 	}
-	TM_TO_TIMESTAMP_STRUCT(&tm, tss, tss->fraction);
 
 	DBGH(stmt, "local: `%04hd-%02hu-%02hu %02hu:%02hu:%02hu..%lu`.",
 		tss->year, tss->month, tss->day,
@@ -1622,6 +1894,80 @@ static SQLRETURN tss_utc_to_local(esodbc_stmt_st *stmt, TIMESTAMP_STRUCT *tss)
 	return SQL_SUCCESS;
 }
 
+/* Fixed-format parser of the timestamps Elasticsearch sends,
+ * `yyyy-mm-ddThh:mm:ss[.f{1,9}]Z`, working on ASCII or UTF-8 input.
+ * Returns FALSE if the string isn't in this format (or is out of range),
+ * case where the generic parser should be used instead. */
+static BOOL parse_iso8601_utc_fast(const char *str, size_t cnt,
+	TIMESTAMP_STRUCT *tss)
+{
+	static const unsigned char mdays[] = {
+		31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+	};
+	static const SQLUINTEGER frac_scale[] = {
+		1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000,
+		100, 10, 1
+	};
+	const unsigned char *s = (const unsigned char *)str;
+	unsigned year, month, day, hour, minute, second, chk;
+	SQLUINTEGER frac;
+	size_t i;
+
+	if (cnt < ISO8601_TS_UTC_LEN(0) ||
+		ISO8601_TS_UTC_LEN(ESODBC_MAX_SEC_PRECISION) < cnt) {
+		return FALSE;
+	}
+	if (s[4] != '-' || s[7] != '-' || s[10] != 'T' || s[13] != ':' ||
+		s[16] != ':' || s[cnt - 1] != 'Z') {
+		return FALSE;
+	}
+
+	/* a digit's value, as well as 9 minus it, are below 16 only for digits
+	 * (with wrap-around for characters under '0') */
+#	define DIGIT(_i)	((unsigned)s[_i] - '0')
+#	define CHK(_i)		(DIGIT(_i) | (9U - DIGIT(_i)))
+	chk = CHK(0) | CHK(1) | CHK(2) | CHK(3) | CHK(5) | CHK(6) | CHK(8) |
+		CHK(9) | CHK(11) | CHK(12) | CHK(14) | CHK(15) | CHK(17) | CHK(18);
+	year = DIGIT(0) * 1000 + DIGIT(1) * 100 + DIGIT(2) * 10 + DIGIT(3);
+	month = DIGIT(5) * 10 + DIGIT(6);
+	day = DIGIT(8) * 10 + DIGIT(9);
+	hour = DIGIT(11) * 10 + DIGIT(12);
+	minute = DIGIT(14) * 10 + DIGIT(15);
+	second = DIGIT(17) * 10 + DIGIT(18);
+
+	frac = 0;
+	if (ISO8601_TS_UTC_LEN(0) < cnt) { /* fractional seconds present */
+		if (s[19] != '.' || cnt == ISO8601_TS_UTC_LEN(0) + /*.*/1) {
+			return FALSE;
+		}
+		for (i = 20; i < cnt - /*Z*/1; i ++) {
+			chk |= CHK(i);
+			frac = frac * 10 + DIGIT(i);
+		}
+		frac *= frac_scale[cnt - /*Z*/1 - 20];
+	}
+#	undef DIGIT
+#	undef CHK
+
+	if (15 < chk || year < 1 || month < 1 || 12 < month || day < 1 ||
+		23 < hour || 59 < minute || 59 < second) {
+		return FALSE;
+	}
+	if (mdays[month - 1] < day && (month != 2 || day != 29 ||
+			(year % 4) || ((! (year % 100)) && (year % 400)))) {
+		return FALSE;
+	}
+
+	tss->year = (SQLSMALLINT)year;
+	tss->month = (SQLUSMALLINT)month;
+	tss->day = (SQLUSMALLINT)day;
+	tss->hour = (SQLUSMALLINT)hour;
+	tss->minute = (SQLUSMALLINT)minute;
+	tss->second = (SQLUSMALLINT)second;
+	tss->fraction = frac;
+	return TRUE;
+}
+
 /* Parses an ISO8601 timestamp and returns the result into a TIMESTAMP_STRUCT.
  * The time is adjusted to UTC timezone or kept "local", depending on 'to_utc'
  * value (TIMESTAMP_STRUCT lacks any timezone indicator).
@@ -1661,23 +2007,25 @@ static SQLRETURN parse_iso8601_timestamp(esodbc_stmt_st *stmt, xstr_st *xstr,
 		}
 	}
 
-	if (timestamp_parse(ts_str.str, ts_str.cnt, &tsp) ||
-		(! timestamp_to_tm_utc(&tsp, &tm))) {
-		ERRH(stmt, "`" LCPDL "` not in ISO 8601 format.", LCSTR(&ts_str));
-		RET_HDIAGS(stmt, SQL_STATE_22007);
+	if (! parse_iso8601_utc_fast(ts_str.str, ts_str.cnt, tss)) {
+		if (timestamp_parse(ts_str.str, ts_str.cnt, &tsp) ||
+			(! timestamp_to_tm_utc(&tsp, &tm))) {
+			ERRH(stmt, "`" LCPDL "` not in ISO 8601 format.",
+				LCSTR(&ts_str));
+			RET_HDIAGS(stmt, SQL_STATE_22007);
+		}
+		/* "the fraction field is the number of billionths of a second" */
+		TM_TO_TIMESTAMP_STRUCT(&tm, tss, tsp.nsec);
 	}
 
 	if (! to_utc) {
 		/* convert UTC to localtime */
-		res = tm_utc_to_local(stmt, &tm);
+		res = tss_utc_to_local(stmt, tss);
 		if (! SQL_SUCCEEDED(res)) {
 			return res;
 		}
 	}
 
-	/* "the fraction field is the number of billionths of a second" */
-	TM_TO_TIMESTAMP_STRUCT(&tm, tss, tsp.nsec);
-
 	DBGH(stmt, "parsed %s timestamp: %04d-%02d-%02d %02d:%02d:%02d.%u.",
 		to_utc ? "UTC" : "local", tss->year, tss->month, tss->day,
 		tss->hour, tss->minute, tss->second, tss->fraction);
@@ -1698,6 +2046,9 @@ BOOL update_crr_date(struct tm *now)
 		return FALSE;
 	}
 	today = *now;
+	/* the timezone could have changed: drop the transitions, in all the
+	 * threads' caches */
+	InterlockedIncrement(&tz_gen);
 	return TRUE;
 }
 
@@ -3362,6 +3713,145 @@ void varchar_limit_apply(esodbc_rec_st *irec, wchar_t *wstr, size_t *chars_0)
 	wstr[varchar_limit] = L'\0';
 }
 
+/* UTF-16 units count of UTF-8 encoded character starting with given byte */
+#define U8_LEAD_U16_UNITS(_c)	(((_c) & 0xF8) == 0xF0 ? 2 : 1)
+/* is the byte a continuation byte of a UTF-8 encoded character? */
+#define U8_IS_TRAIL(_c)			(((_c) & 0xC0) == 0x80)
+
+/*
+ * -> SQL_C_CHAR, from UTF-8 text as received from the server.
+ * The driver's SQL_C_CHAR is UTF-8 itself, so the bytes are copied out
+ * without being transcoded (to UTF-16 and back); the varchar limit and
+ * buffer truncation are applied on characters boundaries, like with
+ * wstr_to_cstr().
+ * u8: not 0-terminated; cnt: its length in bytes.
+ * Only to be used for a planned (see conv_plans_build()), string SQL type.
+ */
+SQLRETURN sql2c_u8string(esodbc_rec_st *arec, esodbc_rec_st *irec,
+	SQLULEN pos, const char *u8, size_t cnt)
+{
+	esodbc_stmt_st *stmt = arec->desc->hdr.stmt;
+	SQLUINTEGER varchar_limit = HDRH(stmt)->dbc->varchar_limit;
+	esodbc_state_et state = SQL_STATE_00000;
+	SQLLEN *octet_len_ptr;
+	char *charp;
+	size_t i, units, in_bytes;
+
+	assert(irec->plan.direct == SQL_C_CHAR && REC_PLAN_VALID(irec, arec));
+	assert(! STMT_GD_CALLING(stmt)); /* no SQLGetData() offset to apply */
+
+	/* the limit is in (UTF-16) characters: count them only if the bytes
+	 * could exceed it */
+	if (0 < varchar_limit && varchar_limit < cnt) {
+		for (i = 0, units = 0; i < cnt; i ++) {
+			if (U8_IS_TRAIL((unsigned char)u8[i])) {
+				continue;
+			}
+			units += U8_LEAD_U16_UNITS((unsigned char)u8[i]);
+			if (varchar_limit < units) {
+				DBGH(stmt, "applying varchar limit truncation: %zu -> "
+					"[%lu] `" LCPDL "`.", cnt, varchar_limit, (int)i, u8);
+				cnt = i;
+				break;
+			}
+		}
+	}
+
+	octet_len_ptr = planned_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec,
+			irec);
+	/* out length needs to be provided with no (potential) truncation. */
+	write_out_octets(octet_len_ptr, cnt, irec);
+
+	charp = planned_address(SQL_DESC_DATA_PTR, pos, arec, irec);
+	if (! charp) {
+		DBGH(stmt, "REC@0x%p, NULL data_ptr.", arec);
+		return SQL_SUCCESS;
+	}
+
+	in_bytes = buff_octet_size(cnt + /*\0*/1, sizeof(SQLCHAR), arec, irec,
+			&state);
+	if (! in_bytes) {
+		DBGH(stmt, "REC@0x%p, data_ptr@0x%p, no room to copy bytes out.",
+			arec, charp);
+	} else {
+		if (in_bytes <= cnt) {
+			/* ran out of buffer: leave room for the 0-term, trimming
+			 * the string to the last character that fits entirely */
+			in_bytes --;
+			while (0 < in_bytes && U8_IS_TRAIL((unsigned char)u8[in_bytes])) {
+				in_bytes --;
+			}
+			state = SQL_STATE_01004; /* indicate truncation */
+		} else {
+			in_bytes = cnt;
+		}
+		memcpy(charp, u8, in_bytes);
+		charp[in_bytes] = '\0';
+		DBGH(stmt, "REC@0x%p, data_ptr@0x%p, copied %zu bytes: `" LCPD "`.",
+			arec, charp, in_bytes, charp);
+	}
+
+	if (state != SQL_STATE_00000) {
+		RET_HDIAGS(stmt, state);
+	}
+	return SQL_SUCCESS;
+}
+
+/*
+ * -> SQL_C_TYPE_TIMESTAMP, from the UTF-8 text of a DATETIME or DATE value,
+ * as received: the format Elasticsearch uses is parsed in place, skipping the
+ * UTF-16 transcoding; any other goes through sql2c_string().
+ * u8: not 0-terminated; cnt: its length in bytes.
+ * Only to be used for a planned (see conv_plans_build()) timestamp target.
+ */
+SQLRETURN sql2c_u8timestamp(esodbc_rec_st *arec, esodbc_rec_st *irec,
+	SQLULEN pos, const char *u8, size_t cnt)
+{
+	esodbc_stmt_st *stmt = arec->desc->hdr.stmt;
+	TIMESTAMP_STRUCT *tss, buff;
+	SQLLEN *octet_len_ptr;
+	SQLWCHAR wbuff[ISO8601_TIMESTAMP_MAX_LEN + /*\0*/1];
+	int n;
+
+	assert(irec->plan.ctype == SQL_C_TYPE_TIMESTAMP &&
+		REC_PLAN_VALID(irec, arec));
+	assert(irec->concise_type == SQL_TYPE_TIMESTAMP ||
+		irec->concise_type == SQL_TYPE_DATE);
+
+	if (parse_iso8601_utc_fast(u8, cnt, &buff)) {
+		octet_len_ptr = planned_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec,
+				irec);
+		if (octet_len_ptr) {
+			*octet_len_ptr = sizeof(*tss);
+		}
+		tss = planned_address(SQL_DESC_DATA_PTR, pos, arec, irec);
+		if (! tss) {
+			DBGH(stmt, "REC@0x%p, NULL data_ptr", arec);
+			return SQL_SUCCESS;
+		}
+		*tss = buff;
+		/* DATEs are always kept as UTC (see wstr_to_timestamp_struct()) */
+		if (irec->concise_type == SQL_TYPE_TIMESTAMP &&
+			HDRH(stmt)->dbc->apply_tz) {
+			return tss_utc_to_local(stmt, tss);
+		}
+		return SQL_SUCCESS;
+	}
+
+	/* generic parsing: the value is still expected to be short, ASCII */
+	if (cnt <= ISO8601_TIMESTAMP_MAX_LEN && 0 < cnt) {
+		n = U8MB_TO_U16WC(u8, cnt, wbuff, ISO8601_TIMESTAMP_MAX_LEN);
+	} else {
+		n = 0;
+	}
+	if (n <= 0) {
+		ERRH(stmt, "`" LCPDL "` not an ISO TIMESTAMP.", (int)cnt, u8);
+		RET_HDIAGS(stmt, SQL_STATE_22018);
+	}
+	wbuff[n] = L'\0';
+	return sql2c_string(arec, irec, pos, wbuff, (size_t)n + /*\0*/1);
+}
+
 /*
  * wstr: is 0-terminated and terminator is counted in 'chars_0'.
  * However: "[w]hen C strings are used to hold character data, the
@@ -3393,9 +3883,10 @@ SQLRETURN sql2c_string(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	assert(1 <= chars_0); /* _0 is really counted */
 
 	/* pointer where to write how many characters we will/would use */
-	octet_len_ptr = deferred_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec);
+	octet_len_ptr = planned_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec,
+			irec);
 	/* pointer to app's buffer */
-	data_ptr = deferred_address(SQL_DESC_DATA_PTR, pos, arec);
+	data_ptr = planned_address(SQL_DESC_DATA_PTR, pos, arec, irec);
 
 	ctarget = get_rec_c_type(arec, irec);
 	switch (ctarget) {
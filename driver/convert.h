@@ -20,6 +20,9 @@ SQLULEN get_param_size(esodbc_rec_st *irec);
 
 inline void *deferred_address(SQLSMALLINT field_id, size_t pos,
 	esodbc_rec_st *rec);
+inline void *planned_address(SQLSMALLINT field_id, size_t pos,
+	esodbc_rec_st *arec, esodbc_rec_st *irec);
+void conv_plans_build(esodbc_stmt_st *stmt);
 
 
 /* column and parameters are all SQLUSMALLINT (unsigned short) */
@@ -40,6 +43,10 @@ BOOL update_crr_date(struct tm *now);
 
 SQLRETURN sql2c_string(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	SQLULEN pos, const wchar_t *wstr, size_t chars_0);
+SQLRETURN sql2c_u8string(esodbc_rec_st *arec, esodbc_rec_st *irec,
+	SQLULEN pos, const char *u8, size_t cnt);
+SQLRETURN sql2c_u8timestamp(esodbc_rec_st *arec, esodbc_rec_st *irec,
+	SQLULEN pos, const char *u8, size_t cnt);
 SQLRETURN sql2c_quadword(esodbc_rec_st *arec, esodbc_rec_st *irec,
 	SQLULEN pos, uint64_t qword, bool unsignd);
 SQLRETURN sql2c_double(esodbc_rec_st *arec, esodbc_rec_st *irec,
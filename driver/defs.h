@@ -23,11 +23,24 @@
 #define ESODBC_LOG_DIR_ENV_VAR		"ESODBC_LOG_DIR"
 /* number of consecutive logging failures that will disable logging */
 #define ESODBC_LOG_MAX_RETRY		5
+/* size of the ring a logger queues its messages into, for the background
+ * writer; must be a power of 2 and hold several ESODBC_LOG_BUF_SIZE
+ * messages */
+#define ESODBC_LOG_RING_SIZE		(32 * 1024)
+/* max interval between two flushes of the queued messages (millis) */
+#define ESODBC_LOG_FLUSH_INTERVAL	250
+/* size of the buffer a logger's queued messages are batched into */
+#define ESODBC_LOG_BATCH_SIZE		(2 * ESODBC_LOG_BUF_SIZE)
+/* size a log file is rotated at: the current file is renamed to
+ * <name>.log.1, replacing any previous one */
+#define ESODBC_LOG_ROTATE_SIZE		(256 * 1024 * 1024)
 
 /* the (POSIX) timezone environment variable */
 #define ESODBC_TZ_ENV_VAR			"TZ"
 
 #define ESODBC_MAX_ROW_ARRAY_SIZE	USHRT_MAX
+/* max number of sets in a parameters array */
+#define ESODBC_MAX_PARAMSET_SIZE	USHRT_MAX
 /* max number of ES/SQL types supported */
 #define ESODBC_MAX_NO_TYPES			64
 #define ESODBC_DEF_ARRAY_SIZE		1
@@ -48,6 +61,39 @@
 #define ESODBC_SQL_DRIVER_TEST		((SQLUSMALLINT)-1)
 #endif /* TESTING */
 
+/* Driver-specific connection attributes */
+/* drop the cached server metadata: reload it on next connect; the cached
+ * catalog answers, server attributes and the results cached for same
+ * endpoint and credentials are dropped right away */
+#define ESODBC_SQL_ATTR_CACHE_REFRESH	(SQL_DRIVER_CONN_ATTR_BASE + 1)
+/* time (secs, SQLUINTEGER) to cache the single-page query answers for (0, by
+ * default: no caching) */
+#define ESODBC_SQL_ATTR_RSLT_CACHE_TTL	(SQL_DRIVER_CONN_ATTR_BASE + 2)
+/* Driver-specific statement attributes */
+/* serve the statement's answers from / save them into the results cache, if
+ * enabled for the connection (SQL_TRUE, by default) */
+#define ESODBC_SQL_ATTR_RSLT_CACHE		(SQL_DRIVER_STMT_ATTR_BASE + 1)
+/* Performance counters, readable as either connection or statement
+ * attributes (with a SQLUBIGINT value); setting any of them resets them all.
+ * The statement's counters accumulate over its lifetime, the connection's
+ * over that of all its statements. Times are in microseconds. */
+#define ESODBC_SQL_ATTR_PERF_BASE		(SQL_DRIVER_CONN_ATTR_BASE + 0x100)
+#define ESODBC_PERF_REQUESTS		0 /* HTTP requests sent */
+#define ESODBC_PERF_PAGES			1 /* result pages received */
+#define ESODBC_PERF_BYTES_SENT		2 /* request bodies' size */
+#define ESODBC_PERF_BYTES_RECV		3 /* answer bodies' (decoded) size */
+#define ESODBC_PERF_BYTES_WIRE		4 /* answer bodies' size on the wire */
+#define ESODBC_PERF_ROWS			5 /* rows converted for application */
+#define ESODBC_PERF_CONV_ERRORS		6 /* rows failing conversion */
+#define ESODBC_PERF_TIME_SERIALIZE	7 /* time spent building requests */
+#define ESODBC_PERF_TIME_NETWORK	8 /* time spent in transfers */
+#define ESODBC_PERF_TIME_PARSE		9 /* time spent parsing answers */
+#define ESODBC_PERF_TIME_CONVERT	10 /* time spent converting rows */
+#define ESODBC_PERF_RSLT_CACHE_HITS	11 /* answers served by results cache */
+#define ESODBC_PERF_RSLT_CACHE_MISSES	12 /* ~ not found in results cache */
+#define ESODBC_PERF_COUNTERS		13
+#define ESODBC_SQL_ATTR_PERF(_ctr)	(ESODBC_SQL_ATTR_PERF_BASE + (_ctr))
+
 #define ESODBC_ALL_TABLES			"%"
 #define ESODBC_ALL_COLUMNS			"%"
 #define ESODBC_STRING_DELIM			"'"
@@ -134,6 +180,16 @@
 
 /* initial receive buffer size for REST answers */
 #define ESODBC_BODY_BUF_START_SIZE		(4 * 1024)
+/* max time (ms) to wait for network activity before checking if the
+ * transfer has been canceled (SQLCancel() will also wake up the wait) */
+#define ESODBC_XFER_POLL_MS				250
+/* max number of requests of a parameters array execution to be concurrently
+ * under way */
+#define ESODBC_MAX_PARAMSET_XFERS		8
+/* max total size (bytes) of the catalog answers a connection caches */
+#define ESODBC_CATALOG_CACHE_MAX		(16 * 1024 * 1024)
+/* max total size (bytes) of the answers cached process-wide */
+#define ESODBC_RSLT_CACHE_MAX			(64 * 1024 * 1024)
 
 /*
  * Versions
@@ -186,6 +242,16 @@
 #define ESODBC_DEF_MFIELD_LENIENT	"true"
 #define ESODBC_DEF_ESC_PVA			"true"
 #define ESODBC_DEF_IDX_INC_FROZEN	"false"
+/* default of next page prefetching (on a worker thread) */
+#define ESODBC_DEF_PREFETCH			"false"
+/* default of requesting column-major result sets */
+#define ESODBC_DEF_COLUMNAR			"false"
+/* default max idle pooled connection sets (0: no pooling) */
+#define ESODBC_DEF_POOL_MAX_IDLE	"0"
+/* default time (secs) a pooled connection can idle */
+#define ESODBC_DEF_POOL_IDLE_TOUT	"118"
+/* default time (secs) to cache server's metadata (0: no caching) */
+#define ESODBC_DEF_META_CACHE_TTL	"0"
 #define ESODBC_DEF_VARCHAR_LIMIT	"0"
 #define ESODBC_DEF_PROXY_ENABLED	"false"
 #define ESODBC_DEF_PROXY_AUTH_ENA	"false"
@@ -40,6 +40,7 @@ SQLColAttributeW
 SQLBindCol
 SQLFetch
 SQLFetchScroll
+SQLFetchArrow
 SQLGetData
 SQLSetPos
 SQLBulkOperations
@@ -84,6 +84,11 @@ int assign_dsn_attr(esodbc_dsn_attrs_st *attrs,
 		{&MK_WSTR(ESODBC_DSN_MFIELD_LENIENT), &attrs->mfield_lenient},
 		{&MK_WSTR(ESODBC_DSN_ESC_PVA), &attrs->auto_esc_pva},
 		{&MK_WSTR(ESODBC_DSN_IDX_INC_FROZEN), &attrs->idx_inc_frozen},
+		{&MK_WSTR(ESODBC_DSN_PREFETCH), &attrs->prefetch},
+		{&MK_WSTR(ESODBC_DSN_COLUMNAR), &attrs->columnar},
+		{&MK_WSTR(ESODBC_DSN_POOL_MAX_IDLE), &attrs->pool_max_idle},
+		{&MK_WSTR(ESODBC_DSN_POOL_IDLE_TOUT), &attrs->pool_idle_tout},
+		{&MK_WSTR(ESODBC_DSN_META_CACHE_TTL), &attrs->meta_cache_ttl},
 		{&MK_WSTR(ESODBC_DSN_PROXY_ENABLED), &attrs->proxy_enabled},
 		{&MK_WSTR(ESODBC_DSN_PROXY_TYPE), &attrs->proxy_type},
 		{&MK_WSTR(ESODBC_DSN_PROXY_HOST), &attrs->proxy_host},
@@ -428,6 +433,11 @@ long TEST_API write_00_list(esodbc_dsn_attrs_st *attrs,
 		{&MK_WSTR(ESODBC_DSN_MFIELD_LENIENT), &attrs->mfield_lenient},
 		{&MK_WSTR(ESODBC_DSN_ESC_PVA), &attrs->auto_esc_pva},
 		{&MK_WSTR(ESODBC_DSN_IDX_INC_FROZEN), &attrs->idx_inc_frozen},
+		{&MK_WSTR(ESODBC_DSN_PREFETCH), &attrs->prefetch},
+		{&MK_WSTR(ESODBC_DSN_COLUMNAR), &attrs->columnar},
+		{&MK_WSTR(ESODBC_DSN_POOL_MAX_IDLE), &attrs->pool_max_idle},
+		{&MK_WSTR(ESODBC_DSN_POOL_IDLE_TOUT), &attrs->pool_idle_tout},
+		{&MK_WSTR(ESODBC_DSN_META_CACHE_TTL), &attrs->meta_cache_ttl},
 		{&MK_WSTR(ESODBC_DSN_PROXY_ENABLED), &attrs->proxy_enabled},
 		{&MK_WSTR(ESODBC_DSN_PROXY_TYPE), &attrs->proxy_type},
 		{&MK_WSTR(ESODBC_DSN_PROXY_HOST), &attrs->proxy_host},
@@ -725,6 +735,26 @@ BOOL write_system_dsn(esodbc_dsn_attrs_st *new_attrs,
 			&new_attrs->idx_inc_frozen,
 			old_attrs ? &old_attrs->idx_inc_frozen : NULL
 		},
+		{
+			&MK_WSTR(ESODBC_DSN_PREFETCH), &new_attrs->prefetch,
+			old_attrs ? &old_attrs->prefetch : NULL
+		},
+		{
+			&MK_WSTR(ESODBC_DSN_COLUMNAR), &new_attrs->columnar,
+			old_attrs ? &old_attrs->columnar : NULL
+		},
+		{
+			&MK_WSTR(ESODBC_DSN_POOL_MAX_IDLE), &new_attrs->pool_max_idle,
+			old_attrs ? &old_attrs->pool_max_idle : NULL
+		},
+		{
+			&MK_WSTR(ESODBC_DSN_POOL_IDLE_TOUT), &new_attrs->pool_idle_tout,
+			old_attrs ? &old_attrs->pool_idle_tout : NULL
+		},
+		{
+			&MK_WSTR(ESODBC_DSN_META_CACHE_TTL), &new_attrs->meta_cache_ttl,
+			old_attrs ? &old_attrs->meta_cache_ttl : NULL
+		},
 		{
 			&MK_WSTR(ESODBC_DSN_PROXY_ENABLED), &new_attrs->proxy_enabled,
 			old_attrs ? &old_attrs->proxy_enabled : NULL
@@ -848,6 +878,11 @@ long TEST_API write_connection_string(esodbc_dsn_attrs_st *attrs,
 		{&attrs->mfield_lenient, &MK_WSTR(ESODBC_DSN_MFIELD_LENIENT)},
 		{&attrs->auto_esc_pva, &MK_WSTR(ESODBC_DSN_ESC_PVA)},
 		{&attrs->idx_inc_frozen, &MK_WSTR(ESODBC_DSN_IDX_INC_FROZEN)},
+		{&attrs->prefetch, &MK_WSTR(ESODBC_DSN_PREFETCH)},
+		{&attrs->columnar, &MK_WSTR(ESODBC_DSN_COLUMNAR)},
+		{&attrs->pool_max_idle, &MK_WSTR(ESODBC_DSN_POOL_MAX_IDLE)},
+		{&attrs->pool_idle_tout, &MK_WSTR(ESODBC_DSN_POOL_IDLE_TOUT)},
+		{&attrs->meta_cache_ttl, &MK_WSTR(ESODBC_DSN_META_CACHE_TTL)},
 		{&attrs->proxy_enabled, &MK_WSTR(ESODBC_DSN_PROXY_ENABLED)},
 		{&attrs->proxy_type, &MK_WSTR(ESODBC_DSN_PROXY_TYPE)},
 		{&attrs->proxy_host, &MK_WSTR(ESODBC_DSN_PROXY_HOST)},
@@ -966,6 +1001,21 @@ void assign_dsn_defaults(esodbc_dsn_attrs_st *attrs)
 	res |= assign_dsn_attr(attrs,
 			&MK_WSTR(ESODBC_DSN_IDX_INC_FROZEN),
 			&MK_WSTR(ESODBC_DEF_IDX_INC_FROZEN), /*overwrite?*/FALSE);
+	res |= assign_dsn_attr(attrs,
+			&MK_WSTR(ESODBC_DSN_PREFETCH),
+			&MK_WSTR(ESODBC_DEF_PREFETCH), /*overwrite?*/FALSE);
+	res |= assign_dsn_attr(attrs,
+			&MK_WSTR(ESODBC_DSN_COLUMNAR),
+			&MK_WSTR(ESODBC_DEF_COLUMNAR), /*overwrite?*/FALSE);
+	res |= assign_dsn_attr(attrs,
+			&MK_WSTR(ESODBC_DSN_POOL_MAX_IDLE),
+			&MK_WSTR(ESODBC_DEF_POOL_MAX_IDLE), /*overwrite?*/FALSE);
+	res |= assign_dsn_attr(attrs,
+			&MK_WSTR(ESODBC_DSN_POOL_IDLE_TOUT),
+			&MK_WSTR(ESODBC_DEF_POOL_IDLE_TOUT), /*overwrite?*/FALSE);
+	res |= assign_dsn_attr(attrs,
+			&MK_WSTR(ESODBC_DSN_META_CACHE_TTL),
+			&MK_WSTR(ESODBC_DEF_META_CACHE_TTL), /*overwrite?*/FALSE);
 
 	res |= assign_dsn_attr(attrs,
 			&MK_WSTR(ESODBC_DSN_PROXY_ENABLED),
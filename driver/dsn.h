@@ -42,6 +42,11 @@
 #define ESODBC_DSN_MFIELD_LENIENT	"MultiFieldLenient"
 #define ESODBC_DSN_ESC_PVA			"AutoEscapePVA"
 #define ESODBC_DSN_IDX_INC_FROZEN	"IndexIncludeFrozen"
+#define ESODBC_DSN_PREFETCH			"Prefetch"
+#define ESODBC_DSN_COLUMNAR			"Columnar"
+#define ESODBC_DSN_POOL_MAX_IDLE	"PoolMaxIdle"
+#define ESODBC_DSN_POOL_IDLE_TOUT	"PoolIdleTimeout"
+#define ESODBC_DSN_META_CACHE_TTL	"MetadataCacheTTL"
 #define ESODBC_DSN_PROXY_ENABLED	"ProxyEnabled"
 #define ESODBC_DSN_PROXY_TYPE		"ProxyType"
 #define ESODBC_DSN_PROXY_HOST		"ProxyHost"
@@ -94,6 +99,11 @@ typedef struct {
 	wstr_st mfield_lenient;
 	wstr_st auto_esc_pva;
 	wstr_st idx_inc_frozen;
+	wstr_st prefetch;
+	wstr_st columnar;
+	wstr_st pool_max_idle;
+	wstr_st pool_idle_tout;
+	wstr_st meta_cache_ttl;
 	wstr_st proxy_enabled;
 	wstr_st proxy_type;
 	wstr_st proxy_host;
@@ -104,7 +114,7 @@ typedef struct {
 	wstr_st trace_enabled;
 	wstr_st trace_file;
 	wstr_st trace_level;
-#define ESODBC_DSN_ATTRS_COUNT	37
+#define ESODBC_DSN_ATTRS_COUNT	42
 
 	SQLWCHAR buff[ESODBC_DSN_ATTRS_COUNT * ESODBC_DSN_MAX_ATTR_LEN];
 	/* DSN reading/writing functions are passed a SQLSMALLINT length param */
@@ -0,0 +1,473 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License;
+ * you may not use this file except in compliance with the Elastic License.
+ */
+
+/*
+ * Numbers to text conversions.
+ *
+ * The doubles are printed off their shortest decimal representation that
+ * reads back to the same value, generated with the Grisu2 algorithm
+ * (F. Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with
+ * Integers", PLDI 2010). The digits are then laid out in fixed or
+ * exponential notation, padded with 0s to the precision asked for (so
+ * unlike printf, no binary noise digits get printed past the shortest
+ * ones). If the precision asked for is lower than the shortest digits
+ * count, the value is printed with the CRT's printf instead, which rounds
+ * off the exact binary value: rounding the (already rounded) shortest
+ * digits would differ in cases like 1.005 (1.00499999999999989...).
+ * The integers are printed two digits at a time, off a lookup table.
+ * Neither of the conversions is locale dependent.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "util.h"
+#include "defs.h"
+
+/* cached powers of ten: 10^k ~= pow10_f[i] * 2^pow10_e[i], for
+ * k = -348 + 8 * i */
+static const uint64_t pow10_f[] = {
+	0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+	0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+	0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+	0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+	0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+	0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+	0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+	0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+	0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+	0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+	0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+	0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+	0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+	0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+	0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+	0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+	0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+	0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+	0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+	0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+	0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+	0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+	0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+	0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+	0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+	0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+	0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+	0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+	0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+static const int16_t pow10_e[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+	-954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+	-688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+	-422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+	-157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+	109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+	641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+	907, 933, 960, 986, 1013, 1039, 1066
+};
+#define POW10_MIN_EXP		-348
+#define POW10_STEP			8
+
+static const char digits_lut[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const uint64_t pow10_u64[] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+	10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+	100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+	100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL
+};
+
+/* "do-it-yourself" floating point: f * 2^e */
+typedef struct {
+	uint64_t f;
+	int e;
+} diyfp_st;
+
+#define DBL_SIGNIF_MASK		0x000FFFFFFFFFFFFFULL
+#define DBL_HIDDEN_BIT		0x0010000000000000ULL
+#define DBL_EXP_MASK		0x7FF0000000000000ULL
+#define DBL_SIGNIF_SIZE		52
+#define DBL_EXP_BIAS		(0x3FF + DBL_SIGNIF_SIZE)
+
+static inline diyfp_st diyfp_from_dbl(double dbl)
+{
+	uint64_t bits;
+	int biased_e;
+	diyfp_st fp;
+
+	memcpy(&bits, &dbl, sizeof(bits));
+	biased_e = (int)((bits & DBL_EXP_MASK) >> DBL_SIGNIF_SIZE);
+	fp.f = bits & DBL_SIGNIF_MASK;
+	if (biased_e) {
+		fp.f += DBL_HIDDEN_BIT;
+		fp.e = biased_e - DBL_EXP_BIAS;
+	} else { /* subnormal */
+		fp.e = 1 - DBL_EXP_BIAS;
+	}
+	return fp;
+}
+
+/* upper 64 bits of the 128 bits product, rounded */
+static inline diyfp_st diyfp_mul(diyfp_st x, diyfp_st y)
+{
+	uint64_t a, b, c, d, ac, bc, ad, bd, tmp;
+	const uint64_t m32 = 0xFFFFFFFFULL;
+
+	a = x.f >> 32;
+	b = x.f & m32;
+	c = y.f >> 32;
+	d = y.f & m32;
+	ac = a * c;
+	bc = b * c;
+	ad = a * d;
+	bd = b * d;
+	tmp = (bd >> 32) + (ad & m32) + (bc & m32);
+	tmp += 1ULL << 31;
+	return (diyfp_st) {
+		ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64
+	};
+}
+
+static inline diyfp_st diyfp_normalize(diyfp_st fp)
+{
+	while (! (fp.f & (1ULL << 63))) {
+		fp.f <<= 1;
+		fp.e --;
+	}
+	return fp;
+}
+
+/* the boundaries of the interval of the reals rounding to the double */
+static inline void normalized_boundaries(diyfp_st fp, diyfp_st *minus,
+	diyfp_st *plus)
+{
+	diyfp_st pl, mi;
+
+	pl.f = (fp.f << 1) + 1;
+	pl.e = fp.e - 1;
+	while (! (pl.f & (DBL_HIDDEN_BIT << 1))) {
+		pl.f <<= 1;
+		pl.e --;
+	}
+	pl.f <<= 64 - DBL_SIGNIF_SIZE - 2;
+	pl.e -= 64 - DBL_SIGNIF_SIZE - 2;
+
+	/* the lower boundary is closer for the powers of 2 */
+	if (fp.f == DBL_HIDDEN_BIT) {
+		mi.f = (fp.f << 2) - 1;
+		mi.e = fp.e - 2;
+	} else {
+		mi.f = (fp.f << 1) - 1;
+		mi.e = fp.e - 1;
+	}
+	mi.f <<= mi.e - pl.e;
+	mi.e = pl.e;
+
+	*plus = pl;
+	*minus = mi;
+}
+
+/* cached power of ten bringing the binary exponent 'e' in [-60, -32] */
+static inline diyfp_st cached_power(int e, int *k10)
+{
+	double dk;
+	int k, idx;
+
+	dk = (-61 - e) * 0.30102999566398114 + 347;
+	k = (int)dk;
+	if (0.0 < dk - k) {
+		k ++;
+	}
+	idx = (k >> 3) + 1;
+	*k10 = -(POW10_MIN_EXP + idx * POW10_STEP);
+	return (diyfp_st) {
+		pow10_f[idx], pow10_e[idx]
+	};
+}
+
+static inline int count_digits32(uint32_t n)
+{
+	int cnt;
+
+	for (cnt = 1; cnt < 10 && pow10_u64[cnt] <= n; cnt ++)
+		;
+	return cnt;
+}
+
+/* move the last digit closer to the exact value, while within the range */
+static inline void grisu_round(char *digits, int cnt, uint64_t delta,
+	uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+	while (rest < wp_w && ten_kappa <= delta - rest &&
+		(rest + ten_kappa < wp_w ||
+			rest + ten_kappa - wp_w < wp_w - rest)) {
+		digits[cnt - 1] --;
+		rest += ten_kappa;
+	}
+}
+
+static int digit_gen(diyfp_st w, diyfp_st mp, uint64_t delta, char *digits,
+	int *k10)
+{
+	diyfp_st one;
+	uint64_t wp_w, p2, tmp;
+	uint32_t p1, d;
+	int kappa, cnt;
+
+	one.e = mp.e;
+	one.f = 1ULL << -one.e;
+	wp_w = mp.f - w.f;
+	p1 = (uint32_t)(mp.f >> -one.e);
+	p2 = mp.f & (one.f - 1);
+	kappa = count_digits32(p1);
+	cnt = 0;
+
+	/* integral part */
+	while (0 < kappa) {
+		d = p1 / (uint32_t)pow10_u64[kappa - 1];
+		p1 %= (uint32_t)pow10_u64[kappa - 1];
+		if (d || cnt) {
+			digits[cnt ++] = '0' + (char)d;
+		}
+		kappa --;
+		tmp = ((uint64_t)p1 << -one.e) + p2;
+		if (tmp <= delta) {
+			*k10 += kappa;
+			grisu_round(digits, cnt, delta, tmp,
+				pow10_u64[kappa] << -one.e, wp_w);
+			return cnt;
+		}
+	}
+	/* fractional part */
+	for (;;) {
+		p2 *= 10;
+		delta *= 10;
+		d = (uint32_t)(p2 >> -one.e);
+		if (d || cnt) {
+			digits[cnt ++] = '0' + (char)d;
+		}
+		p2 &= one.f - 1;
+		kappa --;
+		if (p2 < delta) {
+			*k10 += kappa;
+			grisu_round(digits, cnt, delta, p2, one.f,
+				-kappa < 20 ? wp_w * pow10_u64[-kappa] : 0);
+			return cnt;
+		}
+	}
+}
+
+/*
+ * Shortest decimal digits of a finite, positive double, reading back as
+ * the same value: dbl = digits * 10^exp10.
+ * Returns the count of digits (at most 17), which are not 0-terminated.
+ */
+static int dbl_digits(double dbl, char *digits, int *exp10)
+{
+	diyfp_st v, w, w_m, w_p, c_mk;
+	int mk;
+
+	v = diyfp_from_dbl(dbl);
+	normalized_boundaries(v, &w_m, &w_p);
+	c_mk = cached_power(w_p.e, &mk);
+	w = diyfp_mul(diyfp_normalize(v), c_mk);
+	w_p = diyfp_mul(w_p, c_mk);
+	w_m = diyfp_mul(w_m, c_mk);
+	/* stay clear of the boundaries, given the approximation */
+	w_m.f ++;
+	w_p.f --;
+	*exp10 = mk;
+	return digit_gen(w, w_p, w_p.f - w_m.f, digits, exp10);
+}
+
+static inline void put_char(void *buff, size_t pos, char c, BOOL wide)
+{
+	if (wide) {
+		((SQLWCHAR *)buff)[pos] = (SQLWCHAR)c;
+	} else {
+		((SQLCHAR *)buff)[pos] = (SQLCHAR)c;
+	}
+}
+
+/* printf the double, for when its shortest digits need rounding off */
+static size_t dbl2tot_printf(double dbl, int prec, BOOL sci, void *buff,
+	size_t size, BOOL wide)
+{
+	int n;
+
+	if (wide) {
+		/* Win CRT fails with -1 on insufficient buffer */
+		n = swprintf((SQLWCHAR *)buff, size, sci ? L"%.*E" : L"%.*f", prec,
+				dbl);
+	} else {
+		n = snprintf((char *)buff, size, sci ? "%.*E" : "%.*f", prec, dbl);
+	}
+	return (0 < n && (size_t)n < size) ? (size_t)n : 0;
+}
+
+/*
+ * Print a double in fixed ("%.*f") or exponential ("%.*E") notation, with
+ * 'prec' digits after the radix character (always a '.').
+ * 'size' is the size of the buffer in characters, 0-terminator included.
+ * Returns the count of characters printed, or 0 if the buffer is too small.
+ */
+size_t TEST_API dbl2tot(double dbl, int prec, BOOL sci, void *buff,
+	size_t size, BOOL wide)
+{
+	char digits[/*max. shortest*/17 + /*pad*/1];
+	const char *special;
+	int cnt, exp10, whole, pos, i;
+	size_t n;
+	double val = dbl;
+
+	assert(0 <= prec);
+	n = 0;
+	if (isnan(dbl) || isinf(dbl)) {
+		special = isnan(dbl) ? "nan" : (dbl < 0 ? "-inf" : "inf");
+		if (size <= strlen(special)) {
+			return 0;
+		}
+		for (; *special; special ++) {
+			put_char(buff, n ++, *special, wide);
+		}
+		put_char(buff, n, '\0', wide);
+		return n;
+	}
+
+	if (signbit(dbl)) {
+		dbl = -dbl;
+		if (size <= 1) {
+			return 0;
+		}
+		put_char(buff, n ++, '-', wide);
+	}
+	if (dbl == 0) {
+		cnt = 0;
+		exp10 = 0;
+	} else {
+		cnt = dbl_digits(dbl, digits, &exp10);
+	}
+
+	/* would the shortest digits need to be cut? */
+	if (sci ? prec + /*first digit*/1 < cnt : exp10 + prec < 0) {
+		return dbl2tot_printf(val, prec, sci, buff, size, wide);
+	}
+
+	if (sci) {
+		if (cnt) {
+			/* the exponent of the first digit */
+			exp10 += cnt - 1;
+		}
+		/* d[.dd..d]E+xx[x] */
+		if (size <= n + 1 + !!prec + prec + /*E+*/2 + (100 <= abs(exp10) ?
+				3 : 2)) {
+			return 0;
+		}
+		put_char(buff, n ++, cnt ? digits[0] : '0', wide);
+		if (prec) {
+			put_char(buff, n ++, '.', wide);
+			for (i = 1; i <= prec; i ++) {
+				put_char(buff, n ++, i < cnt ? digits[i] : '0', wide);
+			}
+		}
+		put_char(buff, n ++, 'E', wide);
+		put_char(buff, n ++, exp10 < 0 ? '-' : '+', wide);
+		exp10 = abs(exp10);
+		if (100 <= exp10) {
+			put_char(buff, n ++, '0' + (char)(exp10 / 100), wide);
+			exp10 %= 100;
+		}
+		put_char(buff, n ++, digits_lut[2 * exp10], wide);
+		put_char(buff, n ++, digits_lut[2 * exp10 + 1], wide);
+	} else {
+		whole = cnt ? cnt + exp10 : 0;
+		if (size <= n + (0 < whole ? whole : 1) + !!prec + prec) {
+			return 0;
+		}
+		if (whole <= 0) {
+			put_char(buff, n ++, '0', wide);
+		} else {
+			for (pos = 0; pos < whole; pos ++) {
+				put_char(buff, n ++, pos < cnt ? digits[pos] : '0', wide);
+			}
+		}
+		if (prec) {
+			put_char(buff, n ++, '.', wide);
+			for (i = 0, pos = whole; i < prec; i ++, pos ++) {
+				put_char(buff, n ++, 0 <= pos && pos < cnt ? digits[pos] :
+					'0', wide);
+			}
+		}
+	}
+	put_char(buff, n, '\0', wide);
+	return n;
+}
+
+/*
+ * Print an unsigned integer, 0-terminated. The buffer must be large enough
+ * (ESODBC_PRECISION_UINT64 + 1 characters).
+ * Returns the count of characters printed.
+ */
+size_t TEST_API ui64tot(uint64_t ui64, void *buff, BOOL wide)
+{
+	char tmp[ESODBC_PRECISION_UINT64];
+	char *pos = tmp + sizeof(tmp);
+	size_t cnt, i, idx;
+
+	while (100 <= ui64) {
+		idx = (size_t)(ui64 % 100) * 2;
+		ui64 /= 100;
+		*--pos = digits_lut[idx + 1];
+		*--pos = digits_lut[idx];
+	}
+	if (10 <= ui64) {
+		idx = (size_t)ui64 * 2;
+		*--pos = digits_lut[idx + 1];
+		*--pos = digits_lut[idx];
+	} else {
+		*--pos = '0' + (char)ui64;
+	}
+
+	cnt = tmp + sizeof(tmp) - pos;
+	if (wide) {
+		for (i = 0; i < cnt; i ++) {
+			((SQLWCHAR *)buff)[i] = (SQLWCHAR)pos[i];
+		}
+		((SQLWCHAR *)buff)[cnt] = L'\0';
+	} else {
+		memcpy(buff, pos, cnt);
+		((SQLCHAR *)buff)[cnt] = '\0';
+	}
+	return cnt;
+}
+
+size_t TEST_API i64tot(int64_t i64, void *buff, BOOL wide)
+{
+	if (0 <= i64) {
+		return ui64tot((uint64_t)i64, buff, wide);
+	}
+	put_char(buff, 0, '-', wide);
+	/* the magnitude of INT64_MIN is only representable unsigned */
+	return 1 + ui64tot(0 - (uint64_t)i64, wide ? (void *)((SQLWCHAR *)buff + 1)
+			: (void *)((SQLCHAR *)buff + 1), wide);
+}
@@ -19,11 +19,12 @@ void init_diagnostic(esodbc_diag_st *dest)
 	dest->column_number = SQL_NO_COLUMN_NUMBER;
 }
 
-SQLRETURN post_diagnostic(SQLHANDLE hnd, esodbc_state_et state,
+/* Fill in a diagnostic record, not necessarily one of a handle (i.e. one
+ * that's going to be copied over to a handle by another thread). */
+SQLRETURN fill_diagnostic(esodbc_diag_st *dest, esodbc_state_et state,
 	const SQLWCHAR *text, SQLINTEGER code)
 {
 	size_t pos, tcnt, ebufsz;
-	esodbc_diag_st *dest = &HDRH(hnd)->diag;
 
 	ebufsz = sizeof(dest->text)/sizeof(dest->text[0]);
 
@@ -49,13 +50,23 @@ SQLRETURN post_diagnostic(SQLHANDLE hnd, esodbc_state_et state,
 		wcsncpy(dest->text + pos, text, tcnt + /* 0-term */1);
 		dest->text_len = (SQLUSMALLINT)(pos + tcnt);
 	}
-	DBGH(hnd, "diagnostic message: `" LWPD "` [%d], native code: %d.",
-		dest->text, dest->text_len, dest->native_code);
 
 	RET_STATE(state);
 }
 
-SQLRETURN post_c_diagnostic(SQLHANDLE hnd, esodbc_state_et state,
+SQLRETURN post_diagnostic(SQLHANDLE hnd, esodbc_state_et state,
+	const SQLWCHAR *text, SQLINTEGER code)
+{
+	SQLRETURN ret;
+	esodbc_diag_st *dest = &HDRH(hnd)->diag;
+
+	ret = fill_diagnostic(dest, state, text, code);
+	DBGH(hnd, "diagnostic message: `" LWPD "` [%d], native code: %d.",
+		dest->text, dest->text_len, dest->native_code);
+	return ret;
+}
+
+SQLRETURN fill_c_diagnostic(esodbc_diag_st *dest, esodbc_state_et state,
 	const SQLCHAR *text, SQLINTEGER code)
 {
 	SQLWCHAR wtext[SQL_MAX_MESSAGE_LENGTH], *ptr;
@@ -68,7 +79,19 @@ SQLRETURN post_c_diagnostic(SQLHANDLE hnd, esodbc_state_et state,
 	} else {
 		ptr = NULL;
 	}
-	return post_diagnostic(hnd, state, ptr, code);
+	return fill_diagnostic(dest, state, ptr, code);
+}
+
+SQLRETURN post_c_diagnostic(SQLHANDLE hnd, esodbc_state_et state,
+	const SQLCHAR *text, SQLINTEGER code)
+{
+	SQLRETURN ret;
+	esodbc_diag_st *dest = &HDRH(hnd)->diag;
+
+	ret = fill_c_diagnostic(dest, state, text, code);
+	DBGH(hnd, "diagnostic message: `" LWPD "` [%d], native code: %d.",
+		dest->text, dest->text_len, dest->native_code);
+	return ret;
 }
 
 
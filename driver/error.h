@@ -443,6 +443,10 @@ typedef struct {
 
 
 void init_diagnostic(esodbc_diag_st *dest);
+SQLRETURN fill_diagnostic(esodbc_diag_st *dest, esodbc_state_et state,
+	const SQLWCHAR *text, SQLINTEGER code);
+SQLRETURN fill_c_diagnostic(esodbc_diag_st *dest, esodbc_state_et state,
+	const SQLCHAR *text, SQLINTEGER code);
 SQLRETURN post_diagnostic(SQLHANDLE hnd, esodbc_state_et state,
 	const SQLWCHAR *text, SQLINTEGER code);
 SQLRETURN post_c_diagnostic(SQLHANDLE hnd, esodbc_state_et state,
@@ -13,6 +13,12 @@
 #include "connect.h"
 
 
+/* generations of the descriptors (see esodbc_desc_st.gen) */
+static volatile LONG desc_gen = 0;
+
+#define DESC_TOUCH(_desc) \
+	(_desc)->gen = InterlockedIncrement(&desc_gen)
+
 static void free_rec_fields(esodbc_rec_st *rec)
 {
 	int i;
@@ -93,6 +99,8 @@ void init_dbc(esodbc_dbc_st *dbc, SQLHANDLE InputHandle)
 
 	dbc->metadata_id = SQL_FALSE;
 	ESODBC_MUX_INIT(&dbc->curl_mux);
+	ESODBC_MUX_INIT(&dbc->async_mux);
+	ESODBC_MUX_INIT(&dbc->cat_cache_mux);
 	/* rest of initialization done at connect time */
 }
 
@@ -113,6 +121,7 @@ static void init_desc(esodbc_desc_st *desc, esodbc_stmt_st *stmt,
 	if (DESC_TYPE_IS_APPLICATION(type)) {
 		desc->bind_type = SQL_BIND_BY_COLUMN;
 	}
+	DESC_TOUCH(desc);
 }
 
 static void clear_desc(esodbc_desc_st *desc, BOOL reinit)
@@ -126,6 +135,13 @@ static void clear_desc(esodbc_desc_st *desc, BOOL reinit)
 			break;
 
 		case DESC_TYPE_IRD:
+			/* an asynchronous execution is abandoned */
+			curl_async_abort(HDRH(desc)->stmt);
+			/* a page might still be in flight: the cursor to close is the
+			 * one it carries, if it's been received */
+			prefetch_abort(HDRH(desc)->stmt);
+			/* result sets of a parameters array execution are dropped */
+			free_param_answers(HDRH(desc)->stmt);
 			if (STMT_HAS_CURSOR(HDRH(desc)->stmt)) {
 				close_es_cursor(HDRH(desc)->stmt);
 			}
@@ -169,6 +185,8 @@ static void init_stmt(esodbc_stmt_st *stmt, SQLHANDLE InputHandle)
 	 * Note: these attributes won't propagate at statement level when
 	 * set at connection level. */
 	stmt->metadata_id = DBCH(InputHandle)->metadata_id;
+	stmt->async_enable = DBCH(InputHandle)->async_enable;
+	stmt->rslt_cache = TRUE;
 	stmt->sql2c_conversion = CONVERSION_UNCHECKED;
 	stmt->early_executed = FALSE;
 }
@@ -220,6 +238,95 @@ void dump_record(esodbc_rec_st *rec)
 #undef DUMP_FIELD
 }
 
+/* names of the performance counters, in ESODBC_PERF_* order */
+static const char *perf_names[ESODBC_PERF_COUNTERS] = {
+	"requests", "pages", "bytes sent", "bytes received", "bytes on wire",
+	"rows", "conversion errors", "serialization us", "network us",
+	"parsing us", "conversion us", "result cache hits",
+	"result cache misses"
+};
+/* performance counter ticks per second; constant since boot */
+static LONG64 perf_freq = 0;
+
+/* current time, in performance counter ticks */
+LONG64 perf_clock()
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return now.QuadPart;
+}
+
+/* Account a value with the counters of a statement (if any) and of its
+ * connection. */
+void perf_count(esodbc_dbc_st *dbc, esodbc_perf_st *perf, int ctr,
+	LONG64 val)
+{
+	assert(0 <= ctr && ctr < ESODBC_PERF_COUNTERS);
+	if (perf) {
+		InterlockedExchangeAdd64(&perf->ctr[ctr], val);
+	}
+	InterlockedExchangeAdd64(&dbc->perf.ctr[ctr], val);
+}
+
+/* Account the microseconds elapsed since a perf_clock() reading. */
+void perf_lapse(esodbc_dbc_st *dbc, esodbc_perf_st *perf, int ctr,
+	LONG64 since)
+{
+	LARGE_INTEGER freq;
+	LONG64 ticks = perf_clock() - since;
+
+	if (! perf_freq) {
+		QueryPerformanceFrequency(&freq);
+		perf_freq = freq.QuadPart;
+	}
+	/* split the conversion to avoid overflowing the multiplication */
+	perf_count(dbc, perf, ctr, (ticks / perf_freq) * 1000000 +
+		(ticks % perf_freq) * 1000000 / perf_freq);
+}
+
+SQLRETURN perf_get_attr(SQLHANDLE hnd, esodbc_perf_st *perf,
+	SQLINTEGER attr, SQLPOINTER val)
+{
+	int ctr = attr - ESODBC_SQL_ATTR_PERF_BASE;
+
+	assert(IS_PERF_ATTR(attr));
+	/* atomic read, on 32bit platforms too */
+	*(SQLUBIGINT *)val = (SQLUBIGINT)InterlockedCompareExchange64(
+			&perf->ctr[ctr], 0, 0);
+	DBGH(hnd, "getting perf counter '%s': %llu.", perf_names[ctr],
+		(uint64_t)*(SQLUBIGINT *)val);
+	return SQL_SUCCESS;
+}
+
+SQLRETURN perf_reset_attr(SQLHANDLE hnd, esodbc_perf_st *perf,
+	SQLINTEGER attr)
+{
+	int i;
+
+	assert(IS_PERF_ATTR(attr));
+	for (i = 0; i < ESODBC_PERF_COUNTERS; i ++) {
+		InterlockedExchange64(&perf->ctr[i], 0);
+	}
+	INFOH(hnd, "perf counters reset (through attribute %ld).", attr);
+	return SQL_SUCCESS;
+}
+
+/* Log the performance counters of a handle, if any has been accounted. */
+void perf_dump(SQLHANDLE hnd, esodbc_perf_st *perf)
+{
+	int i;
+
+	for (i = 0; i < ESODBC_PERF_COUNTERS && (! perf->ctr[i]); i ++)
+		;
+	if (ESODBC_PERF_COUNTERS <= i) {
+		return;
+	}
+	for (i = 0; i < ESODBC_PERF_COUNTERS; i ++) {
+		INFOH(hnd, "perf counter %s: %lld.", perf_names[i],
+			(int64_t)perf->ctr[i]);
+	}
+}
+
 /*
  * The Driver Manager does not call the driver-level environment handle
  * allocation function until the application calls SQLConnect,
@@ -272,10 +379,13 @@ SQLRETURN EsSQLAllocHandle(SQLSMALLINT HandleType,
 		 * """
 		 */
 		case SQL_HANDLE_ENV: /* Environment Handle */
+			log_flusher_start();
 			*OutputHandle = (SQLHANDLE)malloc(sizeof(esodbc_env_st));
 			if (*OutputHandle) {
 				init_env(*OutputHandle);
 				DBG("new Environment handle @0x%p.", *OutputHandle);
+			} else {
+				log_flusher_stop();
 			}
 			break;
 
@@ -356,17 +466,24 @@ SQLRETURN EsSQLFreeHandle(SQLSMALLINT HandleType, SQLHANDLE Handle)
 
 	switch(HandleType) {
 		case SQL_HANDLE_ENV: /* Environment Handle */
+			log_flusher_stop();
 			break;
 		case SQL_HANDLE_DBC: /* Connection Handle */
 			dbc = DBCH(Handle);
+			perf_dump(dbc, &dbc->perf);
 			/* app/DM should have SQLDisconnect'ed, but just in case  */
 			cleanup_dbc(dbc);
 			ESODBC_MUX_DEL(&dbc->curl_mux);
+			ESODBC_MUX_DEL(&dbc->async_mux);
+			ESODBC_MUX_DEL(&dbc->cat_cache_mux);
 			break;
 		case SQL_HANDLE_STMT:
 			stmt = STMH(Handle);
+			perf_dump(stmt, &stmt->perf);
 
 			detach_sql(stmt);
+			free_request_tmpl(stmt);
+			curl_batch_cleanup(stmt);
 
 			clear_desc(stmt->ard, FALSE);
 			clear_desc(stmt->ird, FALSE);
@@ -807,11 +924,22 @@ SQLRETURN EsSQLSetStmtAttrW(
 			break;
 
 		case SQL_ATTR_ASYNC_ENABLE:
-			ERRH(stmt, "no support for async API (setting param: %llu)",
-					(uint64_t)ValuePtr);
-			if ((SQLULEN)ValuePtr == SQL_ASYNC_ENABLE_ON) {
-				RET_HDIAGS(stmt, SQL_STATE_HYC00);
+			ulen = (SQLULEN)ValuePtr;
+			DBGH(stmt, "setting async mode to: %llu.", (uint64_t)ulen);
+			if (ulen != SQL_ASYNC_ENABLE_ON && ulen != SQL_ASYNC_ENABLE_OFF) {
+				ERRH(stmt, "invalid async mode value: %llu.", (uint64_t)ulen);
+				RET_HDIAGS(stmt, SQL_STATE_HY024);
+			}
+			if (STMT_ASYNC_UNDERWAY(stmt)) {
+				ERRH(stmt, "asynchronous execution under way.");
+				RET_HDIAGS(stmt, SQL_STATE_HY010);
 			}
+			stmt->async_enable = ulen;
+			break;
+
+		case ESODBC_SQL_ATTR_RSLT_CACHE:
+			DBGH(stmt, "setting result caching: %llu.", (uint64_t)ValuePtr);
+			stmt->rslt_cache = (SQLULEN)ValuePtr != SQL_FALSE;
 			break;
 		case SQL_ATTR_ASYNC_STMT_EVENT:
 		// case SQL_ATTR_ASYNC_STMT_PCALLBACK:
@@ -908,6 +1036,9 @@ SQLRETURN EsSQLSetStmtAttrW(
 			RET_HDIAGS(stmt, SQL_STATE_HY092);
 
 		default:
+			if (IS_PERF_ATTR(Attribute)) {
+				return perf_reset_attr(stmt, &stmt->perf, Attribute);
+			}
 			// FIXME
 			BUGH(stmt, "unknown Attribute: %d.", Attribute);
 			RET_HDIAGS(stmt, SQL_STATE_HY092);
@@ -947,8 +1078,13 @@ SQLRETURN EsSQLGetStmtAttrW(
 			*(SQLULEN *)ValuePtr = stmt->metadata_id;
 			break;
 		case SQL_ATTR_ASYNC_ENABLE:
-			DBGH(stmt, "getting async mode: %lu", SQL_ASYNC_ENABLE_OFF);
-			*(SQLULEN *)ValuePtr = SQL_ASYNC_ENABLE_OFF;
+			DBGH(stmt, "getting async mode: %llu",
+					(uint64_t)stmt->async_enable);
+			*(SQLULEN *)ValuePtr = stmt->async_enable;
+			break;
+		case ESODBC_SQL_ATTR_RSLT_CACHE:
+			DBGH(stmt, "getting result caching: %d.", stmt->rslt_cache);
+			*(SQLULEN *)ValuePtr = stmt->rslt_cache ? SQL_TRUE : SQL_FALSE;
 			break;
 		case SQL_ATTR_MAX_LENGTH:
 			DBGH(stmt, "getting max_length: %llu",
@@ -1034,6 +1170,9 @@ SQLRETURN EsSQLGetStmtAttrW(
 			break;
 
 		default:
+			if (IS_PERF_ATTR(Attribute)) {
+				return perf_get_attr(stmt, &stmt->perf, Attribute, ValuePtr);
+			}
 			ERRH(stmt, "unknown attribute: %ld.", Attribute);
 			RET_HDIAGS(stmt, SQL_STATE_HY092);
 	}
@@ -1477,6 +1616,7 @@ SQLRETURN update_rec_count(esodbc_desc_st *desc, SQLSMALLINT new_count)
 
 	desc->count = new_count;
 	desc->recs = recs;
+	DESC_TOUCH(desc);
 	return SQL_SUCCESS;
 }
 
@@ -2458,6 +2598,8 @@ SQLRETURN EsSQLSetDescFieldW(
 		ERRH(desc, "buffer/~ length check failed (%d).", state);
 		RET_HDIAGS(desc, state);
 	}
+	/* any conversion plans built on the descriptor are now stale */
+	DESC_TOUCH(desc);
 
 	/* header fields */
 	switch (FieldIdentifier) {
@@ -2476,11 +2618,15 @@ SQLRETURN EsSQLSetDescFieldW(
 					RET_HDIAGS(desc, SQL_STATE_HY092);
 				}
 			} else { /* IS_PARAMETER */
-				/* no support for param arrays (yet) TODO */
-				if (1 < ulen) {
-					ERRH(desc, "no support for arrays of parameters.");
-					RET_HDIAG(desc, SQL_STATE_HYC00,
-						"Parameter arrays not implemented", 0);
+				if (ESODBC_MAX_PARAMSET_SIZE < ulen) {
+					WARNH(desc, "provided paramset size (%llu) larger than "
+						"allowed max (%hu) -- set value adjusted to max.",
+						(uint64_t)ulen, ESODBC_MAX_PARAMSET_SIZE);
+					desc->array_size = ESODBC_MAX_PARAMSET_SIZE;
+					RET_HDIAGS(desc, SQL_STATE_01S02);
+				} else if (ulen < 1) {
+					ERRH(desc, "can't set the paramset size to less than 1.");
+					RET_HDIAGS(desc, SQL_STATE_HY092);
 				}
 			}
 			desc->array_size = ulen;
@@ -44,6 +44,12 @@ typedef struct struct_hheader { /* handle header */
 	esodbc_filelog_st *log; /* logger: owned by a DBC; ENV uses global */
 } esodbc_hhdr_st;
 
+/* performance counters (see ESODBC_PERF_*), updated atomically, since the
+ * connection's are shared by its statements */
+typedef struct struct_perf {
+	volatile LONG64 ctr[ESODBC_PERF_COUNTERS];
+} esodbc_perf_st;
+
 /*
  * https://docs.microsoft.com/en-us/sql/odbc/reference/develop-app/environment-handles :
  * """
@@ -172,6 +178,10 @@ typedef struct struct_dbc {
 		wstr_st w; /* NB: w.str and c.str are co-allocated */
 		cstr_st c;
 	} catalog; /* current ~  */
+	struct {
+		wstr_st catalog; /* as reported by `SELECT database()` */
+		wstr_st user; /* as reported by `SELECT user()` */
+	} srv_attrs; /* server attributes, cached once fetched */
 	BOOL early_exec; /* should prepared, non-param queries be exec'd early? */
 	enum {
 		ESODBC_FLTS_DEFAULT = 0,
@@ -181,6 +191,15 @@ typedef struct struct_dbc {
 	BOOL mfield_lenient; /* 'field_multi_value_leniency' request param */
 	BOOL idx_inc_frozen; /* 'field_multi_value_leniency' request param */
 	BOOL auto_esc_pva; /* auto-escape PVA args in catalog functions */
+	BOOL prefetch; /* fetch the next page on a worker thread? */
+	BOOL columnar; /* request column-major result sets ("values")? */
+	SQLUINTEGER meta_cache_ttl; /* seconds to cache server metadata for */
+	BOOL cache_refresh; /* reload the cached metadata */
+	SQLUINTEGER rslt_cache_ttl; /* seconds to cache query answers for */
+	struct srv_cache *srv_cache; /* cached version and types, if any */
+	struct catalog_cache *cat_cache; /* cached catalog answers, MRU first */
+	size_t cat_cache_size; /* total size of the cached answers' bodies */
+	esodbc_mutex_lt cat_cache_mux; /* mutex for the two members above */
 
 	esodbc_estype_st *es_types; /* array with ES types */
 	SQLULEN no_types; /* number of types in array */
@@ -194,6 +213,7 @@ typedef struct struct_dbc {
 	esodbc_estype_st *lgst_name; /* type with longest name */
 
 	CURL *curl; /* cURL handle */
+	CURLM *curl_multi; /* multi handle driving curl's transfers */
 	CURLcode curl_err;
 	char curl_err_buff[CURL_ERROR_SIZE];
 	enum {
@@ -207,13 +227,23 @@ typedef struct struct_dbc {
 	size_t apos; /* current write position in the abuff */
 	size_t amax; /* maximum length (bytes) that abuff can grow to */
 	esodbc_mutex_lt curl_mux; /* mutex for above 'networking' members */
+	/* multi handle driving the statements' asynchronous transfers: apart
+	 * from curl's, for the polling to never wait on a synchronous transfer */
+	CURLM *async_multi;
+	esodbc_mutex_lt async_mux; /* mutex for async_multi */
 	struct curl_slist *curl_hdrs; /* HTTP headers list */
+	CURLSH *curl_share; /* DNS+TLS share handle of conn. pool, if any */
+	long pool_max_idle; /* max idle multi handles kept in the pool */
+	long pool_idle_tout; /* max seconds a pooled connection can idle */
 
 	/* window handler */
 	HWND hwin;
 
+	esodbc_perf_st perf; /* counters of all connection's statements */
+
 	/* options */
 	SQLULEN metadata_id; // default: SQL_FALSE
+	SQLULEN async_enable; // default: SQL_ASYNC_ENABLE_OFF
 } esodbc_dbc_st;
 
 typedef struct desc_rec {
@@ -233,6 +263,28 @@ typedef struct desc_rec {
 		CborValue cbor;
 	} i_val;
 
+	/* IRD: plan of the conversion into the bound ARD record, built ahead of
+	 * fetching (see conv_plans_build()) */
+	struct {
+		struct desc_rec *arec; /* ARD record planned for; NULL if none */
+		LONG gen; /* ARD's generation the plan was built with */
+		SQLSMALLINT ctype; /* resolved C type of the ARD record */
+		/* C type of values that can be copied as-is, with no conversion or
+		 * length adjustment (SQL_C_CHAR: UTF-8 text passed through, with
+		 * length adjustment); SQL_C_DEFAULT if none */
+		SQLSMALLINT direct;
+		size_t data_stride; /* bytes between rowset elements of data_ptr */
+		size_t len_stride; /* ~ of indicator_ptr and octet_length_ptr */
+		SQLLEN *offt_ptr; /* bind offset pointer, if binding by row */
+	} plan;
+
+	/* IRD: value returned instead of any received for the column, if 'set'
+	 * (see update_varchar_defs()) */
+	struct {
+		BOOL set;
+		SQLBIGINT val;
+	} ovr;
+
 	/*
 	 * record fields
 	 */
@@ -321,8 +373,15 @@ typedef struct struct_desc {
 
 	/* array of records of .count cardinality */
 	esodbc_rec_st *recs;
+
+	/* process-wide unique, renewed with every update of the descriptor */
+	LONG gen;
 } esodbc_desc_st;
 
+/* is the IRD record's conversion plan up to date for the ARD record? */
+#define REC_PLAN_VALID(_irec, _arec) \
+	((_irec)->plan.arec == (_arec) && (_irec)->plan.gen == (_arec)->desc->gen)
+
 /* the ES/SQL type must be set for implementation descriptor records */
 #define ASSERT_IXD_HAS_ES_TYPE(_rec) \
 	assert(DESC_TYPE_IS_IMPLEMENTATION(_rec->desc->type) && _rec->es_type)
@@ -332,6 +391,7 @@ struct resultset_cbor {
 	BOOL curs_allocd; /* curs.str is allocated (and reassembled) */
 	CborValue rows_obj; /* top object rows container (EsSQLRowCount()) */
 	CborValue rows_iter; /* iterator over received rows; refs req's body */
+	CborValue *vals_iter; /* columnar: one iterator per column; allocated */
 	wstr_st cols_buff /* columns descriptions; refs allocated chunk */;
 };
 
@@ -341,6 +401,7 @@ struct resultset_json {
 	UJObject rows_obj; /* top object rows container (EsSQLRowCount()) */
 	void *rows_iter; /* UJSON iterator with the rows in result set */
 	UJObject row_array; /* UJSON object for current row */
+	void **vals_iter; /* columnar: one UJSON iterator per column; allocd. */
 };
 
 typedef struct struct_resultset {
@@ -354,6 +415,9 @@ typedef struct struct_resultset {
 	} pack;
 
 	size_t vrows; /* (count of) visited rows in current result set  */
+	/* the result set has been received column-major ("values") */
+	BOOL columnar;
+	size_t nrows; /* columnar: (count of) rows in current result set */
 } resultset_st;
 
 #define STMT_HAS_CURSOR(_stmt)	\
@@ -369,11 +433,33 @@ typedef struct struct_resultset {
  * error."
  */
 
+/* outcome of the request of one set of a parameters array */
+typedef struct param_set_answer {
+	CURLcode res; /* transport outcome of the request */
+	long code; /* HTTP code of received answer; -1 if none */
+	cstr_st body; /* received answer */
+	BOOL is_json; /* encoding of the answer */
+} pset_answ_st;
+
 typedef struct struct_stmt {
 	esodbc_hhdr_st hdr;
 
 	/* cache UTF8 JSON serialized SQL: can be (re)used with varying params */
 	cstr_st u8sql;
+	/* request template: the parts of the (JSON/CBOR) request that don't vary
+	 * with the parameters, encoded once per query (see serialize_statement())
+	 */
+	struct {
+		cstr_st buff; /* allocation holding all the members below */
+		cstr_st head; /* query request, up to the parameters */
+		cstr_st tail; /* query request, after the parameters */
+		cstr_st curs_tail; /* cursor request, after the cursor (tail's end) */
+		size_t keys; /* CBOR map pairs of a query request w/o parameters */
+		size_t curs_keys; /* CBOR map pairs of a cursor request */
+		cstr_st tz; /* time zone encoded in the tail */
+		cstr_st catalog; /* catalog encoded in the tail */
+		BOOL query; /* is the head that of the currently attached query? */
+	} tmpl;
 
 	/* pointers to the current descriptors */
 	esodbc_desc_st *ard;
@@ -389,6 +475,8 @@ typedef struct struct_stmt {
 	/* options */
 	SQLULEN bookmarks; //default: SQL_UB_OFF
 	SQLULEN metadata_id; // default: copied from connection
+	SQLULEN async_enable; // default: copied from connection
+	BOOL rslt_cache; /* use the results cache, if enabled? (default: yes) */
 	/* "the maximum amount of data that the driver returns from a character or
 	 * binary column" */
 	SQLULEN max_length;
@@ -412,12 +500,58 @@ typedef struct struct_stmt {
 	} sql2c_conversion;
 	/* early execution */
 	BOOL early_executed;
+	/* set by SQLCancel(), from any thread; reset on each new request */
+	volatile LONG cancel;
+	/* multi handle of the parameters array transfers, kept for the life of
+	 * the statement (for SQLCancel() to wake it up); NULL if none yet */
+	CURLM *volatile batch_multi;
+	/* asynchronous execution state; the transfer is guarded by the DBC's
+	 * async_mux */
+	struct {
+		/* request body, until the transfer can be started */
+		cstr_st req;
+		CURL *curl; /* handle of the request under way; NULL if none */
+		struct curl_slist *hdrs; /* copy of DBC's HTTP headers, if any */
+		BOOL done; /* has the transfer completed? */
+		CURLcode res; /* outcome of the completed transfer */
+		char *abuff; /* buffer holding the answer */
+		size_t alen; /* size of abuff */
+		size_t apos; /* current write position in the abuff */
+		char err_buff[CURL_ERROR_SIZE];
+	} async;
+	/* next page prefetching state */
+	struct {
+		HANDLE thread; /* worker thread; NULL if none started */
+		SQLULEN tout; /* timeout of the request */
+		cstr_st req; /* serialized cursor request */
+		SQLRETURN ret; /* outcome of the request */
+		long code; /* HTTP code of received answer, if any */
+		cstr_st body; /* received answer */
+		BOOL is_json; /* encoding of the answer */
+		esodbc_diag_st diag; /* transport failure diagnostic */
+	} prefetch;
 
 	/* SQLGetData state members */
 	SQLINTEGER gd_col; /* current column to get from, if positive */
 	SQLINTEGER gd_ctype; /* current target type */
 	SQLLEN gd_offt; /* position in source buffer */
 
+	/* descriptors' generations the IRD conversion plans were built with */
+	struct {
+		LONG ard_gen;
+		LONG ird_gen;
+	} plans;
+
+	/* set of the parameters array being serialized */
+	SQLULEN param_set;
+	/* answers of a parameters array execution, one result set per set */
+	struct {
+		pset_answ_st *answs; /* NULL if no parameters array executed */
+		SQLULEN cnt; /* count of answs */
+		SQLULEN crr; /* set whose answer is currently attached */
+	} psets;
+
+	esodbc_perf_st perf; /* statement's counters */
 } esodbc_stmt_st;
 
 /* reset statment's result set count and number of visited rows */
@@ -444,6 +578,26 @@ void dump_record(esodbc_rec_st *rec);
 
 void init_dbc(esodbc_dbc_st *dbc, SQLHANDLE InputHandle);
 
+LONG64 perf_clock();
+void perf_count(esodbc_dbc_st *dbc, esodbc_perf_st *perf, int ctr,
+	LONG64 val);
+void perf_lapse(esodbc_dbc_st *dbc, esodbc_perf_st *perf, int ctr,
+	LONG64 since);
+SQLRETURN perf_get_attr(SQLHANDLE hnd, esodbc_perf_st *perf,
+	SQLINTEGER attr, SQLPOINTER val);
+SQLRETURN perf_reset_attr(SQLHANDLE hnd, esodbc_perf_st *perf,
+	SQLINTEGER attr);
+void perf_dump(SQLHANDLE hnd, esodbc_perf_st *perf);
+/* is the attribute one of the performance counters? */
+#define IS_PERF_ATTR(_attr) \
+	(ESODBC_SQL_ATTR_PERF_BASE <= (_attr) && \
+		(_attr) < ESODBC_SQL_ATTR_PERF(ESODBC_PERF_COUNTERS))
+/* account a value with both the statement and its connection */
+#define STMT_PERF_COUNT(_stmt, _ctr, _val) \
+	perf_count(HDRH(_stmt)->dbc, &(_stmt)->perf, _ctr, _val)
+#define STMT_PERF_LAPSE(_stmt, _ctr, _since) \
+	perf_lapse(HDRH(_stmt)->dbc, &(_stmt)->perf, _ctr, _since)
+
 esodbc_desc_st *getdata_set_ard(esodbc_stmt_st *stmt, esodbc_desc_st *gd_ard,
 	SQLUSMALLINT colno, esodbc_rec_st *recs, SQLUSMALLINT count);
 void getdata_reset_ard(esodbc_stmt_st *stmt, esodbc_desc_st *ard,
@@ -573,6 +727,9 @@ SQLRETURN EsSQLSetDescRec(
 	} while (0)
 
 #define STMT_HAS_RESULTSET(stmt)	((stmt)->rset.body.str != NULL)
+/* is an asynchronous execution under way (started or not)? */
+#define STMT_ASYNC_UNDERWAY(stmt)	\
+	((stmt)->async.curl != NULL || (stmt)->async.req.str != NULL)
 #define STMT_FORCE_NODATA(stmt)		(stmt)->rset.body.cnt = (size_t)-1
 #define STMT_NODATA_FORCED(stmt)	((stmt)->rset.body.cnt == (size_t)-1)
 /* "An application can unbind the data buffer for a column but still have a
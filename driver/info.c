@@ -158,7 +158,7 @@ static SQLRETURN getinfo_driver(
 			RET_INFO(SQL_C_ULONG, SQL_ASYNC_DBC_NOT_CAPABLE,
 				"async DBC functions");
 		case SQL_ASYNC_MODE:
-			RET_INFO(SQL_C_ULONG, SQL_AM_NONE, "async mode");
+			RET_INFO(SQL_C_ULONG, SQL_AM_STATEMENT, "async mode");
 		/* "if the driver supports asynchronous notification" */
 		case SQL_ASYNC_NOTIFICATION:
 			RET_INFO(SQL_C_ULONG, SQL_ASYNC_NOTIFICATION_NOT_CAPABLE,
@@ -221,6 +221,8 @@ static SQLRETURN getinfo_driver(
 		case SQL_KEYSET_CURSOR_ATTRIBUTES1:
 		case SQL_KEYSET_CURSOR_ATTRIBUTES2:
 			RET_INFO(SQL_C_ULONG, 0, "[keyset cursor attributes]");
+		/* 0: no limit (other than the transfers on same DBC progressing
+		 * together) */
 		case SQL_MAX_ASYNC_CONCURRENT_STATEMENTS:
 			RET_INFO(SQL_C_ULONG, 0, "async concurrent statements");
 		/* "the maximum number of active statements that the driver can
@@ -237,7 +239,7 @@ static SQLRETURN getinfo_driver(
 		case SQL_PARAM_ARRAY_ROW_COUNTS:
 			RET_INFO(SQL_C_ULONG, SQL_PARC_NO_BATCH, "param array row counts");
 		case SQL_PARAM_ARRAY_SELECTS:
-			RET_INFO(SQL_C_ULONG, SQL_PAS_NO_SELECT, "result set availability "
+			RET_INFO(SQL_C_ULONG, SQL_PAS_BATCH, "result set availability "
 				"with parameterized execution");
 #if (ODBCVER < 0x0400)
 		/* this is an ODBC 4.0, but Excel seems to asks for it anyways in
@@ -1221,7 +1223,7 @@ SQLRETURN EsSQLGetTypeInfoW(SQLHSTMT StatementHandle, SQLSMALLINT DataType)
 		RET_HDIAGS(stmt, SQL_STATE_HY000);
 	}
 
-	return EsSQLExecDirectW(stmt, wbuff, cnt);
+	return catalog_exec(stmt, wbuff, (size_t)cnt);
 
 #	undef SQL_TYPES_STMT
 }
@@ -27,10 +27,41 @@
  * Size of buffer to fetch errno-to-string message.
  */
 #define LOG_ERRNO_BUF_SIZE	128
+/* length of the ctime_s()-formatted timestamp, w/o the \n\0 */
+#define LOG_TIMESTAMP_LEN	(sizeof("Wed Jan 02 02:03:55 1980") - 1)
 
 /* global file log */
 esodbc_filelog_st *_gf_log = NULL;
 
+/*
+ * Background writer of the loggers' queued messages: it wakes up every
+ * ESODBC_LOG_FLUSH_INTERVAL or when a queue fills up and writes each
+ * logger's messages in batches.
+ * It runs while there are environment handles allocated and holds a
+ * reference on the library meanwhile, released as it exits
+ * (FreeLibraryAndExitThread()): the library can't be unmapped while its
+ * code is still executing.
+ */
+static struct {
+	esodbc_mutex_lt mux; /* guards the list of loggers */
+	esodbc_filelog_st **logs;
+	size_t cnt;
+	esodbc_mutex_lt ctl_mux; /* serializes the thread's start and stop */
+	size_t users; /* count of allocated environment handles */
+	HANDLE thread;
+	HANDLE wake; /* auto-reset: a queue is filling up or stopping */
+	HANDLE done; /* manual-reset: set by the thread right before exiting */
+	volatile BOOL stop;
+	/* thread is running: loggers queue their messages; otherwise, they
+	 * write synchronously */
+	volatile BOOL running;
+	/* thread terminated w/o exiting (process termination): its locks
+	 * might have been left acquired */
+	BOOL dead;
+} flusher = {.mux = ESODBC_MUX_SINIT, .ctl_mux = ESODBC_MUX_SINIT};
+
+static void flusher_stop();
+
 #ifdef WITH_EXTENDED_BUFF_LOG
 static char **log_buffs = NULL;
 static size_t log_buffs_cnt = 0;
@@ -102,7 +133,12 @@ void log_cleanup()
 {
 #	ifdef WITH_EXTENDED_BUFF_LOG
 	size_t i;
+#	endif /* WITH_EXTENDED_BUFF_LOG */
+
+	/* stop the flusher first: it might (extended-)log itself */
+	flusher_stop();
 
+#	ifdef WITH_EXTENDED_BUFF_LOG
 	if (log_buffs) {
 		for (i = 0; i < log_buffs_cnt; i ++) {
 			free(log_buffs[i]);
@@ -193,6 +229,8 @@ BOOL filelog_print_path(wstr_st *dest, wstr_st *dir_path, wstr_st *ident)
 
 BOOL filelog_reset(esodbc_filelog_st *log)
 {
+	LARGE_INTEGER zero = {0}, end;
+
 	if (ESODBC_LOG_MAX_RETRY < log->fails) {
 		/* disable logging alltogether on this logger */
 		log->level = LOG_LEVEL_DISABLED;
@@ -216,7 +254,350 @@ BOOL filelog_reset(esodbc_filelog_st *log)
 		log->fails ++;
 		return FALSE;
 	}
+	/* append to any existing content */
+	if (! SetFilePointerEx(log->handle, zero, &end, FILE_END)) {
+		ERRN("failed to seek to the end of log file `" LWPD "`.",
+			log->path);
+		end.QuadPart = 0;
+	}
+	log->size = (uint64_t)end.QuadPart;
+	return TRUE;
+}
+
+/* rename current log file to <name>.1 (replacing any existing one) and
+ * continue logging in a new file */
+static void filelog_rotate(esodbc_filelog_st *log)
+{
+	wchar_t rpath[MAX_PATH + sizeof(".1")];
+	int cnt;
+
+	cnt = _snwprintf(rpath, sizeof(rpath)/sizeof(*rpath), L"%s.1",
+			log->path);
+	if (cnt <= 0 || sizeof(rpath)/sizeof(*rpath) <= (size_t)cnt) {
+		return; /* path too long: keep logging into the current file */
+	}
+	CloseHandle(log->handle);
+	log->handle = INVALID_HANDLE_VALUE;
+	if (! MoveFileExW(log->path, rpath, MOVEFILE_REPLACE_EXISTING)) {
+		if (log != _gf_log) {
+			ERRN("failed to rotate log file `" LWPD "`.", log->path);
+		}
+	}
+	filelog_reset(log);
+}
+
+static BOOL filelog_write(esodbc_filelog_st *log, char *buff, size_t cnt)
+{
+	DWORD written;
+
+	/* write the buffer to file */
+	if (! WriteFile(
+			log->handle, /*handle*/
+			buff, /* buffer */
+			(DWORD)(cnt * sizeof(buff[0])), /*bytes to write */
+			&written /* bytes written */,
+			NULL /*overlap*/)) {
+		log->fails ++;
+		/* log into general logger, if available */
+		if (log != _gf_log) { /* avoid spin for general logger's first msg */
+			ERRN("failed writing into log file `" LWPD "`.", log->path);
+		}
+		if (filelog_reset(log)) {
+			/* reattempt the write, if reset is successfull */
+			if (filelog_write(log, buff, cnt)) {
+				log->fails = 0;
+				return TRUE;
+			}
+		}
+		return FALSE;
+	} else {
+#ifndef NDEBUG
+#ifdef _WIN32
+		//FlushFileBuffers(log->handle);
+#endif /* _WIN32 */
+#endif /* NDEBUG */
+	}
+	log->size += written;
+	if (ESODBC_LOG_ROTATE_SIZE < log->size) {
+		filelog_rotate(log);
+	}
+	return TRUE;
+}
+
+/* the records in a logger's ring are 8-bytes aligned and led by their
+ * length: 0 while not yet published, negative for a padding up to the
+ * ring's end */
+#define LOG_REC_ALIGN(_n)		(((_n) + 7) & ~(LONG64)7)
+#define LOG_REC_HDR_SIZE		LOG_REC_ALIGN((LONG64)sizeof(LONG))
+#define LOG_RING_OFF(_pos)		((_pos) & (ESODBC_LOG_RING_SIZE - 1))
+#define LOG_REC_LEN(_log, _pos)	\
+	((volatile LONG *)((_log)->ring + LOG_RING_OFF(_pos)))
+
+/*
+ * Queue a formatted message for the flusher.
+ * The queue is a lock-free, bounded multi-producer byte ring: a producer
+ * claims the bytes of its record (plus a padding, if the record won't fit
+ * before the ring's end) by advancing the head, as long as these have been
+ * freed by the flusher (are behind the tail + ring size). It then copies the
+ * message in and publishes it to the flusher by setting the record's
+ * length. If the ring is full, the message is dropped, instead of blocking
+ * the caller.
+ */
+static void filelog_enqueue(esodbc_filelog_st *log, int level,
+	const char *buff, size_t cnt)
+{
+	LONG64 pos, crr, off, pad, need, used;
+
+	assert(cnt <= ESODBC_LOG_BUF_SIZE);
+	need = LOG_REC_ALIGN(LOG_REC_HDR_SIZE + (LONG64)cnt);
+	for (pos = log->head; ; pos = crr) {
+		off = LOG_RING_OFF(pos);
+		pad = ESODBC_LOG_RING_SIZE < off + need ?
+			ESODBC_LOG_RING_SIZE - off : 0;
+		used = pos - log->tail;
+		if (ESODBC_LOG_RING_SIZE < used + pad + need) {
+			InterlockedIncrement(&log->dropped);
+			return;
+		}
+		crr = InterlockedCompareExchange64(&log->head, pos + pad + need, pos);
+		if (crr == pos) {
+			break; /* bytes claimed */
+		}
+	}
+	if (pad) {
+		InterlockedExchange(LOG_REC_LEN(log, pos), -(LONG)pad);
+		pos += pad;
+	}
+	memcpy(log->ring + LOG_RING_OFF(pos) + LOG_REC_HDR_SIZE, buff, cnt);
+	InterlockedExchange(LOG_REC_LEN(log, pos), (LONG)cnt);
+
+	/* have errors written out promptly and the ring drained before it
+	 * fills up */
+	if (level == LOG_LEVEL_ERR || (used <= ESODBC_LOG_RING_SIZE / 2 &&
+			ESODBC_LOG_RING_SIZE / 2 < used + pad + need)) {
+		SetEvent(flusher.wake);
+	}
+}
+
+/* write out the queued messages, collated; called under logger's mux */
+static void filelog_drain(esodbc_filelog_st *log)
+{
+	size_t pos = 0;
+	LONG dropped, len;
+	LONG64 off, adv;
+	time_t now;
+	char ts_buff[LOG_TIMESTAMP_LEN + /*\n\0*/2];
+	int ret;
+
+	if ((dropped = InterlockedExchange(&log->dropped, 0))) {
+		/* formatted straight into the batch: the logger can't be re-entered
+		 * under its mux */
+		now = time(NULL);
+		if (ctime_s(ts_buff, sizeof(ts_buff), &now)) {
+			ts_buff[0] = '\0';
+		} else {
+			ts_buff[LOG_TIMESTAMP_LEN] = '\0'; /* drop the \n */
+		}
+		ret = snprintf(log->batch, ESODBC_LOG_BATCH_SIZE, "%s - [WARN] %s(): "
+				"%ld messages dropped, with the logging queue full.\n",
+				ts_buff, __func__, dropped);
+		if (0 < ret) {
+			pos = (size_t)ret < ESODBC_LOG_BATCH_SIZE ? (size_t)ret : 0;
+		}
+	}
+
+	for (; ; ) {
+		off = LOG_RING_OFF(log->tail);
+		if (! (len = *LOG_REC_LEN(log, log->tail))) {
+			break; /* not (yet) published */
+		}
+		if (len < 0) { /* padding */
+			adv = -len;
+		} else {
+			if (ESODBC_LOG_BATCH_SIZE < pos + len) {
+				filelog_write(log, log->batch, pos);
+				pos = 0;
+			}
+			memcpy(log->batch + pos, log->ring + off + LOG_REC_HDR_SIZE, len);
+			pos += len;
+			adv = LOG_REC_ALIGN(LOG_REC_HDR_SIZE + len);
+		}
+		/* zero the record, for its bytes to read as unpublished to the
+		 * producers wrapping around to them, then free it */
+		memset(log->ring + off, 0, (size_t)adv);
+		InterlockedExchange64(&log->tail, log->tail + adv);
+	}
+	if (pos) {
+		filelog_write(log, log->batch, pos);
+	}
+}
+
+static DWORD WINAPI flusher_run(LPVOID arg)
+{
+	HMODULE module = (HMODULE)arg;
+	size_t i;
+	esodbc_filelog_st *log;
+
+	while (! flusher.stop) {
+		WaitForSingleObject(flusher.wake, ESODBC_LOG_FLUSH_INTERVAL);
+		ESODBC_MUX_LOCK(&flusher.mux);
+		for (i = 0; i < flusher.cnt; i ++) {
+			log = flusher.logs[i];
+			ESODBC_MUX_LOCK(&log->mux);
+			filelog_drain(log);
+			ESODBC_MUX_UNLOCK(&log->mux);
+		}
+		ESODBC_MUX_UNLOCK(&flusher.mux);
+	}
+	SetEvent(flusher.done);
+	/* no return into the library's code, once the reference is released */
+	FreeLibraryAndExitThread(module, 0);
+	return 0;
+}
+
+static void flusher_close_handles()
+{
+	if (flusher.thread) {
+		CloseHandle(flusher.thread);
+		flusher.thread = NULL;
+	}
+	if (flusher.wake) {
+		CloseHandle(flusher.wake);
+		flusher.wake = NULL;
+	}
+	if (flusher.done) {
+		CloseHandle(flusher.done);
+		flusher.done = NULL;
+	}
+}
+
+/* must be called under flusher's ctl_mux */
+static BOOL flusher_start()
+{
+	HMODULE module = NULL;
+
+	flusher.stop = FALSE;
+	if (! (flusher.wake = CreateEvent(NULL, /*manual*/FALSE, /*init*/FALSE,
+					NULL))) {
+		goto err;
+	}
+	if (! (flusher.done = CreateEvent(NULL, /*manual*/TRUE, /*init*/FALSE,
+					NULL))) {
+		goto err;
+	}
+	/* the thread's reference on the library */
+	if (! GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
+			(LPCWSTR)(void *)&flusher_run, &module)) {
+		goto err;
+	}
+	if (! (flusher.thread = CreateThread(NULL, 0, flusher_run, module, 0,
+					NULL))) {
+		goto err;
+	}
+	flusher.running = TRUE;
 	return TRUE;
+err:
+	ERRN("failed to start the log flusher.");
+	if (module) {
+		FreeLibrary(module);
+	}
+	flusher_close_handles();
+	return FALSE;
+}
+
+/*
+ * Started with the first environment handle: not from DllMain(), where the
+ * thread could only run once the loader lock is released, which wouldn't
+ * happen if the library is unloaded right away. Until started (or if it
+ * can't be), the messages are written synchronously.
+ */
+void log_flusher_start()
+{
+	ESODBC_MUX_LOCK(&flusher.ctl_mux);
+	if (! (flusher.users ++ || flusher.thread)) {
+		flusher_start();
+	}
+	ESODBC_MUX_UNLOCK(&flusher.ctl_mux);
+}
+
+/*
+ * Stopped with the last environment handle, also outside DllMain(): the
+ * thread can be waited on to exit, as it needs the loader lock to.
+ * What's still queued is written out by the thread, before exiting.
+ */
+void log_flusher_stop()
+{
+	ESODBC_MUX_LOCK(&flusher.ctl_mux);
+	assert(flusher.users);
+	if ((! -- flusher.users) && flusher.thread) {
+		flusher.running = FALSE;
+		flusher.stop = TRUE;
+		SetEvent(flusher.wake);
+		WaitForSingleObject(flusher.thread, INFINITE);
+		flusher_close_handles();
+	}
+	ESODBC_MUX_UNLOCK(&flusher.ctl_mux);
+}
+
+static BOOL flusher_add(esodbc_filelog_st *log)
+{
+	esodbc_filelog_st **r;
+	BOOL ret = FALSE;
+
+	ESODBC_MUX_LOCK(&flusher.mux);
+	if (! flusher.dead) {
+		r = realloc(flusher.logs, (flusher.cnt + 1) * sizeof(*r));
+		if (r) {
+			flusher.logs = r;
+			flusher.logs[flusher.cnt ++] = log;
+			ret = TRUE;
+		}
+	}
+	ESODBC_MUX_UNLOCK(&flusher.mux);
+	return ret;
+}
+
+/* once this returns, the flusher no longer accesses the logger */
+static void flusher_remove(esodbc_filelog_st *log)
+{
+	size_t i;
+
+	if (flusher.dead) {
+		return;
+	}
+	ESODBC_MUX_LOCK(&flusher.mux);
+	for (i = 0; i < flusher.cnt; i ++) {
+		if (flusher.logs[i] == log) {
+			flusher.cnt --;
+			memmove(&flusher.logs[i], &flusher.logs[i + 1],
+				(flusher.cnt - i) * sizeof(*flusher.logs));
+			break;
+		}
+	}
+	ESODBC_MUX_UNLOCK(&flusher.mux);
+}
+
+/*
+ * Called from DllMain(), on detach. Since the thread holds a reference on
+ * the library, it can only still be around if the process is terminating
+ * (the thread being terminated along) or if it's the thread itself
+ * releasing the last reference, once done with the flusher.
+ */
+static void flusher_stop()
+{
+	flusher.running = FALSE;
+	flusher.stop = TRUE;
+	if (flusher.thread) {
+		if (WaitForSingleObject(flusher.done, 0) != WAIT_OBJECT_0) {
+			flusher.dead = TRUE;
+		}
+		flusher_close_handles();
+	}
+	if (! flusher.dead) {
+		free(flusher.logs);
+		flusher.logs = NULL;
+		flusher.cnt = 0;
+	}
 }
 
 esodbc_filelog_st *filelog_new(wstr_st *path, int level)
@@ -260,6 +641,17 @@ esodbc_filelog_st *filelog_new(wstr_st *path, int level)
 	log->handle = INVALID_HANDLE_VALUE;
 	ESODBC_MUX_INIT(&log->mux);
 
+	/* set up the queue; if not possible, the logger writes synchronously */
+	log->ring = calloc(1, ESODBC_LOG_RING_SIZE + ESODBC_LOG_BATCH_SIZE);
+	if (log->ring) {
+		log->batch = log->ring + ESODBC_LOG_RING_SIZE;
+		if (! flusher_add(log)) {
+			free(log->ring);
+			log->ring = NULL;
+			log->batch = NULL;
+		}
+	}
+
 	if (LOG_LEVEL_INFO <= level) {
 #ifndef NDEBUG
 		_LOG(log, LOG_LEVEL_INFO, /*werr*/0, "level: %d, file: " LWPDL ".",
@@ -277,6 +669,20 @@ void filelog_del(esodbc_filelog_st *log)
 	if (! log) {
 		return;
 	}
+	if (log->ring) {
+		flusher_remove(log);
+		/* write out what's still queued; the mux could only be left
+		 * acquired by a terminated flusher */
+		if (! flusher.dead) {
+			ESODBC_MUX_LOCK(&log->mux);
+			filelog_drain(log);
+			ESODBC_MUX_UNLOCK(&log->mux);
+		} else if (ESODBC_MUX_TRYLOCK(&log->mux)) {
+			filelog_drain(log);
+			ESODBC_MUX_UNLOCK(&log->mux);
+		}
+		free(log->ring);
+	}
 	if (log->handle != INVALID_HANDLE_VALUE) {
 		CloseHandle(log->handle);
 	}
@@ -284,40 +690,6 @@ void filelog_del(esodbc_filelog_st *log)
 	free(log);
 }
 
-static BOOL filelog_write(esodbc_filelog_st *log, char *buff, size_t cnt)
-{
-	DWORD written;
-
-	/* write the buffer to file */
-	if (! WriteFile(
-			log->handle, /*handle*/
-			buff, /* buffer */
-			(DWORD)(cnt * sizeof(buff[0])), /*bytes to write */
-			&written /* bytes written */,
-			NULL /*overlap*/)) {
-		log->fails ++;
-		/* log into general logger, if available */
-		if (log != _gf_log) { /* avoid spin for general logger's first msg */
-			ERRN("failed writing into log file `" LWPD "`.", log->path);
-		}
-		if (filelog_reset(log)) {
-			/* reattempt the write, if reset is successfull */
-			if (filelog_write(log, buff, cnt)) {
-				log->fails = 0;
-				return TRUE;
-			}
-		}
-		return FALSE;
-	} else {
-#ifndef NDEBUG
-#ifdef _WIN32
-		//FlushFileBuffers(log->handle);
-#endif /* _WIN32 */
-#endif /* NDEBUG */
-	}
-	return TRUE;
-}
-
 static inline void filelog_log(esodbc_filelog_st *log,
 	int level, int werrno, const char *func, const char *srcfile, int lineno,
 	const char *fmt, va_list args)
@@ -335,6 +707,9 @@ static inline void filelog_log(esodbc_filelog_st *log,
 #	endif /* !WITH_EXTENDED_BUFF_LOG */
 	char ebuff[LOG_ERRNO_BUF_SIZE];
 	const char *sfile, *next;
+	/* timestamp is only formatted once a second (per thread) */
+	static thread_local time_t ts_secs = 0;
+	static thread_local char ts_buff[LOG_TIMESTAMP_LEN + /*\n\0*/2];
 	/* keep in sync with esodbc_log_levels */
 	static const char *level2str[] = { "ERROR", "WARN", "INFO", "DEBUG", };
 	assert(level < sizeof(level2str)/sizeof(level2str[0]));
@@ -359,20 +734,22 @@ static inline void filelog_log(esodbc_filelog_st *log,
 	}
 #	endif /* WITH_EXTENDED_BUFF_LOG */
 
-	if (ctime_s(buff, buff_sz, &now)) {
-		/* writing failed */
-		pos = 0;
-	} else {
-		pos = strnlen(buff, buff_sz) - /*\n*/1;
+	if (now != ts_secs) {
 		/*
 		 * https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/ctime-s-ctime32-s-ctime64-s-wctime-s-wctime32-s-wctime64-s :
 		 * """
 		 *  The return value string contains exactly 26 characters and has the
 		 *  form: Wed Jan 02 02:03:55 1980\n\0
 		 * """
-		 * Position on '\n'.
 		 */
-		assert(pos == 24);
+		ts_secs = ctime_s(ts_buff, sizeof(ts_buff), &now) ? 0 : now;
+	}
+	if (ts_secs) {
+		memcpy(buff, ts_buff, LOG_TIMESTAMP_LEN);
+		pos = LOG_TIMESTAMP_LEN; /* position on '\n' */
+	} else {
+		/* writing failed */
+		pos = 0;
 	}
 
 	/* drop path from source file name */
@@ -426,9 +803,18 @@ static inline void filelog_log(esodbc_filelog_st *log,
 	}
 	assert(pos <= buff_sz);
 
-	ESODBC_MUX_LOCK(&log->mux);
-	filelog_write(log, buff, pos);
-	ESODBC_MUX_UNLOCK(&log->mux);
+	if (log->ring && flusher.running && pos <= ESODBC_LOG_BUF_SIZE) {
+		filelog_enqueue(log, level, buff, pos);
+	} else {
+		ESODBC_MUX_LOCK(&log->mux);
+		if (log->ring) {
+			/* no flusher or (extended) message too large to queue: write
+			 * it right away, after what's already queued */
+			filelog_drain(log);
+		}
+		filelog_write(log, buff, pos);
+		ESODBC_MUX_UNLOCK(&log->mux);
+	}
 }
 
 void _esodbc_log(esodbc_filelog_st *log, int lvl, int werrno,
@@ -13,6 +13,7 @@
 
 #include "util.h"
 #include "error.h"
+#include "defs.h"
 
 
 /*
@@ -72,9 +73,28 @@ typedef struct struct_filelog {
 	HANDLE handle;
 	wchar_t *path;
 	unsigned char fails;
-	esodbc_mutex_lt mux;
+	esodbc_mutex_lt mux; /* serializes the writes into the file */
+	uint64_t size; /* bytes in current file */
+
+	/* Ring of variable-length records of formatted messages, written out in
+	 * batches by the background flusher; NULL if the logger writes
+	 * synchronously. There's one ring per logger, shared (lock-free) by all
+	 * the threads logging into it, rather than one per thread: a connection
+	 * is typically used by one thread at a time and a per-thread ring would
+	 * need registering with the flusher for each thread and logger. Memory
+	 * cost: ESODBC_LOG_RING_SIZE + ESODBC_LOG_BATCH_SIZE (40KB) per logger,
+	 * each connection's included. */
+	char *ring;
+	volatile LONG64 head; /* next byte to be claimed by a producer */
+	volatile LONG64 tail; /* next byte to write out; advanced under the mux */
+	volatile LONG dropped; /* messages dropped since last flush */
+	char *batch; /* ESODBC_LOG_BATCH_SIZE buffer to collate writes into */
 } esodbc_filelog_st;
 
+/* start/stop the background writer of the queued messages, with the
+ * first/last environment handle; not to be invoked from DllMain() */
+void log_flusher_start();
+void log_flusher_stop();
 esodbc_filelog_st *filelog_new(wstr_st *path, int level);
 void filelog_del(esodbc_filelog_st *log);
 
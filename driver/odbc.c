@@ -12,6 +12,7 @@
 #include "queries.h"
 #include "convert.h"
 #include "catalogue.h"
+#include "arrow.h"
 #include "tinycbor.h"
 
 
@@ -59,6 +60,7 @@ static BOOL driver_init()
 		return FALSE;
 	}
 	convert_init();
+	utf_init();
 	if (! connect_init()) {
 		return FALSE;
 	}
@@ -889,6 +891,23 @@ SQLRETURN  SQL_API SQLFetch(SQLHSTMT StatementHandle)
 	return ret;
 }
 
+/*
+ * Driver extension: export the result set as Arrow record batches (see
+ * arrow.h). Not known to the DM, so it's called with the driver's handle.
+ */
+SQLRETURN SQL_API SQLFetchArrow(SQLHSTMT StatementHandle,
+	struct ArrowSchema *Schema, struct ArrowArray *Array)
+{
+	SQLRETURN ret;
+	TRACE3(_IN, StatementHandle, "ppp", StatementHandle, Schema, Array);
+	HND_LOCK(StatementHandle);
+	ret = EsSQLFetchArrow(StatementHandle, Schema, Array);
+	HND_UNLOCK(StatementHandle);
+	TRACE4(_OUT, StatementHandle, "dppp", ret, StatementHandle, Schema,
+		Array);
+	return ret;
+}
+
 /*
  * "SQLFetch and SQLFetchScroll use the rowset size at the time of the call to
  * determine how many rows to fetch. However, SQLFetchScroll with a
@@ -991,8 +1010,9 @@ SQLRETURN SQL_API SQLMoreResults(SQLHSTMT StatementHandle)
 {
 	SQLRETURN ret;
 	TRACE1(_IN, StatementHandle, "p", StatementHandle);
-	/* no synchronization required */
+	HND_LOCK(StatementHandle);
 	ret = EsSQLMoreResults(StatementHandle);
+	HND_UNLOCK(StatementHandle);
 	TRACE2(_OUT, StatementHandle, "dp", ret, StatementHandle);
 	return ret;
 }
@@ -1357,9 +1377,8 @@ SQLRETURN  SQL_API SQLCancel(SQLHSTMT StatementHandle)
 {
 	SQLRETURN ret;
 	TRACE1(_IN, StatementHandle, "p", StatementHandle);
-	HND_LOCK(StatementHandle);
+	/* no locking: the handle is likely locked by the function to cancel */
 	ret = EsSQLCancel(StatementHandle);
-	HND_UNLOCK(StatementHandle);
 	TRACE2(_OUT, StatementHandle, "dp", ret, StatementHandle);
 	return ret;
 }
@@ -1369,9 +1388,8 @@ SQLRETURN  SQL_API SQLCancelHandle(SQLSMALLINT HandleType,
 {
 	SQLRETURN ret;
 	TRACE2(_IN, InputHandle, "hp", HandleType, InputHandle);
-	HND_LOCK(InputHandle);
+	/* no locking: see SQLCancel() */
 	ret = EsSQLCancelHandle(HandleType, InputHandle);
-	HND_UNLOCK(InputHandle);
 	TRACE3(_IN, InputHandle, "dhp", ret, HandleType, InputHandle);
 	return ret;
 }
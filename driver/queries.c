@@ -5,6 +5,7 @@
  */
 
 #include <float.h>
+#include <process.h> /* _beginthreadex() */
 
 #include <cborinternal_p.h> /* for decode_half() */
 
@@ -17,6 +18,7 @@
 /* key names used in Elastic/SQL REST/JSON answers */
 #define PACK_PARAM_COLUMNS		"columns"
 #define PACK_PARAM_ROWS			"rows"
+#define PACK_PARAM_VALUES		"values"
 #define PACK_PARAM_CURSOR		"cursor"
 #define PACK_PARAM_STATUS		"status"
 #define PACK_PARAM_ERROR		"error"
@@ -172,7 +174,13 @@ void clear_resultset(esodbc_stmt_st *stmt, BOOL on_close)
 		if (stmt->rset.pack.json.state) {
 			UJFree(stmt->rset.pack.json.state);
 		}
+		if (stmt->rset.pack.json.vals_iter) {
+			free(stmt->rset.pack.json.vals_iter);
+		}
 	} else {
+		if (stmt->rset.pack.cbor.vals_iter) {
+			free(stmt->rset.pack.cbor.vals_iter);
+		}
 		if (stmt->rset.pack.cbor.cols_buff.cnt) {
 			assert(stmt->rset.pack.cbor.cols_buff.str);
 			free(stmt->rset.pack.cbor.cols_buff.str);
@@ -384,13 +392,102 @@ err:
 	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
 }
 
+/* set the internal cursor (UJSON4C array iterator) over the rows */
+static void attach_rows_json(esodbc_stmt_st *stmt, UJObject rows)
+{
+	stmt->rset.pack.json.rows_iter = UJBeginArray(rows);
+	/* UJSON4C will return NULL above, for empty array (meh!) */
+	if (! stmt->rset.pack.json.rows_iter) {
+		STMT_FORCE_NODATA(stmt);
+	}
+	/* save the object, as it might be required by EsSQLRowCount() */
+	stmt->rset.pack.json.rows_obj = rows;
+	/* unlike with tinycbor, the count is readily available with ujson4c
+	 * (since the lib parses the entire JSON object upfront) => keep it in
+	 * Release builds. */
+	INFOH(stmt, "rows received in current (#%zu) result set: %d.",
+		stmt->nset + 1, UJLengthArray(rows));
+}
+
+/*
+ * Set the internal cursors over a column-major result set ("values"): one
+ * UJSON4C iterator per column array, all advanced together when a row is
+ * unpacked. Requires the columns to be attached already.
+ */
+static SQLRETURN attach_values_json(esodbc_stmt_st *stmt, UJObject values)
+{
+	void *iter;
+	UJObject col;
+	SQLSMALLINT i;
+	int nrows;
+
+	stmt->rset.columnar = TRUE;
+	/* ES sends an empty array if a (subsequent) page has no rows */
+	if (! (iter = UJBeginArray(values))) {
+		STMT_FORCE_NODATA(stmt);
+		return SQL_SUCCESS;
+	}
+	if (UJLengthArray(values) != stmt->ird->count) {
+		ERRH(stmt, "received %d value arrays for %hd columns.",
+			UJLengthArray(values), stmt->ird->count);
+		goto err;
+	}
+	stmt->rset.pack.json.vals_iter = malloc(stmt->ird->count *
+			sizeof(*stmt->rset.pack.json.vals_iter));
+	if (! stmt->rset.pack.json.vals_iter) {
+		ERRNH(stmt, "OOM for %hd iterators.", stmt->ird->count);
+		RET_HDIAGS(stmt, SQL_STATE_HY001);
+	}
+
+	nrows = -1;
+	for (i = 0; UJIterArray(&iter, &col); i ++) {
+		if (! UJIsArray(col)) {
+			ERRH(stmt, "'" PACK_PARAM_VALUES "' element #%hd not an array; "
+				"type: %d.", i, UJGetType(col));
+			goto err;
+		}
+		/* all columns must be equally long */
+		if (nrows < 0) {
+			nrows = UJLengthArray(col);
+		} else if (nrows != UJLengthArray(col)) {
+			ERRH(stmt, "column #%hd counts %d values, instead of %d.", i + 1,
+				UJLengthArray(col), nrows);
+			goto err;
+		}
+		/* NULL for an empty array, which won't be iterated over though */
+		stmt->rset.pack.json.vals_iter[i] = UJBeginArray(col);
+	}
+	stmt->rset.nrows = (size_t)nrows;
+	if (! nrows) {
+		STMT_FORCE_NODATA(stmt);
+	}
+	INFOH(stmt, "rows received in current (#%zu) columnar result set: %d.",
+		stmt->nset + 1, nrows);
+	return SQL_SUCCESS;
+err:
+	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
+}
+
+static void attach_cursor_json(esodbc_stmt_st *stmt, UJObject cursor)
+{
+	/* should have been cleared by now */
+	assert(! stmt->rset.pack.json.curs.cnt);
+	/* store new cursor vals */
+	stmt->rset.pack.json.curs.str =
+		(SQLWCHAR *)UJReadString(cursor, &stmt->rset.pack.json.curs.cnt);
+	DBGH(stmt, "new paginating cursor: [%zd] `" LWPDL "`.",
+		stmt->rset.pack.json.curs.cnt, LWSTR(&stmt->rset.pack.json.curs));
+}
+
 static SQLRETURN attach_answer_json(esodbc_stmt_st *stmt)
 {
+	SQLRETURN ret;
 	int unpacked;
-	UJObject obj, columns, rows, cursor;
+	UJObject obj, columns, rows, values, cursor;
 	const wchar_t *keys[] = {
 		MK_WPTR(PACK_PARAM_COLUMNS),
 		MK_WPTR(PACK_PARAM_ROWS),
+		MK_WPTR(PACK_PARAM_VALUES),
 		MK_WPTR(PACK_PARAM_CURSOR)
 	};
 
@@ -407,47 +504,33 @@ static SQLRETURN attach_answer_json(esodbc_stmt_st *stmt)
 			stmt->rset.body.cnt, LCSTR(&stmt->rset.body));
 		goto err;
 	}
-	columns = rows = cursor = NULL;
-	/* extract the columns and rows objects */
-	unpacked = UJObjectUnpack(obj, 3, "AAS", keys, &columns, &rows, &cursor);
-	if (unpacked < /* 'rows' must always be present */1) {
+	columns = rows = values = cursor = NULL;
+	/* extract the columns and rows (or column values) objects */
+	unpacked = UJObjectUnpack(obj, 4, "AAAS", keys, &columns, &rows, &values,
+			&cursor);
+	if (unpacked < /* 'rows'/'values' must always be present */1) {
 		ERRH(stmt, "failed to unpack JSON answer: %s (`" LCPDL "`).",
 			UJGetError(stmt->rset.pack.json.state), LCSTR(&stmt->rset.body));
 		goto err;
 	}
 
 	/*
-	 * set the internal cursor (UJSON4C array iterator)
+	 * set the internal cursor (UJSON4C array iterator); a column-major
+	 * result set is only iterable once its columns are known.
 	 */
-	if (! rows) {
+	if (rows) {
+		attach_rows_json(stmt, rows);
+	} else if (! values) {
 		ERRH(stmt, "no rows object received in answer: `" LCPDL "`.",
 			LCSTR(&stmt->rset.body));
 		goto err;
 	}
-	stmt->rset.pack.json.rows_iter = UJBeginArray(rows);
-	/* UJSON4C will return NULL above, for empty array (meh!) */
-	if (! stmt->rset.pack.json.rows_iter) {
-		STMT_FORCE_NODATA(stmt);
-	}
-	/* save the object, as it might be required by EsSQLRowCount() */
-	stmt->rset.pack.json.rows_obj = rows;
-	/* unlike with tinycbor, the count is readily available with ujson4c
-	 * (since the lib parses the entire JSON object upfront) => keep it in
-	 * Release builds. */
-	INFOH(stmt, "rows received in current (#%zu) result set: %d.",
-		stmt->nset + 1, UJLengthArray(rows));
 
 	/*
 	 * copy ref to ES'es cursor (if there's one)
 	 */
 	if (cursor) {
-		/* should have been cleared by now */
-		assert(! stmt->rset.pack.json.curs.cnt);
-		/* store new cursor vals */
-		stmt->rset.pack.json.curs.str =
-			(SQLWCHAR *)UJReadString(cursor, &stmt->rset.pack.json.curs.cnt);
-		DBGH(stmt, "new paginating cursor: [%zd] `" LWPDL "`.",
-			stmt->rset.pack.json.curs.cnt, LWSTR(&stmt->rset.pack.json.curs));
+		attach_cursor_json(stmt, cursor);
 	}
 
 	/*
@@ -458,10 +541,14 @@ static SQLRETURN attach_answer_json(esodbc_stmt_st *stmt)
 			ERRH(stmt, "%d columns already attached.", stmt->ird->count);
 			goto err;
 		}
-		return attach_columns_json(stmt, columns);
+		ret = attach_columns_json(stmt, columns);
+		if (! SQL_SUCCEEDED(ret)) {
+			return ret;
+		}
 	}
 
-	return SQL_SUCCESS;
+	return values && (! rows) ? attach_values_json(stmt, values) :
+		SQL_SUCCESS;
 err:
 	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
 }
@@ -647,28 +734,194 @@ err:
 	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
 }
 
+/* set the internal "rows" cursor (tinycbor array object) */
+static SQLRETURN attach_rows_cbor(esodbc_stmt_st *stmt, CborValue rows_obj)
+{
+	CborError res;
+	BOOL empty;
+#	ifndef NDEBUG
+	size_t nrows;
+#	endif /* !NDEBUG */
+
+	/* check that we have a valid array object for "rows" */
+	if (! cbor_value_is_array(&rows_obj)) {
+		ERRH(stmt, "no '" PACK_PARAM_ROWS "' array object received in "
+			"answer: `%s`.", cstr_hex_dump(&stmt->rset.body));
+		goto err;
+	}
+	/* save the object, as it might be required by EsSQLRowCount() */
+	stmt->rset.pack.cbor.rows_obj = rows_obj;
+
+	/* ES uses indefinite-length arrays -- meh. */
+	res = cbor_container_is_empty(rows_obj, &empty);
+	CHK_RES(stmt, "failed to check if '" PACK_PARAM_ROWS "' array is empty");
+	if (empty) {
+		STMT_FORCE_NODATA(stmt);
+	} else {
+		/* Note: "expensive", as it requires ad-hoc parsing; so only keep for
+		 * debugging (switching to JSON should be easy if troubleshooting) */
+#		ifndef NDEBUG
+		res = cbor_get_array_count(rows_obj, &nrows);
+		CHK_RES(stmt, "failed to fetch '" PACK_PARAM_ROWS "' array length");
+		INFOH(stmt, "rows received in current (#%zu) result set: %zu.",
+			stmt->nset + 1, nrows);
+#		endif /* NDEBUG */
+		/* prepare iterator for EsSQLFetch(); recursing object and iterator
+		 * can be the same, since there's no need to "leave" the container. */
+		res = cbor_value_enter_container(&rows_obj, &rows_obj);
+		CHK_RES(stmt, "failed to access '" PACK_PARAM_ROWS "' container");
+		stmt->rset.pack.cbor.rows_iter = rows_obj;
+	}
+	return SQL_SUCCESS;
+err:
+	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
+}
+
+/*
+ * Set the internal cursors over a column-major result set ("values"): one
+ * tinycbor iterator per column array, all advanced together when a row is
+ * unpacked. Requires the columns to be attached already.
+ * Since the arrays can only be reached sequentially, each is walked through
+ * once here, which also validates that all columns are equally long.
+ */
+static SQLRETURN attach_values_cbor(esodbc_stmt_st *stmt, CborValue vals_obj)
+{
+	CborError res;
+	CborValue it, col;
+	SQLSMALLINT i;
+	size_t n, nrows;
+	BOOL empty;
+
+	stmt->rset.columnar = TRUE;
+	if (! cbor_value_is_array(&vals_obj)) {
+		ERRH(stmt, "'" PACK_PARAM_VALUES "' object received is not an "
+			"array: `%s`.", cstr_hex_dump(&stmt->rset.body));
+		goto err;
+	}
+	res = cbor_container_is_empty(vals_obj, &empty);
+	CHK_RES(stmt, "failed to check if '" PACK_PARAM_VALUES "' array is "
+		"empty");
+	/* ES sends an empty array if a (subsequent) page has no rows */
+	if (empty) {
+		STMT_FORCE_NODATA(stmt);
+		return SQL_SUCCESS;
+	}
+
+	stmt->rset.pack.cbor.vals_iter = malloc(stmt->ird->count *
+			sizeof(*stmt->rset.pack.cbor.vals_iter));
+	if (! stmt->rset.pack.cbor.vals_iter) {
+		ERRNH(stmt, "OOM for %hd iterators.", stmt->ird->count);
+		RET_HDIAGS(stmt, SQL_STATE_HY001);
+	}
+
+	res = cbor_value_enter_container(&vals_obj, &it);
+	CHK_RES(stmt, "failed to access '" PACK_PARAM_VALUES "' container");
+	nrows = 0;
+	for (i = 0; ! cbor_value_at_end(&it); i ++) {
+		if (stmt->ird->count <= i) {
+			ERRH(stmt, "more value arrays received than columns (%hd).",
+				stmt->ird->count);
+			goto err;
+		}
+		if (! cbor_value_is_array(&it)) {
+			ERRH(stmt, "'" PACK_PARAM_VALUES "' element #%hd not an array; "
+				"type: 0x%x.", i, cbor_value_get_type(&it));
+			goto err;
+		}
+		res = cbor_value_enter_container(&it, &col);
+		CHK_RES(stmt, "failed to enter value array #%hd", i);
+		stmt->rset.pack.cbor.vals_iter[i] = col;
+		for (n = 0; ! cbor_value_at_end(&col); n ++) {
+			if (cbor_value_is_tag(&col)) {
+				res = cbor_value_skip_tag(&col);
+				CHK_RES(stmt, "failed to skip tag in value array #%hd", i);
+			}
+			res = cbor_value_advance(&col);
+			CHK_RES(stmt, "failed to advance in value array #%hd", i);
+		}
+		if (! i) {
+			nrows = n;
+		} else if (n != nrows) {
+			ERRH(stmt, "column #%hd counts %zu values, instead of %zu.",
+				i + 1, n, nrows);
+			goto err;
+		}
+		res = cbor_value_leave_container(&it, &col);
+		CHK_RES(stmt, "failed to exit value array #%hd", i);
+	}
+	if (i != stmt->ird->count) {
+		ERRH(stmt, "received %hd value arrays for %hd columns.", i,
+			stmt->ird->count);
+		goto err;
+	}
+
+	stmt->rset.nrows = nrows;
+	if (! nrows) {
+		STMT_FORCE_NODATA(stmt);
+	}
+	INFOH(stmt, "rows received in current (#%zu) columnar result set: %zu.",
+		stmt->nset + 1, nrows);
+	return SQL_SUCCESS;
+err:
+	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
+}
+
+static SQLRETURN attach_cursor_cbor(esodbc_stmt_st *stmt, CborValue *curs_obj)
+{
+	CborError res;
+	CborType obj_type;
+
+	obj_type = cbor_value_get_type(curs_obj);
+	if (obj_type != CborTextStringType) {
+		ERRH(stmt, "invalid '" PACK_PARAM_CURSOR "' parameter type "
+			"(0x%x)", obj_type);
+		RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
+	}
+	/* should have been cleared by now */
+	assert(! stmt->rset.pack.cbor.curs.cnt);
+	res = cbor_value_get_unchunked_string(curs_obj,
+			&stmt->rset.pack.cbor.curs.str,
+			&stmt->rset.pack.cbor.curs.cnt);
+	if (res == CborErrorUnknownLength) {
+		assert(stmt->rset.pack.cbor.curs_allocd == false);
+		/* cursor is in chunked string; get it assembled in one chunk */
+		res = cbor_value_dup_text_string(curs_obj,
+				&stmt->rset.pack.cbor.curs.str,
+				&stmt->rset.pack.cbor.curs.cnt,
+				curs_obj);
+		if (res == CborNoError) {
+			stmt->rset.pack.cbor.curs_allocd = true;
+		}
+	}
+	CHK_RES(stmt, "failed to read '" PACK_PARAM_CURSOR "' value");
+	DBGH(stmt, "new paginating cursor: [%zd] `" LCPDL "`.",
+		stmt->rset.pack.cbor.curs.cnt, LWSTR(&stmt->rset.pack.cbor.curs));
+	return SQL_SUCCESS;
+err:
+	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, res);
+}
+
 static SQLRETURN attach_answer_cbor(esodbc_stmt_st *stmt)
 {
+	SQLRETURN ret;
 	CborError res;
 	CborParser parser;
-	CborValue top_obj, cols_obj, curs_obj, rows_obj;
+	CborValue top_obj, cols_obj, curs_obj, rows_obj, vals_obj;
 	CborType obj_type;
 	const char *keys[] = {
 		PACK_PARAM_COLUMNS,
 		PACK_PARAM_CURSOR,
 		PACK_PARAM_ROWS,
+		PACK_PARAM_VALUES,
 	};
 	size_t keys_no = sizeof(keys) / sizeof(keys[0]);
 	const size_t lens[] = {
 		sizeof(PACK_PARAM_COLUMNS) - 1,
 		sizeof(PACK_PARAM_CURSOR) - 1,
 		sizeof(PACK_PARAM_ROWS) - 1,
+		sizeof(PACK_PARAM_VALUES) - 1,
 	};
-	CborValue *vals[] = {&cols_obj, &curs_obj, &rows_obj};
-	BOOL empty;
-#	ifndef NDEBUG
-	size_t nrows;
-#	endif /* !NDEBUG */
+	CborValue *vals[] = {&cols_obj, &curs_obj, &rows_obj, &vals_obj};
 
 	DBGH(stmt, "attaching CBOR answer: [%zu] `%s`.", stmt->rset.body.cnt,
 		cstr_hex_dump(&stmt->rset.body));
@@ -694,67 +947,24 @@ static SQLRETURN attach_answer_cbor(esodbc_stmt_st *stmt)
 	CHK_RES(stmt, "failed to lookup answer keys in map");
 
 	/*
-	 * set the internal "rows" cursor (tinycbor array object)
+	 * set the internal "rows" cursor; a column-major result set is only
+	 * iterable once its columns are known.
 	 */
-	/* check that we have a valid array object for "rows" */
-	if (! cbor_value_is_array(&rows_obj)) {
-		ERRH(stmt, "no '" PACK_PARAM_ROWS "' array object received in "
-			"answer: `%s`.", cstr_hex_dump(&stmt->rset.body));
-		goto err;
-	}
-	/* save the object, as it might be required by EsSQLRowCount() */
-	stmt->rset.pack.cbor.rows_obj = rows_obj;
-
-	/* ES uses indefinite-length arrays -- meh. */
-	res = cbor_container_is_empty(rows_obj, &empty);
-	CHK_RES(stmt, "failed to check if '" PACK_PARAM_ROWS "' array is empty");
-	if (empty) {
-		STMT_FORCE_NODATA(stmt);
-	} else {
-		/* Note: "expensive", as it requires ad-hoc parsing; so only keep for
-		 * debugging (switching to JSON should be easy if troubleshooting) */
-#		ifndef NDEBUG
-		res = cbor_get_array_count(rows_obj, &nrows);
-		CHK_RES(stmt, "failed to fetch '" PACK_PARAM_ROWS "' array length");
-		INFOH(stmt, "rows received in current (#%zu) result set: %zu.",
-			stmt->nset + 1, nrows);
-#		endif /* NDEBUG */
-		/* prepare iterator for EsSQLFetch(); recursing object and iterator
-		 * can be the same, since there's no need to "leave" the container. */
-		res = cbor_value_enter_container(&rows_obj, &rows_obj);
-		CHK_RES(stmt, "failed to access '" PACK_PARAM_ROWS "' container");
-		stmt->rset.pack.cbor.rows_iter = rows_obj;
+	if (! cbor_value_is_valid(&vals_obj)) {
+		ret = attach_rows_cbor(stmt, rows_obj);
+		if (! SQL_SUCCEEDED(ret)) {
+			return ret;
+		}
 	}
 
 	/*
 	 * copy ref to ES'es cursor (if there's one)
 	 */
 	if (cbor_value_is_valid(&curs_obj)) {
-		obj_type = cbor_value_get_type(&curs_obj);
-		if (obj_type != CborTextStringType) {
-			ERRH(stmt, "invalid '" PACK_PARAM_CURSOR "' parameter type "
-				"(0x%x)", obj_type);
-			goto err;
-		}
-		/* should have been cleared by now */
-		assert(! stmt->rset.pack.cbor.curs.cnt);
-		res = cbor_value_get_unchunked_string(&curs_obj,
-				&stmt->rset.pack.cbor.curs.str,
-				&stmt->rset.pack.cbor.curs.cnt);
-		if (res == CborErrorUnknownLength) {
-			assert(stmt->rset.pack.cbor.curs_allocd == false);
-			/* cursor is in chunked string; get it assembled in one chunk */
-			res = cbor_value_dup_text_string(&curs_obj,
-					&stmt->rset.pack.cbor.curs.str,
-					&stmt->rset.pack.cbor.curs.cnt,
-					&curs_obj);
-			if (res == CborNoError) {
-				stmt->rset.pack.cbor.curs_allocd = true;
-			}
+		ret = attach_cursor_cbor(stmt, &curs_obj);
+		if (! SQL_SUCCEEDED(ret)) {
+			return ret;
 		}
-		CHK_RES(stmt, "failed to read '" PACK_PARAM_CURSOR "' value");
-		DBGH(stmt, "new paginating cursor: [%zd] `" LCPDL "`.",
-			stmt->rset.pack.cbor.curs.cnt, LWSTR(&stmt->rset.pack.cbor.curs));
 	}
 
 	/*
@@ -765,10 +975,14 @@ static SQLRETURN attach_answer_cbor(esodbc_stmt_st *stmt)
 			ERRH(stmt, "%d columns already attached.", stmt->ird->count);
 			goto err;
 		}
-		return attach_columns_cbor(stmt, cols_obj);
+		ret = attach_columns_cbor(stmt, cols_obj);
+		if (! SQL_SUCCEEDED(ret)) {
+			return ret;
+		}
 	}
 
-	return SQL_SUCCESS;
+	return cbor_value_is_valid(&vals_obj) ?
+		attach_values_cbor(stmt, vals_obj) : SQL_SUCCESS;
 err:
 	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, res);
 }
@@ -901,6 +1115,7 @@ SQLRETURN TEST_API attach_answer(esodbc_stmt_st *stmt, cstr_st *answer,
 {
 	SQLRETURN ret;
 	size_t old_ird_cnt;
+	LONG64 start;
 
 	/* clear any previous result set */
 	if (STMT_HAS_RESULTSET(stmt)) {
@@ -911,7 +1126,9 @@ SQLRETURN TEST_API attach_answer(esodbc_stmt_st *stmt, cstr_st *answer,
 	stmt->rset.body = *answer;
 	stmt->rset.pack_json = is_json;
 	old_ird_cnt = stmt->ird->count;
+	start = perf_clock();
 	ret = is_json ? attach_answer_json(stmt) : attach_answer_cbor(stmt);
+	STMT_PERF_LAPSE(stmt, ESODBC_PERF_TIME_PARSE, start);
 
 	/* check if the columns either have just or had already been attached */
 	if (SQL_SUCCEEDED(ret)) {
@@ -927,12 +1144,69 @@ SQLRETURN TEST_API attach_answer(esodbc_stmt_st *stmt, cstr_st *answer,
 			DBGH(stmt, "empty result set received.");
 		} else {
 			stmt->nset ++;
+			STMT_PERF_COUNT(stmt, ESODBC_PERF_PAGES, 1);
 		}
 	}
 
 	return ret;
 }
 
+/*
+ * Take over an answer only for the ES cursor it carries (if any), with no
+ * result set being attached: the columns and rows aren't looked at. The
+ * body is released along with the (otherwise empty) result set.
+ */
+static SQLRETURN attach_cursor(esodbc_stmt_st *stmt, cstr_st *answer,
+	BOOL is_json)
+{
+	UJObject obj, cursor;
+	const wchar_t *wkeys[] = {MK_WPTR(PACK_PARAM_CURSOR)};
+	CborError res;
+	CborParser parser;
+	CborValue top_obj, curs_obj;
+	const char *keys[] = {PACK_PARAM_CURSOR};
+	const size_t lens[] = {sizeof(PACK_PARAM_CURSOR) - 1};
+	CborValue *vals[] = {&curs_obj};
+
+	if (STMT_HAS_RESULTSET(stmt)) {
+		clear_resultset(stmt, /*on_close*/FALSE);
+	}
+	/* the statement takes ownership of mem obj */
+	stmt->rset.body = *answer;
+	stmt->rset.pack_json = is_json;
+
+	if (is_json) {
+		obj = UJDecode(answer->str, answer->cnt, NULL,
+				&stmt->rset.pack.json.state);
+		if (! obj) {
+			ERRH(stmt, "failed to decode JSON answer: %s.",
+				stmt->rset.pack.json.state ?
+				UJGetError(stmt->rset.pack.json.state) : "<none>");
+			RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
+		}
+		cursor = NULL;
+		if (0 < UJObjectUnpack(obj, 1, "S", wkeys, &cursor) && cursor) {
+			attach_cursor_json(stmt, cursor);
+		}
+		return SQL_SUCCESS;
+	}
+
+	res = cbor_parser_init(answer->str, answer->cnt, ES_CBOR_PARSE_FLAGS,
+			&parser, &top_obj);
+	CHK_RES(stmt, "failed to init CBOR parser for object: [%zu] `%s`",
+		answer->cnt, cstr_hex_dump(answer));
+	if (cbor_value_get_type(&top_obj) != CborMapType) {
+		ERRH(stmt, "top object is not a map.");
+		RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, 0);
+	}
+	res = cbor_map_lookup_keys(&top_obj, 1, keys, lens, vals);
+	CHK_RES(stmt, "failed to lookup answer keys in map");
+	return cbor_value_is_valid(&curs_obj) ?
+		attach_cursor_cbor(stmt, &curs_obj) : SQL_SUCCESS;
+err:
+	RET_HDIAG(stmt, SQL_STATE_HY000, MSG_INV_SRV_ANS, res);
+}
+
 static BOOL attach_error_json(SQLHANDLE hnd, cstr_st *body)
 {
 	BOOL ret;
@@ -1143,6 +1417,8 @@ void detach_sql(esodbc_stmt_st *stmt)
 	free(stmt->u8sql.str);
 	stmt->u8sql.str = NULL;
 	stmt->u8sql.cnt = 0;
+	/* the template's tail remains usable for cursor requests */
+	stmt->tmpl.query = FALSE;
 }
 
 
@@ -1308,14 +1584,34 @@ static SQLRETURN set_row_diag(esodbc_desc_st *ird,
 }
 
 /*
- * Copy one row from IRD to ARD.
+ * Copy the value overriding the received ones of a column into the ARD.
+ * pos, rowno, colno: as for copy_one_cell_json()/_cbor()
+ */
+static SQLRETURN copy_override(esodbc_stmt_st *stmt, esodbc_rec_st *arec,
+	esodbc_rec_st *irec, SQLULEN pos, size_t rowno, SQLINTEGER colno)
+{
+	SQLRETURN ret;
+
+	DBGH(stmt, "value [%zd, %d] overridden: %lld.", rowno, colno,
+		irec->ovr.val);
+	ret = sql2c_longlong(arec, irec, pos, irec->ovr.val);
+	if (ret != SQL_SUCCESS) {
+		stmt->hdr.diag.row_number = rowno;
+		stmt->hdr.diag.column_number = colno;
+	}
+	return ret;
+}
+
+/*
+ * Copy one value from IRD to ARD.
  * pos: row number in the rowset
+ * rowno, colno: (result set) row and column number of the value, to set in
+ * the diagnostic
  */
-SQLRETURN copy_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
+static SQLRETURN copy_one_cell_json(esodbc_stmt_st *stmt, esodbc_rec_st *arec,
+	esodbc_rec_st *irec, UJObject obj, SQLULEN pos, size_t rowno,
+	SQLINTEGER colno)
 {
-	SQLINTEGER i;
-	size_t rowno;
-	UJObject obj;
 	SQLRETURN ret;
 	SQLLEN *ind_len;
 	long long ll;
@@ -1324,23 +1620,113 @@ SQLRETURN copy_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
 	const wchar_t *wstr;
 	BOOL boolval;
 	size_t len;
-	BOOL with_info;
-	esodbc_desc_st *ard, *ird;
-	esodbc_rec_st *arec, *irec;
 
-	ard = stmt->ard;
-	ird = stmt->ird;
-	rowno = stmt->tv_rows
-		+ STMT_GD_CALLING(stmt)
-		? /* SQLFetch() executed already, row counted */0
-		: /* SQLFetch() in progress, current row not yet counted */1;
+	if (irec->ovr.set) {
+		return copy_override(stmt, arec, irec, pos, rowno, colno);
+	}
 
-	with_info = FALSE;
-	/* iterate over the bound cols of one (table) row */
-	assert((! STMT_GD_CALLING(stmt)) || 0 < stmt->gd_col);
-	for (i = STMT_GD_CALLING(stmt) ? stmt->gd_col -1 : 0; i < ard->count;
-		i ++) {
-		arec = &ard->recs[i]; /* access safe if 'i < ard->count' */
+	switch (UJGetType(obj)) {
+		default:
+			ERRH(stmt, "unexpected object of type %d in row L#%zu/T#%zd.",
+				UJGetType(obj), stmt->rset.vrows, rowno);
+			return set_row_diag(stmt->ird, SQL_STATE_HY000, MSG_INV_SRV_ANS,
+					pos, colno);
+
+		case UJT_Null:
+			DBGH(stmt, "value [%zd, %d] is NULL.", rowno, colno);
+			ind_len = planned_address(SQL_DESC_INDICATOR_PTR, pos, arec,
+					irec);
+			if (! ind_len) {
+				ERRH(stmt, "no buffer to signal NULL value.");
+				return set_row_diag(stmt->ird, SQL_STATE_22002, NULL, pos,
+						colno);
+			}
+			if (arec->es_type && (! arec->es_type->nullable)) {
+				WARNH(stmt, "returning NULL for non-nullable type.");
+			}
+			*ind_len = SQL_NULL_DATA;
+			return SQL_SUCCESS; /* no 'ret' processing to do */
+
+		case UJT_String:
+			wstr = UJReadString(obj, &len);
+			DBGH(stmt, "value [%zd, %d] is string: [%d] `" LWPDL "`.",
+				rowno, colno, len, len, wstr);
+			/* UJSON4C returns chars count, but 0-terminates w/o counting
+			 * the terminator */
+			assert(wstr[len] == '\0');
+			/* "When character data is returned from the driver to the
+			 * application, the driver must always null-terminate it." */
+			ret = sql2c_string(arec, irec, pos, wstr, len + /*\0*/1);
+			break;
+
+		case UJT_Long:
+		case UJT_LongLong:
+			ll = UJNumericLongLong(obj);
+			DBGH(stmt, "value [%zd, %d] is integer: %lld.", rowno, colno,
+				ll);
+			ret = sql2c_longlong(arec, irec, pos, ll);
+			break;
+
+		case UJT_UnsignedLongLong:
+			ull = UJNumericUnsignedLongLong(obj);
+			DBGH(stmt, "value [%zd, %d] is unsigned long long: %llu.",
+					rowno, colno, ull);
+			ret = sql2c_quadword(arec, irec, pos, ull, /*unsigned*/true);
+			break;
+
+		case UJT_Double:
+			dbl = UJNumericFloat(obj);
+			DBGH(stmt, "value [%zd, %d] is double: %f.", rowno, colno,
+				dbl);
+			ret = sql2c_double(arec, irec, pos, dbl);
+			break;
+
+		case UJT_True:
+		case UJT_False:
+			boolval = UJGetType(obj) == UJT_True ? TRUE : FALSE;
+			DBGH(stmt, "value [%zd, %d] is boolean: %d.", rowno, colno,
+				boolval);
+			/* "When bit SQL data is converted to character C data, the
+			 * possible values are "0" and "1"." */
+			ret = sql2c_longlong(arec, irec, pos, boolval ? 1LL : 0LL);
+			break;
+	}
+
+	/* set the (row, column) details in the diagnostic, in case the value
+	 * copying isn't a clean success (i.e. success with info or an error) */
+	if (ret != SQL_SUCCESS) {
+		stmt->hdr.diag.row_number = rowno;
+		stmt->hdr.diag.column_number = colno;
+	}
+	return ret;
+}
+
+/*
+ * Copy one row from IRD to ARD.
+ * pos: row number in the rowset
+ */
+SQLRETURN copy_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
+{
+	SQLINTEGER i;
+	size_t rowno;
+	SQLRETURN ret;
+	BOOL with_info;
+	esodbc_desc_st *ard, *ird;
+	esodbc_rec_st *arec, *irec;
+
+	ard = stmt->ard;
+	ird = stmt->ird;
+	rowno = stmt->tv_rows
+		+ STMT_GD_CALLING(stmt)
+		? /* SQLFetch() executed already, row counted */0
+		: /* SQLFetch() in progress, current row not yet counted */1;
+
+	with_info = FALSE;
+	/* iterate over the bound cols of one (table) row */
+	assert((! STMT_GD_CALLING(stmt)) || 0 < stmt->gd_col);
+	for (i = STMT_GD_CALLING(stmt) ? stmt->gd_col -1 : 0; i < ard->count;
+		i ++) {
+		arec = &ard->recs[i]; /* access safe if 'i < ard->count' */
 		/* if record not bound skip it */
 		if (! REC_IS_BOUND(arec)) {
 			DBGH(stmt, "column #%d not bound, skipping it.", i + 1);
@@ -1356,88 +1742,16 @@ SQLRETURN copy_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
 			irec = &ird->recs[i];
 		}
 
-		obj = irec->i_val.json;
-		switch (UJGetType(obj)) {
-			default:
-				ERRH(stmt, "unexpected object of type %d in row L#%zu/T#%zd.",
-					UJGetType(obj), stmt->rset.vrows, rowno);
-				return set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS, pos,
-						i + 1);
-
-			case UJT_Null:
-				DBGH(stmt, "value [%zd, %d] is NULL.", rowno, i + 1);
-				ind_len = deferred_address(SQL_DESC_INDICATOR_PTR, pos, arec);
-				if (! ind_len) {
-					ERRH(stmt, "no buffer to signal NULL value.");
-					return set_row_diag(ird, SQL_STATE_22002, NULL, pos,
-							i + 1);
-				}
-				if (arec->es_type && (! arec->es_type->nullable)) {
-					WARNH(stmt, "returning NULL for non-nullable type.");
-				}
-				*ind_len = SQL_NULL_DATA;
-				continue; /* instead of break! no 'ret' processing to do. */
-
-			case UJT_String:
-				wstr = UJReadString(obj, &len);
-				DBGH(stmt, "value [%zd, %d] is string: [%d] `" LWPDL "`.",
-					rowno, i + 1, len, len, wstr);
-				/* UJSON4C returns chars count, but 0-terminates w/o counting
-				 * the terminator */
-				assert(wstr[len] == '\0');
-				/* "When character data is returned from the driver to the
-				 * application, the driver must always null-terminate it." */
-				ret = sql2c_string(arec, irec, pos, wstr, len + /*\0*/1);
-				break;
-
-			case UJT_Long:
-			case UJT_LongLong:
-				ll = UJNumericLongLong(obj);
-				DBGH(stmt, "value [%zd, %d] is integer: %lld.", rowno, i + 1,
-					ll);
-				ret = sql2c_longlong(arec, irec, pos, ll);
-				break;
-
-			case UJT_UnsignedLongLong:
-				ull = UJNumericUnsignedLongLong(obj);
-				DBGH(stmt, "value [%zd, %d] is unsigned long long: %llu.",
-						rowno, i + 1, ull);
-				ret = sql2c_quadword(arec, irec, pos, ull, /*unsigned*/true);
-				break;
-
-			case UJT_Double:
-				dbl = UJNumericFloat(obj);
-				DBGH(stmt, "value [%zd, %d] is double: %f.", rowno, i + 1,
-					dbl);
-				ret = sql2c_double(arec, irec, pos, dbl);
-				break;
-
-			case UJT_True:
-			case UJT_False:
-				boolval = UJGetType(obj) == UJT_True ? TRUE : FALSE;
-				DBGH(stmt, "value [%zd, %d] is boolean: %d.", rowno, i + 1,
-					boolval);
-				/* "When bit SQL data is converted to character C data, the
-				 * possible values are "0" and "1"." */
-				ret = sql2c_longlong(arec, irec, pos, boolval ? 1LL : 0LL);
-				break;
-		}
-
-		/* set the (row, column) details in the diagnostic, in case the
-		 * value copying isn't a clean success (i.e. success with info or an
-		 * error) */
+		ret = copy_one_cell_json(stmt, arec, irec, irec->i_val.json, pos,
+				rowno, i + 1);
 		switch (ret) {
 			case SQL_SUCCESS_WITH_INFO:
 				with_info = TRUE;
-				stmt->hdr.diag.row_number = rowno;
-				stmt->hdr.diag.column_number = i + 1;
 			/* no break */
 			case SQL_SUCCESS:
 				break; /* continue iteration over row's values */
 
 			default: /* error */
-				stmt->hdr.diag.row_number = rowno;
-				stmt->hdr.diag.column_number = i + 1;
 				return ret; /* row fetching failed */
 		}
 	}
@@ -1452,7 +1766,12 @@ SQLRETURN copy_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
 	return with_info ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
 }
 
-static SQLRETURN unpack_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
+/*
+ * Iterate over one row of the JSON result set, referencing each of its
+ * values in the respective IRD record.
+ * pos: row number in the rowset
+ */
+static SQLRETURN scan_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
 {
 	SQLSMALLINT i;
 	size_t rowno;
@@ -1501,26 +1820,80 @@ static SQLRETURN unpack_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
 				SQL_NO_COLUMN_NUMBER);
 	}
 
+	return SQL_SUCCESS;
+}
+
+static SQLRETURN unpack_one_row_json(esodbc_stmt_st *stmt, SQLULEN pos)
+{
+	SQLRETURN ret = scan_one_row_json(stmt, pos);
+	if (! SQL_SUCCEEDED(ret)) {
+		return ret;
+	}
 	/* copy values, if there's already any bound column */
 	return 0 < stmt->ard->count ? copy_one_row_json(stmt, pos) : SQL_SUCCESS;
 }
 
 
 /*
- * Copy one row from IRD to ARD.
+ * Copy a value as-is into the application's buffer, if the column's
+ * conversion plan allows it.
+ * Returns FALSE if the value needs converting.
+ */
+static inline BOOL planned_copy_cbor(esodbc_rec_st *arec,
+	esodbc_rec_st *irec, CborValue *obj, SQLULEN pos)
+{
+	void *data_ptr;
+	SQLLEN *octet_len_ptr;
+	int64_t i64;
+	double dbl;
+
+	if (irec->plan.direct == SQL_C_DEFAULT ||
+		(! REC_PLAN_VALID(irec, arec))) {
+		return FALSE;
+	}
+	if (! (data_ptr = planned_address(SQL_DESC_DATA_PTR, pos, arec, irec))) {
+		return FALSE;
+	}
+	switch (irec->plan.direct) {
+		case SQL_C_SBIGINT:
+			if ((! cbor_value_is_integer(obj)) ||
+				cbor_value_get_int64_checked(obj, &i64) != CborNoError) {
+				return FALSE;
+			}
+			*(SQLBIGINT *)data_ptr = (SQLBIGINT)i64;
+			break;
+		case SQL_C_DOUBLE:
+			if ((! cbor_value_is_double(obj)) ||
+				cbor_value_get_double(obj, &dbl) != CborNoError) {
+				return FALSE;
+			}
+			*(SQLDOUBLE *)data_ptr = dbl;
+			break;
+		default:
+			return FALSE;
+	}
+	octet_len_ptr = planned_address(SQL_DESC_OCTET_LENGTH_PTR, pos, arec,
+			irec);
+	if (octet_len_ptr) {
+		*octet_len_ptr = irec->plan.direct == SQL_C_SBIGINT ?
+			sizeof(SQLBIGINT) : sizeof(SQLDOUBLE);
+	}
+	return TRUE;
+}
+
+/*
+ * Copy one value from IRD to ARD.
  * pos: row number in the rowset
+ * rowno, colno: (result set) row and column number of the value, to set in
+ * the diagnostic
  */
-static SQLRETURN copy_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
+static SQLRETURN copy_one_cell_cbor(esodbc_stmt_st *stmt, esodbc_rec_st *arec,
+	esodbc_rec_st *irec, CborValue *obj, SQLULEN pos, size_t rowno,
+	SQLINTEGER colno)
 {
 	SQLRETURN ret;
 	CborError res;
-	CborValue obj;
 	CborType elem_type;
-	SQLINTEGER i;
-	esodbc_desc_st *ard, *ird;
-	esodbc_rec_st *arec, *irec;
-	size_t rowno;
-	BOOL with_info;
 	SQLLEN *ind_len;
 	int64_t i64;
 	wstr_st wstr;
@@ -1529,6 +1902,159 @@ static SQLRETURN copy_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
 	uint16_t ui16;
 	uint64_t ui64;
 	float flt;
+	cstr_st u8;
+
+	if (irec->ovr.set) {
+		return copy_override(stmt, arec, irec, pos, rowno, colno);
+	}
+	if (planned_copy_cbor(arec, irec, obj, pos)) {
+		return SQL_SUCCESS;
+	}
+
+	elem_type = cbor_value_get_type(obj);
+	DBGH(stmt, "current element of type: 0x%x", elem_type);
+	switch (elem_type) {
+		case CborByteStringType:
+		case CborArrayType:
+		case CborMapType:
+		case CborSimpleType:
+		case CborUndefinedType:
+		default: /* + CborInvalidType */
+			ERRH(stmt, "unexpected elem. of type 0x%x in row", elem_type);
+			goto err;
+
+		case CborNullType:
+			DBGH(stmt, "value [%zd, %d] is NULL.", rowno, colno);
+			ind_len = planned_address(SQL_DESC_INDICATOR_PTR, pos, arec,
+					irec);
+			if (! ind_len) {
+				ERRH(stmt, "no buffer to signal NULL value.");
+				ret = set_row_diag(stmt->ird, SQL_STATE_22002, NULL, pos,
+						colno);
+				break;
+			}
+			if (arec->es_type && (! arec->es_type->nullable)) {
+				WARNH(stmt, "returning NULL for non-nullable type.");
+			}
+			*ind_len = SQL_NULL_DATA;
+			ret = SQL_SUCCESS;
+			break;
+
+		case CborTextStringType:
+			/* datetime into a planned timestamp: parse the UTF-8 */
+			if (irec->plan.ctype == SQL_C_TYPE_TIMESTAMP &&
+				(irec->concise_type == SQL_TYPE_TIMESTAMP ||
+					irec->concise_type == SQL_TYPE_DATE) &&
+				REC_PLAN_VALID(irec, arec)
+				&& cbor_value_get_unchunked_string(obj, &u8.str,
+					&u8.cnt) == CborNoError) {
+				DBGH(stmt, "value [%zu, %d] is datetime: [%zu] `" LCPDL "`.",
+					rowno, colno, u8.cnt, LCSTR(&u8));
+				ret = sql2c_u8timestamp(arec, irec, pos, (char *)u8.str,
+						u8.cnt);
+				break;
+			}
+			/* text into a planned SQL_C_CHAR: pass the UTF-8 through */
+			if (irec->plan.direct == SQL_C_CHAR && REC_PLAN_VALID(irec, arec)
+				&& cbor_value_get_unchunked_string(obj, &u8.str,
+					&u8.cnt) == CborNoError) {
+				DBGH(stmt, "value [%zu, %d] is string: [%zu] `" LCPDL "`.",
+					rowno, colno, u8.cnt, LCSTR(&u8));
+				ret = sql2c_u8string(arec, irec, pos, (char *)u8.str,
+						u8.cnt);
+				break;
+			}
+			res = cbor_value_get_utf16_wstr(obj, &wstr);
+			CHK_RES(stmt, "failed to extract text string");
+			DBGH(stmt, "value [%zu, %d] is string: [%zu] `" LWPDL "`.",
+				rowno, colno, wstr.cnt, LWSTR(&wstr));
+			/* UTF8/16 conversion terminates the string */
+			assert(wstr.str[wstr.cnt] == '\0');
+			/* "When character data is returned from the driver to the
+			 * application, the driver must always null-terminate it." */
+			ret = sql2c_string(arec, irec, pos, wstr.str, wstr.cnt + 1);
+			break;
+
+		case CborIntegerType:
+			res = cbor_value_get_int64_checked(obj, &i64);
+			CHK_RES(stmt, "failed to extract int64 value");
+			DBGH(stmt, "value [%zu, %d] is integer: %I64d.", rowno, colno,
+				i64);
+			assert(sizeof(int64_t) == sizeof(long long));
+			ret = sql2c_longlong(arec, irec, pos, (long long)i64);
+			break;
+
+		case CborTagType:
+			/* Elastic's Java BigInteger is CBOR-encoded as (tagged)
+			 * Bignum. No other tag is expected in the protocol, so it's
+			 * either an unsigned long long, or an error.  */
+			res = cbor_value_get_tagged_uint64(obj, &ui64);
+			CHK_RES(stmt, "failed to extract tagged uint64 value");
+			DBGH(stmt, "value [%zu, %d] is biginteger: %I64u.", rowno,
+				colno, ui64);
+			ret = sql2c_quadword(arec, irec, pos, ui64, /*unsigned*/true);
+			break;
+
+		/*INDENT-OFF*/
+		do {
+		case CborHalfFloatType:
+			res = cbor_value_get_half_float(obj, &ui16);
+			/* res not yet checked, but likely(OK) */
+			dbl = decode_half(ui16);
+			break;
+		case CborFloatType:
+			res = cbor_value_get_float(obj, &flt);
+			dbl = (double)flt;
+			break;
+		case CborDoubleType:
+			res = cbor_value_get_double(obj, &dbl);
+			break;
+		} while (0);
+			CHK_RES(stmt, "failed to extract flt. point type 0x%x",
+					elem_type);
+			DBGH(stmt, "value [%zu, %d] is double: %f.", rowno, colno, dbl);
+			ret = sql2c_double(arec, irec, pos, dbl);
+			break;
+		/*INDENT-ON*/
+
+		case CborBooleanType:
+			res = cbor_value_get_boolean(obj, &boolval);
+			CHK_RES(stmt, "failed to extract boolean value");
+			DBGH(stmt, "value [%zu, %d] is boolean: %d.", rowno, colno,
+				boolval);
+			/* 'When bit SQL data is converted to character C data, the
+			 * possible values are "0" and "1".' */
+			ret = sql2c_longlong(arec, irec, pos, (long long)!!boolval);
+			break;
+	}
+
+	/* set the (row, column) details in the diagnostic, in case the value
+	 * copying isn't a clean success (i.e. success with info or an error) */
+	if (ret != SQL_SUCCESS) {
+		stmt->hdr.diag.row_number = rowno;
+		stmt->hdr.diag.column_number = colno;
+	}
+	return ret;
+
+err:
+	ret = set_row_diag(stmt->ird, SQL_STATE_HY000, MSG_INV_SRV_ANS, pos,
+			colno);
+	stmt->hdr.diag.row_number = rowno;
+	return ret;
+}
+
+/*
+ * Copy one row from IRD to ARD.
+ * pos: row number in the rowset
+ */
+static SQLRETURN copy_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
+{
+	SQLRETURN ret;
+	SQLINTEGER i;
+	esodbc_desc_st *ard, *ird;
+	esodbc_rec_st *arec, *irec;
+	size_t rowno;
+	BOOL with_info;
 
 	ard = stmt->ard;
 	ird = stmt->ird;
@@ -1558,115 +2084,16 @@ static SQLRETURN copy_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
 			irec = &ird->recs[i];
 		}
 
-		obj = irec->i_val.cbor;
-		elem_type = cbor_value_get_type(&obj);
-		DBGH(stmt, "current element of type: 0x%x", elem_type);
-		switch (elem_type) {
-			case CborByteStringType:
-			case CborArrayType:
-			case CborMapType:
-			case CborSimpleType:
-			case CborUndefinedType:
-			default: /* + CborInvalidType */
-				ERRH(stmt, "unexpected elem. of type 0x%x in row", elem_type);
-				goto err;
-
-			case CborNullType:
-				DBGH(stmt, "value [%zd, %d] is NULL.", rowno, i + 1);
-				ind_len = deferred_address(SQL_DESC_INDICATOR_PTR, pos, arec);
-				if (! ind_len) {
-					ERRH(stmt, "no buffer to signal NULL value.");
-					return set_row_diag(ird, SQL_STATE_22002, NULL, pos,
-							i + 1);
-				}
-				if (arec->es_type && (! arec->es_type->nullable)) {
-					WARNH(stmt, "returning NULL for non-nullable type.");
-				}
-				*ind_len = SQL_NULL_DATA;
-				ret = SQL_SUCCESS;
-				break;
-
-			case CborTextStringType:
-				res = cbor_value_get_utf16_wstr(&obj, &wstr);
-				CHK_RES(stmt, "failed to extract text string");
-				DBGH(stmt, "value [%zu, %d] is string: [%zu] `" LWPDL "`.",
-					rowno, i + 1, wstr.cnt, LWSTR(&wstr));
-				/* UTF8/16 conversion terminates the string */
-				assert(wstr.str[wstr.cnt] == '\0');
-				/* "When character data is returned from the driver to the
-				 * application, the driver must always null-terminate it." */
-				ret = sql2c_string(arec, irec, pos, wstr.str, wstr.cnt + 1);
-				break;
-
-			case CborIntegerType:
-				res = cbor_value_get_int64_checked(&obj, &i64);
-				CHK_RES(stmt, "failed to extract int64 value");
-				DBGH(stmt, "value [%zu, %d] is integer: %I64d.", rowno,
-					i + 1, i64);
-				assert(sizeof(int64_t) == sizeof(long long));
-				ret = sql2c_longlong(arec, irec, pos, (long long)i64);
-				break;
-
-			case CborTagType:
-				/* Elastic's Java BigInteger is CBOR-encoded as (tagged)
-				 * Bignum. No other tag is expected in the protocol, so it's
-				 * either an unsigned long long, or an error.  */
-				res = cbor_value_get_tagged_uint64(&obj, &ui64);
-				CHK_RES(stmt, "failed to extract tagged uint64 value");
-				DBGH(stmt, "value [%zu, %d] is biginteger: %I64u.", rowno,
-					i + 1, ui64);
-				ret = sql2c_quadword(arec, irec, pos, ui64, /*unsigned*/true);
-				break;
-
-			/*INDENT-OFF*/
-			do {
-			case CborHalfFloatType:
-				res = cbor_value_get_half_float(&obj, &ui16);
-				/* res not yet checked, but likely(OK) */
-				dbl = decode_half(ui16);
-				break;
-			case CborFloatType:
-				res = cbor_value_get_float(&obj, &flt);
-				dbl = (double)flt;
-				break;
-			case CborDoubleType:
-				res = cbor_value_get_double(&obj, &dbl);
-				break;
-			} while (0);
-				CHK_RES(stmt, "failed to extract flt. point type 0x%x",
-						elem_type);
-				DBGH(stmt, "value [%zu, %d] is double: %f.", rowno,
-					i + 1, dbl);
-				ret = sql2c_double(arec, irec, pos, dbl);
-				break;
-			/*INDENT-ON*/
-
-			case CborBooleanType:
-				res = cbor_value_get_boolean(&obj, &boolval);
-				CHK_RES(stmt, "failed to extract boolean value");
-				DBGH(stmt, "value [%zu, %d] is boolean: %d.", rowno,
-					i + 1, boolval);
-				/* 'When bit SQL data is converted to character C data, the
-				 * possible values are "0" and "1".' */
-				ret = sql2c_longlong(arec, irec, pos, (long long)!!boolval);
-				break;
-		}
-
-		/* set the (row, column) details in the diagnostic, in case the
-		 * value copying isn't a clean success (i.e. success with info or an
-		 * error) */
+		ret = copy_one_cell_cbor(stmt, arec, irec, &irec->i_val.cbor, pos,
+				rowno, i + 1);
 		switch (ret) {
 			case SQL_SUCCESS_WITH_INFO:
 				with_info = TRUE;
-				stmt->hdr.diag.row_number = rowno;
-				stmt->hdr.diag.column_number = i + 1;
 			/* no break */
 			case SQL_SUCCESS:
 				break; /* continue iteration over row's values */
 
 			default: /* error */
-				stmt->hdr.diag.row_number = rowno;
-				stmt->hdr.diag.column_number = i + 1;
 				return ret; /* row fetching failed */
 		}
 	}
@@ -1678,12 +2105,14 @@ static SQLRETURN copy_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
 			pos, ird->array_status_ptr[pos]);
 	}
 	return with_info ? SQL_SUCCESS_WITH_INFO : SQL_SUCCESS;
-
-err:
-	return set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS, pos, i + 1);
 }
 
-static SQLRETURN unpack_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
+/*
+ * Parse one row of the CBOR result set, referencing each of its values in
+ * the respective IRD record.
+ * pos: row number in the rowset
+ */
+static SQLRETURN scan_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
 {
 	CborError res;
 	CborValue *rows_iter, it;
@@ -1749,25 +2178,585 @@ static SQLRETURN unpack_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
 	} else {
 		res = cbor_value_leave_container(rows_iter, &it);
 	}
-	if (res != CborNoError) {
-		ERRH(stmt, "failed to exit row array: %s.", cbor_error_string(res));
-		return set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS, pos,
-				SQL_NO_COLUMN_NUMBER);
+	if (res != CborNoError) {
+		ERRH(stmt, "failed to exit row array: %s.", cbor_error_string(res));
+		return set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS, pos,
+				SQL_NO_COLUMN_NUMBER);
+	}
+
+	return SQL_SUCCESS;
+
+err:
+	res = (i < 0) ? cbor_value_advance(rows_iter) :
+		cbor_value_exit_container(rows_iter, &it);
+	if (res != CborNoError) {
+		ERRH(stmt, "failed to %s current row: %s.", (i < 0) ? "skip" : "exit",
+			cbor_error_string(res));
+	}
+	return set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS, pos,
+			SQL_NO_COLUMN_NUMBER);
+}
+
+static SQLRETURN unpack_one_row_cbor(esodbc_stmt_st *stmt, SQLULEN pos)
+{
+	SQLRETURN ret = scan_one_row_cbor(stmt, pos);
+	if (! SQL_SUCCEEDED(ret)) {
+		return ret;
+	}
+	return 0 < stmt->ard->count ? copy_one_row_cbor(stmt, pos) : SQL_SUCCESS;
+}
+
+/*
+ * Copy one value from IRD to ARD, along copy_one_cell_cbor(); 'wide' tells
+ * if the column is planned to be delivered as SQL_C_WCHAR, case where text
+ * can be transcoded straight into the application's buffer.
+ */
+static inline SQLRETURN transfer_cell_cbor(esodbc_stmt_st *stmt,
+	esodbc_rec_st *arec, esodbc_rec_st *irec, CborValue *obj, SQLULEN pos,
+	size_t rowno, SQLINTEGER colno, BOOL wide)
+{
+	SQLRETURN ret;
+	wstr_st wstr;
+
+	if (wide && cbor_value_is_text_string(obj) &&
+		cbor_value_get_utf16_wstr(obj, &wstr) == CborNoError) {
+		ret = sql2c_string(arec, irec, pos, wstr.str, wstr.cnt + 1);
+		if (ret != SQL_SUCCESS) {
+			stmt->hdr.diag.row_number = rowno;
+			stmt->hdr.diag.column_number = colno;
+		}
+		return ret;
+	}
+	return copy_one_cell_cbor(stmt, arec, irec, obj, pos, rowno, colno);
+}
+
+/*
+ * Column-wise transfer of up to 'cnt' rows of the current CBOR result set
+ * into the rowset, starting at position 'pos': the rows are all scanned
+ * first, with their values referenced; then each bound column is copied
+ * over all the rows, along the column's conversion plan (see
+ * conv_plans_build()): values with the same representation as the bound
+ * buffer (SQL_C_SBIGINT integers, SQL_C_DOUBLE doubles) are stored directly,
+ * text goes straight to SQL_C_WCHAR transcoding, while all others (NULLs
+ * included) are converted value by value.
+ * Only used with column-wise binding, whose buffers are contiguous.
+ * Returns the number of rows consumed from the result set (0 if the
+ * transfer couldn't be set up); 'errors' is incremented with the number of
+ * failed rows.
+ */
+static SQLULEN copy_rows_cbor(esodbc_stmt_st *stmt, SQLULEN pos,
+	SQLULEN cnt, SQLULEN *errors)
+{
+	SQLRETURN ret;
+	esodbc_desc_st *ard, *ird;
+	esodbc_rec_st *arec, *irec;
+	CborValue *vals;
+	SQLRETURN *rets;
+	SQLULEN r, n;
+	SQLSMALLINT i;
+	size_t rowno0;
+	BOOL wide;
+
+	ard = stmt->ard;
+	ird = stmt->ird;
+	assert(ard->bind_type == SQL_BIND_BY_COLUMN);
+
+	vals = malloc(cnt * ird->count * sizeof(*vals));
+	rets = malloc(cnt * sizeof(*rets));
+	if ((! vals) || (! rets)) {
+		WARNH(stmt, "OOM for %llu x %hd values: falling back to row-wise "
+			"copying.", (uint64_t)cnt, ird->count);
+		free(vals);
+		free(rets);
+		return 0;
+	}
+
+	/* first pass: scan the rows, saving the values' references */
+	rowno0 = stmt->tv_rows + /* first row not yet counted */1;
+	for (n = 0; n < cnt; n ++) {
+		if (cbor_value_at_end(&stmt->rset.pack.cbor.rows_iter)) {
+			break;
+		}
+		rets[n] = scan_one_row_cbor(stmt, pos + n);
+		if (SQL_SUCCEEDED(rets[n])) {
+			for (i = 0; i < ird->count; i ++) {
+				vals[i * cnt + n] = ird->recs[i].i_val.cbor;
+			}
+		} else {
+			ERRH(stmt, "fetching row %zu failed.", stmt->rset.vrows + 1);
+		}
+		stmt->rset.vrows ++;
+		stmt->tv_rows ++;
+	}
+	DBGH(stmt, "scanned %llu rows, copying %hd columns column-wise.",
+		(uint64_t)n, ard->count);
+
+	/* second pass: copy the rows, one column at a time */
+	for (i = 0; i < ard->count; i ++) {
+		arec = &ard->recs[i];
+		if (! REC_IS_BOUND(arec)) {
+			continue;
+		}
+		if (ird->count <= i) {
+			ERRH(stmt, "only %hd columns in result set, no data to return in "
+				"column #%hd.", ird->count, i + 1);
+			for (r = 0; r < n; r ++) {
+				if (SQL_SUCCEEDED(rets[r])) {
+					rets[r] = set_row_diag(ird, SQL_STATE_HY000,
+							MSG_INV_SRV_ANS, pos + r, i + 1);
+				}
+			}
+			continue;
+		}
+		irec = &ird->recs[i];
+		/* text to wide strings can skip the source type resolution */
+		wide = REC_PLAN_VALID(irec, arec) && irec->plan.ctype == SQL_C_WCHAR;
+
+		for (r = 0; r < n; r ++) {
+			if (! SQL_SUCCEEDED(rets[r])) {
+				continue;
+			}
+			ret = transfer_cell_cbor(stmt, arec, irec, &vals[i * cnt + r],
+					pos + r, rowno0 + r, i + 1, wide);
+			/* an error fails the row, a warning only if no error */
+			if (! SQL_SUCCEEDED(ret) || rets[r] == SQL_SUCCESS) {
+				rets[r] = ret;
+			}
+		}
+	}
+
+	for (r = 0; r < n; r ++) {
+		if (! SQL_SUCCEEDED(rets[r])) {
+			(*errors) ++;
+		}
+		if (ird->array_status_ptr) {
+			ird->array_status_ptr[pos + r] = (! SQL_SUCCEEDED(rets[r])) ?
+				SQL_ROW_ERROR : rets[r] == SQL_SUCCESS_WITH_INFO ?
+				SQL_ROW_SUCCESS_WITH_INFO : SQL_ROW_SUCCESS;
+		}
+	}
+
+	free(vals);
+	free(rets);
+	return n;
+}
+
+/* reference the current value of a CBOR column array and advance past it */
+static inline CborError next_value_cbor(CborValue *it, CborValue *val)
+{
+	CborError res;
+
+	*val = *it;
+	if (cbor_value_is_tag(it)) { /* CborPositiveBignumTag (or error) */
+		if ((res = cbor_value_skip_tag(it)) != CborNoError) {
+			return res;
+		}
+	}
+	return cbor_value_advance(it);
+}
+
+/*
+ * Reference the values of the current row of a column-major result set in
+ * the respective IRD records.
+ * pos: row number in the rowset
+ */
+static SQLRETURN scan_one_row_columnar(esodbc_stmt_st *stmt, SQLULEN pos)
+{
+	CborError res;
+	SQLSMALLINT i;
+	esodbc_desc_st *ird;
+	esodbc_rec_st *irec;
+	BOOL json;
+
+	ird = stmt->ird;
+	json = stmt->rset.pack_json;
+	/* the column arrays have all been checked to count 'nrows' values */
+	assert(stmt->rset.vrows < stmt->rset.nrows);
+
+	for (i = 0; i < ird->count; i ++) {
+		irec = &ird->recs[i];
+		if (json) {
+			if (! UJIterArray(&stmt->rset.pack.json.vals_iter[i],
+					&irec->i_val.json)) {
+				ERRH(stmt, "value array #%hd exhausted.", i);
+				return set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS,
+						pos, i + 1);
+			}
+		} else {
+			res = next_value_cbor(&stmt->rset.pack.cbor.vals_iter[i],
+					&irec->i_val.cbor);
+			if (res != CborNoError) {
+				ERRH(stmt, "failed to advance in value array #%hd: %s.", i,
+					cbor_error_string(res));
+				return set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS,
+						pos, i + 1);
+			}
+		}
+	}
+
+	return SQL_SUCCESS;
+}
+
+/*
+ * Scan the current row of a column-major result set, then, if any columns
+ * are bound, transfer it to the application.
+ * pos: row number in the rowset
+ */
+static SQLRETURN unpack_one_row_columnar(esodbc_stmt_st *stmt, SQLULEN pos)
+{
+	SQLRETURN ret = scan_one_row_columnar(stmt, pos);
+	if ((! SQL_SUCCEEDED(ret)) || stmt->ard->count <= 0) {
+		return ret;
+	}
+	return stmt->rset.pack_json ? copy_one_row_json(stmt, pos) :
+		copy_one_row_cbor(stmt, pos);
+}
+
+/*
+ * Column-wise transfer of up to 'cnt' rows of the current column-major
+ * result set into the rowset, starting at position 'pos': each bound column
+ * is copied over all the rows, straight off its values array, with no
+ * per-row scanning. The columns that aren't bound are only iterated over,
+ * to keep them in step with the others.
+ * Only used with column-wise binding, whose buffers are contiguous.
+ * Returns the number of rows consumed from the result set (0 if the
+ * transfer couldn't be set up); 'errors' is incremented with the number of
+ * failed rows.
+ */
+static SQLULEN copy_columns(esodbc_stmt_st *stmt, SQLULEN pos, SQLULEN cnt,
+	SQLULEN *errors)
+{
+	SQLRETURN ret, *rets;
+	esodbc_desc_st *ard, *ird;
+	esodbc_rec_st *arec, *irec;
+	CborValue cval;
+	UJObject jval;
+	SQLULEN r, n;
+	SQLSMALLINT i;
+	size_t rowno0;
+	BOOL json, bound, wide, valid;
+
+	ard = stmt->ard;
+	ird = stmt->ird;
+	assert(ard->bind_type == SQL_BIND_BY_COLUMN);
+	assert(stmt->rset.vrows < stmt->rset.nrows);
+
+	n = stmt->rset.nrows - stmt->rset.vrows;
+	if (cnt < n) {
+		n = cnt;
+	}
+	if (! (rets = malloc(n * sizeof(*rets)))) {
+		WARNH(stmt, "OOM for %llu row results: falling back to row-wise "
+			"copying.", (uint64_t)n);
+		return 0;
+	}
+	for (r = 0; r < n; r ++) {
+		rets[r] = SQL_SUCCESS;
+	}
+	json = stmt->rset.pack_json;
+	rowno0 = stmt->tv_rows + /* first row not yet counted */1;
+	DBGH(stmt, "copying %llu rows of %hd columns column-wise.", (uint64_t)n,
+		ird->count);
+
+	for (i = 0; i < ird->count; i ++) {
+		irec = &ird->recs[i];
+		arec = i < ard->count ? &ard->recs[i] : NULL;
+		bound = arec && REC_IS_BOUND(arec);
+		/* text to wide strings can skip the source type resolution */
+		wide = bound && REC_PLAN_VALID(irec, arec) &&
+			irec->plan.ctype == SQL_C_WCHAR;
+
+		for (r = 0; r < n; r ++) {
+			valid = json ?
+				UJIterArray(&stmt->rset.pack.json.vals_iter[i], &jval) :
+				next_value_cbor(&stmt->rset.pack.cbor.vals_iter[i],
+					&cval) == CborNoError;
+			if (! valid) {
+				ERRH(stmt, "failed to advance in value array #%hd.", i);
+				ret = set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS,
+						pos + r, i + 1);
+				stmt->hdr.diag.row_number = rowno0 + r;
+			} else if ((! bound) || (! SQL_SUCCEEDED(rets[r]))) {
+				continue;
+			} else if (json) {
+				ret = copy_one_cell_json(stmt, arec, irec, jval, pos + r,
+						rowno0 + r, i + 1);
+			} else {
+				ret = transfer_cell_cbor(stmt, arec, irec, &cval, pos + r,
+						rowno0 + r, i + 1, wide);
+			}
+			/* an error fails the row, a warning only if no error */
+			if (! SQL_SUCCEEDED(ret) || rets[r] == SQL_SUCCESS) {
+				rets[r] = ret;
+			}
+		}
+	}
+	/* columns bound past the result set's can't receive any data */
+	for (i = ird->count; i < ard->count; i ++) {
+		if (! REC_IS_BOUND(&ard->recs[i])) {
+			continue;
+		}
+		ERRH(stmt, "only %hd columns in result set, no data to return in "
+			"column #%hd.", ird->count, i + 1);
+		for (r = 0; r < n; r ++) {
+			if (SQL_SUCCEEDED(rets[r])) {
+				rets[r] = set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS,
+						pos + r, i + 1);
+			}
+		}
+	}
+
+	for (r = 0; r < n; r ++) {
+		if (! SQL_SUCCEEDED(rets[r])) {
+			(*errors) ++;
+		}
+		if (ird->array_status_ptr) {
+			ird->array_status_ptr[pos + r] = (! SQL_SUCCEEDED(rets[r])) ?
+				SQL_ROW_ERROR : rets[r] == SQL_SUCCESS_WITH_INFO ?
+				SQL_ROW_SUCCESS_WITH_INFO : SQL_ROW_SUCCESS;
+		}
+	}
+	stmt->rset.vrows += n;
+	stmt->tv_rows += n;
+
+	free(rets);
+	return n;
+}
+
+/* Worker thread routine: POSTs the cursor request and collects the answer
+ * (or the failure). Only touches the statement's prefetch members. */
+static unsigned __stdcall prefetch_worker(void *arg)
+{
+	esodbc_stmt_st *stmt = (esodbc_stmt_st *)arg;
+
+	DBGH(stmt, "prefetching next page; request of %zu bytes.",
+		stmt->prefetch.req.cnt);
+	stmt->prefetch.ret = dbc_curl_post(HDRH(stmt)->dbc, stmt->prefetch.tout,
+			ESODBC_CURL_QUERY, &stmt->prefetch.req, &stmt->cancel,
+			&stmt->prefetch.code, &stmt->prefetch.body,
+			&stmt->prefetch.is_json, &stmt->prefetch.diag, &stmt->perf);
+	DBGH(stmt, "prefetching done: ret=%hd, code=%ld, body: %zu bytes.",
+		stmt->prefetch.ret, stmt->prefetch.code, stmt->prefetch.body.cnt);
+	return 0;
+}
+
+/*
+ * Start requesting the next page of the result set on a worker thread, so
+ * that its transfer overlaps with the application consuming the current
+ * page. Only done if enabled, if there is a cursor to continue with and if
+ * no worker is already running.
+ * A failure to start is not an error: the page will be requested
+ * synchronously once the current one is exhausted.
+ */
+void prefetch_start(esodbc_stmt_st *stmt)
+{
+	SQLRETURN ret;
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	cstr_st req = (cstr_st) {
+		NULL, 0
+	};
+
+	if ((! dbc->prefetch) || stmt->prefetch.thread ||
+		(! STMT_HAS_CURSOR(stmt))) {
+		return;
+	}
+
+	/* serialize on the calling thread, since the request contains the cursor
+	 * in the current result set (and uses the thread-local TZ param) */
+	ret = serialize_statement(stmt, &req);
+	if (! SQL_SUCCEEDED(ret)) {
+		WARNH(stmt, "failed to serialize the prefetch request.");
+		if (req.str) {
+			free(req.str);
+		}
+		return;
+	}
+
+	stmt->prefetch.req = req;
+	stmt->prefetch.tout = dbc->timeout < stmt->query_timeout ?
+		stmt->query_timeout : dbc->timeout;
+	stmt->prefetch.ret = SQL_ERROR;
+	stmt->prefetch.code = -1;
+	stmt->prefetch.body = (cstr_st) {
+		NULL, 0
+	};
+	init_diagnostic(&stmt->prefetch.diag);
+	/* discard any cancellation requested while no request was under way */
+	InterlockedExchange(&stmt->cancel, FALSE);
+
+	stmt->prefetch.thread = (HANDLE)_beginthreadex(NULL, 0, prefetch_worker,
+			stmt, 0, NULL);
+	if (! stmt->prefetch.thread) {
+		ERRNH(stmt, "failed to start prefetching thread.");
+		free(stmt->prefetch.req.str);
+		stmt->prefetch.req.str = NULL;
+		stmt->prefetch.req.cnt = 0;
+	} else {
+		DBGH(stmt, "prefetching thread started for result set #%zu.",
+			stmt->nset);
+	}
+}
+
+/* Wait for the prefetching worker to finish.
+ * Returns FALSE if no worker had been started. */
+static BOOL prefetch_join(esodbc_stmt_st *stmt)
+{
+	if (! stmt->prefetch.thread) {
+		return FALSE;
+	}
+	if (WaitForSingleObject(stmt->prefetch.thread, INFINITE) !=
+		WAIT_OBJECT_0) {
+		ERRNH(stmt, "failed to wait for prefetching thread.");
+		assert(0);
+	}
+	CloseHandle(stmt->prefetch.thread);
+	stmt->prefetch.thread = NULL;
+
+	free(stmt->prefetch.req.str);
+	stmt->prefetch.req.str = NULL;
+	stmt->prefetch.req.cnt = 0;
+	return TRUE;
+}
+
+/* Attach the prefetched page as the current result set or, if retrieving it
+ * failed, post the failure on the statement. */
+static SQLRETURN prefetch_attach(esodbc_stmt_st *stmt)
+{
+	SQLRETURN ret;
+	cstr_st body = stmt->prefetch.body;
+
+	assert(! stmt->prefetch.thread);
+	stmt->prefetch.body = (cstr_st) {
+		NULL, 0
+	};
+
+	if (SQL_SUCCEEDED(stmt->prefetch.ret)) {
+		DBGH(stmt, "attaching prefetched page.");
+		/* statement takes ownership of the body */
+		return attach_answer(stmt, &body, stmt->prefetch.is_json);
+	}
+
+	ret = stmt->prefetch.ret;
+	if (0 < stmt->prefetch.code) {
+		ret = attach_error(stmt, &body, stmt->prefetch.is_json,
+				stmt->prefetch.code);
+	} else if (stmt->prefetch.diag.state) {
+		HDRH(stmt)->diag = stmt->prefetch.diag;
+	}
+	if (body.str) {
+		free(body.str);
+	}
+	return ret;
+}
+
+/* Stop any running prefetching worker. If the next page had already been
+ * received, only the ES cursor it carries is taken in (replacing the current
+ * result set), so that the latest cursor is the one subsequently closed. */
+void prefetch_abort(esodbc_stmt_st *stmt)
+{
+	cstr_st body;
+
+	if (! stmt->prefetch.thread) {
+		return;
+	}
+	/* abort the transfer, if still under way */
+	InterlockedExchange(&stmt->cancel, TRUE);
+	dbc_curl_wakeup(HDRH(stmt)->dbc);
+	prefetch_join(stmt);
+	InterlockedExchange(&stmt->cancel, FALSE);
+
+	body = stmt->prefetch.body;
+	stmt->prefetch.body = (cstr_st) {
+		NULL, 0
+	};
+	if (SQL_SUCCEEDED(stmt->prefetch.ret)) {
+		/* statement takes ownership of the body */
+		if (! SQL_SUCCEEDED(attach_cursor(stmt, &body,
+					stmt->prefetch.is_json))) {
+			WARNH(stmt, "failed to read cursor of prefetched page.");
+		}
+	} else {
+		INFOH(stmt, "discarding failed or aborted prefetch (code: %ld).",
+			stmt->prefetch.code);
+		if (body.str) {
+			free(body.str);
+		}
+	}
+}
+
+
+/* Tell if all the rows (or column values) of current page have been
+ * consumed. For a row-major page, this moves the rows iterator onto the
+ * next row, if any. */
+static BOOL page_exhausted(esodbc_stmt_st *stmt)
+{
+	if (stmt->rset.columnar) {
+		return stmt->rset.nrows <= stmt->rset.vrows;
 	}
+	return stmt->rset.pack_json ?
+		(! UJIterArray(&stmt->rset.pack.json.rows_iter,
+				&stmt->rset.pack.json.row_array)) :
+		cbor_value_at_end(&stmt->rset.pack.cbor.rows_iter);
+}
 
-	return 0 < stmt->ard->count ? copy_one_row_cbor(stmt, pos) : SQL_SUCCESS;
+/*
+ * Replace the exhausted current page with the next one in the result set,
+ * either the one prefetched in the background or one requested now.
+ * Returns SQL_NO_DATA if there's no ES cursor to continue with or if the
+ * new page comes empty.
+ */
+SQLRETURN fetch_next_page(esodbc_stmt_st *stmt)
+{
+	SQLRETURN ret;
 
-err:
-	res = (i < 0) ? cbor_value_advance(rows_iter) :
-		cbor_value_exit_container(rows_iter, &it);
-	if (res != CborNoError) {
-		ERRH(stmt, "failed to %s current row: %s.", (i < 0) ? "skip" : "exit",
-			cbor_error_string(res));
+	if (! STMT_HAS_CURSOR(stmt)) { /* is there an ES cursor? */
+		return SQL_NO_DATA;
 	}
-	return set_row_diag(ird, SQL_STATE_HY000, MSG_INV_SRV_ANS, pos,
-			SQL_NO_COLUMN_NUMBER);
+	/* has the next page been requested in the background? */
+	ret = prefetch_join(stmt) ? prefetch_attach(stmt) : EsSQLExecute(stmt);
+	if (! SQL_SUCCEEDED(ret)) {
+		ERRH(stmt, "failed to fetch next resultset.");
+		return ret;
+	}
+	assert(STMT_HAS_RESULTSET(stmt));
+	if (STMT_NODATA_FORCED(stmt)) {
+		return SQL_NO_DATA;
+	}
+	prefetch_start(stmt);
+	return ret;
 }
 
+/*
+ * Reference the values of the next row in the current page in the IRD
+ * records, with no transfer to the application's buffers (for the
+ * consumers that read the values off the IRD directly).
+ * Returns SQL_NO_DATA once the page is exhausted; the row counters are
+ * updated, as with a fetch.
+ */
+SQLRETURN scan_row(esodbc_stmt_st *stmt)
+{
+	SQLRETURN ret;
+	SQLUSMALLINT *status;
+
+	if (page_exhausted(stmt)) {
+		return SQL_NO_DATA;
+	}
+	/* a failure is posted as a row diagnostic: keep the rowset's status
+	 * array, if any, out of it */
+	status = stmt->ird->array_status_ptr;
+	stmt->ird->array_status_ptr = NULL;
+	if (stmt->rset.columnar) {
+		ret = scan_one_row_columnar(stmt, /*pos*/0);
+	} else {
+		ret = stmt->rset.pack_json ? scan_one_row_json(stmt, /*pos*/0) :
+			scan_one_row_cbor(stmt, /*pos*/0);
+	}
+	stmt->ird->array_status_ptr = status;
+
+	stmt->rset.vrows ++;
+	stmt->tv_rows ++;
+	return ret;
+}
 
 /*
  * "SQLFetch and SQLFetchScroll use the rowset size at the time of the call to
@@ -1829,9 +2818,10 @@ SQLRETURN EsSQLFetch(SQLHSTMT StatementHandle)
 {
 	esodbc_stmt_st *stmt;
 	esodbc_desc_st *ard, *ird;
-	SQLULEN i, j, errors;
+	SQLULEN i, j, n, errors;
 	SQLRETURN ret;
-	BOOL empty, pack_json;
+	BOOL pack_json, colwise;
+	LONG64 start;
 
 	stmt = STMH(StatementHandle);
 
@@ -1878,6 +2868,11 @@ SQLRETURN EsSQLFetch(SQLHSTMT StatementHandle)
 		default:
 			DBGH(stmt, "ES/app data/buffer types found compatible.");
 	}
+	/* (re)build the conversion plans, if the binding or columns changed */
+	if (stmt->plans.ard_gen != stmt->ard->gen ||
+		stmt->plans.ird_gen != stmt->ird->gen) {
+		conv_plans_build(stmt);
+	}
 
 	DBGH(stmt, "cursor found @ row # %zu in set # %zu.", stmt->rset.vrows,
 		stmt->nset);
@@ -1885,35 +2880,36 @@ SQLRETURN EsSQLFetch(SQLHSTMT StatementHandle)
 	/* reset SQLGetData state, to reset fetch position */
 	STMT_GD_RESET(stmt);
 
+	/* have the next page requested, while the current one is consumed */
+	prefetch_start(stmt);
+
 	ard = stmt->ard;
 	ird = stmt->ird;
 	pack_json = stmt->rset.pack_json;
+	/* columns bound in contiguous arrays can be copied column by column */
+	colwise = 1 < ard->array_size && ard->bind_type == SQL_BIND_BY_COLUMN &&
+		0 < ard->count;
 
 	DBGH(stmt, "rowset size: %zu.", ard->array_size);
 	errors = 0;
 	i = 0;
+	start = perf_clock();
 	/* for all rows in rowset/array (of application), iterate over rows in
 	 * current resultset (of data source) */
 	while (i < ard->array_size) {
-		/* is there any array left in resultset? */
-		empty = pack_json ? (! UJIterArray(&stmt->rset.pack.json.rows_iter,
-					&stmt->rset.pack.json.row_array)) :
-			cbor_value_at_end(&stmt->rset.pack.cbor.rows_iter);
-
-		if (empty) {
+		/* is there any array (or column values) left in resultset? */
+		if (page_exhausted(stmt)) {
 			DBGH(stmt, "ran out of rows in current result set.");
-			if (STMT_HAS_CURSOR(stmt)) { /* is there an ES cursor? */
-				ret = EsSQLExecute(stmt);
-				if (! SQL_SUCCEEDED(ret)) {
-					ERRH(stmt, "failed to fetch next resultset.");
-					return ret;
-				}
-				assert(STMT_HAS_RESULTSET(stmt));
-				if (! STMT_NODATA_FORCED(stmt)) {
-					/* resume copying from the new resultset, staying on the
-					 * same position in rowset. */
-					continue;
-				}
+			/* the page retrieval is accounted separately */
+			STMT_PERF_LAPSE(stmt, ESODBC_PERF_TIME_CONVERT, start);
+			ret = fetch_next_page(stmt);
+			start = perf_clock();
+			if (SQL_SUCCEEDED(ret)) {
+				/* resume copying from the new resultset, staying on the
+				 * same position in rowset. */
+				continue;
+			} else if (ret != SQL_NO_DATA) {
+				return ret;
 			}
 			/* no cursor and no row left in resultset array: the End. */
 			DBGH(stmt, "reached end of entire result set; fetched=%zd.",
@@ -1930,6 +2926,16 @@ SQLRETURN EsSQLFetch(SQLHSTMT StatementHandle)
 			break;
 		}
 
+		if (colwise && (stmt->rset.columnar || (! pack_json))) {
+			n = stmt->rset.columnar ?
+				copy_columns(stmt, i, ard->array_size - i, &errors) :
+				copy_rows_cbor(stmt, i, ard->array_size - i, &errors);
+			if (n) {
+				i += n;
+				continue;
+			}
+		}
+
 		/* Unpack one row, then, if any columns are bound, transfer it to the
 		 * application.
 		 * Unpacking involves (a: JSON) iterating or (b: CBOR) parsing and
@@ -1937,9 +2943,15 @@ SQLRETURN EsSQLFetch(SQLHSTMT StatementHandle)
 		 * object reference into the IRD records.
 		 * These two are now separate steps since SQLGetData() binds/unbinds
 		 * one column at a time (after SQLFetch()), which for CBOR would
-		 * involve re-parsing the row for each column otherwise. */
-		ret = pack_json ? unpack_one_row_json(stmt, i) :
-			unpack_one_row_cbor(stmt, i);
+		 * involve re-parsing the row for each column otherwise.
+		 * A column-major result set is unpacked by advancing the iterators
+		 * over each column's values. */
+		if (stmt->rset.columnar) {
+			ret = unpack_one_row_columnar(stmt, i);
+		} else {
+			ret = pack_json ? unpack_one_row_json(stmt, i) :
+				unpack_one_row_cbor(stmt, i);
+		}
 		if (! SQL_SUCCEEDED(ret)) {
 			ERRH(stmt, "fetching row %zu failed.", stmt->rset.vrows + 1);
 			errors ++;
@@ -1949,6 +2961,9 @@ SQLRETURN EsSQLFetch(SQLHSTMT StatementHandle)
 		stmt->rset.vrows ++;
 		stmt->tv_rows ++;
 	}
+	STMT_PERF_LAPSE(stmt, ESODBC_PERF_TIME_CONVERT, start);
+	STMT_PERF_COUNT(stmt, ESODBC_PERF_ROWS, (LONG64)(i - errors));
+	STMT_PERF_COUNT(stmt, ESODBC_PERF_CONV_ERRORS, (LONG64)errors);
 
 	/* return number of processed rows (even if 0) */
 	if (ird->rows_processed_ptr) {
@@ -2237,10 +3252,45 @@ SQLRETURN EsSQLBulkOperations(
 	RET_HDIAGS(STMH(StatementHandle), SQL_STATE_IM001);
 }
 
+/*
+ * Moves to the answer of the next set of a parameters array execution: the
+ * only case of multiple result sets.
+ */
 SQLRETURN EsSQLMoreResults(SQLHSTMT hstmt)
 {
-	INFOH(hstmt, "multiple result sets not supported.");
-	return SQL_NO_DATA;
+	esodbc_stmt_st *stmt = STMH(hstmt);
+	pset_answ_st *answ = NULL;
+	SQLRETURN ret;
+
+	if (! stmt->psets.answs) {
+		INFOH(stmt, "no more result sets available.");
+		return SQL_NO_DATA;
+	}
+	while (++ stmt->psets.crr < stmt->psets.cnt) {
+		if (stmt->psets.answs[stmt->psets.crr].body.str) {
+			answ = &stmt->psets.answs[stmt->psets.crr];
+			break;
+		}
+	}
+	if (! answ) {
+		INFOH(stmt, "no more parameter sets results available.");
+		free_param_answers(stmt);
+		return SQL_NO_DATA;
+	}
+	DBGH(stmt, "moving to result of parameter set #%llu.",
+		(uint64_t)stmt->psets.crr + 1);
+
+	/* discard what's left of the current result set */
+	prefetch_abort(stmt);
+	if (STMT_HAS_CURSOR(stmt)) {
+		close_es_cursor(stmt);
+	}
+	STMT_ROW_CNT_RESET(stmt);
+	/* statement takes ownership of the body */
+	ret = attach_answer(stmt, &answ->body, answ->is_json);
+	answ->body.str = NULL;
+	answ->body.cnt = 0;
+	return ret;
 }
 
 static SQLRETURN close_es_handler_json(esodbc_stmt_st *stmt, cstr_st *body,
@@ -2409,22 +3459,29 @@ SQLRETURN EsSQLCancel(SQLHSTMT StatementHandle)
 
 	/*
 	 * Use cases:
-	 * - "A function running asynchronously on the statement.": no async
-	 *   support.
+	 * - "A function running asynchronously on the statement.": flag the
+	 *   statement; the next poll abandons the request and returns HY008.
 	 * - "A function on a statement that needs data." TODO: if data-at-exec.
-	 * - "A function running on the statement on another thread.": this could
-	 *   theoretically cancel an ongoing fetch/connect/etc. For now libcurl is
-	 *   left to timeout -- TODO: if swiching to "multi" API in libcurl.
-	 *   XXX: for this last case: stmt lock is being held here.
+	 * - "A function running on the statement on another thread.": flag the
+	 *   statement and wake up the transfer loop, which will abort the
+	 *   request under way; the running function will then return HY008.
+	 *   Note: the statement's lock is not taken (it's held by the running
+	 *   function), so only the flag is touched here.
 	 */
 
-	DBGH(stmt, "canceling current statement operation -- NOOP.");
+	DBGH(stmt, "canceling current statement operation.");
+	InterlockedExchange(&stmt->cancel, TRUE);
+	dbc_curl_wakeup(HDRH(stmt)->dbc);
+	curl_batch_wakeup(stmt);
 	return SQL_SUCCESS;
 }
 
 SQLRETURN EsSQLCancelHandle(SQLSMALLINT HandleType, SQLHANDLE InputHandle)
 {
-	/* see EsSQLCancel() */
+	if (HandleType == SQL_HANDLE_STMT) {
+		return EsSQLCancel(InputHandle);
+	}
+	/* no asynchronous connection functions support */
 	DBGH(InputHandle, "canceling current handle operation -- NOOP.");
 	return SQL_SUCCESS;
 }
@@ -2479,8 +3536,10 @@ SQLRETURN EsSQLPrepareW
 
 	ret = attach_sql(stmt, szSqlStr, cchSqlStr);
 	/* if early execution mode is on and the statement has no parameter
-	 * markers, execute the query right away */
-	if (HDRH(stmt)->dbc->early_exec && SQL_SUCCEEDED(ret)) {
+	 * markers, execute the query right away (unless executing
+	 * asynchronously, which is left to SQLExecute()) */
+	if (HDRH(stmt)->dbc->early_exec && SQL_SUCCEEDED(ret) &&
+		stmt->async_enable == SQL_ASYNC_ENABLE_OFF) {
 		assert(! stmt->early_executed); /* cleared by now */
 		if (! SQL_SUCCEEDED(count_param_markers(stmt, &markers))) {
 			ERRH(stmt, "failed to count parameter markers in query. "
@@ -2945,85 +4004,479 @@ static SQLRETURN get_param_recs(esodbc_stmt_st *stmt, SQLSMALLINT no,
 	return SQL_SUCCESS;
 }
 
-/* Forms the JSON array with params:
- * [{"type": "<ES/SQL type name>", "value": <param value>}(,etc)*] */
-static SQLRETURN serialize_params_json(esodbc_stmt_st *stmt, char *dest,
-	size_t *len)
+/* Forms the JSON array with params:
+ * [{"type": "<ES/SQL type name>", "value": <param value>}(,etc)*] */
+static SQLRETURN serialize_params_json(esodbc_stmt_st *stmt, char *dest,
+	size_t *len)
+{
+	/* JSON keys for building one parameter object */
+	const static cstr_st j_type = CSTR_INIT("{\"" REQ_KEY_PARAM_TYPE "\": \"");
+	const static cstr_st j_val = CSTR_INIT("\", \"" REQ_KEY_PARAM_VAL "\": ");
+	esodbc_rec_st *arec, *irec;
+	SQLRETURN ret;
+	SQLSMALLINT i, count;
+	size_t l, pos;
+	esodbc_estype_st *estype;
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+
+	pos = 0;
+	if (dest) {
+		dest[pos] = '[';
+	}
+	pos ++;
+
+	/* some apps set/reset various parameter record attributes (maybe to
+	 * workaround for some driver issues? like Linked Servers), which increaes
+	 * the record count, but (1) do not bind the parameter and (2) do not use
+	 * the standard mechanism (through SQL_DESC_ARRAY_STATUS_PTR) to signal
+	 * params to ignore. */
+	count = count_bound(stmt->apd);
+	for (i = 0; i < count; i ++) {
+		ret = get_param_recs(stmt, i + 1, &arec, &irec);
+		if (! SQL_SUCCEEDED(ret)) {
+			return ret;
+		}
+
+		if (dest) {
+			if (i) {
+				memcpy(dest + pos, ", ", 2);
+			}
+			/* copy 'type' JSON key name */
+			memcpy(dest + pos + 2 * !!i, j_type.str, j_type.cnt);
+		}
+		pos += 2 * !!i + j_type.cnt;
+
+		/* copy/eval ES/SQL type name */
+		/* Due to UNSIGNED_LONG type requiring value evaluation, which only
+		 * happens below with convert_param_val(), a max is used for the first
+		 * lenght-evaluation pass. */
+		estype = dest ? irec->es_type : dbc->lgst_name;
+		pos += json_escape(estype->type_name_c.str, estype->type_name_c.cnt,
+				dest ? dest + pos : NULL, /*"unlimited" buffer*/(size_t)-1);
+
+		if (dest) {
+			/* copy 'value' JSON key name */
+			memcpy(dest + pos, j_val.str, j_val.cnt);
+		}
+		pos += j_val.cnt;
+
+		/* copy converted parameter value */
+		ret = convert_param_val(arec, irec, stmt->param_set,
+				dest ? dest + pos : NULL, &l);
+		if (SQL_SUCCEEDED(ret)) {
+			pos += l;
+		} else {
+			ERRH(stmt, "converting parameter #%hd failed.", i + 1);
+			return ret;
+		}
+
+		if (dest) {
+			dest[pos] = '}';
+		}
+		pos ++;
+	}
+
+	if (dest) {
+		dest[pos] = ']';
+	}
+	pos ++;
+
+	*len = pos;
+	return SQL_SUCCESS;
+}
+
+static inline size_t copy_bool_val(char *dest, BOOL val)
+{
+	if (val) {
+		memcpy(dest, "true", sizeof("true") - 1);
+		return sizeof("true") - 1;
+	} else {
+		memcpy(dest, "false", sizeof("false") - 1);
+		return sizeof("false") - 1;
+	}
+}
+
+#define FAIL_ON_CBOR_ERR(_hnd, _cbor_err) \
+	do { \
+		if (_cbor_err != CborNoError) { \
+			ERRH(_hnd, "CBOR: %s.", cbor_error_string(_cbor_err)); \
+			RET_HDIAG(_hnd, SQL_STATE_HY000, "CBOR serialization error", \
+				_cbor_err); \
+		} \
+	} while (0)
+
+/* Release the statement's request template. */
+void free_request_tmpl(esodbc_stmt_st *stmt)
+{
+	if (stmt->tmpl.buff.str) {
+		free(stmt->tmpl.buff.str);
+	}
+	memset(&stmt->tmpl, 0, sizeof(stmt->tmpl));
+}
+
+/* Are the time zone and catalog encoded in the template still current? */
+static BOOL request_tmpl_current(esodbc_stmt_st *stmt, const cstr_st *tz)
+{
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+
+	if (! stmt->tmpl.buff.str) {
+		return FALSE;
+	}
+	if (stmt->tmpl.tz.cnt != tz->cnt ||
+		memcmp(stmt->tmpl.tz.str, tz->str, tz->cnt)) {
+		DBGH(stmt, "time zone changed since template built.");
+		return FALSE;
+	}
+	if (stmt->tmpl.catalog.cnt != dbc->catalog.c.cnt || (dbc->catalog.c.cnt &&
+			memcmp(stmt->tmpl.catalog.str, dbc->catalog.c.str,
+				dbc->catalog.c.cnt))) {
+		DBGH(stmt, "catalog changed since template built.");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* Allocate the template buffer and copy in it the time zone and catalog the
+ * template is going to encode; the returned position is where the head of
+ * the query request can be written. */
+static SQLCHAR *alloc_request_tmpl(esodbc_stmt_st *stmt, const cstr_st *tz,
+	size_t len)
+{
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	cstr_st *catalog = &dbc->catalog.c;
+	SQLCHAR *pos;
+
+	free_request_tmpl(stmt);
+	len += tz->cnt + catalog->cnt;
+	if (! (stmt->tmpl.buff.str = malloc(len))) {
+		ERRNH(stmt, "OOM for %zu bytes.", len);
+		return NULL;
+	}
+	stmt->tmpl.buff.cnt = len;
+
+	pos = stmt->tmpl.buff.str;
+	memcpy(pos, tz->str, tz->cnt);
+	stmt->tmpl.tz.str = pos;
+	stmt->tmpl.tz.cnt = tz->cnt;
+	pos += tz->cnt;
+	if (catalog->cnt) {
+		memcpy(pos, catalog->str, catalog->cnt);
+		stmt->tmpl.catalog.str = pos;
+		stmt->tmpl.catalog.cnt = catalog->cnt;
+		pos += catalog->cnt;
+	}
+	return pos;
+}
+
+/* Encode the parts of a JSON request that don't depend on the parameters:
+ * - head: `{"query": "..."`;
+ * - tail: `, "fetch_size": ..., ..., "version": "..."` + the cursor tail;
+ * - cursor tail: `, "mode": ..., "binary_format": false}`. */
+static SQLRETURN build_request_tmpl_json(esodbc_stmt_st *stmt,
+	const cstr_st *tz)
+{
+	size_t len, pos, curs_pos;
+	char *body;
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+
+	/* head */
+	len = 1; /* { */
+	len += sizeof(JSON_KEY_QUERY) - 1;
+	/* (json_escape() takes a 0 length for a 0-terminated input) */
+	if (stmt->u8sql.cnt) {
+		len += json_escape(stmt->u8sql.str, stmt->u8sql.cnt, NULL, 0);
+	}
+	len += 2; /* 2x `"` for query value */
+	/* tail */
+	if (dbc->fetch.slen) {
+		len += sizeof(JSON_KEY_FETCH) - 1;
+		len += dbc->fetch.slen;
+	}
+	len += sizeof(JSON_KEY_MULTIVAL) - 1;
+	len += /*false*/5;
+	len += sizeof(JSON_KEY_IDX_FROZEN) - 1;
+	len += /*false*/5;
+	len += sizeof(JSON_KEY_TIMEZONE) - 1;
+	len += tz->cnt;
+	if (dbc->catalog.c.cnt) {
+		len += sizeof(JSON_KEY_CATALOG) - 1;
+		len += dbc->catalog.c.cnt;
+		len += /* 2x `"` */2;
+	}
+	len += sizeof(JSON_KEY_VERSION) - 1;
+	len += version.cnt + /* 2x`"` */2;
+	/* cursor tail */
+	len += sizeof(JSON_KEY_VAL_MODE) - 1;
+	len += sizeof(JSON_KEY_CLT_ID) - 1;
+	len += sizeof(JSON_KEY_BINARY_FMT) - 1;
+	len += sizeof("false") - 1;
+	if (dbc->columnar) {
+		len += sizeof(JSON_KEY_COLUMNAR) - 1;
+	}
+	len += 1; /* } */
+
+	if (! (body = (char *)alloc_request_tmpl(stmt, tz, len))) {
+		RET_HDIAGS(stmt, SQL_STATE_HY001);
+	}
+
+	pos = 0;
+	body[pos ++] = '{';
+	/* "query": "..." */
+	memcpy(body + pos, JSON_KEY_QUERY, sizeof(JSON_KEY_QUERY) - 1);
+	pos += sizeof(JSON_KEY_QUERY) - 1;
+	body[pos ++] = '"';
+	if (stmt->u8sql.cnt) {
+		pos += json_escape(stmt->u8sql.str, stmt->u8sql.cnt, body + pos,
+				len - pos);
+	}
+	body[pos ++] = '"';
+	stmt->tmpl.head.str = (SQLCHAR *)body;
+	stmt->tmpl.head.cnt = pos;
+
+	/* does the statement have any fetch_size? */
+	if (dbc->fetch.slen) {
+		memcpy(body + pos, JSON_KEY_FETCH, sizeof(JSON_KEY_FETCH) - 1);
+		pos += sizeof(JSON_KEY_FETCH) - 1;
+		memcpy(body + pos, dbc->fetch.str, dbc->fetch.slen);
+		pos += dbc->fetch.slen;
+	}
+	/* "field_multi_value_leniency": true/false */
+	memcpy(body + pos, JSON_KEY_MULTIVAL, sizeof(JSON_KEY_MULTIVAL) - 1);
+	pos += sizeof(JSON_KEY_MULTIVAL) - 1;
+	pos += copy_bool_val(body + pos, dbc->mfield_lenient);
+	/* "index_include_frozen": true/false */
+	memcpy(body + pos, JSON_KEY_IDX_FROZEN, sizeof(JSON_KEY_IDX_FROZEN) - 1);
+	pos += sizeof(JSON_KEY_IDX_FROZEN) - 1;
+	pos += copy_bool_val(body + pos, dbc->idx_inc_frozen);
+	/* "time_zone": "-05:45" */
+	memcpy(body + pos, JSON_KEY_TIMEZONE, sizeof(JSON_KEY_TIMEZONE) - 1);
+	pos += sizeof(JSON_KEY_TIMEZONE) - 1;
+	memcpy(body + pos, tz->str, tz->cnt);
+	pos += tz->cnt;
+	if (dbc->catalog.c.cnt) {
+		/* "catalog": "my_cluster" */
+		memcpy(body + pos, JSON_KEY_CATALOG, sizeof(JSON_KEY_CATALOG) - 1);
+		pos += sizeof(JSON_KEY_CATALOG) - 1;
+		body[pos ++] = '"';
+		memcpy(body + pos, dbc->catalog.c.str, dbc->catalog.c.cnt);
+		pos += dbc->catalog.c.cnt;
+		body[pos ++] = '"';
+	}
+	/* "version": ... */
+	memcpy(body + pos, JSON_KEY_VERSION, sizeof(JSON_KEY_VERSION) - 1);
+	pos += sizeof(JSON_KEY_VERSION) - 1;
+	body[pos ++] = '"';
+	memcpy(body + pos, version.str, version.cnt);
+	pos += version.cnt;
+	body[pos ++] = '"';
+
+	curs_pos = pos;
+	/* "mode": "ODBC" */
+	memcpy(body + pos, JSON_KEY_VAL_MODE, sizeof(JSON_KEY_VAL_MODE) - 1);
+	pos += sizeof(JSON_KEY_VAL_MODE) - 1;
+	/* "client_id": "odbcXX" */
+	memcpy(body + pos, JSON_KEY_CLT_ID, sizeof(JSON_KEY_CLT_ID) - 1);
+	pos += sizeof(JSON_KEY_CLT_ID) - 1;
+	/* "binary_format": false (true means CBOR) */
+	memcpy(body + pos, JSON_KEY_BINARY_FMT, sizeof(JSON_KEY_BINARY_FMT) - 1);
+	pos += sizeof(JSON_KEY_BINARY_FMT) - 1;
+	pos += copy_bool_val(body + pos, FALSE);
+	/* "columnar": true (ES won't remember it across pages) */
+	if (dbc->columnar) {
+		memcpy(body + pos, JSON_KEY_COLUMNAR, sizeof(JSON_KEY_COLUMNAR) - 1);
+		pos += sizeof(JSON_KEY_COLUMNAR) - 1;
+	}
+	body[pos ++] = '}';
+
+	assert(pos <= len);
+	stmt->tmpl.tail.str = (SQLCHAR *)body + stmt->tmpl.head.cnt;
+	stmt->tmpl.tail.cnt = pos - stmt->tmpl.head.cnt;
+	stmt->tmpl.curs_tail.str = (SQLCHAR *)body + curs_pos;
+	stmt->tmpl.curs_tail.cnt = pos - curs_pos;
+	return SQL_SUCCESS;
+}
+
+/* Encode the parts of a CBOR request that don't depend on the parameters, as
+ * sequences of map items (the map header depends on the presence of the
+ * parameters):
+ * - head: "query": "...";
+ * - tail: "fetch_size": ..., ..., "version": "..." + the cursor tail;
+ * - cursor tail: "mode": ..., "binary_format": true. */
+static SQLRETURN build_request_tmpl_cbor(esodbc_stmt_st *stmt,
+	const cstr_st *tz)
+{
+	CborEncoder enc;
+	CborError err;
+	size_t len, keys, curs_keys;
+	SQLCHAR *body, *curs_tail;
+	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+
+	/* head */
+	len = cbor_str_obj_len(sizeof(REQ_KEY_QUERY) - 1);
+	len += cbor_str_obj_len(stmt->u8sql.cnt);
+	keys = 1;
+	/* tail */
+	if (dbc->fetch.slen) {
+		len += cbor_str_obj_len(sizeof(REQ_KEY_FETCH) - 1);
+		len += CBOR_INT_OBJ_LEN(dbc->fetch.max);
+		keys ++;
+	}
+	len += cbor_str_obj_len(sizeof(REQ_KEY_MULTIVAL) - 1);
+	len += CBOR_OBJ_BOOL_LEN;
+	len += cbor_str_obj_len(sizeof(REQ_KEY_IDX_FROZEN) - 1);
+	len += CBOR_OBJ_BOOL_LEN;
+	len += cbor_str_obj_len(sizeof(REQ_KEY_TIMEZONE) - 1);
+	len += cbor_str_obj_len(tz->cnt);
+	keys += 3;
+	if (dbc->catalog.c.cnt) {
+		len += cbor_str_obj_len(sizeof(REQ_KEY_CATALOG) - 1);
+		len += cbor_str_obj_len(dbc->catalog.c.cnt);
+		keys ++;
+	}
+	len += cbor_str_obj_len(sizeof(REQ_KEY_VERSION) - 1);
+	len += cbor_str_obj_len(version.cnt);
+	keys ++;
+	/* cursor tail */
+	len += cbor_str_obj_len(sizeof(REQ_KEY_MODE) - 1);
+	len += cbor_str_obj_len(sizeof(REQ_VAL_MODE) - 1);
+	len += cbor_str_obj_len(sizeof(REQ_KEY_CLT_ID) - 1);
+	len += cbor_str_obj_len(sizeof(REQ_VAL_CLT_ID) - 1);
+	len += cbor_str_obj_len(sizeof(REQ_KEY_BINARY_FMT) - 1);
+	len += CBOR_OBJ_BOOL_LEN;
+	curs_keys = 3;
+	if (dbc->columnar) {
+		len += cbor_str_obj_len(sizeof(REQ_KEY_COLUMNAR) - 1);
+		len += CBOR_OBJ_BOOL_LEN;
+		curs_keys ++;
+	}
+
+	if (! (body = alloc_request_tmpl(stmt, tz, len))) {
+		RET_HDIAGS(stmt, SQL_STATE_HY001);
+	}
+	/* the items are encoded as a sequence, outside of any container */
+	cbor_encoder_init(&enc, body, len, /*flags*/0);
+
+	err = cbor_encode_text_string(&enc, REQ_KEY_QUERY,
+			sizeof(REQ_KEY_QUERY) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	err = cbor_encode_text_string(&enc, stmt->u8sql.str, stmt->u8sql.cnt);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	stmt->tmpl.head.str = body;
+	stmt->tmpl.head.cnt = cbor_encoder_get_buffer_size(&enc, body);
+
+	/* does the statement have any fetch_size? */
+	if (dbc->fetch.slen) {
+		err = cbor_encode_text_string(&enc, REQ_KEY_FETCH,
+				sizeof(REQ_KEY_FETCH) - 1);
+		FAIL_ON_CBOR_ERR(stmt, err);
+		err = cbor_encode_uint(&enc, dbc->fetch.max);
+		FAIL_ON_CBOR_ERR(stmt, err);
+	}
+	/* "field_multi_value_leniency": true/false */
+	err = cbor_encode_text_string(&enc, REQ_KEY_MULTIVAL,
+			sizeof(REQ_KEY_MULTIVAL) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	err = cbor_encode_boolean(&enc, dbc->mfield_lenient);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	/* "index_include_frozen": true/false */
+	err = cbor_encode_text_string(&enc, REQ_KEY_IDX_FROZEN,
+			sizeof(REQ_KEY_IDX_FROZEN) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	err = cbor_encode_boolean(&enc, dbc->idx_inc_frozen);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	/* "time_zone": "-05:45" */
+	err = cbor_encode_text_string(&enc, REQ_KEY_TIMEZONE,
+			sizeof(REQ_KEY_TIMEZONE) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	err = cbor_encode_text_string(&enc, tz->str, tz->cnt);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	if (dbc->catalog.c.cnt) {
+		err = cbor_encode_text_string(&enc, REQ_KEY_CATALOG,
+				sizeof(REQ_KEY_CATALOG) - 1);
+		FAIL_ON_CBOR_ERR(stmt, err);
+		err = cbor_encode_text_string(&enc, dbc->catalog.c.str,
+				dbc->catalog.c.cnt);
+		FAIL_ON_CBOR_ERR(stmt, err);
+	}
+	/* version */
+	err = cbor_encode_text_string(&enc, REQ_KEY_VERSION,
+			sizeof(REQ_KEY_VERSION) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	err = cbor_encode_text_string(&enc, version.str, version.cnt);
+	FAIL_ON_CBOR_ERR(stmt, err);
+
+	curs_tail = body + cbor_encoder_get_buffer_size(&enc, body);
+	/* mode : ODBC */
+	err = cbor_encode_text_string(&enc, REQ_KEY_MODE,
+			sizeof(REQ_KEY_MODE) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	err = cbor_encode_text_string(&enc, REQ_VAL_MODE,
+			sizeof(REQ_VAL_MODE) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	/* client_id : odbcXX */
+	err = cbor_encode_text_string(&enc, REQ_KEY_CLT_ID,
+			sizeof(REQ_KEY_CLT_ID) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	err = cbor_encode_text_string(&enc, REQ_VAL_CLT_ID,
+			sizeof(REQ_VAL_CLT_ID) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	/* binary_format: true (false means JSON) */
+	err = cbor_encode_text_string(&enc, REQ_KEY_BINARY_FMT,
+			sizeof(REQ_KEY_BINARY_FMT) - 1);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	err = cbor_encode_boolean(&enc, TRUE);
+	FAIL_ON_CBOR_ERR(stmt, err);
+	/* columnar: true (ES won't remember it across pages) */
+	if (dbc->columnar) {
+		err = cbor_encode_text_string(&enc, REQ_KEY_COLUMNAR,
+				sizeof(REQ_KEY_COLUMNAR) - 1);
+		FAIL_ON_CBOR_ERR(stmt, err);
+		err = cbor_encode_boolean(&enc, TRUE);
+		FAIL_ON_CBOR_ERR(stmt, err);
+	}
+
+	len = cbor_encoder_get_buffer_size(&enc, body);
+	stmt->tmpl.tail.str = body + stmt->tmpl.head.cnt;
+	stmt->tmpl.tail.cnt = len - stmt->tmpl.head.cnt;
+	stmt->tmpl.curs_tail.str = curs_tail;
+	stmt->tmpl.curs_tail.cnt = body + len - curs_tail;
+	stmt->tmpl.keys = keys + curs_keys;
+	stmt->tmpl.curs_keys = /*cursor*/1 + curs_keys;
+	return SQL_SUCCESS;
+}
+
+/* (Re)build the request template, if the statement lacks a current one. The
+ * cursor tail only depends on the connection, so a template is kept (and
+ * used for the cursor requests) after the query is detached. */
+static SQLRETURN update_request_tmpl(esodbc_stmt_st *stmt, BOOL cursor)
 {
-	/* JSON keys for building one parameter object */
-	const static cstr_st j_type = CSTR_INIT("{\"" REQ_KEY_PARAM_TYPE "\": \"");
-	const static cstr_st j_val = CSTR_INIT("\", \"" REQ_KEY_PARAM_VAL "\": ");
-	esodbc_rec_st *arec, *irec;
 	SQLRETURN ret;
-	SQLSMALLINT i, count;
-	size_t l, pos;
-	esodbc_estype_st *estype;
+	cstr_st tz;
 	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
 
-	pos = 0;
-	if (dest) {
-		dest[pos] = '[';
+	if (dbc->apply_tz) {
+		tz = tz_param;
+	} else if (dbc->pack_json) {
+		tz = (cstr_st)CSTR_INIT(JSON_VAL_TIMEZONE_Z);
+	} else {
+		tz = (cstr_st)CSTR_INIT(REQ_VAL_TIMEZONE_Z);
 	}
-	pos ++;
-
-	/* some apps set/reset various parameter record attributes (maybe to
-	 * workaround for some driver issues? like Linked Servers), which increaes
-	 * the record count, but (1) do not bind the parameter and (2) do not use
-	 * the standard mechanism (through SQL_DESC_ARRAY_STATUS_PTR) to signal
-	 * params to ignore. */
-	count = count_bound(stmt->apd);
-	for (i = 0; i < count; i ++) {
-		ret = get_param_recs(stmt, i + 1, &arec, &irec);
-		if (! SQL_SUCCEEDED(ret)) {
-			return ret;
-		}
-
-		if (dest) {
-			if (i) {
-				memcpy(dest + pos, ", ", 2);
-			}
-			/* copy 'type' JSON key name */
-			memcpy(dest + pos + 2 * !!i, j_type.str, j_type.cnt);
-		}
-		pos += 2 * !!i + j_type.cnt;
-
-		/* copy/eval ES/SQL type name */
-		/* Due to UNSIGNED_LONG type requiring value evaluation, which only
-		 * happens below with convert_param_val(), a max is used for the first
-		 * lenght-evaluation pass. */
-		estype = dest ? irec->es_type : dbc->lgst_name;
-		pos += json_escape(estype->type_name_c.str, estype->type_name_c.cnt,
-				dest ? dest + pos : NULL, /*"unlimited" buffer*/(size_t)-1);
-
-		if (dest) {
-			/* copy 'value' JSON key name */
-			memcpy(dest + pos, j_val.str, j_val.cnt);
-		}
-		pos += j_val.cnt;
-
-		/* copy converted parameter value */
-		ret = convert_param_val(arec, irec, /*params array pos*/0LLU,
-				dest ? dest + pos : NULL, &l);
-		if (SQL_SUCCEEDED(ret)) {
-			pos += l;
-		} else {
-			ERRH(stmt, "converting parameter #%hd failed.", i + 1);
-			return ret;
-		}
-
-		if (dest) {
-			dest[pos] = '}';
-		}
-		pos ++;
+	if (request_tmpl_current(stmt, &tz) && (cursor || stmt->tmpl.query)) {
+		return SQL_SUCCESS;
 	}
 
-	if (dest) {
-		dest[pos] = ']';
+	ret = dbc->pack_json ? build_request_tmpl_json(stmt, &tz) :
+		build_request_tmpl_cbor(stmt, &tz);
+	if (SQL_SUCCEEDED(ret)) {
+		/* built on cursor request, after the query had been detached? */
+		stmt->tmpl.query = stmt->u8sql.str != NULL;
+		DBGH(stmt, "request template built: head: %zu, tail: %zu, cursor "
+			"tail: %zu bytes.", stmt->tmpl.head.cnt, stmt->tmpl.tail.cnt,
+			stmt->tmpl.curs_tail.cnt);
+	} else {
+		free_request_tmpl(stmt);
 	}
-	pos ++;
-
-	*len = pos;
-	return SQL_SUCCESS;
+	return ret;
 }
 
 static SQLRETURN statement_len_cbor(esodbc_stmt_st *stmt, size_t *enc_len,
@@ -3031,14 +4484,11 @@ static SQLRETURN statement_len_cbor(esodbc_stmt_st *stmt, size_t *enc_len,
 {
 	SQLRETURN ret;
 	size_t bodylen, len, curslen;
-	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
-
-	/* Initial all-encompassing map preamble. */
-	bodylen = cbor_nn_hdr_len(REST_REQ_KEY_COUNT); /* max count */
 
-	*keys = 1; /* cursor or query */
 	curslen = STMT_HAS_CURSOR(stmt);
 	if (curslen) { /* eval CURSOR object length */
+		*keys = stmt->tmpl.curs_keys;
+		bodylen = cbor_nn_hdr_len(*keys);
 		bodylen += cbor_str_obj_len(sizeof(REQ_KEY_CURSOR) - 1);
 		bodylen += cbor_str_obj_len(curslen);
 		if (stmt->rset.pack_json) {
@@ -3050,9 +4500,10 @@ static SQLRETURN statement_len_cbor(esodbc_stmt_st *stmt, size_t *enc_len,
 			 * string object header's length. */
 			bodylen += cbor_nn_hdr_len(curslen);
 		}
+		bodylen += stmt->tmpl.curs_tail.cnt;
 	} else { /* eval QUERY object length */
-		bodylen += cbor_str_obj_len(sizeof(REQ_KEY_QUERY) - 1);
-		bodylen += cbor_str_obj_len(stmt->u8sql.cnt);
+		*keys = stmt->tmpl.keys;
+		bodylen = stmt->tmpl.head.cnt + stmt->tmpl.tail.cnt;
 
 		/* does the statement have any bound parameters? */
 		if (count_bound(stmt->apd)) {
@@ -3066,47 +4517,9 @@ static SQLRETURN statement_len_cbor(esodbc_stmt_st *stmt, size_t *enc_len,
 			bodylen += len;
 			(*keys) ++;
 		}
-
-		/* does the statement have any fetch_size? */
-		if (dbc->fetch.slen) {
-			bodylen += cbor_str_obj_len(sizeof(REQ_KEY_FETCH) - 1);
-			bodylen += CBOR_INT_OBJ_LEN(dbc->fetch.max);
-			(*keys) ++;
-		}
-		/* "field_multi_value_leniency": true/false */
-		bodylen += cbor_str_obj_len(sizeof(REQ_KEY_MULTIVAL) - 1);
-		bodylen += CBOR_OBJ_BOOL_LEN;
-		(*keys) ++;
-		/* "index_include_frozen": true/false */
-		bodylen += cbor_str_obj_len(sizeof(REQ_KEY_IDX_FROZEN) - 1);
-		bodylen += CBOR_OBJ_BOOL_LEN;
-		(*keys) ++;
-		/* "time_zone": "-05:45" */
-		bodylen += cbor_str_obj_len(sizeof(REQ_KEY_TIMEZONE) - 1);
-		bodylen += cbor_str_obj_len(tz_param.cnt); /* lax len */
-		(*keys) ++;
-		/* "catalog": "my_cluster" */
-		if (dbc->catalog.c.cnt) {
-			bodylen += cbor_str_obj_len(sizeof(REQ_KEY_CATALOG) - 1);
-			bodylen += cbor_str_obj_len(dbc->catalog.c.cnt);
-			(*keys) ++;
-		}
-		bodylen += cbor_str_obj_len(sizeof(REQ_KEY_VERSION) - 1);
-		bodylen += cbor_str_obj_len(version.cnt);
-		(*keys) ++;
-	}
-	/* mode */
-	bodylen += cbor_str_obj_len(sizeof(REQ_KEY_MODE) - 1);
-	bodylen += cbor_str_obj_len(sizeof(REQ_VAL_MODE) - 1);
-	(*keys) ++;
-	/* client_id */
-	bodylen += cbor_str_obj_len(sizeof(REQ_KEY_CLT_ID) - 1);
-	bodylen += cbor_str_obj_len(sizeof(REQ_VAL_CLT_ID) - 1);
-	(*keys) ++;
-	/* binary_format */
-	bodylen += cbor_str_obj_len(sizeof(REQ_KEY_BINARY_FMT) - 1);
-	bodylen += CBOR_OBJ_BOOL_LEN;
-	(*keys) ++;
+		/* map preamble */
+		bodylen += cbor_nn_hdr_len(*keys);
+	}
 	/* TODO: request_/page_timeout */
 
 	assert(*keys <= REST_REQ_KEY_COUNT);
@@ -3118,22 +4531,20 @@ static SQLRETURN statement_len_json(esodbc_stmt_st *stmt, size_t *outlen)
 {
 	SQLRETURN ret;
 	size_t bodylen, len, curslen;
-	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
 
-	bodylen = 1; /* { */
 	curslen = STMT_HAS_CURSOR(stmt);
 	/* evaluate how long the stringified REST object will be */
 	if (curslen) { /* eval CURSOR object length */
 		/* assumptions: (1) the cursor is a Base64 encoded string and thus
 		 * (2) no JSON escaping needed.
 		 * (both assumptions checked on copy, in serialize_to_json()). */
+		bodylen = 1; /* { */
 		bodylen += sizeof(JSON_KEY_CURSOR) - 1; /* "cursor":  */
 		bodylen += curslen;
 		bodylen += 2; /* 2x `"` for cursor value */
+		bodylen += stmt->tmpl.curs_tail.cnt;
 	} else { /* eval QUERY object length */
-		bodylen += sizeof(JSON_KEY_QUERY) - 1;
-		bodylen += json_escape(stmt->u8sql.str, stmt->u8sql.cnt, NULL, 0);
-		bodylen += 2; /* 2x `"` for query value */
+		bodylen = stmt->tmpl.head.cnt + stmt->tmpl.tail.cnt;
 
 		/* does the statement have any bound parameters? */
 		if (count_bound(stmt->apd)) {
@@ -3147,50 +4558,13 @@ static SQLRETURN statement_len_json(esodbc_stmt_st *stmt, size_t *outlen)
 			}
 			bodylen += len;
 		}
-		/* does the statement have any fetch_size? */
-		if (dbc->fetch.slen) {
-			bodylen += sizeof(JSON_KEY_FETCH) - /*\0*/1;
-			bodylen += dbc->fetch.slen;
-		}
-		/* "field_multi_value_leniency": true/false */
-		bodylen += sizeof(JSON_KEY_MULTIVAL) - 1;
-		bodylen += /*false*/5;
-		/* "index_include_frozen": true/false */
-		bodylen += sizeof(JSON_KEY_IDX_FROZEN) - 1;
-		bodylen += /*false*/5;
-		/* "time_zone": "-05:45" */
-		bodylen += sizeof(JSON_KEY_TIMEZONE) - 1;
-		bodylen += tz_param.cnt;
-		/* "catalog": "my_cluster" */
-		if (dbc->catalog.c.cnt) {
-			bodylen += sizeof(JSON_KEY_CATALOG) - 1;
-			bodylen += dbc->catalog.c.cnt;
-			bodylen += /* 2x `"` */2;
-		}
-		/* "version": */
-		bodylen += sizeof(JSON_KEY_VERSION) - 1;
-		bodylen += version.cnt + /* 2x`"` */2;
-	}
-	bodylen += sizeof(JSON_KEY_VAL_MODE) - 1; /* "mode": */
-	bodylen += sizeof(JSON_KEY_CLT_ID) - 1; /* "client_id": */
-	bodylen += sizeof(JSON_KEY_BINARY_FMT) - 1; /* "binary_format": false */
-	bodylen += sizeof("false") - 1;
+	}
 	/* TODO: request_/page_timeout */
-	bodylen += 1; /* } */
 
 	*outlen = bodylen;
 	return SQL_SUCCESS;
 }
 
-#define FAIL_ON_CBOR_ERR(_hnd, _cbor_err) \
-	do { \
-		if (_cbor_err != CborNoError) { \
-			ERRH(_hnd, "CBOR: %s.", cbor_error_string(_cbor_err)); \
-			RET_HDIAG(_hnd, SQL_STATE_HY000, "CBOR serialization error", \
-				_cbor_err); \
-		} \
-	} while (0)
-
 static SQLRETURN statement_params_len_cbor(esodbc_stmt_st *stmt,
 	size_t *enc_len, size_t *conv_len)
 {
@@ -3226,7 +4600,7 @@ static SQLRETURN statement_params_len_cbor(esodbc_stmt_st *stmt,
 		assert(irec->es_type);
 
 		/* assume quick maxes */
-		ret = convert_param_val(arec, irec, /*params array pos*/0,
+		ret = convert_param_val(arec, irec, stmt->param_set,
 				/*dest: calc length*/NULL, &l);
 		if (! SQL_SUCCEEDED(ret)) {
 			return ret;
@@ -3260,8 +4634,8 @@ static SQLRETURN serialize_param_cbor(esodbc_rec_st *arec,
 	size_t len;
 	SQLLEN *ind_ptr;
 	size_t skip_quote;
-	static SQLULEN param_array_pos = 0; /* parames array not yet supported */
 	esodbc_stmt_st *stmt = HDRH(arec->desc)->stmt;
+	SQLULEN param_array_pos = stmt->param_set;
 
 	ind_ptr = deferred_address(SQL_DESC_INDICATOR_PTR, param_array_pos, arec);
 	if (ind_ptr && *ind_ptr == SQL_NULL_DATA) {
@@ -3374,14 +4748,56 @@ static SQLRETURN serialize_params_cbor(esodbc_stmt_st *stmt, CborEncoder *map,
 	return SQL_SUCCESS;
 }
 
+/*
+ * tinycbor has no API to append already encoded items to a container, so
+ * cbor_append_encoded() needs to advance the encoder itself. This is the
+ * only place that touches the encoder's members, which are tied to the
+ * vendored version (0.5.4):
+ * struct CborEncoder {
+ *     union { uint8_t *ptr; ptrdiff_t bytes_needed; } data;
+ *     const uint8_t *end;
+ *     size_t remaining; // items left to add, +1
+ *     int flags;
+ * };
+ * Review the function when updating the library.
+ */
+#if TINYCBOR_VERSION_MAJOR != 0 || TINYCBOR_VERSION_MINOR != 5 || \
+	TINYCBOR_VERSION_PATCH != 4
+#	error "tinycbor version changed: review cbor_append_encoded()"
+#endif
+C_ASSERT(offsetof(CborEncoder, data) == 0);
+C_ASSERT(sizeof(((CborEncoder *)0)->data) == sizeof(uint8_t *));
+C_ASSERT(offsetof(CborEncoder, end) == sizeof(uint8_t *));
+C_ASSERT(offsetof(CborEncoder, remaining) == 2 * sizeof(uint8_t *));
+C_ASSERT(offsetof(CborEncoder, flags) ==
+	2 * sizeof(uint8_t *) + sizeof(size_t));
+
+/* Append to the map being encoded the 'pairs' count of key-value items
+ * already encoded in 'raw'. */
+static BOOL cbor_append_encoded(CborEncoder *map, const cstr_st *raw,
+	size_t pairs)
+{
+	/* only definite length containers, writing into a buffer (vs.
+	 * counting the bytes needed) */
+	assert(! (map->flags & CborIteratorFlag_UnknownLength));
+	if (! map->end || map->end < map->data.ptr + raw->cnt) {
+		return FALSE;
+	}
+	memcpy(map->data.ptr, raw->str, raw->cnt);
+	map->data.ptr += raw->cnt;
+	assert(2 * pairs < map->remaining);
+	map->remaining -= 2 * pairs;
+	return TRUE;
+}
+
 static SQLRETURN serialize_to_cbor(esodbc_stmt_st *stmt, cstr_st *dest,
 	size_t conv_len, size_t keys)
 {
 	CborEncoder encoder, map;
 	CborError err;
-	cstr_st tz, curs;
-	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	cstr_st curs;
 	size_t dest_cnt;
+	BOOL appended;
 
 	assert(conv_len < dest->cnt);
 	cbor_encoder_init(&encoder, dest->str, dest->cnt - conv_len, /*flags*/0);
@@ -3408,86 +4824,25 @@ static SQLRETURN serialize_to_cbor(esodbc_stmt_st *stmt, cstr_st *dest,
 		}
 		err = cbor_encode_text_string(&map, curs.str, curs.cnt);
 		FAIL_ON_CBOR_ERR(stmt, err);
+		appended = cbor_append_encoded(&map, &stmt->tmpl.curs_tail,
+				stmt->tmpl.curs_keys - /*cursor*/1);
 	} else { /* copy QUERY object */
-		err = cbor_encode_text_string(&map, REQ_KEY_QUERY,
-				sizeof(REQ_KEY_QUERY) - 1);
-		FAIL_ON_CBOR_ERR(stmt, err);
-		err = cbor_encode_text_string(&map, stmt->u8sql.str, stmt->u8sql.cnt);
-		FAIL_ON_CBOR_ERR(stmt, err);
-
+		appended = cbor_append_encoded(&map, &stmt->tmpl.head, /*query*/1);
 		/* does the statement have any bound parameters? */
-		if (count_bound(stmt->apd)) {
+		if (appended && count_bound(stmt->apd)) {
 			err = cbor_encode_text_string(&map, REQ_KEY_PARAMS,
 					sizeof(REQ_KEY_PARAMS) - 1);
 			FAIL_ON_CBOR_ERR(stmt, err);
 			err = serialize_params_cbor(stmt, &map, conv_len);
 			FAIL_ON_CBOR_ERR(stmt, err);
 		}
-		/* does the statement have any fetch_size? */
-		if (dbc->fetch.slen) {
-			err = cbor_encode_text_string(&map, REQ_KEY_FETCH,
-					sizeof(REQ_KEY_FETCH) - 1);
-			FAIL_ON_CBOR_ERR(stmt, err);
-			err = cbor_encode_uint(&map, dbc->fetch.max);
-			FAIL_ON_CBOR_ERR(stmt, err);
-		}
-		/* "field_multi_value_leniency": true/false */
-		err = cbor_encode_text_string(&map, REQ_KEY_MULTIVAL,
-				sizeof(REQ_KEY_MULTIVAL) - 1);
-		FAIL_ON_CBOR_ERR(stmt, err);
-		err = cbor_encode_boolean(&map, dbc->mfield_lenient);
-		FAIL_ON_CBOR_ERR(stmt, err);
-		/* "index_include_frozen": true/false */
-		err = cbor_encode_text_string(&map, REQ_KEY_IDX_FROZEN,
-				sizeof(REQ_KEY_IDX_FROZEN) - 1);
-		FAIL_ON_CBOR_ERR(stmt, err);
-		err = cbor_encode_boolean(&map, dbc->idx_inc_frozen);
-		FAIL_ON_CBOR_ERR(stmt, err);
-		/* "time_zone": "-05:45" */
-		err = cbor_encode_text_string(&map, REQ_KEY_TIMEZONE,
-				sizeof(REQ_KEY_TIMEZONE) - 1);
-		FAIL_ON_CBOR_ERR(stmt, err);
-		if (dbc->apply_tz) {
-			tz = tz_param;
-		} else {
-			tz = (cstr_st)CSTR_INIT(REQ_VAL_TIMEZONE_Z);
-		}
-		err = cbor_encode_text_string(&map, tz.str, tz.cnt);
-		FAIL_ON_CBOR_ERR(stmt, err);
-		if (dbc->catalog.c.cnt) {
-			err = cbor_encode_text_string(&map, REQ_KEY_CATALOG,
-					sizeof(REQ_KEY_CATALOG) - 1);
-			FAIL_ON_CBOR_ERR(stmt, err);
-			err = cbor_encode_text_string(&map, dbc->catalog.c.str,
-					dbc->catalog.c.cnt);
-			FAIL_ON_CBOR_ERR(stmt, err);
-		}
-		/* version */
-		err = cbor_encode_text_string(&map, REQ_KEY_VERSION,
-				sizeof(REQ_KEY_VERSION) - 1);
-		FAIL_ON_CBOR_ERR(stmt, err);
-		err = cbor_encode_text_string(&map, version.str, version.cnt);
-		FAIL_ON_CBOR_ERR(stmt, err);
+		appended = appended && cbor_append_encoded(&map, &stmt->tmpl.tail,
+				stmt->tmpl.keys - /*query*/1);
+	}
+	if (! appended) {
+		BUGH(stmt, "request template doesn't fit the serialization buffer.");
+		RET_HDIAGS(stmt, SQL_STATE_HY000);
 	}
-	/* mode : ODBC */
-	err = cbor_encode_text_string(&map, REQ_KEY_MODE,
-			sizeof(REQ_KEY_MODE) - 1);
-	FAIL_ON_CBOR_ERR(stmt, err);
-	err = cbor_encode_text_string(&map, REQ_VAL_MODE,
-			sizeof(REQ_VAL_MODE) - 1);
-	FAIL_ON_CBOR_ERR(stmt, err);
-	/* client_id : odbcXX */
-	err = cbor_encode_text_string(&map, REQ_KEY_CLT_ID,
-			sizeof(REQ_KEY_CLT_ID) - 1);
-	FAIL_ON_CBOR_ERR(stmt, err);
-	err = cbor_encode_text_string(&map, REQ_VAL_CLT_ID,
-			sizeof(REQ_VAL_CLT_ID) - 1);
-	FAIL_ON_CBOR_ERR(stmt, err);
-	/* binary_format: true (false means JSON) */
-	err = cbor_encode_text_string(&map, REQ_KEY_BINARY_FMT,
-			sizeof(REQ_KEY_BINARY_FMT) - 1);
-	FAIL_ON_CBOR_ERR(stmt, err);
-	err = cbor_encode_boolean(&map, TRUE);
 
 	err = cbor_encoder_close_container(&encoder, &map);
 	FAIL_ON_CBOR_ERR(stmt, err);
@@ -3501,28 +4856,17 @@ static SQLRETURN serialize_to_cbor(esodbc_stmt_st *stmt, cstr_st *dest,
 	return SQL_SUCCESS;
 }
 
-static inline size_t copy_bool_val(char *dest, BOOL val)
-{
-	if (val) {
-		memcpy(dest, "true", sizeof("true") - 1);
-		return sizeof("true") - 1;
-	} else {
-		memcpy(dest, "false", sizeof("false") - 1);
-		return sizeof("false") - 1;
-	}
-}
-
 static SQLRETURN serialize_to_json(esodbc_stmt_st *stmt, cstr_st *dest)
 {
 	SQLRETURN ret;
 	size_t pos, len;
 	char *body = dest->str;
-	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	cstr_st *tail;
 
 	pos = 0;
-	body[pos ++] = '{';
 	/* build the actual stringified JSON object */
 	if (STMT_HAS_CURSOR(stmt)) { /* copy CURSOR object */
+		body[pos ++] = '{';
 		memcpy(body + pos, JSON_KEY_CURSOR, sizeof(JSON_KEY_CURSOR) - 1);
 		pos += sizeof(JSON_KEY_CURSOR) - 1;
 		body[pos ++] = '"';
@@ -3543,13 +4887,10 @@ static SQLRETURN serialize_to_json(esodbc_stmt_st *stmt, cstr_st *dest)
 			pos += stmt->rset.pack.cbor.curs.cnt;
 		}
 		body[pos ++] = '"';
+		tail = &stmt->tmpl.curs_tail;
 	} else { /* copy QUERY object */
-		memcpy(body + pos, JSON_KEY_QUERY, sizeof(JSON_KEY_QUERY) - 1);
-		pos += sizeof(JSON_KEY_QUERY) - 1;
-		body[pos ++] = '"';
-		pos += json_escape(stmt->u8sql.str, stmt->u8sql.cnt, body + pos,
-				dest->cnt - pos);
-		body[pos ++] = '"';
+		memcpy(body + pos, stmt->tmpl.head.str, stmt->tmpl.head.cnt);
+		pos += stmt->tmpl.head.cnt;
 
 		/* does the statement have any parameters? */
 		if (count_bound(stmt->apd)) {
@@ -3563,61 +4904,10 @@ static SQLRETURN serialize_to_json(esodbc_stmt_st *stmt, cstr_st *dest)
 			}
 			pos += len;
 		}
-		/* does the statement have any fetch_size? */
-		if (dbc->fetch.slen) {
-			memcpy(body + pos, JSON_KEY_FETCH, sizeof(JSON_KEY_FETCH) - 1);
-			pos += sizeof(JSON_KEY_FETCH) - 1;
-			memcpy(body + pos, dbc->fetch.str, dbc->fetch.slen);
-			pos += dbc->fetch.slen;
-		}
-		/* "field_multi_value_leniency": true/false */
-		memcpy(body + pos, JSON_KEY_MULTIVAL, sizeof(JSON_KEY_MULTIVAL) - 1);
-		pos += sizeof(JSON_KEY_MULTIVAL) - 1;
-		pos += copy_bool_val(body + pos, dbc->mfield_lenient);
-		/* "index_include_frozen": true/false */
-		memcpy(body + pos, JSON_KEY_IDX_FROZEN,
-			sizeof(JSON_KEY_IDX_FROZEN) - 1);
-		pos += sizeof(JSON_KEY_IDX_FROZEN) - 1;
-		pos += copy_bool_val(body + pos, dbc->idx_inc_frozen);
-		/* "time_zone": "-05:45" */
-		memcpy(body + pos, JSON_KEY_TIMEZONE, sizeof(JSON_KEY_TIMEZONE) - 1);
-		pos += sizeof(JSON_KEY_TIMEZONE) - 1;
-		if (dbc->apply_tz) {
-			memcpy(body + pos, tz_param.str, tz_param.cnt);
-			pos += tz_param.cnt;
-		} else {
-			memcpy(body + pos, JSON_VAL_TIMEZONE_Z,
-				sizeof(JSON_VAL_TIMEZONE_Z) - 1);
-			pos += sizeof(JSON_VAL_TIMEZONE_Z) - 1;
-		}
-		if (dbc->catalog.c.cnt) {
-			/* "catalog": "my_cluster" */
-			memcpy(body + pos, JSON_KEY_CATALOG, sizeof(JSON_KEY_CATALOG) - 1);
-			pos += sizeof(JSON_KEY_CATALOG) - 1;
-			body[pos ++] = '"';
-			memcpy(body + pos, dbc->catalog.c.str, dbc->catalog.c.cnt);
-			pos += dbc->catalog.c.cnt;
-			body[pos ++] = '"';
-		}
-		/* "version": ... */
-		memcpy(body + pos, JSON_KEY_VERSION, sizeof(JSON_KEY_VERSION) - 1);
-		pos += sizeof(JSON_KEY_VERSION) - 1;
-		body[pos ++] = '"';
-		memcpy(body + pos, version.str, version.cnt);
-		pos += version.cnt;
-		body[pos ++] = '"';
+		tail = &stmt->tmpl.tail;
 	}
-	/* "mode": "ODBC" */
-	memcpy(body + pos, JSON_KEY_VAL_MODE, sizeof(JSON_KEY_VAL_MODE) - 1);
-	pos += sizeof(JSON_KEY_VAL_MODE) - 1;
-	/* "client_id": "odbcXX" */
-	memcpy(body + pos, JSON_KEY_CLT_ID, sizeof(JSON_KEY_CLT_ID) - 1);
-	pos += sizeof(JSON_KEY_CLT_ID) - 1;
-	/* "binary_format": false (true means CBOR) */
-	memcpy(body + pos, JSON_KEY_BINARY_FMT, sizeof(JSON_KEY_BINARY_FMT) - 1);
-	pos += sizeof(JSON_KEY_BINARY_FMT) - 1;
-	pos += copy_bool_val(body + pos, FALSE);
-	body[pos ++] = '}';
+	memcpy(body + pos, tail->str, tail->cnt);
+	pos += tail->cnt;
 
 	/* check that the buffer hasn't been overrun. it can be used less than
 	 * initially calculated, since the calculation is an upper-bound one. */
@@ -3639,14 +4929,19 @@ SQLRETURN TEST_API serialize_statement(esodbc_stmt_st *stmt, cstr_st *dest)
 	SQLRETURN ret;
 	size_t enc_len, conv_len, alloc_len, keys;
 	esodbc_dbc_st *dbc = HDRH(stmt)->dbc;
+	LONG64 start = perf_clock();
 
 	/* enforced in EsSQLSetDescFieldW(SQL_DESC_ARRAY_SIZE) */
-	assert(stmt->apd->array_size <= 1);
+	assert(stmt->param_set < stmt->apd->array_size);
 
 	if (! update_tz_param()) {
 		RET_HDIAG(stmt, SQL_STATE_HY000,
 			"Failed to update the timezone parameter", 0);
 	}
+	ret = update_request_tmpl(stmt, /*cursor?*/STMT_HAS_CURSOR(stmt));
+	if (! SQL_SUCCEEDED(ret)) {
+		return ret;
+	}
 
 	conv_len = 0;
 	ret = dbc->pack_json ? statement_len_json(stmt, &enc_len) :
@@ -3670,8 +4965,182 @@ SQLRETURN TEST_API serialize_statement(esodbc_stmt_st *stmt, cstr_st *dest)
 		dest->cnt = alloc_len;
 	}
 
-	return dbc->pack_json ? serialize_to_json(stmt, dest) :
+	ret = dbc->pack_json ? serialize_to_json(stmt, dest) :
 		serialize_to_cbor(stmt, dest, conv_len, keys);
+	STMT_PERF_LAPSE(stmt, ESODBC_PERF_TIME_SERIALIZE, start);
+	return ret;
+}
+
+/* Release the answers of a parameters array execution, if any. */
+void free_param_answers(esodbc_stmt_st *stmt)
+{
+	SQLULEN i;
+
+	if (! stmt->psets.answs) {
+		return;
+	}
+	for (i = 0; i < stmt->psets.cnt; i ++) {
+		if (stmt->psets.answs[i].body.str) {
+			free(stmt->psets.answs[i].body.str);
+		}
+	}
+	free(stmt->psets.answs);
+	memset(&stmt->psets, 0, sizeof(stmt->psets));
+}
+
+/* is the set to be excluded from execution, as per APD's status array?
+ * SQL_ATTR_PARAM_OPERATION_PTR only defines SQL_PARAM_PROCEED and
+ * SQL_PARAM_IGNORE: any value other than the latter has the set executed. */
+static BOOL param_set_ignored(esodbc_desc_st *apd, SQLULEN pos)
+{
+	return apd->array_status_ptr &&
+		apd->array_status_ptr[pos] == SQL_PARAM_IGNORE;
+}
+
+/*
+ * Executes the statement with each set of the parameters array: the sets are
+ * all serialized upfront, then their requests posted concurrently.
+ * Each set's answer makes a result set of its own (SQL_PAS_BATCH): the first
+ * one is attached right away, the following ones with SQLMoreResults().
+ * Failing sets are reported in IPD's status array; the diagnostic of the
+ * first one is posted.
+ * The execution is always synchronous, even with SQL_ATTR_ASYNC_ENABLE on:
+ * the call only returns once all the sets are answered (or canceled with
+ * SQLCancel() from another thread), never with SQL_STILL_EXECUTING.
+ */
+static SQLRETURN execute_param_sets(esodbc_stmt_st *stmt)
+{
+	SQLRETURN ret;
+	esodbc_desc_st *apd = stmt->apd, *ipd = stmt->ipd;
+	SQLULEN i, cnt = apd->array_size, processed = 0, failed = 0, first;
+	SQLUSMALLINT *status = ipd->array_status_ptr;
+	cstr_st *reqs;
+	pset_answ_st *answs, *answ;
+	esodbc_diag_st diag = {0};
+
+	DBGH(stmt, "executing query with %llu parameter sets: [%zd] `" LCPDL "`.",
+		(uint64_t)cnt, stmt->u8sql.cnt, LCSTR(&stmt->u8sql));
+
+	reqs = calloc(cnt, sizeof(*reqs));
+	answs = calloc(cnt, sizeof(*answs));
+	if ((! reqs) || (! answs)) {
+		ERRNH(stmt, "OOM for %llu parameter sets.", (uint64_t)cnt);
+		free(reqs);
+		free(answs);
+		RET_HDIAGS(stmt, SQL_STATE_HY001);
+	}
+
+	for (i = 0; i < cnt; i ++) {
+		if (param_set_ignored(apd, i)) {
+			DBGH(stmt, "parameter set #%llu ignored.", (uint64_t)i + 1);
+			if (status) {
+				status[i] = SQL_PARAM_UNUSED;
+			}
+			continue;
+		}
+		processed ++;
+		stmt->param_set = i;
+		ret = serialize_statement(stmt, &reqs[i]);
+		if (SQL_SUCCEEDED(ret)) {
+			continue;
+		}
+		ERRH(stmt, "failed to serialize parameter set #%llu.",
+			(uint64_t)i + 1);
+		if (! failed ++) {
+			diag = HDRH(stmt)->diag;
+			diag.row_number = i + 1;
+		}
+		if (status) {
+			status[i] = SQL_PARAM_ERROR;
+		}
+		if (reqs[i].str) {
+			free(reqs[i].str);
+			reqs[i].str = NULL;
+		}
+	}
+	stmt->param_set = 0;
+
+	ret = curl_post_batch(stmt, cnt, reqs, answs);
+	if (! SQL_SUCCEEDED(ret)) {
+		goto end;
+	}
+
+	first = cnt;
+	for (i = 0; i < cnt; i ++) {
+		if (! reqs[i].str) {
+			continue;
+		}
+		answ = &answs[i];
+		if (answ->res == CURLE_OK && answ->code == 200 && answ->body.cnt) {
+			if (status) {
+				status[i] = SQL_PARAM_SUCCESS;
+			}
+			if (first == cnt) {
+				first = i;
+			}
+			continue;
+		}
+		if (status) {
+			status[i] = SQL_PARAM_ERROR;
+		}
+		if (! failed ++) {
+			if (answ->res != CURLE_OK) {
+				post_c_diagnostic(stmt, SQL_STATE_08S01,
+					curl_easy_strerror(answ->res), answ->res);
+			} else if (0 < answ->code && answ->code != 200) {
+				attach_error(stmt, &answ->body, answ->is_json, answ->code);
+			} else {
+				post_c_diagnostic(stmt, SQL_STATE_08S01,
+					"Received 200 response code with empty body.", 0);
+			}
+			diag = HDRH(stmt)->diag;
+			diag.row_number = i + 1;
+		}
+		if (answ->body.str) {
+			free(answ->body.str);
+			answ->body.str = NULL;
+			answ->body.cnt = 0;
+		}
+	}
+	INFOH(stmt, "parameter sets: %llu processed, %llu failed.",
+		(uint64_t)processed, (uint64_t)failed);
+
+	if (first < cnt) {
+		stmt->psets.answs = answs;
+		stmt->psets.cnt = cnt;
+		stmt->psets.crr = first;
+		answs = NULL;
+		/* statement takes ownership of the body */
+		answ = &stmt->psets.answs[first];
+		ret = attach_answer(stmt, &answ->body, answ->is_json);
+		answ->body.str = NULL;
+		answ->body.cnt = 0;
+		if (SQL_SUCCEEDED(ret) && failed) {
+			HDRH(stmt)->diag = diag;
+			ret = SQL_SUCCESS_WITH_INFO;
+		}
+	} else if (failed) {
+		HDRH(stmt)->diag = diag;
+		ret = SQL_ERROR;
+	} else {
+		WARNH(stmt, "all %llu parameter sets ignored.", (uint64_t)cnt);
+	}
+
+end:
+	if (ipd->rows_processed_ptr) {
+		*ipd->rows_processed_ptr = processed;
+	}
+	for (i = 0; i < cnt; i ++) {
+		if (reqs[i].str) {
+			free(reqs[i].str);
+		}
+		if (answs && answs[i].body.str) {
+			free(answs[i].body.str);
+		}
+	}
+	free(reqs);
+	free(answs);
+	return ret;
 }
 
 
@@ -3704,6 +5173,9 @@ SQLRETURN TEST_API serialize_statement(esodbc_stmt_st *stmt, cstr_st *dest)
  * SQL_ROW_DELETED, SQL_ROW_UPDATED, and SQL_ROW_ERROR."; the opposite is:
  * SQL_ROW_PROCEED, SQL_ROW_SUCCESS, SQL_ROW_SUCCESS_WITH_INFO, and
  * SQL_ROW_ADDED.
+ * However, SQL_ATTR_PARAM_OPERATION_PTR (the application's way of setting
+ * the field) only defines SQL_PARAM_PROCEED and SQL_PARAM_IGNORE, so only
+ * the latter excludes a set: see param_set_ignored().
  */
 SQLRETURN EsSQLExecute(SQLHSTMT hstmt)
 {
@@ -3711,6 +5183,13 @@ SQLRETURN EsSQLExecute(SQLHSTMT hstmt)
 	esodbc_stmt_st *stmt = STMH(hstmt);
 	char buff[ESODBC_BODY_BUF_START_SIZE];
 	cstr_st body = {buff, sizeof(buff)};
+	cstr_st answer;
+	BOOL is_json, use_cache;
+
+	/* re-invoked while an asynchronous execution is under way */
+	if (STMT_ASYNC_UNDERWAY(stmt)) {
+		return curl_async_poll(stmt);
+	}
 
 	if (stmt->early_executed) {
 		stmt->early_executed = false; /* re-enable subsequent executions */
@@ -3723,12 +5202,41 @@ SQLRETURN EsSQLExecute(SQLHSTMT hstmt)
 				" set.", LCSTR(&stmt->u8sql));
 		}
 	}
+	/* (the subsequent pages of a set's result are fetched individually) */
+	if (! STMT_HAS_CURSOR(stmt)) {
+		/* drop any results of a previous parameters array execution */
+		free_param_answers(stmt);
+		/* (parameters arrays are executed synchronously, async mode on or
+		 * not) */
+		if (1 < stmt->apd->array_size) {
+			return execute_param_sets(stmt);
+		}
+	}
+
 	DBGH(stmt, "executing query: [%zd] `" LCPDL "`.", stmt->u8sql.cnt,
 		LCSTR(&stmt->u8sql));
 
+	/* only new queries' answers are cached, not subsequent pages' */
+	use_cache = HDRH(stmt)->dbc->rslt_cache_ttl && stmt->rslt_cache &&
+		(! STMT_HAS_CURSOR(stmt));
+
 	ret = serialize_statement(stmt, &body);
-	if (SQL_SUCCEEDED(ret)) {
+	if (! SQL_SUCCEEDED(ret)) {
+		/* nothing to post */
+	} else if (use_cache &&
+		rslt_cache_lookup(stmt, &body, &answer, &is_json)) {
+		ret = attach_answer(stmt, &answer, is_json);
+	} else if (stmt->async_enable == SQL_ASYNC_ENABLE_ON &&
+		(! STMT_HAS_CURSOR(stmt))) {
+		/* the subsequent pages of a result set (with a cursor) are always
+		 * fetched synchronously */
+		ret = curl_post_async(stmt, &body);
+	} else {
 		ret = curl_post(stmt, ESODBC_CURL_QUERY, &body);
+		/* cache only complete, single-page answers */
+		if (use_cache && SQL_SUCCEEDED(ret) && (! STMT_HAS_CURSOR(stmt))) {
+			rslt_cache_add(stmt, &body);
+		}
 	}
 
 	if (buff != body.str) {
@@ -3760,6 +5268,12 @@ SQLRETURN EsSQLExecDirectW
 	esodbc_stmt_st *stmt = STMH(hstmt);
 	SQLRETURN ret;
 
+	/* re-invoked while an asynchronous execution is under way */
+	if (STMT_ASYNC_UNDERWAY(stmt)) {
+		ret = curl_async_poll(stmt);
+		goto end;
+	}
+
 	if (cchSqlStr == SQL_NTS) {
 		cchSqlStr = (SQLINTEGER)wcslen(szSqlStr);
 	} else if (cchSqlStr <= 0) {
@@ -3772,17 +5286,16 @@ SQLRETURN EsSQLExecDirectW
 	ret = EsSQLFreeStmt(stmt, ESODBC_SQL_CLOSE);
 	assert(SQL_SUCCEEDED(ret)); /* can't return error */
 
-	/* no support for parameter arrays (yet) */
-	// & param marker is set!
-	assert(stmt->apd->array_size <= 1);
-
 	ret = attach_sql(stmt, szSqlStr, cchSqlStr);
 	if (SQL_SUCCEEDED(ret)) {
 		ret = EsSQLExecute(stmt);
 	}
+end:
 #ifdef NDEBUG
 	/* no reason to keep it (it can't be re-executed), except for debugging */
-	detach_sql(stmt);
+	if (ret != SQL_STILL_EXECUTING) {
+		detach_sql(stmt);
+	}
 #endif /* NDEBUG */
 	return ret;
 }
@@ -4233,7 +5746,9 @@ SQLRETURN EsSQLRowCount(_In_ SQLHSTMT StatementHandle, _Out_ SQLLEN *RowCount)
 		RET_HDIAGS(stmt, SQL_STATE_HY010);
 	}
 
-	if (stmt->rset.pack_json) {
+	if (stmt->rset.columnar) {
+		*RowCount = (SQLLEN)stmt->rset.nrows;
+	} else if (stmt->rset.pack_json) {
 		*RowCount = UJLengthArray(stmt->rset.pack.json.rows_obj);
 	} else {
 		res = cbor_get_array_count(stmt->rset.pack.cbor.rows_obj, &nrows);
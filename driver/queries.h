@@ -18,10 +18,16 @@ SQLRETURN TEST_API attach_error(SQLHANDLE hnd, cstr_st *body, BOOL is_json,
 SQLRETURN TEST_API attach_sql(esodbc_stmt_st *stmt, const SQLWCHAR *sql,
 	size_t tlen);
 void detach_sql(esodbc_stmt_st *stmt);
+void free_request_tmpl(esodbc_stmt_st *stmt);
 esodbc_estype_st *lookup_es_type(esodbc_dbc_st *dbc,
 	SQLSMALLINT es_type, SQLULEN col_size);
 SQLRETURN TEST_API serialize_statement(esodbc_stmt_st *stmt, cstr_st *buff);
 SQLRETURN close_es_cursor(esodbc_stmt_st *stmt);
+void prefetch_start(esodbc_stmt_st *stmt);
+void prefetch_abort(esodbc_stmt_st *stmt);
+SQLRETURN fetch_next_page(esodbc_stmt_st *stmt);
+SQLRETURN scan_row(esodbc_stmt_st *stmt);
+void free_param_answers(esodbc_stmt_st *stmt);
 SQLRETURN close_es_answ_handler(esodbc_stmt_st *stmt, cstr_st *body,
 	BOOL is_json);
 
@@ -140,8 +146,9 @@ SQLRETURN EsSQLRowCount(_In_ SQLHSTMT StatementHandle, _Out_ SQLLEN *RowCount);
 #define REQ_KEY_TIMEZONE		"time_zone"
 #define REQ_KEY_CATALOG			"catalog"
 #define REQ_KEY_BINARY_FMT		"binary_format"
+#define REQ_KEY_COLUMNAR		"columnar"
 
-#define REST_REQ_KEY_COUNT		13 /* "query" / "cursor" count as one */
+#define REST_REQ_KEY_COUNT		14 /* "query" / "cursor" count as one */
 
 /* keys for the "params" argument */
 #define REQ_KEY_PARAM_TYPE		"type"
@@ -173,6 +180,7 @@ SQLRETURN EsSQLRowCount(_In_ SQLHSTMT StatementHandle, _Out_ SQLLEN *RowCount);
 #define JSON_KEY_TIMEZONE		", \"" REQ_KEY_TIMEZONE "\": " /* n-th key */
 #define JSON_KEY_CATALOG		", \"" REQ_KEY_CATALOG "\": " /* n-th key */
 #define JSON_KEY_BINARY_FMT		", \"" REQ_KEY_BINARY_FMT "\": " /* n-th key */
+#define JSON_KEY_COLUMNAR		", \"" REQ_KEY_COLUMNAR "\": true" /* n-th */
 
 #define JSON_VAL_TIMEZONE_Z		"\"" REQ_VAL_TIMEZONE_Z "\""
 
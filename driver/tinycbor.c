@@ -327,8 +327,7 @@ static BOOL enlarge_buffer(void *str_ptr, size_t new_cnt, size_t usize)
  * 0-terminates the string */
 CborError cbor_value_get_utf16_wstr(CborValue *it, wstr_st *utf16)
 {
-	/* .cnt needs to be non-zero, for U8MB_TO_U16WC() to fail on 1st invoc. */
-	static thread_local wstr_st wbuff = {.str = NULL, .cnt = (size_t)-1};
+	static thread_local wstr_st wbuff = {0};
 	static thread_local cstr_st cbuff = {0};
 	cstr_st mb_str; /* multibyte string */
 	CborError res;
@@ -357,34 +356,21 @@ CborError cbor_value_get_utf16_wstr(CborValue *it, wstr_st *utf16)
 		}
 	}
 
-	/* attempt string conversion */
-	while ((n = U8MB_TO_U16WC(mb_str.str, mb_str.cnt, wbuff.str,
-					wbuff.cnt)) <= 0) {
-		/* U8MB_TO_U16WC will return error (though not set it with
-		 * SetLastError()) for empty source strings */
-		if (mb_str.cnt) {
-			/* is this a non-buffer related error? (like decoding) */
-			if ((! WAPI_ERR_EBUFF()) && wbuff.str) {
-				ERR("mb_str.str @ 0x%p, mb_str.cnt = %zu, wbuff.str @ 0x%p, "
-					"wbuff.cnt = %zu", mb_str.str, mb_str.cnt, wbuff.str,
-					wbuff.cnt);
-				ERR("WAPI_ERRNO=0x%x.", WAPI_ERRNO());
-				ERR("MB: [%zu] `" LCPDL "`.", mb_str.cnt, LCSTR(&mb_str));
-				return CborErrorInvalidUtf8TextString;
-			} /* else: buffer hasn't yet been allocated or is too small */
-			/* what's the minimum space needed? */
-			if ((n = U8MB_TO_U16WC(mb_str.str, mb_str.cnt, NULL, 0)) < 0) {
-				return CborErrorInvalidUtf8TextString;
-			}
-		} else {
-			n = 0; /* \0 */
-			if (wbuff.str) { /* has it been already allocated? */
-				break;
-			}
-		}
-		if (! enlarge_buffer(&wbuff, (size_t)n, sizeof(wchar_t))) {
-			return CborErrorOutOfMemory;
+	/* a UTF-8 byte yields at most a UTF-16 unit: make room for the worst
+	 * case (plus the 0-term), to convert in one pass */
+	if (wbuff.cnt <= mb_str.cnt &&
+		! enlarge_buffer(&wbuff, mb_str.cnt, sizeof(wchar_t))) {
+		return CborErrorOutOfMemory;
+	}
+	if (mb_str.cnt) {
+		n = U8MB_TO_U16WC(mb_str.str, mb_str.cnt, wbuff.str, wbuff.cnt);
+		if (n <= 0) {
+			ERR("WAPI_ERRNO=0x%x.", WAPI_ERRNO());
+			ERR("MB: [%zu] `" LCPDL "`.", mb_str.cnt, LCSTR(&mb_str));
+			return CborErrorInvalidUtf8TextString;
 		}
+	} else {
+		n = 0; /* \0 */
 	}
 
 	/* U8MB_TO_U16WC() will only convert the 0-term if counted in input*/
@@ -0,0 +1,336 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License;
+ * you may not use this file except in compliance with the Elastic License.
+ */
+
+/*
+ * UTF-8 <-> UTF-16 transcoding.
+ *
+ * The conversions validate and convert in one pass over the source. Runs of
+ * ASCII characters - the bulk of the text exchanged with Elasticsearch - are
+ * checked and widened/narrowed with SSE2 or AVX2 instructions, if the CPU
+ * supports these; the rest of the characters are (de)coded one by one.
+ */
+
+#include "util.h"
+#include "log.h"
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#include <immintrin.h>
+#define UTF_WITH_SIMD
+#endif /* _M_X64 || _M_IX86 */
+
+/* vector instruction sets the transcoder can use */
+typedef enum {
+	SIMD_NONE = 0,
+	SIMD_SSE2,
+	SIMD_AVX2,
+} simd_level_et;
+
+static simd_level_et simd_level = SIMD_NONE;
+
+#define U8_IS_TRAIL(_c)		(((_c) & 0xC0) == 0x80)
+#define U16_IS_SURR(_w)		(((_w) & 0xF800) == 0xD800)
+#define U16_IS_HI_SURR(_w)	(((_w) & 0xFC00) == 0xD800)
+#define U16_IS_LO_SURR(_w)	(((_w) & 0xFC00) == 0xDC00)
+
+void utf_init(void)
+{
+#ifdef UTF_WITH_SIMD
+	int regs[4], max_leaf;
+
+	__cpuid(regs, 0);
+	max_leaf = regs[0];
+	__cpuid(regs, 1);
+	if (regs[3] & (1 << 26)) { /* EDX.SSE2 */
+		simd_level = SIMD_SSE2;
+	}
+	/* AVX2 needs both the CPU support and the OS saving the YMM registers
+	 * (ECX.OSXSAVE, ECX.AVX, XCR0.SSE|AVX) */
+	if (7 <= max_leaf && (regs[2] & (1 << 27)) && (regs[2] & (1 << 28)) &&
+		(_xgetbv(0) & 0x6) == 0x6) {
+		__cpuidex(regs, 7, 0);
+		if (regs[1] & (1 << 5)) { /* EBX.AVX2 */
+			simd_level = SIMD_AVX2;
+		}
+	}
+#endif /* UTF_WITH_SIMD */
+	INFO("UTF transcoding vector extensions: %s.",
+		simd_level == SIMD_AVX2 ? "AVX2" :
+		simd_level == SIMD_SSE2 ? "SSE2" : "none");
+}
+
+/*
+ * Widen the leading ASCII run of up to 'cnt' bytes of 'u8' into 'u16'; if
+ * 'u16' is NULL, only measure the run.
+ * Returns the length of the run.
+ */
+static size_t ascii_widen(const unsigned char *u8, size_t cnt,
+	wchar_t *u16)
+{
+	size_t i = 0;
+#ifdef UTF_WITH_SIMD
+	__m256i v32;
+	__m128i v16, zero;
+
+	if (SIMD_AVX2 <= simd_level) {
+		for (; i + 32 <= cnt; i += 32) {
+			v32 = _mm256_loadu_si256((const __m256i *)(u8 + i));
+			if (_mm256_movemask_epi8(v32)) {
+				break;
+			}
+			if (u16) {
+				_mm256_storeu_si256((__m256i *)(u16 + i),
+					_mm256_cvtepu8_epi16(_mm256_castsi256_si128(v32)));
+				_mm256_storeu_si256((__m256i *)(u16 + i + 16),
+					_mm256_cvtepu8_epi16(_mm256_extracti128_si256(v32, 1)));
+			}
+		}
+	}
+	if (SIMD_SSE2 <= simd_level) {
+		zero = _mm_setzero_si128();
+		for (; i + 16 <= cnt; i += 16) {
+			v16 = _mm_loadu_si128((const __m128i *)(u8 + i));
+			if (_mm_movemask_epi8(v16)) {
+				break;
+			}
+			if (u16) {
+				_mm_storeu_si128((__m128i *)(u16 + i),
+					_mm_unpacklo_epi8(v16, zero));
+				_mm_storeu_si128((__m128i *)(u16 + i + 8),
+					_mm_unpackhi_epi8(v16, zero));
+			}
+		}
+	}
+#endif /* UTF_WITH_SIMD */
+	for (; i < cnt && u8[i] < 0x80; i ++) {
+		if (u16) {
+			u16[i] = (wchar_t)u8[i];
+		}
+	}
+	return i;
+}
+
+/*
+ * Narrow the leading ASCII run of up to 'cnt' characters of 'u16' into 'u8';
+ * if 'u8' is NULL, only measure the run.
+ * Returns the length of the run.
+ */
+static size_t ascii_narrow(const wchar_t *u16, size_t cnt,
+	unsigned char *u8)
+{
+	size_t i = 0;
+#ifdef UTF_WITH_SIMD
+	__m256i a32, b32, mask32;
+	__m128i a16, b16, t16, mask16, zero;
+
+	if (SIMD_AVX2 <= simd_level) {
+		mask32 = _mm256_set1_epi16((short)0xFF80);
+		for (; i + 32 <= cnt; i += 32) {
+			a32 = _mm256_loadu_si256((const __m256i *)(u16 + i));
+			b32 = _mm256_loadu_si256((const __m256i *)(u16 + i + 16));
+			if (! _mm256_testz_si256(_mm256_or_si256(a32, b32), mask32)) {
+				break;
+			}
+			if (u8) {
+				/* the pack works per 128-bit lanes: reorder the quads */
+				_mm256_storeu_si256((__m256i *)(u8 + i),
+					_mm256_permute4x64_epi64(_mm256_packus_epi16(a32, b32),
+						0xD8));
+			}
+		}
+	}
+	if (SIMD_SSE2 <= simd_level) {
+		mask16 = _mm_set1_epi16((short)0xFF80);
+		zero = _mm_setzero_si128();
+		for (; i + 16 <= cnt; i += 16) {
+			a16 = _mm_loadu_si128((const __m128i *)(u16 + i));
+			b16 = _mm_loadu_si128((const __m128i *)(u16 + i + 8));
+			t16 = _mm_and_si128(_mm_or_si128(a16, b16), mask16);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(t16, zero)) != 0xFFFF) {
+				break;
+			}
+			if (u8) {
+				_mm_storeu_si128((__m128i *)(u8 + i),
+					_mm_packus_epi16(a16, b16));
+			}
+		}
+	}
+#endif /* UTF_WITH_SIMD */
+	for (; i < cnt && u16[i] < 0x80; i ++) {
+		if (u8) {
+			u8[i] = (unsigned char)u16[i];
+		}
+	}
+	return i;
+}
+
+/*
+ * Decode one non-ASCII UTF-8 character.
+ * Returns the number of bytes consumed or 0 on invalid encoding (truncated,
+ * overlong, surrogate or out of range code point).
+ */
+static inline size_t u8_decode(const unsigned char *u8, size_t cnt,
+	uint32_t *cp)
+{
+	uint32_t c = u8[0];
+
+	if (c < 0xC2) { /* stray continuation byte or overlong 2-bytes lead */
+		return 0;
+	} else if (c < 0xE0) {
+		if (cnt < 2 || (! U8_IS_TRAIL(u8[1]))) {
+			return 0;
+		}
+		*cp = ((c & 0x1F) << 6) | (u8[1] & 0x3F);
+		return 2;
+	} else if (c < 0xF0) {
+		if (cnt < 3 || (! U8_IS_TRAIL(u8[1])) || (! U8_IS_TRAIL(u8[2]))) {
+			return 0;
+		}
+		*cp = ((c & 0x0F) << 12) | ((u8[1] & 0x3F) << 6) | (u8[2] & 0x3F);
+		return (*cp < 0x800 || U16_IS_SURR(*cp)) ? 0 : 3;
+	} else if (c < 0xF5) {
+		if (cnt < 4 || (! U8_IS_TRAIL(u8[1])) || (! U8_IS_TRAIL(u8[2])) ||
+			(! U8_IS_TRAIL(u8[3]))) {
+			return 0;
+		}
+		*cp = ((c & 0x07) << 18) | ((u8[1] & 0x3F) << 12) |
+			((u8[2] & 0x3F) << 6) | (u8[3] & 0x3F);
+		return (*cp < 0x10000 || 0x10FFFF < *cp) ? 0 : 4;
+	}
+	return 0;
+}
+
+int TEST_API utf8_to_utf16(const char *src, int src_cnt, wchar_t *dst,
+	int dst_cnt)
+{
+	const unsigned char *u8 = (const unsigned char *)src;
+	size_t i, n, cnt, room, out, len;
+	uint32_t cp;
+
+	if (src_cnt <= 0 || dst_cnt < 0) {
+		/* like MultiByteToWideChar(), fail on empty source */
+		return 0;
+	}
+	cnt = (size_t)src_cnt;
+	/* no destination buffer: only count the needed characters */
+	room = dst ? (size_t)dst_cnt : 0;
+
+	for (i = 0, out = 0; i < cnt; ) {
+		if (u8[i] < 0x80) {
+			if (room) {
+				n = cnt - i < room - out ? cnt - i : room - out;
+				if (! n) {
+					SetLastError(ERROR_INSUFFICIENT_BUFFER);
+					return 0;
+				}
+				n = ascii_widen(u8 + i, n, dst + out);
+			} else {
+				n = ascii_widen(u8 + i, cnt - i, NULL);
+			}
+			i += n;
+			out += n;
+			continue;
+		}
+
+		if (! (len = u8_decode(u8 + i, cnt - i, &cp))) {
+			SetLastError(ERROR_NO_UNICODE_TRANSLATION);
+			return 0;
+		}
+		n = cp < 0x10000 ? 1 : 2;
+		if (room) {
+			if (room - out < n) {
+				SetLastError(ERROR_INSUFFICIENT_BUFFER);
+				return 0;
+			}
+			if (n == 1) {
+				dst[out] = (wchar_t)cp;
+			} else {
+				cp -= 0x10000;
+				dst[out] = (wchar_t)(0xD800 | (cp >> 10));
+				dst[out + 1] = (wchar_t)(0xDC00 | (cp & 0x3FF));
+			}
+		}
+		i += len;
+		out += n;
+	}
+	return (int)out;
+}
+
+int TEST_API utf16_to_utf8(const wchar_t *src, int src_cnt, char *dst,
+	int dst_cnt)
+{
+	unsigned char *u8 = (unsigned char *)dst;
+	size_t i, n, cnt, room, out;
+	uint32_t cp;
+
+	if (src_cnt <= 0 || dst_cnt < 0) {
+		/* like WideCharToMultiByte(), fail on empty source */
+		return 0;
+	}
+	cnt = (size_t)src_cnt;
+	/* no destination buffer: only count the needed bytes */
+	room = dst ? (size_t)dst_cnt : 0;
+
+	for (i = 0, out = 0; i < cnt; ) {
+		if (src[i] < 0x80) {
+			if (room) {
+				n = cnt - i < room - out ? cnt - i : room - out;
+				if (! n) {
+					SetLastError(ERROR_INSUFFICIENT_BUFFER);
+					return 0;
+				}
+				n = ascii_narrow(src + i, n, u8 + out);
+			} else {
+				n = ascii_narrow(src + i, cnt - i, NULL);
+			}
+			i += n;
+			out += n;
+			continue;
+		}
+
+		cp = src[i];
+		if (U16_IS_SURR(cp)) {
+			/* only valid as a high + low surrogate pair */
+			if ((! U16_IS_HI_SURR(cp)) || cnt <= i + 1 ||
+				(! U16_IS_LO_SURR(src[i + 1]))) {
+				SetLastError(ERROR_NO_UNICODE_TRANSLATION);
+				return 0;
+			}
+			cp = 0x10000 + (((cp & 0x3FF) << 10) | (src[i + 1] & 0x3FF));
+			n = 4;
+		} else {
+			n = cp < 0x800 ? 2 : 3;
+		}
+		if (room) {
+			if (room - out < n) {
+				SetLastError(ERROR_INSUFFICIENT_BUFFER);
+				return 0;
+			}
+			switch (n) {
+				case 2:
+					u8[out] = (unsigned char)(0xC0 | (cp >> 6));
+					u8[out + 1] = (unsigned char)(0x80 | (cp & 0x3F));
+					break;
+				case 3:
+					u8[out] = (unsigned char)(0xE0 | (cp >> 12));
+					u8[out + 1] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+					u8[out + 2] = (unsigned char)(0x80 | (cp & 0x3F));
+					break;
+				case 4:
+					u8[out] = (unsigned char)(0xF0 | (cp >> 18));
+					u8[out + 1] = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+					u8[out + 2] = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+					u8[out + 3] = (unsigned char)(0x80 | (cp & 0x3F));
+					break;
+			}
+		}
+		i += n == 4 ? 2 : 1;
+		out += n;
+	}
+	return (int)out;
+}
+
+/* vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 : */
@@ -201,29 +201,6 @@ int str2double(void *val, BOOL wide, SQLDOUBLE *dbl, BOOL strict)
 	return (int)digits;
 }
 
-size_t i64tot(int64_t i64, void *buff, BOOL wide)
-{
-	if (wide) {
-		_i64tow((int64_t)i64, buff, /*radix*/10);
-		/* TODO: find/write a function that returns len of conversion? */
-		return wcslen(buff);
-	} else {
-		_i64toa((int64_t)i64, buff, /*radix*/10);
-		return strlen(buff);
-	}
-}
-
-size_t ui64tot(uint64_t ui64, void *buff, BOOL wide)
-{
-	if (wide) {
-		_ui64tow((uint64_t)ui64, buff, /*radix*/10);
-		return wcslen(buff);
-	} else {
-		_ui64toa((uint64_t)ui64, buff, /*radix*/10);
-		return strlen(buff);
-	}
-}
-
 /*
  * Trims leading WS of a wide string of 'chars' length.
  * 0-terminator should not be counted (as it's a non-WS).
@@ -398,6 +375,18 @@ const SQLWCHAR *wcsnstr(const SQLWCHAR *hay, size_t len, SQLWCHAR needle)
 	return NULL;
 }
 
+uint64_t fnv1a_hash(uint64_t hash, const void *data, size_t cnt)
+{
+	const uint8_t *u8 = (const uint8_t *)data;
+	size_t i;
+
+	for (i = 0; i < cnt; i ++) {
+		hash ^= u8[i];
+		hash *= 1099511628211ULL; /* FNV-1a prime */
+	}
+	return hash;
+}
+
 /* retuns the length of a buffer to hold the escaped variant of the unescaped
  * given json object  */
 static inline size_t json_escaped_len(const char *json, size_t len)
@@ -580,30 +569,26 @@ SQLRETURN TEST_API write_wstr(SQLHANDLE hnd, SQLWCHAR *dest, wstr_st *src,
 
 cstr_st TEST_API *wstr_to_utf8(wstr_st *src, cstr_st *dst)
 {
-	int len;
+	int len, max;
 	size_t cnt;
-	void *addr;
+	void *addr, *fit;
 	BOOL nts; /* is the \0 present and counted in source string? */
+	BOOL own; /* is the destination allocated along with the string? */
 
 	if (0 < src->cnt) {
 		nts = !src->str[src->cnt - 1];
-
-		/* eval the needed space for conversion */
-		len = U16WC_TO_MBU8(src->str, src->cnt, NULL, 0);
-		if (! len) {
-			ERRN("failed to eval UTF-8 conversion space necessary for [%zu] "
-				"`" LWPDL "`.", src->cnt, LWSTR(src));
-			return NULL;
-		}
+		/* a UTF-16 unit takes at most 3 UTF-8 bytes (a surrogate pair, 4):
+		 * allocate for the worst case, to convert in one pass */
+		max = (int)(3 * src->cnt);
 	} else {
 		nts = FALSE;
-		len = 0;
+		max = 0;
 	}
 
-	assert(0 <= len);
+	assert(0 <= max);
 	/* explicitely allocate the \0 if not present&counted  */
-	cnt = len + /*0-term?*/!nts;
-	if (! dst) { /* if null destination, allocate that as well */
+	cnt = max + /*0-term?*/!nts;
+	if ((own = ! dst)) { /* if null destination, allocate that as well */
 		cnt += sizeof(cstr_st);
 	}
 
@@ -611,7 +596,7 @@ cstr_st TEST_API *wstr_to_utf8(wstr_st *src, cstr_st *dst)
 		ERRN("OOM for size: %zuB.", cnt);
 		return NULL;
 	}
-	if (! dst) {
+	if (own) {
 		dst = (cstr_st *)addr;
 		dst->str = (uint8_t *)addr + sizeof(cstr_st);
 	} else {
@@ -620,13 +605,24 @@ cstr_st TEST_API *wstr_to_utf8(wstr_st *src, cstr_st *dst)
 
 	if (0 < src->cnt) {
 		/* convert the string */
-		len = U16WC_TO_MBU8(src->str, src->cnt, dst->str, len);
+		len = U16WC_TO_MBU8(src->str, src->cnt, dst->str, max);
 		if (! len) {
-			/* should not happen, since a first scan already happened */
 			ERRN("failed to UTF-8 convert `" LWPDL "`.", LWSTR(src));
 			free(addr);
 			return NULL;
 		}
+		/* give back the unused worst case room, most of it for the usual
+		 * ASCII strings; on failure, the larger block is kept */
+		if (len < max && (fit = realloc(addr, cnt - (max - len)))) {
+			if (own) {
+				dst = (cstr_st *)fit;
+				dst->str = (uint8_t *)fit + sizeof(cstr_st);
+			} else {
+				dst->str = (SQLCHAR *)fit;
+			}
+		}
+	} else {
+		len = 0;
 	}
 
 	if (! nts) {
@@ -646,14 +642,9 @@ wstr_st TEST_API *utf8_to_wstr(cstr_st *src, wstr_st *dst)
 
 	if (0 < src->cnt) {
 		nts = !src->str[src->cnt - 1];
-
-		/* eval the needed space for conversion */
-		len = U8MB_TO_U16WC(src->str, src->cnt, NULL, 0);
-		if (! len) {
-			ERRN("failed to eval UTF-16 conversion space necessary for [%zu] "
-				"`" LCPDL "`.", src->cnt, LCSTR(src));
-			return NULL;
-		}
+		/* a UTF-8 byte yields at most a UTF-16 unit: allocate for the worst
+		 * case, to convert in one pass */
+		len = (int)src->cnt;
 	} else {
 		nts = FALSE;
 		len = 0;
@@ -681,7 +672,6 @@ wstr_st TEST_API *utf8_to_wstr(cstr_st *src, wstr_st *dst)
 		/* convert the string */
 		len = U8MB_TO_U16WC(src->str, src->cnt, dst->str, len);
 		if (! len) {
-			/* should not happen, since a first scan already happened */
 			ERRN("failed to UTF-16 convert `" LCPDL "`.", LCSTR(src));
 			free(addr);
 			return NULL;
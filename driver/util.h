@@ -105,6 +105,13 @@ int wszmemcmp(const SQLWCHAR *a, const SQLWCHAR *b, long count);
  */
 const SQLWCHAR *wcsnstr(const SQLWCHAR *hay, size_t len, SQLWCHAR needle);
 
+/*
+ * FNV-1a (64 bit) hash 'cnt' bytes at 'data' into 'hash'; a new hash starts
+ * from ESODBC_FNV1A_BASIS. Can be chained over multiple fields.
+ */
+#define ESODBC_FNV1A_BASIS	14695981039346656037ULL
+uint64_t fnv1a_hash(uint64_t hash, const void *data, size_t cnt);
+
 typedef struct wstr {
 	SQLWCHAR *str;
 	size_t cnt;
@@ -164,9 +171,15 @@ int str2ubigint(void *val, BOOL wide, SQLUBIGINT *out, BOOL strict);
 int str2bigint(void *val,  BOOL wide, SQLBIGINT *out, BOOL strict);
 int str2double(void *val, BOOL wide, SQLDOUBLE *dbl, BOOL strict);
 
-/* converts the int types to a C or wide string, returning the string length */
-size_t i64tot(int64_t i64, void *buff, BOOL wide);
-size_t ui64tot(uint64_t ui64, void *buff, BOOL wide);
+/* converts the int types to a C or wide string, returning the string length
+ * (see dtoa.c) */
+size_t TEST_API i64tot(int64_t i64, void *buff, BOOL wide);
+size_t TEST_API ui64tot(uint64_t ui64, void *buff, BOOL wide);
+/* converts a double to a C or wide string, in fixed or exponential notation
+ * with 'prec' fractional digits; 'size' counts the 0-terminator.
+ * Returns the string length or 0 if the buffer is too small. */
+size_t TEST_API dbl2tot(double dbl, int prec, BOOL sci, void *buff,
+	size_t size, BOOL wide);
 
 #ifdef _WIN32
 /*
@@ -176,22 +189,28 @@ size_t ui64tot(uint64_t ui64, void *buff, BOOL wide);
  * and DM's UTF-16 wide char.
  */
 /*
- * WideCharToMultiByte():
- * "[D]oes not null-terminate an output string if the input string length is
- * explicitly specified without a terminating null character. To
- * null-terminate an output string for this function, the application should
- * pass in -1 or explicitly count the terminating null character for the input
- * string."
- * "If successful, returns the number of bytes written" or required (if
- * _ubytes == 0), OR "0 if it does not succeed".
+ * The driver's transcoder (utf.c) follows the contract of
+ * WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS) and
+ * MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS):
+ * - the output is not 0-terminated, unless the terminator is counted in the
+ *   input;
+ * - returns the number of units written or required (if the output count is
+ *   0), OR 0 on failure, with the last error set to
+ *   ERROR_INSUFFICIENT_BUFFER or ERROR_NO_UNICODE_TRANSLATION;
+ * - fails, with no error set, for an empty input.
  */
+void utf_init(void);
+int TEST_API utf16_to_utf8(const wchar_t *src, int src_cnt, char *dst,
+	int dst_cnt);
+int TEST_API utf8_to_utf16(const char *src, int src_cnt, wchar_t *dst,
+	int dst_cnt);
+
 #define U16WC_TO_MBU8(_wstr, _wcnt, _u8str, _u8len) \
-	WideCharToMultiByte(CP_UTF8, WC_ERR_INVALID_CHARS, \
-		_wstr, (int)(_wcnt), _u8str, (int)(_u8len), \
-		NULL, NULL)
+	utf16_to_utf8((const wchar_t *)(_wstr), (int)(_wcnt), \
+		(char *)(_u8str), (int)(_u8len))
 #define U8MB_TO_U16WC(_u8str, _u8len, _wstr, _wcnt) \
-	MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, \
-		_u8str, (int)(_u8len), _wstr, (int)(_wcnt))
+	utf8_to_utf16((const char *)(_u8str), (int)(_u8len), \
+		(wchar_t *)(_wstr), (int)(_wcnt))
 
 #define WAPI_ERRNO()		GetLastError()
 #define WAPI_CLR_ERRNO()	SetLastError(ERROR_SUCCESS)
@@ -0,0 +1,435 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License;
+ * you may not use this file except in compliance with the Elastic License.
+ */
+
+/*
+ * Throughput of the conversion layer, measured over canned answers (for
+ * ES -> app conversions) and bound parameters (for app -> ES ones).
+ * No server is involved: the answers are attached to the statement the way
+ * the driver does it upon a successful request, and only the fetching
+ * (respectively, serialization) is timed.
+ *
+ * Each measurement is printed and also recorded as a test property, in
+ * nanoseconds per cell (resp. per parameter); run with
+ * --gtest_output=json:<file> to have them collected machine-readably.
+ */
+
+#include <gtest/gtest.h>
+#include "connected_dbc.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/* rows in an answer and columns in each row */
+#define BENCH_ROWS			20000
+#define BENCH_COLS			8
+/* application's rowset size */
+#define BENCH_ROWSET		100
+/* serializations of a statement, each with BENCH_COLS parameters */
+#define BENCH_SERIALIZE		20000
+/* repetitions of a measurement; the fastest is reported */
+#define BENCH_ROUNDS		5
+
+namespace test {
+
+class Bench : public ::testing::Test, public ConnectedDBC {
+	protected:
+
+	/* CBOR encoding of an item's head (type and count/value) */
+	static void cborHead(std::string &out, uint8_t major, uint64_t val)
+	{
+		int i, bytes;
+
+		major <<= 5;
+		if (val < 24) {
+			out += (char)(major | val);
+			return;
+		} else if (val <= UINT8_MAX) {
+			out += (char)(major | 24);
+			bytes = 1;
+		} else if (val <= UINT16_MAX) {
+			out += (char)(major | 25);
+			bytes = 2;
+		} else if (val <= UINT32_MAX) {
+			out += (char)(major | 26);
+			bytes = 4;
+		} else {
+			out += (char)(major | 27);
+			bytes = 8;
+		}
+		for (i = bytes - 1; 0 <= i; i --) {
+			out += (char)(val >> (8 * i));
+		}
+	}
+
+	static void cborText(std::string &out, const char *str)
+	{
+		cborHead(out, /*text string*/3, strlen(str));
+		out += str;
+	}
+
+	static std::string cborDouble(double dbl)
+	{
+		std::string out(1, (char)0xfb);
+		uint64_t u64;
+		int i;
+
+		memcpy(&u64, &dbl, sizeof(u64));
+		for (i = 7; 0 <= i; i --) {
+			out += (char)(u64 >> (8 * i));
+		}
+		return out;
+	}
+
+	static std::string cborUInt(uint64_t val)
+	{
+		std::string out;
+		cborHead(out, /*unsigned int*/0, val);
+		return out;
+	}
+
+	static std::string cborString(const char *str)
+	{
+		std::string out;
+		cborText(out, str);
+		return out;
+	}
+
+	/* build an answer of BENCH_ROWS rows, all cells of given type and
+	 * (already encoded) value */
+	static std::string answer(bool cbor, const char *es_type,
+		const std::string &val)
+	{
+		std::string out;
+		char name[16];
+		int r, c;
+
+		if (cbor) {
+			cborHead(out, /*map*/5, 2);
+			cborText(out, "columns");
+			cborHead(out, /*array*/4, BENCH_COLS);
+		} else {
+			out = "{\"columns\": [";
+		}
+		for (c = 0; c < BENCH_COLS; c ++) {
+			snprintf(name, sizeof(name), "col%d", c);
+			if (cbor) {
+				cborHead(out, /*map*/5, 2);
+				cborText(out, "name");
+				cborText(out, name);
+				cborText(out, "type");
+				cborText(out, es_type);
+			} else {
+				out += std::string(c ? ", " : "") + "{\"name\": \"" + name +
+					"\", \"type\": \"" + es_type + "\"}";
+			}
+		}
+		if (cbor) {
+			cborText(out, "rows");
+			cborHead(out, /*array*/4, BENCH_ROWS);
+		} else {
+			out += "], \"rows\": [";
+		}
+		for (r = 0; r < BENCH_ROWS; r ++) {
+			if (cbor) {
+				cborHead(out, /*array*/4, BENCH_COLS);
+			} else {
+				out += r ? ", [" : "[";
+			}
+			for (c = 0; c < BENCH_COLS; c ++) {
+				if (! cbor && c) {
+					out += ", ";
+				}
+				out += val;
+			}
+			if (! cbor) {
+				out += "]";
+			}
+		}
+		if (! cbor) {
+			out += "]}";
+		}
+		return out;
+	}
+
+	void report(const std::string &name, double ns)
+	{
+		char buff[32];
+
+		snprintf(buff, sizeof(buff), "%.2f", ns);
+		printf("[    BENCH ] %-40s %10s ns\n", name.c_str(), buff);
+		RecordProperty(name, buff);
+	}
+
+	/* attach the answer to the statement */
+	void attach(bool cbor, const std::string &body)
+	{
+		DBCH(dbc)->pack_json = ! cbor;
+		if (cbor) {
+			prepareStatement((const uint8_t *)body.data(), body.size());
+		} else {
+			prepareStatement(body.c_str());
+		}
+	}
+
+	/* bind all columns to 'ctype' buffers of 'size' bytes, either row- or
+	 * column-wise */
+	void bind(std::vector<char> &mem, SQLSMALLINT ctype, SQLLEN size,
+		bool colwise)
+	{
+		/* row-wise: values, then indicators, of one row at a time */
+		SQLLEN row_size = BENCH_COLS * (size + sizeof(SQLLEN));
+		char *vals, *inds;
+		SQLUSMALLINT c;
+
+		mem.assign(BENCH_ROWSET * row_size, 0);
+		ret = SQLFreeStmt(stmt, SQL_UNBIND);
+		ASSERT_TRUE(SQL_SUCCEEDED(ret));
+		ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_ARRAY_SIZE,
+				(SQLPOINTER)BENCH_ROWSET, 0);
+		ASSERT_TRUE(SQL_SUCCEEDED(ret));
+		ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_BIND_TYPE, colwise ?
+				(SQLPOINTER)SQL_BIND_BY_COLUMN : (SQLPOINTER)row_size, 0);
+		ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+		for (c = 0; c < BENCH_COLS; c ++) {
+			if (colwise) {
+				vals = &mem[c * BENCH_ROWSET * size];
+				inds = &mem[BENCH_COLS * BENCH_ROWSET * size +
+					c * BENCH_ROWSET * sizeof(SQLLEN)];
+			} else {
+				vals = &mem[c * size];
+				inds = &mem[BENCH_COLS * size + c * sizeof(SQLLEN)];
+			}
+			ret = SQLBindCol(stmt, c + 1, ctype, vals, size, (SQLLEN *)inds);
+			ASSERT_TRUE(SQL_SUCCEEDED(ret));
+		}
+	}
+
+	/* time fetching all the rows of an answer, for each packing and binding
+	 * type */
+	void benchFetch(const char *es_type, const std::string &json_val,
+		const std::string &cbor_val, SQLSMALLINT ctype, SQLLEN size)
+	{
+		static const char *packing[] = {"json", "cbor"};
+		static const char *binding[] = {"rowwise", "colwise"};
+		std::vector<char> mem;
+		std::string body;
+		SQLULEN rows;
+		double best, ns;
+		int p, b, r;
+
+		for (p = 0; p < 2; p ++) {
+			body = answer(p, es_type, p ? cbor_val : json_val);
+			for (b = 0; b < 2; b ++) {
+				for (r = 0, best = 0; r < BENCH_ROUNDS; r ++) {
+					attach(p, body);
+					bind(mem, ctype, size, b);
+
+					rows = 0;
+					auto start = std::chrono::steady_clock::now();
+					while (SQL_SUCCEEDED(ret = SQLFetch(stmt))) {
+						rows += BENCH_ROWSET;
+					}
+					auto stop = std::chrono::steady_clock::now();
+					ASSERT_EQ(ret, SQL_NO_DATA);
+					ASSERT_EQ(rows, BENCH_ROWS);
+
+					ns = (double)std::chrono::duration_cast<
+							std::chrono::nanoseconds>(stop - start).count();
+					if (! r || ns < best) {
+						best = ns;
+					}
+				}
+				report(std::string(packing[p]) + "_" + binding[b],
+					best / ((double)BENCH_ROWS * BENCH_COLS));
+			}
+		}
+	}
+
+	/* time serializing a statement with all parameters bound to same
+	 * value (strings are 0-terminated) */
+	void benchSerialize(SQLSMALLINT ctype, SQLSMALLINT sqltype,
+		SQLULEN col_size, SQLSMALLINT dec_digits, SQLPOINTER val,
+		SQLLEN val_len)
+	{
+		static const char *packing[] = {"json", "cbor"};
+		char buff[ESODBC_BODY_BUF_START_SIZE];
+		cstr_st body;
+		SQLUSMALLINT c;
+		double best, ns;
+		int p, r, i;
+
+		prepareStatement();
+		for (c = 0; c < BENCH_COLS; c ++) {
+			ret = SQLBindParameter(stmt, c + 1, SQL_PARAM_INPUT, ctype,
+					sqltype, col_size, dec_digits, val, val_len,
+					/*IndLen*/NULL);
+			ASSERT_TRUE(SQL_SUCCEEDED(ret));
+		}
+
+		for (p = 0; p < 2; p ++) {
+			DBCH(dbc)->pack_json = ! p;
+			for (r = 0, best = 0; r < BENCH_ROUNDS; r ++) {
+				auto start = std::chrono::steady_clock::now();
+				for (i = 0; i < BENCH_SERIALIZE; i ++) {
+					body.str = (SQLCHAR *)buff;
+					body.cnt = sizeof(buff);
+					ret = serialize_statement(STMH(stmt), &body);
+					ASSERT_TRUE(SQL_SUCCEEDED(ret));
+					if (body.str != (SQLCHAR *)buff) {
+						free(body.str);
+					}
+				}
+				auto stop = std::chrono::steady_clock::now();
+
+				ns = (double)std::chrono::duration_cast<
+						std::chrono::nanoseconds>(stop - start).count();
+				if (! r || ns < best) {
+					best = ns;
+				}
+			}
+			report(packing[p], best / ((double)BENCH_SERIALIZE * BENCH_COLS));
+		}
+	}
+};
+
+
+/*
+ * ES -> application
+ */
+
+TEST_F(Bench, Integer2SLong)
+{
+	benchFetch("integer", "123456", cborUInt(123456), SQL_C_SLONG,
+		sizeof(SQLINTEGER));
+}
+
+TEST_F(Bench, Integer2Char)
+{
+	benchFetch("integer", "123456", cborUInt(123456), SQL_C_CHAR, 16);
+}
+
+TEST_F(Bench, Integer2WChar)
+{
+	benchFetch("integer", "123456", cborUInt(123456), SQL_C_WCHAR, 32);
+}
+
+TEST_F(Bench, Long2SBigInt)
+{
+	benchFetch("long", "1234567890123", cborUInt(1234567890123LL),
+		SQL_C_SBIGINT, sizeof(SQLBIGINT));
+}
+
+TEST_F(Bench, Long2Char)
+{
+	benchFetch("long", "1234567890123", cborUInt(1234567890123LL),
+		SQL_C_CHAR, 24);
+}
+
+TEST_F(Bench, Double2Double)
+{
+	benchFetch("double", "1234.5678", cborDouble(1234.5678), SQL_C_DOUBLE,
+		sizeof(SQLDOUBLE));
+}
+
+TEST_F(Bench, Double2Char)
+{
+	benchFetch("double", "1234.5678", cborDouble(1234.5678), SQL_C_CHAR, 32);
+}
+
+TEST_F(Bench, Double2WChar)
+{
+	benchFetch("double", "1234.5678", cborDouble(1234.5678), SQL_C_WCHAR, 64);
+}
+
+TEST_F(Bench, Boolean2Bit)
+{
+	benchFetch("boolean", "true", std::string(1, (char)0xf5), SQL_C_BIT,
+		sizeof(SQLCHAR));
+}
+
+TEST_F(Bench, Keyword2Char)
+{
+	benchFetch("keyword", "\"Elasticsearch SQL ODBC\"",
+		cborString("Elasticsearch SQL ODBC"), SQL_C_CHAR, 32);
+}
+
+TEST_F(Bench, Keyword2WChar)
+{
+	benchFetch("keyword", "\"Elasticsearch SQL ODBC\"",
+		cborString("Elasticsearch SQL ODBC"), SQL_C_WCHAR, 64);
+}
+
+TEST_F(Bench, Datetime2Timestamp)
+{
+	benchFetch("datetime", "\"2345-01-23T12:34:56.789Z\"",
+		cborString("2345-01-23T12:34:56.789Z"), SQL_C_TYPE_TIMESTAMP,
+		sizeof(TIMESTAMP_STRUCT));
+}
+
+TEST_F(Bench, Datetime2Char)
+{
+	benchFetch("datetime", "\"2345-01-23T12:34:56.789Z\"",
+		cborString("2345-01-23T12:34:56.789Z"), SQL_C_CHAR, 32);
+}
+
+TEST_F(Bench, Interval2Interval)
+{
+	benchFetch("interval_day_to_second", "\"P1DT22H44M55.666S\"",
+		cborString("P1DT22H44M55.666S"), SQL_C_INTERVAL_DAY_TO_SECOND,
+		sizeof(SQL_INTERVAL_STRUCT));
+}
+
+
+/*
+ * application -> ES
+ */
+
+TEST_F(Bench, CStr2Integer)
+{
+	SQLCHAR val[] = "-12345";
+	benchSerialize(SQL_C_CHAR, SQL_INTEGER, 0, 0, val, sizeof(val));
+}
+
+TEST_F(Bench, CSBigInt2BigInt)
+{
+	SQLBIGINT val = -1234567890123LL;
+	benchSerialize(SQL_C_SBIGINT, SQL_BIGINT, 0, 0, &val, sizeof(val));
+}
+
+TEST_F(Bench, CDouble2Double)
+{
+	SQLDOUBLE val = 1234.5678;
+	benchSerialize(SQL_C_DOUBLE, SQL_DOUBLE, 0, 0, &val, sizeof(val));
+}
+
+TEST_F(Bench, CStr2Varchar)
+{
+	SQLCHAR val[] = "Elasticsearch SQL ODBC";
+	benchSerialize(SQL_C_CHAR, SQL_VARCHAR, sizeof(val), 0, val, sizeof(val));
+}
+
+TEST_F(Bench, CWStr2Varchar)
+{
+	SQLWCHAR val[] = L"Elasticsearch SQL ODBC";
+	benchSerialize(SQL_C_WCHAR, SQL_VARCHAR, sizeof(val) / sizeof(*val), 0,
+		val, sizeof(val));
+}
+
+TEST_F(Bench, CTimestamp2Timestamp)
+{
+	TIMESTAMP_STRUCT val = {2345, 1, 23, 12, 34, 56, 789000000};
+	benchSerialize(SQL_C_TYPE_TIMESTAMP, SQL_TYPE_TIMESTAMP, 0, 3, &val,
+		sizeof(val));
+}
+
+} // test namespace
+
+/* vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 : */
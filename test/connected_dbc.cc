@@ -207,4 +207,15 @@ void ConnectedDBC::prepareStatement(const char *jsonAnswer)
 	ASSERT_TRUE(SQL_SUCCEEDED(ret));
 }
 
+void ConnectedDBC::prepareStatement(const uint8_t *cborAnswer, size_t len)
+{
+	prepareStatement();
+
+	cstr_st answer = {(SQLCHAR *)malloc(len), len};
+	ASSERT_TRUE(answer.str != NULL);
+	memcpy(answer.str, cborAnswer, len);
+	ret = attach_answer((esodbc_stmt_st *)stmt, &answer, /*JSON*/FALSE);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+}
+
 /* vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 tw=78 : */
@@ -134,6 +134,8 @@ class ConnectedDBC {
 	void prepareStatement(const SQLWCHAR *sql, const char *jsonAnswer);
 	// use test name as SQL and attach given answer
 	void prepareStatement(const char *jsonAnswer);
+	// use test name as SQL and attach given CBOR answer
+	void prepareStatement(const uint8_t *cborAnswer, size_t len);
 };
 
 #endif /* __CONNECTED_DBC_H__ */
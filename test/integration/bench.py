@@ -0,0 +1,246 @@
+#!/usr/bin/python3
+#
+# Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+# or more contributor license agreements. Licensed under the Elastic License;
+# you may not use this file except in compliance with the Elastic License.
+#
+
+# Required modules: none (standard library only)
+
+import argparse
+import ctypes
+import itertools
+import json
+import sys
+import time
+from ctypes import byref, c_void_p, c_wchar_p, c_short, c_ushort, c_int, c_uint64, c_ssize_t, c_size_t
+
+from mockes import MockElasticsearch, Dataset, M1
+
+SQL_HANDLE_ENV = 1
+SQL_HANDLE_DBC = 2
+SQL_HANDLE_STMT = 3
+SQL_ATTR_ODBC_VERSION = 200
+SQL_OV_ODBC3 = 3
+SQL_ATTR_ROW_ARRAY_SIZE = 27
+SQL_ATTR_ROWS_FETCHED_PTR = 26
+SQL_BIND_BY_COLUMN = 0
+SQL_ATTR_ROW_BIND_TYPE = 5
+SQL_C_WCHAR = -8
+SQL_C_CHAR = 1
+SQL_NTS = -3
+SQL_DRIVER_NOPROMPT = 0
+SQL_NO_DATA = 100
+SQL_SUCCESS = 0
+SQL_SUCCESS_WITH_INFO = 1
+
+# the driver's performance counters (see ESODBC_PERF_* in driver/defs.h)
+ESODBC_SQL_ATTR_PERF_BASE = 0x4000 + 0x100
+ESODBC_PERF_COUNTERS = ["requests", "pages", "bytes_sent", "bytes_recv", "bytes_wire", "rows", "conv_errors",
+		"serialize_us", "network_us", "parse_us", "convert_us", "rslt_cache_hits", "rslt_cache_misses"]
+
+QUERY = "SELECT * FROM bench"
+DRIVER_NAME = "Elasticsearch Driver"
+
+
+class OdbcError(Exception):
+	pass
+
+class Odbc(object):
+	"""Thin wrapper over the Driver Manager's API, to have the fetching done with a bound rowset, which pyODBC
+	doesn't do."""
+
+	_dm = None
+	env = None
+
+	def __init__(self):
+		self._dm = ctypes.windll.odbc32
+		for name in ("SQLAllocHandle", "SQLFreeHandle", "SQLSetEnvAttr", "SQLDriverConnectW", "SQLDisconnect",
+				"SQLSetStmtAttrW", "SQLGetStmtAttrW", "SQLExecDirectW", "SQLNumResultCols", "SQLBindCol",
+				"SQLFetch", "SQLGetDiagRecW"):
+			getattr(self._dm, name).restype = c_short
+		self._dm.SQLAllocHandle.argtypes = [c_short, c_void_p, ctypes.POINTER(c_void_p)]
+		self._dm.SQLFreeHandle.argtypes = [c_short, c_void_p]
+		self._dm.SQLSetEnvAttr.argtypes = [c_void_p, c_int, c_void_p, c_int]
+		self._dm.SQLDriverConnectW.argtypes = [c_void_p, c_void_p, c_wchar_p, c_short, c_void_p, c_short,
+				ctypes.POINTER(c_short), c_ushort]
+		self._dm.SQLDisconnect.argtypes = [c_void_p]
+		self._dm.SQLSetStmtAttrW.argtypes = [c_void_p, c_int, c_void_p, c_int]
+		self._dm.SQLGetStmtAttrW.argtypes = [c_void_p, c_int, c_void_p, c_int, c_void_p]
+		self._dm.SQLExecDirectW.argtypes = [c_void_p, c_wchar_p, c_int]
+		self._dm.SQLNumResultCols.argtypes = [c_void_p, ctypes.POINTER(c_short)]
+		self._dm.SQLBindCol.argtypes = [c_void_p, c_ushort, c_short, c_void_p, c_ssize_t, c_void_p]
+		self._dm.SQLFetch.argtypes = [c_void_p]
+		self._dm.SQLGetDiagRecW.argtypes = [c_short, c_void_p, c_short, c_wchar_p, ctypes.POINTER(c_int),
+				c_wchar_p, c_short, ctypes.POINTER(c_short)]
+
+		self.env = self.alloc(SQL_HANDLE_ENV, None)
+		self.check(self._dm.SQLSetEnvAttr(self.env, SQL_ATTR_ODBC_VERSION, SQL_OV_ODBC3, 0), SQL_HANDLE_ENV,
+				self.env)
+
+	def __getattr__(self, name):
+		return getattr(self._dm, name)
+
+	def check(self, ret, htype, handle):
+		if ret in (SQL_SUCCESS, SQL_SUCCESS_WITH_INFO):
+			return ret
+		state, native, msg = ctypes.create_unicode_buffer(6), c_int(), ctypes.create_unicode_buffer(1024)
+		if self._dm.SQLGetDiagRecW(htype, handle, 1, state, byref(native), msg, len(msg), None) in \
+				(SQL_SUCCESS, SQL_SUCCESS_WITH_INFO):
+			raise OdbcError("ODBC call failed (%d): [%s] %s" % (ret, state.value, msg.value))
+		raise OdbcError("ODBC call failed (%d), no diagnostic available" % ret)
+
+	def alloc(self, htype, parent):
+		handle = c_void_p()
+		ret = self._dm.SQLAllocHandle(htype, parent, byref(handle))
+		if ret not in (SQL_SUCCESS, SQL_SUCCESS_WITH_INFO):
+			raise OdbcError("failed to allocate handle of type %d" % htype)
+		return handle
+
+	def perf_counters(self, stmt):
+		"""Driver's counters of the statement, if the driver provides them."""
+		counters = {}
+		val = c_uint64()
+		for idx, name in enumerate(ESODBC_PERF_COUNTERS):
+			if self._dm.SQLGetStmtAttrW(stmt, ESODBC_SQL_ATTR_PERF_BASE + idx, byref(val), ctypes.sizeof(val),
+					None) not in (SQL_SUCCESS, SQL_SUCCESS_WITH_INFO):
+				return None
+			counters[name] = val.value
+		return counters
+
+
+class Benchmark(object):
+
+	COL_WIDTH = 64 # characters of the buffer each column is bound to
+
+	_mock = None
+	_odbc = None
+	_dsn = None
+	_c_type = None
+
+	def __init__(self, mock, dsn, wide=True):
+		self._mock = mock
+		self._odbc = Odbc()
+		self._dsn = dsn
+		self._c_type = SQL_C_WCHAR if wide else SQL_C_CHAR
+
+	def _conn_str(self, packing, compression, columnar, fetch_size):
+		return "%sServer=127.0.0.1;Port=%d;Secure=0;Packing=%s;Compression=%s;Columnar=%s;MaxFetchSize=%d;" % \
+				(self._dsn, self._mock.port(), packing, compression, columnar, fetch_size)
+
+	def run(self, packing, compression, columnar, fetch_size, array_size):
+		odbc = self._odbc
+		dbc = odbc.alloc(SQL_HANDLE_DBC, odbc.env)
+		try:
+			conn_str = self._conn_str(packing, compression, columnar, fetch_size)
+			odbc.check(odbc.SQLDriverConnectW(dbc, None, conn_str, SQL_NTS, None, 0, None, SQL_DRIVER_NOPROMPT),
+					SQL_HANDLE_DBC, dbc)
+			stmt = odbc.alloc(SQL_HANDLE_STMT, dbc)
+			try:
+				return self._fetch_all(stmt, array_size)
+			finally:
+				odbc.SQLFreeHandle(SQL_HANDLE_STMT, stmt)
+				odbc.SQLDisconnect(dbc)
+		finally:
+			odbc.SQLFreeHandle(SQL_HANDLE_DBC, dbc)
+
+	def _fetch_all(self, stmt, array_size):
+		odbc = self._odbc
+		fetched = c_size_t()
+		odbc.check(odbc.SQLSetStmtAttrW(stmt, SQL_ATTR_ROW_ARRAY_SIZE, array_size, 0), SQL_HANDLE_STMT, stmt)
+		odbc.check(odbc.SQLSetStmtAttrW(stmt, SQL_ATTR_ROW_BIND_TYPE, SQL_BIND_BY_COLUMN, 0), SQL_HANDLE_STMT, stmt)
+		odbc.check(odbc.SQLSetStmtAttrW(stmt, SQL_ATTR_ROWS_FETCHED_PTR, ctypes.addressof(fetched), 0),
+				SQL_HANDLE_STMT, stmt)
+
+		self._mock.reset_stats()
+		started_at = time.perf_counter()
+
+		odbc.check(odbc.SQLExecDirectW(stmt, QUERY, SQL_NTS), SQL_HANDLE_STMT, stmt)
+		cols = c_short()
+		odbc.check(odbc.SQLNumResultCols(stmt, byref(cols)), SQL_HANDLE_STMT, stmt)
+		width = self.COL_WIDTH * (ctypes.sizeof(ctypes.c_wchar) if self._c_type == SQL_C_WCHAR else 1)
+		buffers = []
+		for col in range(1, cols.value + 1):
+			vals = ctypes.create_string_buffer(array_size * width)
+			inds = (c_ssize_t * array_size)()
+			buffers.append((vals, inds))
+			odbc.check(odbc.SQLBindCol(stmt, col, self._c_type, vals, width, inds), SQL_HANDLE_STMT, stmt)
+		rows = 0
+		while True:
+			ret = odbc.SQLFetch(stmt)
+			if ret == SQL_NO_DATA:
+				break
+			odbc.check(ret, SQL_HANDLE_STMT, stmt)
+			rows += fetched.value
+
+		elapsed = time.perf_counter() - started_at
+		stats = self._mock.stats()
+		return {
+			"rows": rows,
+			"seconds": elapsed,
+			"rows_per_sec": rows / elapsed,
+			"mb_per_sec": stats["bytes_sent"] / M1 / elapsed,
+			"server": stats,
+			"driver": odbc.perf_counters(stmt),
+		}
+
+
+def csv_list(conv):
+	return lambda arg: [conv(tok) for tok in arg.split(",")]
+
+def main():
+	parser = argparse.ArgumentParser(description='End-to-end throughput benchmark, against a mock Elasticsearch.')
+	parser.add_argument("-c", "--dsn", help="The connection string prefix selecting the driver to benchmark; "
+			"default: 'Driver={%s};'." % DRIVER_NAME, default="Driver={%s};" % DRIVER_NAME)
+	parser.add_argument("-s", "--shape", help="Comma separated list of column types (with optional ':<size>' for "
+			"strings) of the served table; default: %s." % Dataset.DEFAULT_SHAPE, default=Dataset.DEFAULT_SHAPE)
+	parser.add_argument("-r", "--rows", help="Rows to fetch.", type=int, default=100000)
+	parser.add_argument("-k", "--packing", help="Packing formats to test.", type=csv_list(str),
+			default=["JSON", "CBOR"])
+	parser.add_argument("-z", "--compression", help="Compression settings to test.", type=csv_list(str),
+			default=["on", "off"])
+	parser.add_argument("-m", "--columnar", help="Columnar settings to test.", type=csv_list(str), default=["false"])
+	parser.add_argument("-f", "--fetch-size", help="MaxFetchSize settings to test.", type=csv_list(int),
+			default=[1000, 10000])
+	parser.add_argument("-a", "--array-size", help="SQL_ATTR_ROW_ARRAY_SIZE settings to test.", type=csv_list(int),
+			default=[1, 100, 1000])
+	parser.add_argument("-n", "--repeat", help="Runs of each combination; the fastest is reported.", type=int,
+			default=3)
+	parser.add_argument("-l", "--latency", help="Milliseconds to delay each answer by.", type=float, default=0)
+	parser.add_argument("-b", "--bandwidth", help="Maximum throughput to send answers with, in MB/s.", type=float,
+			default=0)
+	parser.add_argument("-w", "--narrow", help="Bind the columns as SQL_C_CHAR, instead of SQL_C_WCHAR.",
+			action="store_true", default=False)
+	parser.add_argument("-o", "--output", help="File to save the results to, as JSON.")
+	args = parser.parse_args()
+
+	mock = MockElasticsearch(Dataset(args.shape, args.rows), latency=args.latency / 1000,
+			bandwidth=args.bandwidth * M1)
+	mock.start()
+	try:
+		bench = Benchmark(mock, args.dsn, not args.narrow)
+		results = []
+		print("%-6s %-5s %-5s %8s %6s %12s %10s" % ("pack", "cmprs", "clmnr", "fetch", "array", "rows/s", "MB/s"))
+		for (packing, compression, columnar, fetch_size, array_size) in itertools.product(args.packing,
+				args.compression, args.columnar, args.fetch_size, args.array_size):
+			runs = [bench.run(packing, compression, columnar, fetch_size, array_size) for _ in range(args.repeat)]
+			best = min(runs, key=lambda run: run["seconds"])
+			if best["rows"] != args.rows:
+				raise Exception("fetched %d rows instead of %d" % (best["rows"], args.rows))
+			print("%-6s %-5s %-5s %8d %6d %12.0f %10.2f" % (packing, compression, columnar, fetch_size,
+					array_size, best["rows_per_sec"], best["mb_per_sec"]))
+			results.append(dict(best, packing=packing, compression=compression, columnar=columnar,
+					fetch_size=fetch_size, array_size=array_size))
+	finally:
+		mock.stop()
+
+	if args.output:
+		with open(args.output, "w") as f:
+			json.dump({"shape": args.shape, "rows": args.rows, "latency_ms": args.latency,
+					"bandwidth_mbps": args.bandwidth, "results": results}, f, indent=2)
+		print("Results saved to %s." % args.output)
+
+if __name__== "__main__":
+	main()
+
+# vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 tw=118 :
@@ -0,0 +1,475 @@
+#!/usr/bin/python3
+#
+# Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+# or more contributor license agreements. Licensed under the Elastic License;
+# you may not use this file except in compliance with the Elastic License.
+#
+
+# Required modules: none (standard library only)
+
+import argparse
+import base64
+import gzip
+import json
+import struct
+import threading
+import time
+from datetime import datetime, timedelta
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+APP_JSON = "application/json"
+APP_CBOR = "application/cbor"
+
+K1 = 1024
+M1 = K1 * K1
+
+# the data types the driver loads when connecting, as in: name, DATA_TYPE, PRECISION, UNSIGNED_ATTRIBUTE,
+# CASE_SENSITIVE, MINIMUM_SCALE, MAXIMUM_SCALE, SQL_DATA_TYPE, SQL_DATETIME_SUB, NUM_PREC_RADIX
+SYS_TYPES = [
+	("BYTE", -6, 3, False, False, 0, 0, -6, 0, 10),
+	("LONG", -5, 19, False, False, 0, 0, -5, 0, 10),
+	("BINARY", -2, 2147483647, True, False, None, None, -2, 0, None),
+	("NULL", 0, 0, True, False, None, None, 0, 0, None),
+	("UNSIGNED_LONG", 2, 20, True, False, 0, 0, 2, 0, 10),
+	("INTEGER", 4, 10, False, False, 0, 0, 4, 0, 10),
+	("SHORT", 5, 5, False, False, 0, 0, 5, 0, 10),
+	("HALF_FLOAT", 6, 3, False, False, 3, 3, 6, 0, 2),
+	("FLOAT", 7, 7, False, False, 7, 7, 7, 0, 2),
+	("DOUBLE", 8, 15, False, False, 15, 15, 8, 0, 2),
+	("SCALED_FLOAT", 8, 15, False, False, 15, 15, 8, 0, 2),
+	("IP", 12, 45, True, False, None, None, 12, 0, None),
+	("KEYWORD", 12, 32766, True, True, None, None, 12, 0, None),
+	("TEXT", 12, 2147483647, True, True, None, None, 12, 0, None),
+	("VERSION", 12, 2147483647, True, True, None, None, 12, 0, None),
+	("BOOLEAN", 16, 1, True, False, None, None, 16, 0, None),
+	("DATE", 91, 29, True, False, 3, 3, 91, 0, None),
+	("TIME", 92, 18, True, False, None, None, 92, 0, None),
+	("DATETIME", 93, 29, True, False, 3, 3, 9, 3, None),
+	("INTERVAL_YEAR", 101, 7, True, False, None, None, 101, 0, None),
+	("INTERVAL_MONTH", 102, 7, True, False, None, None, 102, 0, None),
+	("INTERVAL_DAY", 103, 23, True, False, None, None, 103, 0, None),
+	("INTERVAL_HOUR", 104, 23, True, False, None, None, 104, 0, None),
+	("INTERVAL_MINUTE", 105, 23, True, False, None, None, 105, 0, None),
+	("INTERVAL_SECOND", 106, 23, True, False, None, None, 106, 0, None),
+	("INTERVAL_YEAR_TO_MONTH", 107, 7, True, False, None, None, 107, 0, None),
+	("INTERVAL_DAY_TO_HOUR", 108, 23, True, False, None, None, 108, 0, None),
+	("INTERVAL_DAY_TO_MINUTE", 109, 23, True, False, None, None, 109, 0, None),
+	("INTERVAL_DAY_TO_SECOND", 110, 23, True, False, None, None, 110, 0, None),
+	("INTERVAL_HOUR_TO_MINUTE", 111, 23, True, False, None, None, 111, 0, None),
+	("INTERVAL_HOUR_TO_SECOND", 112, 23, True, False, None, None, 112, 0, None),
+	("INTERVAL_MINUTE_TO_SECOND", 113, 23, True, False, None, None, 113, 0, None),
+	("GEO_POINT", 114, 58, True, False, None, None, 114, 0, None),
+	("GEO_SHAPE", 114, 2147483647, True, False, None, None, 114, 0, None),
+	("SHAPE", 114, 2147483647, True, False, None, None, 114, 0, None),
+	("UNSUPPORTED", 1111, 0, True, False, None, None, 1111, 0, None),
+	("NESTED", 2002, 0, True, False, None, None, 2002, 0, None),
+	("OBJECT", 2002, 0, True, False, None, None, 2002, 0, None),
+]
+
+SYS_TYPES_COLUMNS = [("TYPE_NAME", "keyword"), ("DATA_TYPE", "integer"), ("PRECISION", "integer"),
+		("LITERAL_PREFIX", "keyword"), ("LITERAL_SUFFIX", "keyword"), ("CREATE_PARAMS", "keyword"),
+		("NULLABLE", "short"), ("CASE_SENSITIVE", "boolean"), ("SEARCHABLE", "short"),
+		("UNSIGNED_ATTRIBUTE", "boolean"), ("FIXED_PREC_SCALE", "boolean"), ("AUTO_INCREMENT", "boolean"),
+		("LOCAL_TYPE_NAME", "keyword"), ("MINIMUM_SCALE", "short"), ("MAXIMUM_SCALE", "short"),
+		("SQL_DATA_TYPE", "integer"), ("SQL_DATETIME_SUB", "integer"), ("NUM_PREC_RADIX", "integer"),
+		("INTERVAL_PRECISION", "integer")]
+
+def sys_types_rows():
+	return [[name, data_type, prec, "'", "'", None, 2, case_sens, 3, unsigned, False, False, None, min_scale,
+			max_scale, sql_data_type, dt_sub, radix, None]
+		for (name, data_type, prec, unsigned, case_sens, min_scale, max_scale, sql_data_type, dt_sub, radix)
+		in SYS_TYPES]
+
+
+class Cbor(object):
+	"""Minimal CBOR codec, covering what the driver sends and receives."""
+
+	@staticmethod
+	def _head(major, val):
+		major <<= 5
+		if val < 24:
+			return bytes([major | val])
+		elif val < 0x100:
+			return struct.pack(">BB", major | 24, val)
+		elif val < 0x10000:
+			return struct.pack(">BH", major | 25, val)
+		elif val < 0x100000000:
+			return struct.pack(">BI", major | 26, val)
+		return struct.pack(">BQ", major | 27, val)
+
+	@staticmethod
+	def dumps(obj):
+		out = bytearray()
+		Cbor._dump(obj, out)
+		return bytes(out)
+
+	@staticmethod
+	def _dump(obj, out):
+		if obj is None:
+			out += b"\xf6"
+		elif obj is True:
+			out += b"\xf5"
+		elif obj is False:
+			out += b"\xf4"
+		elif isinstance(obj, int):
+			out += Cbor._head(0, obj) if 0 <= obj else Cbor._head(1, -1 - obj)
+		elif isinstance(obj, float):
+			out += b"\xfb" + struct.pack(">d", obj)
+		elif isinstance(obj, str):
+			enc = obj.encode("utf-8")
+			out += Cbor._head(3, len(enc)) + enc
+		elif isinstance(obj, (bytes, bytearray)):
+			out += Cbor._head(2, len(obj)) + obj
+		elif isinstance(obj, (list, tuple)):
+			out += Cbor._head(4, len(obj))
+			for item in obj:
+				Cbor._dump(item, out)
+		elif isinstance(obj, dict):
+			out += Cbor._head(5, len(obj))
+			for key, val in obj.items():
+				Cbor._dump(key, out)
+				Cbor._dump(val, out)
+		else:
+			raise Exception("can't CBOR-encode object of type %s" % type(obj))
+
+	@staticmethod
+	def loads(data):
+		obj, pos = Cbor._load(memoryview(data), 0)
+		if pos != len(data):
+			raise Exception("trailing bytes after CBOR object: %d" % (len(data) - pos))
+		return obj
+
+	@staticmethod
+	def _load(data, pos):
+		ib = data[pos]
+		pos += 1
+		major, info = ib >> 5, ib & 0x1f
+		if major == 7:
+			if info == 20:
+				return False, pos
+			elif info == 21:
+				return True, pos
+			elif info in (22, 23):
+				return None, pos
+			elif info == 25:
+				return struct.unpack(">e", data[pos : pos + 2])[0], pos + 2
+			elif info == 26:
+				return struct.unpack(">f", data[pos : pos + 4])[0], pos + 4
+			elif info == 27:
+				return struct.unpack(">d", data[pos : pos + 8])[0], pos + 8
+			raise Exception("unsupported CBOR simple value %d" % info)
+		if info < 24:
+			val = info
+		elif info == 31:
+			val = None # indefinite length
+		else:
+			size = 1 << (info - 24)
+			val = int.from_bytes(data[pos : pos + size], "big")
+			pos += size
+		if major == 0:
+			return val, pos
+		elif major == 1:
+			return -1 - val, pos
+		elif major in (2, 3):
+			if val is None:
+				chunks = []
+				while data[pos] != 0xff:
+					chunk, pos = Cbor._load(data, pos)
+					chunks.append(chunk)
+				return ("" if major == 3 else b"").join(chunks), pos + 1
+			chunk = bytes(data[pos : pos + val])
+			return chunk.decode("utf-8") if major == 3 else chunk, pos + val
+		elif major in (4, 5):
+			items = []
+			cnt = val * (major - 3) if val is not None else None # a map holds key-value pairs
+			while (data[pos] != 0xff) if cnt is None else (len(items) < cnt):
+				item, pos = Cbor._load(data, pos)
+				items.append(item)
+			if cnt is None:
+				pos += 1 # "break" stop code
+			return (items if major == 4 else dict(zip(items[0::2], items[1::2]))), pos
+		elif major == 6:
+			return Cbor._load(data, pos) # tags are ignored
+		raise Exception("unsupported CBOR major type %d" % major)
+
+
+class Dataset(object):
+	"""Deterministic table of configurable shape: each cell's value is derived from its row and column index."""
+
+	DEFAULT_SHAPE = "long,double,keyword:16,datetime,boolean"
+	EPOCH = datetime(2020, 1, 1)
+
+	_columns = None
+	_makers = None
+	rows = None
+
+	def __init__(self, shape=DEFAULT_SHAPE, rows=100000):
+		self.rows = rows
+		self._columns = []
+		self._makers = []
+		for idx, spec in enumerate(shape.split(",")):
+			es_type, _, arg = spec.strip().lower().partition(":")
+			self._columns.append(("%s_%d" % (es_type, idx), es_type))
+			self._makers.append(self._maker(es_type, int(arg) if arg else 16))
+
+	@staticmethod
+	def _maker(es_type, size):
+		if es_type in ("byte", "short", "integer", "long", "unsigned_long"):
+			mod = {"byte": 1 << 7, "short": 1 << 15, "integer": 1 << 31}.get(es_type, 1 << 62)
+			return lambda r, c: (r * 7919 + c) % mod
+		elif es_type in ("half_float", "float", "double", "scaled_float"):
+			return lambda r, c: r * 1.25 + c / 8
+		elif es_type in ("keyword", "text", "ip", "version"):
+			return lambda r, c: ("%d-%d-" % (r, c)).ljust(size, "x")[:size]
+		elif es_type in ("datetime", "date"):
+			return lambda r, c: (Dataset.EPOCH + timedelta(seconds=r, milliseconds=c)).isoformat(
+					timespec="milliseconds") + "Z"
+		elif es_type == "time":
+			return lambda r, c: "%02d:%02d:%02d.%03dZ" % ((r // 3600) % 24, (r // 60) % 60, r % 60, c)
+		elif es_type == "boolean":
+			return lambda r, c: (r + c) % 2 == 0
+		elif es_type == "null":
+			return lambda r, c: None
+		raise Exception("unsupported column type in shape: %s" % es_type)
+
+	def columns(self):
+		return [{"name": name, "type": es_type} for (name, es_type) in self._columns]
+
+	def page(self, offset, size):
+		return [[make(r, c) for c, make in enumerate(self._makers)] for r in range(offset, offset + size)]
+
+
+class MockElasticsearch(object):
+	"""Local server speaking the root, `/_sql` and `/_sql/close` endpoints of Elasticsearch, in JSON and CBOR."""
+
+	VERSION = "7.17.0"
+	CLUSTER_NAME = "mock"
+	DEFAULT_FETCH_SIZE = 1000
+	PAGE_CACHE_SIZE = 64 # encoded pages kept in memory
+	SHAPING_CHUNK = 16 * K1
+
+	_dataset = None
+	_server = None
+	_thread = None
+	_compress = None
+	_latency = None
+	_bandwidth = None
+	_cursor_size = None
+	_lock = None
+	_cache = None
+	_stats = None
+
+	def __init__(self, dataset=None, port=0, compress=True, latency=0, bandwidth=0, cursor_size=0):
+		"""latency: seconds added to each answer; bandwidth: maximum bytes/s to send answers with (0: no limit);
+		cursor_size: minimum length of the returned cursors (ES' are a few hundred bytes long)."""
+		self._dataset = dataset if dataset else Dataset()
+		self._compress = compress
+		self._latency = latency
+		self._bandwidth = bandwidth
+		self._cursor_size = cursor_size
+		self._lock = threading.Lock()
+		self._cache = {}
+		self.reset_stats()
+
+		mock = self
+		class Handler(MockHandler):
+			server_mock = mock
+		self._server = ThreadingHTTPServer(("127.0.0.1", port), Handler)
+		self._server.daemon_threads = True
+
+	def start(self):
+		self._thread = threading.Thread(target=self._server.serve_forever, daemon=True)
+		self._thread.start()
+		print("Mock Elasticsearch listening on %s." % self.base_url())
+
+	def stop(self):
+		self._server.shutdown()
+		self._server.server_close()
+		self._thread.join()
+
+	def port(self):
+		return self._server.server_address[1]
+
+	def base_url(self):
+		return "http://127.0.0.1:%d" % self.port()
+
+	def reset_stats(self):
+		with self._lock:
+			self._stats = {"requests": 0, "pages": 0, "rows": 0, "bytes_sent": 0, "bytes_recv": 0}
+
+	def stats(self):
+		with self._lock:
+			return dict(self._stats)
+
+	def _account(self, **kwargs):
+		with self._lock:
+			for key, val in kwargs.items():
+				self._stats[key] += val
+
+	def _cursor(self, offset, fetch_size):
+		curs = base64.b64encode(("%d:%d:" % (offset, fetch_size)).encode("ascii"))
+		return (curs + b"=" * max(0, self._cursor_size - len(curs))).decode("ascii")
+
+	@staticmethod
+	def _uncursor(cursor):
+		curs = cursor.rstrip("=")
+		curs += "=" * (-len(curs) % 4) # drop the size padding
+		offset, fetch_size, _ = base64.b64decode(curs).decode("ascii").split(":")
+		return int(offset), int(fetch_size)
+
+	def _encode(self, obj, cbor):
+		return Cbor.dumps(obj) if cbor else json.dumps(obj, separators=(",", ":")).encode("utf-8")
+
+	@staticmethod
+	def _orient(answer, columnar):
+		"""Turn the answer column-major, as ES/SQL does if asked for "columnar" results."""
+		if columnar:
+			rows = answer.pop("rows")
+			cols = len(rows[0]) if rows else len(answer.get("columns", []))
+			answer["values"] = [[row[col] for row in rows] for col in range(cols)]
+		return answer
+
+	def _page(self, offset, fetch_size, cbor, columnar):
+		key = (offset, fetch_size, cbor, columnar)
+		with self._lock:
+			body = self._cache.get(key)
+		if body is None:
+			size = max(0, min(fetch_size, self._dataset.rows - offset))
+			answer = {"rows": self._dataset.page(offset, size)}
+			if not offset:
+				answer["columns"] = self._dataset.columns()
+			if offset + size < self._dataset.rows:
+				answer["cursor"] = self._cursor(offset + size, fetch_size)
+			body = self._encode(self._orient(answer, columnar), cbor)
+			with self._lock:
+				if self.PAGE_CACHE_SIZE <= len(self._cache):
+					self._cache.pop(next(iter(self._cache)))
+				self._cache[key] = body
+		else:
+			size = max(0, min(fetch_size, self._dataset.rows - offset))
+		self._account(pages=1, rows=size)
+		return body
+
+	def answer_root(self, cbor):
+		return 200, self._encode({"name": "mock-node", "cluster_name": self.CLUSTER_NAME,
+				"version": {"number": self.VERSION}, "tagline": "You Know, for Search"}, cbor)
+
+	def answer_query(self, req, cbor):
+		# like ES, the orientation is not stored in the cursor, but needs asking with every page
+		columnar = bool(req.get("columnar"))
+		if "cursor" in req:
+			offset, fetch_size = self._uncursor(req["cursor"])
+			return 200, self._page(offset, fetch_size, cbor, columnar)
+
+		query = req.get("query", "").strip()
+		uquery = query.upper()
+		if uquery.startswith("SYS TYPES"):
+			answer = {"columns": [{"name": n, "type": t} for (n, t) in SYS_TYPES_COLUMNS], "rows": sys_types_rows()}
+		elif uquery.startswith("SELECT DATABASE()"):
+			answer = {"columns": [{"name": "DATABASE()", "type": "keyword"}], "rows": [[self.CLUSTER_NAME]]}
+		elif uquery.startswith("SELECT USER()"):
+			answer = {"columns": [{"name": "USER()", "type": "keyword"}], "rows": [["elastic"]]}
+		elif uquery.startswith("SELECT") or uquery.startswith("FROM"):
+			fetch_size = req.get("fetch_size") or self.DEFAULT_FETCH_SIZE
+			return 200, self._page(0, fetch_size, cbor, columnar)
+		else:
+			return self.error(400, "parsing_exception", "mock can't process query: %s" % query, cbor)
+		return 200, self._encode(self._orient(answer, columnar), cbor)
+
+	def answer_close(self, req, cbor):
+		return 200, self._encode({"succeeded": "cursor" in req}, cbor)
+
+	def error(self, status, err_type, reason, cbor):
+		err = {"type": err_type, "reason": reason}
+		return status, self._encode({"error": dict(err, root_cause=[err]), "status": status}, cbor)
+
+	def send(self, handler, status, body, cbor, accept_enc):
+		if self._latency:
+			time.sleep(self._latency)
+		handler.send_response(status)
+		handler.send_header("Content-Type", APP_CBOR if cbor else APP_JSON)
+		if self._compress and "gzip" in accept_enc:
+			body = gzip.compress(body, compresslevel=1)
+			handler.send_header("Content-Encoding", "gzip")
+		handler.send_header("Content-Length", str(len(body)))
+		handler.end_headers()
+		if not self._bandwidth:
+			handler.wfile.write(body)
+		else:
+			for pos in range(0, len(body), self.SHAPING_CHUNK):
+				chunk = body[pos : pos + self.SHAPING_CHUNK]
+				started_at = time.perf_counter()
+				handler.wfile.write(chunk)
+				lag = len(chunk) / self._bandwidth - (time.perf_counter() - started_at)
+				if 0 < lag:
+					time.sleep(lag)
+		self._account(requests=1, bytes_sent=len(body))
+
+
+class MockHandler(BaseHTTPRequestHandler):
+
+	protocol_version = "HTTP/1.1" # keep-alive, as the driver reuses its connections
+	server_mock = None
+
+	def log_message(self, format, *args):
+		pass # quiet
+
+	def _wants_cbor(self, header):
+		return APP_CBOR in (self.headers.get(header) or "")
+
+	def do_GET(self):
+		mock = self.server_mock
+		cbor = self._wants_cbor("Accept")
+		if self.path.split("?")[0] in ("", "/"):
+			status, body = mock.answer_root(cbor)
+		else:
+			status, body = mock.error(404, "resource_not_found_exception", "no such path: %s" % self.path, cbor)
+		mock.send(self, status, body, cbor, self.headers.get("Accept-Encoding") or "")
+
+	def do_POST(self):
+		mock = self.server_mock
+		cbor = self._wants_cbor("Accept")
+		data = self.rfile.read(int(self.headers.get("Content-Length") or 0))
+		mock._account(bytes_recv=len(data))
+		path = self.path.split("?")[0].rstrip("/")
+		try:
+			req = Cbor.loads(data) if self._wants_cbor("Content-Type") else json.loads(data.decode("utf-8"))
+			if path == "/_sql":
+				status, body = mock.answer_query(req, cbor)
+			elif path == "/_sql/close":
+				status, body = mock.answer_close(req, cbor)
+			else:
+				status, body = mock.error(404, "resource_not_found_exception", "no such path: %s" % path, cbor)
+		except Exception as e:
+			status, body = mock.error(400, "parsing_exception", "invalid request: %s" % e, cbor)
+		mock.send(self, status, body, cbor, self.headers.get("Accept-Encoding") or "")
+
+
+def main():
+	parser = argparse.ArgumentParser(description='Mock Elasticsearch SQL endpoint.')
+	parser.add_argument("-p", "--port", help="Port to listen on.", type=int, default=9200)
+	parser.add_argument("-s", "--shape", help="Comma separated list of column types (with optional ':<size>' for "
+			"strings) of the served table; default: %s." % Dataset.DEFAULT_SHAPE, default=Dataset.DEFAULT_SHAPE)
+	parser.add_argument("-r", "--rows", help="Rows in the served table.", type=int, default=100000)
+	parser.add_argument("-n", "--no-compression", help="Never compress the answers.", action="store_true",
+			default=False)
+	parser.add_argument("-l", "--latency", help="Milliseconds to delay each answer by.", type=float, default=0)
+	parser.add_argument("-b", "--bandwidth", help="Maximum throughput to send answers with, in MB/s.", type=float,
+			default=0)
+	parser.add_argument("-c", "--cursor-size", help="Minimum length of the cursors.", type=int, default=0)
+	args = parser.parse_args()
+
+	mock = MockElasticsearch(Dataset(args.shape, args.rows), args.port, not args.no_compression,
+			args.latency / 1000, args.bandwidth * M1, args.cursor_size)
+	mock.start()
+	try:
+		while True:
+			time.sleep(1)
+	except KeyboardInterrupt:
+		mock.stop()
+		print("Served: %s." % mock.stats())
+
+if __name__== "__main__":
+	main()
+
+# vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 tw=118 :
@@ -0,0 +1,198 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License;
+ * you may not use this file except in compliance with the Elastic License.
+ */
+
+/* winsock2.h needs to be included ahead of windows.h */
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include <assert.h>
+#include <ctype.h>
+#include <string.h>
+#include <chrono>
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "util.h"
+#include "defs.h"
+}
+
+#include "mock_server.h"
+
+/* how long to wait for a request (and between loop checks) */
+#define MOCK_RECV_TIMEOUT_MS	5000
+#define MOCK_POLL_MS			10
+
+MockServer::MockServer(const char *jsonAnswer, unsigned delayMs) :
+	answer(jsonAnswer), delay_ms(delayMs), lsock(INVALID_SOCKET), lport(0),
+	stop(false), served(0)
+{
+	WSADATA wsa_data;
+	struct sockaddr_in addr = {0};
+	int addr_len = sizeof(addr);
+	SOCKET sock;
+
+	if (WSAStartup(MAKEWORD(2, 2), &wsa_data)) {
+		ADD_FAILURE() << "WSAStartup failed: " << WSAGetLastError();
+		return;
+	}
+	if ((sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) ==
+		INVALID_SOCKET) {
+		ADD_FAILURE() << "socket failed: " << WSAGetLastError();
+		return;
+	}
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0; /* ephemeral */
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) ||
+		getsockname(sock, (struct sockaddr *)&addr, &addr_len) ||
+		listen(sock, SOMAXCONN)) {
+		ADD_FAILURE() << "failed to set up listening socket: " <<
+			WSAGetLastError();
+		closesocket(sock);
+		return;
+	}
+	lsock = (uintptr_t)sock;
+	lport = ntohs(addr.sin_port);
+	runner = std::thread(&MockServer::run, this);
+}
+
+MockServer::~MockServer()
+{
+	stop = true;
+	if (runner.joinable()) {
+		runner.join();
+	}
+	if ((SOCKET)lsock != INVALID_SOCKET) {
+		closesocket((SOCKET)lsock);
+	}
+	WSACleanup();
+}
+
+/* wait for the configured delay; returns false if stopped meanwhile */
+bool MockServer::pause()
+{
+	auto until = std::chrono::steady_clock::now() +
+		std::chrono::milliseconds(delay_ms);
+
+	while (std::chrono::steady_clock::now() < until) {
+		if (stop) {
+			return false;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(MOCK_POLL_MS));
+	}
+	return true;
+}
+
+void MockServer::run()
+{
+	SOCKET sock;
+	fd_set fds;
+	struct timeval tout = {0, MOCK_POLL_MS * 1000};
+
+	while (! stop) {
+		FD_ZERO(&fds);
+		FD_SET((SOCKET)lsock, &fds);
+		if (select(/*ignored*/0, &fds, NULL, NULL, &tout) <= 0) {
+			continue;
+		}
+		if ((sock = accept((SOCKET)lsock, NULL, NULL)) != INVALID_SOCKET) {
+			/* one request per connection: no keep-alive to tend to, so that
+			 * concurrent connections can be served one after the other */
+			serve((uintptr_t)sock);
+			closesocket(sock);
+		}
+	}
+}
+
+void MockServer::serve(uintptr_t s)
+{
+	SOCKET sock = (SOCKET)s;
+	DWORD rtout = MOCK_RECV_TIMEOUT_MS;
+	std::string req, head, rsp;
+	size_t hend, pos, clen = 0;
+	char buff[4096];
+	int n;
+
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&rtout,
+		sizeof(rtout));
+
+	/* read the header */
+	while ((hend = req.find("\r\n\r\n")) == std::string::npos) {
+		if ((n = recv(sock, buff, sizeof(buff), 0)) <= 0) {
+			return;
+		}
+		req.append(buff, n);
+	}
+	head = req.substr(0, hend);
+	for (auto &c : head) {
+		c = (char)tolower(c);
+	}
+	if ((pos = head.find("\r\ncontent-length:")) != std::string::npos) {
+		clen = strtoul(head.c_str() + pos + sizeof("\r\ncontent-length:") - 1,
+				NULL, 10);
+	}
+	if (head.find("100-continue") != std::string::npos) {
+		rsp = "HTTP/1.1 100 Continue\r\n\r\n";
+		send(sock, rsp.c_str(), (int)rsp.size(), 0);
+	}
+	/* read the body */
+	while (req.size() < hend + /*\r\n\r\n*/4 + clen) {
+		if ((n = recv(sock, buff, sizeof(buff), 0)) <= 0) {
+			return;
+		}
+		req.append(buff, n);
+	}
+
+	if (! pause()) {
+		return;
+	}
+	rsp = "HTTP/1.1 200 OK\r\n"
+		"Content-Type: application/json\r\n"
+		"Content-Length: " + std::to_string(answer.size()) + "\r\n"
+		"Connection: close\r\n"
+		"\r\n" + answer;
+	if (send(sock, rsp.c_str(), (int)rsp.size(), 0) == (int)rsp.size()) {
+		served ++;
+	}
+}
+
+
+void MockedDBC::connectTo(MockServer &server)
+{
+	cstr_st types = {0};
+	std::wstring conn_str = std::wstring(CONNECT_STRING) +
+		L"Server=127.0.0.1;Secure=0;Port=" + std::to_wstring(server.port()) +
+		L";";
+
+	ASSERT_TRUE(server.port());
+	ret = SQLAllocHandle(SQL_HANDLE_DBC, env, &mdbc);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	/* freed by the driver, once loaded */
+	types.str = (SQLCHAR *)STRDUP(SYSTYPES_ANSWER);
+	ASSERT_TRUE(types.str != NULL);
+	types.cnt = sizeof(SYSTYPES_ANSWER) - 1;
+	ret = SQLDriverConnect(mdbc, (SQLHWND)&types, (SQLWCHAR *)&conn_str[0],
+			(SQLSMALLINT)conn_str.size(), NULL, 0, NULL,
+			ESODBC_SQL_DRIVER_TEST);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLAllocHandle(SQL_HANDLE_STMT, mdbc, &mstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+}
+
+MockedDBC::~MockedDBC()
+{
+	if (mstmt != SQL_NULL_HANDLE) {
+		SQLFreeHandle(SQL_HANDLE_STMT, mstmt);
+	}
+	if (mdbc != SQL_NULL_HANDLE) {
+		SQLDisconnect(mdbc);
+		SQLFreeHandle(SQL_HANDLE_DBC, mdbc);
+	}
+}
+
+/* vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 tw=78 : */
@@ -0,0 +1,57 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License;
+ * you may not use this file except in compliance with the Elastic License.
+ */
+
+#ifndef __MOCK_SERVER_H__
+#define __MOCK_SERVER_H__
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "connected_dbc.h"
+
+/*
+ * Minimal HTTP server, listening on a loopback ephemeral port and answering
+ * every request with the same JSON body, optionally after a delay. Meant for
+ * the tests that need to go through the transport (asynchronous execution,
+ * parameter arrays), with no Elasticsearch instance available.
+ */
+class MockServer {
+	private:
+		std::string answer;
+		unsigned delay_ms;
+		uintptr_t lsock;
+		unsigned short lport;
+		std::atomic<bool> stop;
+		std::atomic<unsigned> served;
+		std::thread runner;
+
+		void run();
+		void serve(uintptr_t sock);
+		bool pause();
+
+	public:
+		MockServer(const char *jsonAnswer, unsigned delayMs = 0);
+		virtual ~MockServer();
+
+		unsigned short port() { return lport; }
+		/* count of requests answered so far */
+		unsigned requests() { return served; }
+};
+
+/*
+ * Provides a connected DBC and a statement of it, whose transport goes to a
+ * mock server (vs. the unreachable default Elasticsearch endpoint).
+ */
+class MockedDBC : public ConnectedDBC {
+	protected:
+		SQLHANDLE mdbc = SQL_NULL_HANDLE, mstmt = SQL_NULL_HANDLE;
+
+	void connectTo(MockServer &server);
+	virtual ~MockedDBC();
+};
+
+#endif /* __MOCK_SERVER_H__ */
@@ -0,0 +1,162 @@
+/*
+ * Copyright Elasticsearch B.V. and/or licensed to Elasticsearch B.V. under one
+ * or more contributor license agreements. Licensed under the Elastic License;
+ * you may not use this file except in compliance with the Elastic License.
+ */
+
+extern "C" {
+#include "arrow.h"
+} // extern C
+
+#include "connected_dbc.h"
+#include <gtest/gtest.h>
+#include <string.h>
+
+
+namespace test {
+
+class Arrow : public ::testing::Test, public ConnectedDBC {
+};
+
+static bool is_valid(const struct ArrowArray *arr, int64_t i)
+{
+	const uint8_t *bmap = (const uint8_t *)arr->buffers[0];
+	return (! bmap) || (bmap[i >> 3] & (1 << (i & 7)));
+}
+
+TEST_F(Arrow, RecordBatch) {
+
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"k\", \"type\": \"keyword\"},\
+    {\"name\": \"l\", \"type\": \"long\"},\
+    {\"name\": \"b\", \"type\": \"boolean\"},\
+    {\"name\": \"dt\", \"type\": \"datetime\"},\
+    {\"name\": \"t\", \"type\": \"text\"}\
+  ],\
+  \"rows\": [\
+    [\"foo\", 1, true, \"1970-01-02T00:00:01.5Z\", \"x\"],\
+    [\"bar\", null, false, null, \"\\u00e9\"],\
+    [\"foo\", -3, null, \"1969-12-31T23:59:59Z\", null]\
+  ]\
+}\
+";
+	struct ArrowSchema schema;
+	struct ArrowArray array;
+
+	prepareStatement(json_answer);
+
+	ret = SQLFetchArrow(stmt, &schema, &array);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_TRUE(schema.release != NULL);
+	ASSERT_TRUE(array.release != NULL);
+
+	EXPECT_STREQ(schema.format, "+s");
+	ASSERT_EQ(schema.n_children, 5);
+	ASSERT_EQ(array.n_children, 5);
+	EXPECT_EQ(array.length, 3);
+
+	/* keyword: dictionary-encoded */
+	struct ArrowSchema *s = schema.children[0];
+	struct ArrowArray *a = array.children[0];
+	EXPECT_STREQ(s->name, "k");
+	EXPECT_STREQ(s->format, "i");
+	ASSERT_TRUE(s->dictionary != NULL);
+	EXPECT_STREQ(s->dictionary->format, "u");
+	ASSERT_TRUE(a->dictionary != NULL);
+	EXPECT_EQ(a->dictionary->length, 2);
+	const int32_t *idx = (const int32_t *)a->buffers[1];
+	EXPECT_EQ(idx[0], 0);
+	EXPECT_EQ(idx[1], 1);
+	EXPECT_EQ(idx[2], 0);
+	const int32_t *offs = (const int32_t *)a->dictionary->buffers[1];
+	const char *data = (const char *)a->dictionary->buffers[2];
+	EXPECT_EQ(offs[2], 6);
+	EXPECT_EQ(memcmp(data, "foobar", 6), 0);
+
+	/* long, with a NULL */
+	s = schema.children[1];
+	a = array.children[1];
+	EXPECT_STREQ(s->format, "l");
+	EXPECT_EQ(a->null_count, 1);
+	ASSERT_TRUE(a->buffers[0] != NULL);
+	EXPECT_TRUE(is_valid(a, 0));
+	EXPECT_FALSE(is_valid(a, 1));
+	EXPECT_TRUE(is_valid(a, 2));
+	EXPECT_EQ(((const int64_t *)a->buffers[1])[0], 1);
+	EXPECT_EQ(((const int64_t *)a->buffers[1])[2], -3);
+
+	/* boolean: bit-packed */
+	s = schema.children[2];
+	a = array.children[2];
+	EXPECT_STREQ(s->format, "b");
+	EXPECT_EQ(a->null_count, 1);
+	EXPECT_EQ(((const uint8_t *)a->buffers[1])[0] & 0x3, 0x1);
+
+	/* datetime: microseconds since Epoch */
+	s = schema.children[3];
+	a = array.children[3];
+	EXPECT_STREQ(s->format, "tsu:UTC");
+	EXPECT_EQ(((const int64_t *)a->buffers[1])[0], 86401500000LL);
+	EXPECT_FALSE(is_valid(a, 1));
+	EXPECT_EQ(((const int64_t *)a->buffers[1])[2], -1000000LL);
+
+	/* text: UTF-8 */
+	s = schema.children[4];
+	a = array.children[4];
+	EXPECT_STREQ(s->format, "u");
+	offs = (const int32_t *)a->buffers[1];
+	data = (const char *)a->buffers[2];
+	EXPECT_EQ(offs[1], 1);
+	EXPECT_EQ(offs[2], 3); /* U+00E9 takes two bytes */
+	EXPECT_EQ(offs[3], 3);
+	EXPECT_EQ(memcmp(data, "x\xC3\xA9", 3), 0);
+	EXPECT_FALSE(is_valid(a, 2));
+
+	schema.release(&schema);
+	array.release(&array);
+	EXPECT_TRUE(schema.release == NULL);
+	EXPECT_TRUE(array.release == NULL);
+
+	ret = SQLFetchArrow(stmt, &schema, &array);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+}
+
+TEST_F(Arrow, AfterFetch) {
+
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"i\", \"type\": \"integer\"}\
+  ],\
+  \"rows\": [\
+    [1], [2], [3]\
+  ]\
+}\
+";
+	struct ArrowSchema schema;
+	struct ArrowArray array;
+
+	prepareStatement(json_answer);
+
+	/* the batch holds the rows not yet fetched */
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLFetchArrow(stmt, &schema, &array);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(array.length, 2);
+	EXPECT_STREQ(schema.children[0]->format, "i");
+	EXPECT_TRUE(array.children[0]->buffers[0] == NULL);
+	EXPECT_EQ(((const int32_t *)array.children[0]->buffers[1])[0], 2);
+	EXPECT_EQ(((const int32_t *)array.children[0]->buffers[1])[1], 3);
+	schema.release(&schema);
+	array.release(&array);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+}
+
+} // test namespace
+
@@ -85,5 +85,311 @@ TEST_F(BindCol, ColumnWise) {
 }
 
 
+/* CBOR result sets are copied column by column, with column-wise binding */
+TEST_F(BindCol, ColumnWiseCbor) {
+
+	/* {"columns": [{"name": "l", "type": "long"},
+	 *   {"name": "d", "type": "double"}],
+	 *  "rows": [[1, 1.5], [2, null], [3, 3.5]]} */
+	const unsigned char cbor_answer[] = {
+		0xA2,
+		0x67, 'c', 'o', 'l', 'u', 'm', 'n', 's',
+		0x82,
+		0xA2, 0x64, 'n', 'a', 'm', 'e', 0x61, 'l',
+		0x64, 't', 'y', 'p', 'e', 0x64, 'l', 'o', 'n', 'g',
+		0xA2, 0x64, 'n', 'a', 'm', 'e', 0x61, 'd',
+		0x64, 't', 'y', 'p', 'e', 0x66, 'd', 'o', 'u', 'b', 'l', 'e',
+		0x64, 'r', 'o', 'w', 's',
+		0x83,
+		0x82, 0x01, 0xFB, 0x3F, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x82, 0x02, 0xF6,
+		0x82, 0x03, 0xFB, 0x40, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	};
+
+#define CBOR_ROWS	3
+	SQLBIGINT lbuff[CBOR_ROWS];
+	SQLDOUBLE dbuff[CBOR_ROWS];
+	SQLLEN lind[CBOR_ROWS], dind[CBOR_ROWS];
+	SQLUSMALLINT row_stats[CBOR_ROWS];
+	SQLULEN fetched_rows;
+
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_BIND_TYPE,
+			(SQLPOINTER)SQL_BIND_BY_COLUMN, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_ARRAY_SIZE,
+			(SQLPOINTER)CBOR_ROWS, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_STATUS_PTR, row_stats, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROWS_FETCHED_PTR, &fetched_rows, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLBindCol(stmt, /*col#*/1, SQL_C_SBIGINT, lbuff, sizeof(lbuff[0]),
+			lind);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLBindCol(stmt, /*col#*/2, SQL_C_DOUBLE, dbuff, sizeof(dbuff[0]),
+			dind);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	prepareStatement((const uint8_t *)cbor_answer, sizeof(cbor_answer));
+
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	EXPECT_EQ(fetched_rows, CBOR_ROWS);
+	for (SQLUINTEGER i = 0; i < CBOR_ROWS; i ++) {
+		EXPECT_EQ(lbuff[i], i + 1);
+		EXPECT_EQ(lind[i], sizeof(SQLBIGINT));
+		EXPECT_EQ(row_stats[i], SQL_ROW_SUCCESS);
+	}
+	EXPECT_EQ(dbuff[0], 1.5);
+	EXPECT_EQ(dind[1], SQL_NULL_DATA);
+	EXPECT_EQ(dbuff[2], 3.5);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+#undef CBOR_ROWS
+}
+
+/* column-major result sets are copied column by column, with column-wise
+ * binding; the columns not bound are stepped over */
+TEST_F(BindCol, ColumnarJson) {
+
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"s\", \"type\": \"keyword\"},\
+    {\"name\": \"l\", \"type\": \"long\"}\
+  ],\
+  \"values\": [\
+    [\"a\", \"b\", \"c\"],\
+    [1, 2, 3]\
+  ]\
+}\
+";
+
+#define ARR_SZ	2
+	SQLINTEGER buff[ARR_SZ];
+	SQLLEN ind_len_buff[ARR_SZ];
+	SQLUSMALLINT row_stats[ARR_SZ];
+	SQLULEN fetched_rows;
+	SQLLEN row_cnt;
+
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_BIND_TYPE,
+			(SQLPOINTER)SQL_BIND_BY_COLUMN, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)ARR_SZ, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROW_STATUS_PTR, row_stats, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ROWS_FETCHED_PTR, &fetched_rows, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLBindCol(stmt, /*col#*/2, SQL_C_SLONG, buff, sizeof(buff[0]),
+			ind_len_buff);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	prepareStatement(json_answer);
+
+	ret = SQLRowCount(stmt, &row_cnt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(row_cnt, 3);
+
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(fetched_rows, ARR_SZ);
+	for (SQLUINTEGER i = 0; i < ARR_SZ; i ++) {
+		EXPECT_EQ(buff[i], i + 1);
+		EXPECT_EQ(row_stats[i], SQL_ROW_SUCCESS);
+	}
+
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(fetched_rows, 1);
+	EXPECT_EQ(buff[0], 3);
+	EXPECT_EQ(row_stats[0], SQL_ROW_SUCCESS);
+	EXPECT_EQ(row_stats[1], SQL_ROW_NOROW);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+#undef ARR_SZ
+}
+
+/* column-major CBOR result sets can be fetched row by row, with
+ * SQLGetData() */
+TEST_F(BindCol, ColumnarCborGetData) {
+
+	/* {"columns": [{"name": "l", "type": "long"},
+	 *   {"name": "s", "type": "keyword"}],
+	 *  "values": [[1, 2], ["x", null]]} */
+	const unsigned char cbor_answer[] = {
+		0xA2,
+		0x67, 'c', 'o', 'l', 'u', 'm', 'n', 's',
+		0x82,
+		0xA2, 0x64, 'n', 'a', 'm', 'e', 0x61, 'l',
+		0x64, 't', 'y', 'p', 'e', 0x64, 'l', 'o', 'n', 'g',
+		0xA2, 0x64, 'n', 'a', 'm', 'e', 0x61, 's',
+		0x64, 't', 'y', 'p', 'e', 0x67, 'k', 'e', 'y', 'w', 'o', 'r', 'd',
+		0x66, 'v', 'a', 'l', 'u', 'e', 's',
+		0x82,
+		0x82, 0x01, 0x02,
+		0x82, 0x61, 'x', 0xF6,
+	};
+	SQLBIGINT lval;
+	SQLCHAR sval[8];
+	SQLLEN ind;
+
+	prepareStatement((const uint8_t *)cbor_answer, sizeof(cbor_answer));
+
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLGetData(stmt, /*col*/1, SQL_C_SBIGINT, &lval, sizeof(lval), &ind);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(lval, 1);
+	ret = SQLGetData(stmt, /*col*/2, SQL_C_CHAR, sval, sizeof(sval), &ind);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(ind, 1);
+	EXPECT_STREQ((char *)sval, "x");
+
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLGetData(stmt, /*col*/1, SQL_C_SBIGINT, &lval, sizeof(lval), &ind);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(lval, 2);
+	ret = SQLGetData(stmt, /*col*/2, SQL_C_CHAR, sval, sizeof(sval), &ind);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(ind, SQL_NULL_DATA);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+}
+
+/* conversion plans are rebuilt when a column is rebound between fetches */
+TEST_F(BindCol, RebindBetweenFetches) {
+
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"col_name\", \"type\": \"long\"}\
+  ],\
+  \"rows\": [\
+    [1],[2]\
+  ]\
+}\
+";
+	SQLBIGINT val;
+	SQLCHAR buff[sizeof("-9223372036854775808")];
+	SQLLEN ind_len;
+
+	ret = SQLBindCol(stmt, /*col#*/1, SQL_C_SBIGINT, &val, sizeof(val),
+			&ind_len);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	prepareStatement(json_answer);
+
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_EQ(val, 1);
+	EXPECT_EQ(ind_len, sizeof(val));
+
+	ret = SQLBindCol(stmt, /*col#*/1, SQL_C_CHAR, buff, sizeof(buff),
+			&ind_len);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	EXPECT_STREQ((char *)buff, "2");
+	EXPECT_EQ(ind_len, 1);
+}
+
+/* UTF-8 text is passed through into SQL_C_CHAR, truncated to whole chars */
+TEST_F(BindCol, Utf8PassthroughCbor) {
+
+	/* {"columns": [{"name": "k", "type": "keyword"}],
+	 *  "rows": [["abc"], ["\u00e4\u00f6\u00fc"]]} */
+	const unsigned char cbor_answer[] = {
+		0xA2,
+		0x67, 'c', 'o', 'l', 'u', 'm', 'n', 's',
+		0x81,
+		0xA2, 0x64, 'n', 'a', 'm', 'e', 0x61, 'k',
+		0x64, 't', 'y', 'p', 'e', 0x67, 'k', 'e', 'y', 'w', 'o', 'r', 'd',
+		0x64, 'r', 'o', 'w', 's',
+		0x82,
+		0x81, 0x63, 'a', 'b', 'c',
+		0x81, 0x66, 0xC3, 0xA4, 0xC3, 0xB6, 0xC3, 0xBC,
+	};
+	/* room for two of the three two-byte chars and a half */
+	SQLCHAR buff[6];
+	SQLLEN ind_len;
+
+	ret = SQLBindCol(stmt, /*col#*/1, SQL_C_CHAR, buff, sizeof(buff),
+			&ind_len);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	prepareStatement((const uint8_t *)cbor_answer, sizeof(cbor_answer));
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_SUCCESS);
+	EXPECT_STREQ((char *)buff, "abc");
+	EXPECT_EQ(ind_len, 3);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_SUCCESS_WITH_INFO);
+	assertState(L"01004");
+	EXPECT_STREQ((char *)buff, "\xC3\xA4\xC3\xB6");
+	EXPECT_EQ(ind_len, 6);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+}
+
+/* datetimes are parsed from UTF-8 into SQL_C_TYPE_TIMESTAMP, with the
+ * generic parser as fallback for non-UTC values */
+TEST_F(BindCol, DatetimeCbor) {
+
+	/* {"columns": [{"name": "dt", "type": "datetime"}],
+	 *  "rows": [["2345-01-23T12:34:56.789Z"],
+	 *    ["2345-01-23T12:34:56+01:00"]]} */
+	const char cbor_answer[] =
+		"\xA2"
+		"\x67" "columns"
+		"\x81"
+		"\xA2" "\x64" "name" "\x62" "dt"
+		"\x64" "type" "\x68" "datetime"
+		"\x64" "rows"
+		"\x82"
+		"\x81" "\x78\x18" "2345-01-23T12:34:56.789Z"
+		"\x81" "\x78\x19" "2345-01-23T12:34:56+01:00";
+	TIMESTAMP_STRUCT ts;
+	SQLLEN ind_len;
+
+	ret = SQLBindCol(stmt, /*col#*/1, SQL_C_TYPE_TIMESTAMP, &ts, sizeof(ts),
+			&ind_len);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	prepareStatement((const uint8_t *)cbor_answer,
+		sizeof(cbor_answer) - /*\0*/1);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_SUCCESS);
+	EXPECT_EQ(ind_len, sizeof(ts));
+	EXPECT_EQ(ts.year, 2345);
+	EXPECT_EQ(ts.month, 1);
+	EXPECT_EQ(ts.day, 23);
+	EXPECT_EQ(ts.hour, 12);
+	EXPECT_EQ(ts.minute, 34);
+	EXPECT_EQ(ts.second, 56);
+	EXPECT_EQ(ts.fraction, 789000000);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_SUCCESS);
+	EXPECT_EQ(ts.hour, 11);
+	EXPECT_EQ(ts.minute, 34);
+	EXPECT_EQ(ts.fraction, 0);
+
+	ret = SQLFetch(stmt);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+}
+
 } // test namespace
 
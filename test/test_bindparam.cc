@@ -6,13 +6,14 @@
 
 #include <gtest/gtest.h>
 #include "connected_dbc.h"
+#include "mock_server.h"
 
 #include <string.h>
 
 
 namespace test {
 
-class BindParam : public ::testing::Test, public ConnectedDBC {
+class BindParam : public ::testing::Test, public MockedDBC {
 };
 
 
@@ -129,5 +130,68 @@ TEST_F(BindParam, BindTwo) {
 			"{\"type\": \"BOOLEAN\", \"value\": false}]");
 }
 
+TEST_F(BindParam, ParamArray) {
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"b\", \"type\": \"boolean\"}\
+  ],\
+  \"rows\": [\
+    [true]\
+  ]\
+}\
+";
+	MockServer server(json_answer);
+	SQLWCHAR sql[] = L"SELECT ?";
+	SQLSMALLINT vals[] = {1, 0, 1};
+	SQLUSMALLINT ops[] = {SQL_PARAM_PROCEED, SQL_PARAM_IGNORE,
+			SQL_PARAM_PROCEED};
+	SQLUSMALLINT status[] = {SQL_PARAM_ERROR, SQL_PARAM_ERROR,
+			SQL_PARAM_ERROR};
+	SQLULEN processed = 0;
+
+	connectTo(server);
+	ret = SQLPrepareW(mstmt, sql, SQL_NTS);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLBindParameter(mstmt, /*param nr*/1, SQL_PARAM_INPUT,
+			SQL_C_SSHORT, ESODBC_SQL_BOOLEAN, /*size*/0, /*decdigits*/0, vals,
+			sizeof(*vals), /*IndLen*/NULL);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLSetStmtAttr(mstmt, SQL_ATTR_PARAMSET_SIZE,
+			(SQLPOINTER)(sizeof(vals)/sizeof(*vals)), SQL_IS_UINTEGER);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(mstmt, SQL_ATTR_PARAM_OPERATION_PTR, ops,
+			SQL_IS_POINTER);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(mstmt, SQL_ATTR_PARAM_STATUS_PTR, status,
+			SQL_IS_POINTER);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(mstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, &processed,
+			SQL_IS_POINTER);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLExecute(mstmt);
+	ASSERT_EQ(ret, SQL_SUCCESS);
+
+	/* the ignored set is not posted */
+	ASSERT_EQ(status[0], SQL_PARAM_SUCCESS);
+	ASSERT_EQ(status[1], SQL_PARAM_UNUSED);
+	ASSERT_EQ(status[2], SQL_PARAM_SUCCESS);
+	ASSERT_EQ(processed, 2U);
+	ASSERT_EQ(server.requests(), 2U);
+
+	/* one result set per executed set */
+	ret = SQLFetch(mstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLMoreResults(mstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLFetch(mstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLMoreResults(mstmt);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+}
+
 } // test namespace
 
@@ -151,6 +151,57 @@ TEST_F(Catalogue, Columns_update_varchar_defs) {
 #	undef VARCHAR_LIMIT
 }
 
+TEST_F(Catalogue, CacheKeyedByCurrentCatalog) {
+	const char response[] = "{"
+		"\"columns\":["
+			"{\"name\":\"TABLE_CAT\", \"type\":\"keyword\"}"
+		"],"
+		"\"rows\":["
+			"[\"some_catalog\"]"
+		"]"
+	"}";
+	wstr_st sql = WSTR_INIT("SYS TABLES CATALOG LIKE '%' ESCAPE '\\'");
+	wstr_st cat_a = WSTR_INIT("catalog_a");
+	wstr_st cat_b = WSTR_INIT("catalog_b");
+	esodbc_dbc_st *edbc = HDRH(stmt)->dbc;
+	cstr_st body;
+	BOOL is_json;
+
+	edbc->meta_cache_ttl = 60;
+	prepareStatement(response);
+
+	/* cached with no current catalog */
+	cat_cache_add(STMH(stmt), &sql);
+	ASSERT_TRUE(cat_cache_lookup(edbc, &sql, &body, &is_json));
+	free(body.str);
+
+	/* a catalog change misses the previous entries.. */
+	ASSERT_TRUE(SQL_SUCCEEDED(SQLSetConnectAttrW(dbc,
+					SQL_ATTR_CURRENT_CATALOG, (SQLPOINTER)cat_a.str,
+					(SQLINTEGER)(cat_a.cnt * sizeof(SQLWCHAR)))));
+	ASSERT_FALSE(cat_cache_lookup(edbc, &sql, &body, &is_json));
+	cat_cache_add(STMH(stmt), &sql);
+	ASSERT_TRUE(cat_cache_lookup(edbc, &sql, &body, &is_json));
+	ASSERT_TRUE(is_json);
+	ASSERT_EQ(body.cnt, sizeof(response) - 1);
+	free(body.str);
+
+	ASSERT_TRUE(SQL_SUCCEEDED(SQLSetConnectAttrW(dbc,
+					SQL_ATTR_CURRENT_CATALOG, (SQLPOINTER)cat_b.str,
+					(SQLINTEGER)(cat_b.cnt * sizeof(SQLWCHAR)))));
+	ASSERT_FALSE(cat_cache_lookup(edbc, &sql, &body, &is_json));
+
+	/* ..which are served again once switching back */
+	ASSERT_TRUE(SQL_SUCCEEDED(SQLSetConnectAttrW(dbc,
+					SQL_ATTR_CURRENT_CATALOG, (SQLPOINTER)cat_a.str,
+					(SQLINTEGER)(cat_a.cnt * sizeof(SQLWCHAR)))));
+	ASSERT_TRUE(cat_cache_lookup(edbc, &sql, &body, &is_json));
+	free(body.str);
+
+	catalog_cache_clear(edbc);
+	edbc->meta_cache_ttl = 0;
+}
+
 } // test namespace
 
 /* vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 : */
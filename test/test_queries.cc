@@ -6,15 +6,38 @@
 
 extern "C" {
 #include "queries.h"
+#include "connect.h"
 } // extern C
 
 #include "connected_dbc.h"
+#include "mock_server.h"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 
 namespace test {
 
 class Queries : public ::testing::Test, public ConnectedDBC {
+	protected:
+		/* replaces the DBC's API key with a copy of given one, or clears it
+		 * for a NULL key; the DBC frees its key when cleaned up */
+		void setApiKey(const char *key)
+		{
+			esodbc_dbc_st *edbc = (esodbc_dbc_st *)dbc;
+
+			if (edbc->api_key.str) {
+				free(edbc->api_key.str);
+				edbc->api_key.str = NULL;
+				edbc->api_key.cnt = 0;
+			}
+			if (key) {
+				edbc->api_key.str = (SQLCHAR *)STRDUP(key);
+				ASSERT_TRUE(edbc->api_key.str != NULL);
+				edbc->api_key.cnt = strlen(key);
+			}
+		}
 };
 
 TEST_F(Queries, attach_error_sql) {
@@ -375,6 +398,347 @@ TEST_F(Queries, serialize_with_catalog) {
 #	undef CURRENT_CATALOG
 }
 
+TEST_F(Queries, SQLCancel_idle) {
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"i\", \"type\": \"integer\"}\
+  ],\
+  \"rows\": [\
+    [1]\
+  ]\
+}\
+";
+	prepareStatement(json_answer);
+
+	/* no request under way: only flags the statement */
+	ret = SQLCancel(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_TRUE(STMH(stmt)->cancel);
+
+	/* the already received result set is not affected */
+	ret = SQLFetch(stmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+}
+
+TEST_F(Queries, SQLSetStmtAttr_async_enable) {
+	SQLULEN async_enable = SQL_ASYNC_ENABLE_OFF;
+
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ASYNC_ENABLE,
+			(SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLGetStmtAttr(stmt, SQL_ATTR_ASYNC_ENABLE, &async_enable,
+			sizeof(async_enable), NULL);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(async_enable, SQL_ASYNC_ENABLE_ON);
+
+	/* invalid value */
+	ret = SQLSetStmtAttr(stmt, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER)2, 0);
+	ASSERT_FALSE(SQL_SUCCEEDED(ret));
+	assertState(L"HY024");
+}
+
+TEST_F(Queries, perf_counters) {
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"i\", \"type\": \"integer\"}\
+  ],\
+  \"rows\": [\
+    [1],\
+    [2]\
+  ]\
+}\
+";
+	SQLINTEGER val;
+	SQLLEN ind;
+	SQLUBIGINT cnt;
+
+	ret = SQLSetConnectAttr(dbc, ESODBC_SQL_ATTR_PERF(ESODBC_PERF_ROWS),
+			NULL, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	prepareStatement(json_answer);
+
+	ret = SQLBindCol(stmt, /*col#*/1, SQL_C_SLONG, &val, sizeof(val), &ind);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	while (SQL_SUCCEEDED(ret = SQLFetch(stmt)))
+		;
+	ASSERT_EQ(ret, SQL_NO_DATA);
+
+	ret = SQLGetStmtAttr(stmt, ESODBC_SQL_ATTR_PERF(ESODBC_PERF_PAGES), &cnt,
+			sizeof(cnt), NULL);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(cnt, 1);
+	ret = SQLGetStmtAttr(stmt, ESODBC_SQL_ATTR_PERF(ESODBC_PERF_ROWS), &cnt,
+			sizeof(cnt), NULL);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(cnt, 2);
+	/* the connection accounts for its statements too */
+	ret = SQLGetConnectAttr(dbc, ESODBC_SQL_ATTR_PERF(ESODBC_PERF_ROWS),
+			&cnt, sizeof(cnt), NULL);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(cnt, 2);
+
+	/* setting any counter resets them all */
+	ret = SQLSetStmtAttr(stmt, ESODBC_SQL_ATTR_PERF_BASE, NULL, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLGetStmtAttr(stmt, ESODBC_SQL_ATTR_PERF(ESODBC_PERF_ROWS), &cnt,
+			sizeof(cnt), NULL);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(cnt, 0);
+}
+
+TEST_F(Queries, ResultCache) {
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"i\", \"type\": \"integer\"}\
+  ],\
+  \"rows\": [\
+    [1]\
+  ]\
+}\
+";
+	cstr_st req = CSTR_INIT("{\"query\":\"SELECT i FROM t\"}");
+	cstr_st other = CSTR_INIT("{\"query\":\"SELECT j FROM t\"}");
+	cstr_st answer;
+	BOOL is_json;
+	SQLUBIGINT cnt;
+
+	ret = SQLSetConnectAttr(dbc, ESODBC_SQL_ATTR_RSLT_CACHE_TTL,
+			(SQLPOINTER)60, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	prepareStatement(json_answer);
+
+	rslt_cache_add((esodbc_stmt_st *)stmt, &req);
+	ASSERT_TRUE(rslt_cache_lookup((esodbc_stmt_st *)stmt, &req, &answer,
+			&is_json));
+	ASSERT_TRUE(is_json);
+	ASSERT_EQ(answer.cnt, sizeof(json_answer) - 1);
+	ASSERT_EQ(memcmp(answer.str, json_answer, answer.cnt), 0);
+	free(answer.str);
+	ASSERT_FALSE(rslt_cache_lookup((esodbc_stmt_st *)stmt, &other, &answer,
+			&is_json));
+
+	ret = SQLGetStmtAttr(stmt,
+			ESODBC_SQL_ATTR_PERF(ESODBC_PERF_RSLT_CACHE_HITS), &cnt,
+			sizeof(cnt), NULL);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(cnt, 1);
+	ret = SQLGetStmtAttr(stmt,
+			ESODBC_SQL_ATTR_PERF(ESODBC_PERF_RSLT_CACHE_MISSES), &cnt,
+			sizeof(cnt), NULL);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(cnt, 1);
+
+	/* a cache refresh drops the connection's cached results */
+	ret = SQLSetConnectAttr(dbc, ESODBC_SQL_ATTR_CACHE_REFRESH,
+			(SQLPOINTER)TRUE, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_FALSE(rslt_cache_lookup((esodbc_stmt_st *)stmt, &req, &answer,
+			&is_json));
+}
+
+TEST_F(Queries, ResultCacheApiKey) {
+	const char json_answer[] = "\
+{\
+  \"columns\": [\
+    {\"name\": \"i\", \"type\": \"integer\"}\
+  ],\
+  \"rows\": [\
+    [1]\
+  ]\
+}\
+";
+	cstr_st req = CSTR_INIT("{\"query\":\"SELECT i FROM t\"}");
+	const char key1[] = "a2V5MTpzZWNyZXQx";
+	const char key2[] = "a2V5MjpzZWNyZXQy";
+	cstr_st answer;
+	BOOL is_json;
+	esodbc_dbc_st *edbc = (esodbc_dbc_st *)dbc;
+
+	ret = SQLSetConnectAttr(dbc, ESODBC_SQL_ATTR_RSLT_CACHE_TTL,
+			(SQLPOINTER)60, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	prepareStatement(json_answer);
+
+	/* no user name set: the API key is used */
+	ASSERT_EQ(edbc->uid.cnt, 0);
+	ASSERT_EQ(edbc->api_key.cnt, 0);
+
+	setApiKey(key1);
+	rslt_cache_add((esodbc_stmt_st *)stmt, &req);
+	ASSERT_TRUE(rslt_cache_lookup((esodbc_stmt_st *)stmt, &req, &answer,
+			&is_json));
+	free(answer.str);
+
+	/* a connection with a different API key misses the entry... */
+	setApiKey(key2);
+	ASSERT_FALSE(rslt_cache_lookup((esodbc_stmt_st *)stmt, &req, &answer,
+			&is_json));
+	/* ...as does one without any */
+	setApiKey(NULL);
+	ASSERT_FALSE(rslt_cache_lookup((esodbc_stmt_st *)stmt, &req, &answer,
+			&is_json));
+
+	/* entries of different API keys coexist */
+	setApiKey(key2);
+	rslt_cache_add((esodbc_stmt_st *)stmt, &req);
+	ASSERT_TRUE(rslt_cache_lookup((esodbc_stmt_st *)stmt, &req, &answer,
+			&is_json));
+	free(answer.str);
+	setApiKey(key1);
+	ASSERT_TRUE(rslt_cache_lookup((esodbc_stmt_st *)stmt, &req, &answer,
+			&is_json));
+	ASSERT_EQ(answer.cnt, sizeof(json_answer) - 1);
+	free(answer.str);
+
+	setApiKey(NULL);
+}
+
+class QueriesAsync : public ::testing::Test, public MockedDBC {
+	protected:
+		/* re-invokes SQLExecDirect() until the execution is no longer under
+		 * way, for up to about 5 seconds */
+		SQLRETURN pollExecDirect(SQLWCHAR *sql)
+		{
+			SQLRETURN ret;
+			int i;
+
+			for (i = 0; i < 500; i ++) {
+				ret = SQLExecDirectW(mstmt, sql, SQL_NTS);
+				if (ret != SQL_STILL_EXECUTING) {
+					break;
+				}
+				Sleep(10);
+			}
+			return ret;
+		}
+};
+
+#define ASYNC_ANSWER "\
+{\
+  \"columns\": [\
+    {\"name\": \"i\", \"type\": \"integer\"}\
+  ],\
+  \"rows\": [\
+    [1]\
+  ]\
+}\
+"
+
+TEST_F(QueriesAsync, SQLExecDirect_poll) {
+	MockServer server(ASYNC_ANSWER, /*delay*/300);
+	SQLWCHAR sql[] = L"SELECT 1";
+	SQLINTEGER val = 0;
+	SQLLEN ind;
+
+	connectTo(server);
+	ret = SQLSetStmtAttr(mstmt, SQL_ATTR_ASYNC_ENABLE,
+			(SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	/* the server holds the answer back: request must be left under way */
+	ret = SQLExecDirectW(mstmt, sql, SQL_NTS);
+	ASSERT_EQ(ret, SQL_STILL_EXECUTING);
+
+	ret = pollExecDirect(sql);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(server.requests(), 1U);
+
+	ret = SQLFetch(mstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLGetData(mstmt, /*col#*/1, SQL_C_SLONG, &val, sizeof(val), &ind);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_EQ(val, 1);
+	ret = SQLFetch(mstmt);
+	ASSERT_EQ(ret, SQL_NO_DATA);
+}
+
+TEST_F(QueriesAsync, SQLExecDirect_cancel) {
+	/* (the server gives up waiting once destroyed) */
+	MockServer server(ASYNC_ANSWER, /*delay*/60 * 1000);
+	SQLWCHAR sql[] = L"SELECT 1";
+	SQLWCHAR state[SQL_SQLSTATE_SIZE + 1];
+	SQLSMALLINT len;
+
+	connectTo(server);
+	ret = SQLSetStmtAttr(mstmt, SQL_ATTR_ASYNC_ENABLE,
+			(SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	ret = SQLExecDirectW(mstmt, sql, SQL_NTS);
+	ASSERT_EQ(ret, SQL_STILL_EXECUTING);
+
+	ret = SQLCancel(mstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	/* next poll abandons the request */
+	ret = pollExecDirect(sql);
+	ASSERT_EQ(ret, SQL_ERROR);
+	ret = SQLGetDiagField(SQL_HANDLE_STMT, mstmt, 1, SQL_DIAG_SQLSTATE,
+			state, sizeof(state), &len);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_STREQ(state, L"HY008");
+	ASSERT_EQ(server.requests(), 0U);
+
+	/* statement no longer executing: no result set to fetch */
+	ret = SQLFetch(mstmt);
+	ASSERT_EQ(ret, SQL_ERROR);
+}
+
+TEST_F(QueriesAsync, SQLExecDirect_poll_concurrent) {
+	/* the server answers one request at a time, each after the delay */
+	MockServer server(ASYNC_ANSWER, /*delay*/1000);
+	SQLWCHAR sql[] = L"SELECT 1";
+	SQLHANDLE sstmt = SQL_NULL_HANDLE;
+	std::atomic<bool> sync_done(false);
+	SQLRETURN sync_ret = SQL_ERROR;
+	unsigned polls_meanwhile = 0;
+	int i;
+
+	connectTo(server);
+	ret = SQLAllocHandle(SQL_HANDLE_STMT, mdbc, &sstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLSetStmtAttr(mstmt, SQL_ATTR_ASYNC_ENABLE,
+			(SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+
+	/* another statement's synchronous transfer holds the DBC's handle */
+	std::thread sync([&] {
+		sync_ret = SQLExecDirectW(sstmt, sql, SQL_NTS);
+		sync_done = true;
+	});
+	Sleep(200);
+
+	/* neither starting, nor polling the async request must wait on it */
+	for (i = 0; i < 500; i ++) {
+		auto start = std::chrono::steady_clock::now();
+		ret = SQLExecDirectW(mstmt, sql, SQL_NTS);
+		auto lapse = std::chrono::steady_clock::now() - start;
+		EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(
+				lapse).count(), 200);
+		if (ret != SQL_STILL_EXECUTING) {
+			break;
+		}
+		if (! sync_done) {
+			polls_meanwhile ++;
+		}
+		Sleep(10);
+	}
+	sync.join();
+
+	ASSERT_TRUE(SQL_SUCCEEDED(sync_ret));
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ASSERT_LT(0U, polls_meanwhile);
+	ASSERT_EQ(server.requests(), 2U);
+
+	ret = SQLFetch(mstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	ret = SQLFreeHandle(SQL_HANDLE_STMT, sstmt);
+	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+}
+
 } // test namespace
 
 /* vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 : */
@@ -704,14 +704,9 @@ TEST_F(GetData, TrimOnVarcharLimit_chunked) {
 }
 
 TEST_F(GetData, CborChunkedStrings) {
-	cstr_st answer;
-	answer.cnt = sizeof(cbor_answer_string_chunked) - 1;
-	answer.str = (SQLCHAR *)malloc(answer.cnt);
-	assert(answer.str);
-	memcpy(answer.str, cbor_answer_string_chunked, answer.cnt);
 	DBCH(dbc)->pack_json = false;
-	ret = attach_answer(STMH(stmt), &answer, false);
-	ASSERT_TRUE(SQL_SUCCEEDED(ret));
+	prepareStatement(cbor_answer_string_chunked,
+		sizeof(cbor_answer_string_chunked) - 1);
 
 	/* check reassembled value length */
 	ret = SQLFetch(stmt);
@@ -171,6 +171,67 @@ TEST_F(Util, utf8_to_wstr_unicode) {
 	free(dst_wc.str);
 }
 
+/* long enough to take the vectorized ASCII paths, with non-ASCII runs */
+TEST_F(Util, utf8_utf16_long_mixed) {
+#undef SRC_STR
+#define SRC_STR	"0123456789abcdef0123456789abcdef0123456789abcdef" \
+	"\xC3\xA4\xE2\x82\xAC\xF0\x9F\x98\x80" \
+	"0123456789abcdef0123456789abcdef0123456789abcdef"
+	const char *u8 = SRC_STR;
+	int u8cnt = sizeof(SRC_STR) - 1;
+	wchar_t wbuff[sizeof(SRC_STR)];
+	char cbuff[sizeof(SRC_STR)];
+	int wcnt, ccnt;
+
+	/* ASCII + 1 (U+00E4) + 1 (U+20AC) + 2 (U+1F600) */
+	wcnt = U8MB_TO_U16WC(u8, u8cnt, NULL, 0);
+	ASSERT_EQ(wcnt, 2 * 48 + 4);
+	ASSERT_EQ(U8MB_TO_U16WC(u8, u8cnt, wbuff, wcnt), wcnt);
+	ASSERT_EQ(wbuff[48], 0x00E4);
+	ASSERT_EQ(wbuff[49], 0x20AC);
+	ASSERT_EQ(wbuff[50], 0xD83D);
+	ASSERT_EQ(wbuff[51], 0xDE00);
+	ASSERT_EQ(wbuff[wcnt - 1], L'f');
+
+	ASSERT_EQ(U16WC_TO_MBU8(wbuff, wcnt, NULL, 0), u8cnt);
+	ccnt = U16WC_TO_MBU8(wbuff, wcnt, cbuff, sizeof(cbuff));
+	ASSERT_EQ(ccnt, u8cnt);
+	ASSERT_EQ(memcmp(cbuff, u8, u8cnt), 0);
+}
+
+TEST_F(Util, utf8_utf16_short_buffer) {
+#undef SRC_STR
+#define SRC_STR	"0123456789abcdef0123456789abcdef\xC3\xA4"
+	wchar_t wbuff[sizeof(SRC_STR)];
+	char cbuff[sizeof(SRC_STR)];
+
+	ASSERT_EQ(U8MB_TO_U16WC(SRC_STR, sizeof(SRC_STR) - 1, wbuff, 32), 0);
+	ASSERT_TRUE(WAPI_ERR_EBUFF());
+	ASSERT_EQ(U8MB_TO_U16WC(SRC_STR, sizeof(SRC_STR) - 1, wbuff, 33), 33);
+	ASSERT_EQ(U16WC_TO_MBU8(wbuff, 33, cbuff, 33), 0);
+	ASSERT_TRUE(WAPI_ERR_EBUFF());
+}
+
+TEST_F(Util, utf8_utf16_invalid) {
+	wchar_t wbuff[8];
+	char cbuff[8];
+	/* overlong, encoded surrogate, out of range, stray continuation,
+	 * truncated sequence */
+	const char *invalid[] = {"\xC0\x80", "\xED\xA0\x80",
+		"\xF4\x90\x80\x80", "a\x80", "a\xE2\x82"
+	};
+	const wchar_t lone[] = {L'a', 0xD800, L'b'};
+
+	for (size_t i = 0; i < sizeof(invalid)/sizeof(*invalid); i ++) {
+		ASSERT_EQ(U8MB_TO_U16WC(invalid[i], strlen(invalid[i]), wbuff,
+				sizeof(wbuff)/sizeof(*wbuff)), 0);
+		ASSERT_EQ(WAPI_ERRNO(), ERROR_NO_UNICODE_TRANSLATION);
+	}
+	ASSERT_EQ(U16WC_TO_MBU8(lone, sizeof(lone)/sizeof(*lone), cbuff,
+			sizeof(cbuff)), 0);
+	ASSERT_EQ(WAPI_ERRNO(), ERROR_NO_UNICODE_TRANSLATION);
+}
+
 TEST_F(Util, ascii_c2w2c)
 {
 #undef SRC_STR
@@ -266,6 +327,76 @@ TEST_F(Util, metadata_id_escape)
 	ASSERT_TRUE(EQ_WSTR(&dst, &exp));
 }
 
+TEST_F(Util, i64tot)
+{
+	char buff[ESODBC_PRECISION_UINT64 + /*-*/1 + /*\0*/1];
+	SQLWCHAR wbuff[sizeof(buff)];
+
+	ASSERT_EQ(i64tot(0, buff, FALSE), 1);
+	ASSERT_STREQ(buff, "0");
+	ASSERT_EQ(i64tot(-1234567, buff, FALSE), 8);
+	ASSERT_STREQ(buff, "-1234567");
+	ASSERT_EQ(i64tot(INT64_MIN, buff, FALSE), 20);
+	ASSERT_STREQ(buff, "-9223372036854775808");
+	ASSERT_EQ(ui64tot(UINT64_MAX, buff, FALSE), 20);
+	ASSERT_STREQ(buff, "18446744073709551615");
+	ASSERT_EQ(i64tot(-42, wbuff, TRUE), 3);
+	ASSERT_STREQ((wchar_t *)wbuff, L"-42");
+}
+
+TEST_F(Util, dbl2tot)
+{
+	char buff[64];
+	SQLWCHAR wbuff[64];
+
+	/* fixed: the digits past the shortest representation are 0s */
+	ASSERT_EQ(dbl2tot(128.998, 15, FALSE, buff, sizeof(buff), FALSE), 19);
+	ASSERT_STREQ(buff, "128.998000000000000");
+	ASSERT_EQ(dbl2tot(-0.996, 2, FALSE, buff, sizeof(buff), FALSE), 5);
+	ASSERT_STREQ(buff, "-1.00");
+	ASSERT_EQ(dbl2tot(12345.0, 0, FALSE, buff, sizeof(buff), FALSE), 5);
+	ASSERT_STREQ(buff, "12345");
+	ASSERT_EQ(dbl2tot(0.0, 3, FALSE, buff, sizeof(buff), FALSE), 5);
+	ASSERT_STREQ(buff, "0.000");
+	ASSERT_EQ(dbl2tot(1e-5, 3, FALSE, buff, sizeof(buff), FALSE), 5);
+	ASSERT_STREQ(buff, "0.000");
+	/* exponential */
+	ASSERT_EQ(dbl2tot(1e-5, 3, TRUE, buff, sizeof(buff), FALSE), 9);
+	ASSERT_STREQ(buff, "1.000E-05");
+	ASSERT_EQ(dbl2tot(-9.9999e200, 2, TRUE, buff, sizeof(buff), FALSE), 10);
+	ASSERT_STREQ(buff, "-1.00E+201");
+	ASSERT_EQ(dbl2tot(0.1 + 0.2, 16, TRUE, buff, sizeof(buff), FALSE), 22);
+	ASSERT_STREQ(buff, "3.0000000000000004E-01");
+	/* wide */
+	ASSERT_EQ(dbl2tot(-2.5, 1, FALSE, wbuff, 64, TRUE), 4);
+	ASSERT_STREQ((wchar_t *)wbuff, L"-2.5");
+	/* too small a buffer */
+	ASSERT_EQ(dbl2tot(123.456, 2, FALSE, buff, 6, FALSE), 0);
+	ASSERT_EQ(dbl2tot(123.456, 2, FALSE, buff, 7, FALSE), 6);
+}
+
+TEST_F(Util, dbl2tot_rounding)
+{
+	char buff[64];
+	SQLWCHAR wbuff[64];
+
+	/* cutting the shortest digits rounds the exact binary value, as printf
+	 * does: 1.005 is 1.00499999999999989.. */
+	ASSERT_EQ(dbl2tot(1.005, 2, FALSE, buff, sizeof(buff), FALSE), 4);
+	ASSERT_STREQ(buff, "1.00");
+	ASSERT_EQ(dbl2tot(2.675, 2, FALSE, buff, sizeof(buff), FALSE), 4);
+	ASSERT_STREQ(buff, "2.67");
+	ASSERT_EQ(dbl2tot(1.0005, 3, TRUE, buff, sizeof(buff), FALSE), 9);
+	ASSERT_STREQ(buff, "1.000E+00");
+	ASSERT_EQ(dbl2tot(1.005, 2, FALSE, wbuff, 64, TRUE), 4);
+	ASSERT_STREQ((wchar_t *)wbuff, L"1.00");
+	/* ..but no binary noise is printed past the shortest digits */
+	ASSERT_EQ(dbl2tot(0.1, 20, FALSE, buff, sizeof(buff), FALSE), 22);
+	ASSERT_STREQ(buff, "0.10000000000000000000");
+	ASSERT_EQ(dbl2tot(968.653, 19, TRUE, buff, sizeof(buff), FALSE), 25);
+	ASSERT_STREQ(buff, "9.6865300000000000000E+02");
+}
+
 } // test namespace
 
 /* vim: set noet fenc=utf-8 ff=dos sts=0 sw=4 ts=4 : */